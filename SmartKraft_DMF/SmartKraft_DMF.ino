@@ -21,6 +21,8 @@
 #include "mail_functions.h"
 #include "web_handlers.h"
 #include "ota_manager.h"
+#include "tls_session_cache.h"
+#include "wifi_link_cache.h"
 
 // Debug: 0=kapalı, 1=kritik, 2=detaylı
 #ifndef DEBUG_LEVEL
@@ -110,13 +112,10 @@ void resetTimerFromButton() {
 void processAlarms() {
     uint8_t alarmIndex = 0;
 
-    if (scheduler.alarmDue(alarmIndex)) {
+    // Bağlantı beklenmez: ONLINE değilse alarm vadeli kalır, bağlanınca gönderilir
+    if (scheduler.alarmDue(alarmIndex) && networkManager.ensureConnected(true)) {
         ScheduleSnapshot snap = scheduler.snapshot();
         
-        if (!networkManager.isConnected()) {
-            networkManager.ensureConnected(true);
-        }
-        
         String error;
         if (!mailAgent.sendWarning(alarmIndex, snap, error)) {
             // Mail başarısız, tekrar denenecek
@@ -132,9 +131,7 @@ void processAlarms() {
         ScheduleSnapshot snap = scheduler.snapshot();
         latchRelay(true);
         
-        if (!networkManager.isConnected()) {
-            networkManager.ensureConnected(true);
-        }
+        if (!networkManager.ensureConnected(true)) return;
         
         TimerRuntime runtime = scheduler.runtimeState();
         
@@ -274,6 +271,8 @@ void setup() {
     // NOT: initTemperatureSensor() KALDIRILDI
     initHardware();
     configStore.begin();
+    TlsSessionCache::begin(); // Yazılımsal resetten kalan TLS oturumları
+    WiFiLinkCache::begin();   // Son AP (BSSID/kanal) - taramasız bağlanma için
     
     uniqueChipId = getOrCreateDeviceId();
     deviceId = generateDeviceId();
@@ -411,7 +410,6 @@ void loop() {
         
         if (!wifiOk && !apActive) {
             LOG_CRITICAL("[STATUS] WiFi/AP yok, bağlanılıyor...\n");
-            esp_task_wdt_reset();
             networkManager.ensureConnected(false);
         }
         
@@ -424,6 +422,7 @@ void loop() {
         loopCounter = 0;
     }
     
+    networkManager.loop(); // WiFi taraması ve bağlantı durum makinesi
     webUI.loop();
     yield();
     esp_task_wdt_reset();
@@ -478,34 +477,7 @@ void loop() {
         lastHeapCheck = now;
     }
     
-    // WiFi reconnect - AP modunda değilse ve termal blok yoksa
-    static unsigned long lastWiFiReconnect = 0;
-    static uint8_t reconnectFailCount = 0;
-    
-    if (now - lastWiFiReconnect > 30000) {
-        if (!networkManager.isConnected()) {
-            wifi_mode_t mode = WiFi.getMode();
-            // Sadece AP modunda değilse reconnect dene
-            if (mode != WIFI_AP) {
-                esp_task_wdt_reset();
-                bool connected = networkManager.ensureConnected(false);
-                
-                if (!connected) {
-                    reconnectFailCount++;
-                    // 5 başarısız denemeden sonra interval'i artır (2dk)
-                    if (reconnectFailCount >= 5) {
-                        lastWiFiReconnect = now + 90000; // Ekstra 90sn bekle
-                        LOG_CRITICAL("[WIFI] 5x başarısız, 2dk bekleniyor\n");
-                    }
-                } else {
-                    reconnectFailCount = 0;
-                }
-            }
-        } else {
-            reconnectFailCount = 0;
-        }
-        lastWiFiReconnect = now;
-    }
+    // WiFi yeniden bağlanma ve geri çekilme networkManager.loop() içindeki durum makinesinde
     
     if (now - lastWiFiCheck > 300000) {
         disableWiFiPowerSave();
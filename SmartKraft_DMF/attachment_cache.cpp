@@ -0,0 +1,134 @@
+#include "attachment_cache.h"
+#include "base64_stream.h"
+
+namespace {
+
+String tempPathFor(const String &storedPath) {
+    return AttachmentCache::sidecarPath(storedPath) + ".tmp";
+}
+
+}
+
+namespace AttachmentCache {
+
+String sidecarPath(const String &storedPath) {
+    return storedPath + ATTACHMENT_SIDECAR_SUFFIX;
+}
+
+bool build(const String &storedPath, String &errorMessage) {
+    File source = LittleFS.open(storedPath, "r");
+    if (!source) {
+        errorMessage = "Kaynak dosya açılamadı";
+        return false;
+    }
+
+    size_t sourceSize = source.size();
+    size_t encodedSize = Base64Stream::encodedSize(sourceSize);
+    size_t freeBytes = LittleFS.totalBytes() - LittleFS.usedBytes();
+    if (encodedSize + ATTACHMENT_CACHE_FS_RESERVE > freeBytes) {
+        source.close();
+        errorMessage = "Flash'ta yer yok (" + String(encodedSize) + " bayt gerekli)";
+        return false;
+    }
+
+    String tempPath = tempPathFor(storedPath);
+    File target = LittleFS.open(tempPath, "w");
+    if (!target) {
+        source.close();
+        errorMessage = "Sidecar oluşturulamadı";
+        return false;
+    }
+
+    uint32_t start = millis();
+    uint8_t input[Base64Stream::LINE_INPUT * 8];
+    char output[Base64Stream::encodedSize(sizeof(input))];
+    size_t written = 0;
+    bool ok = true;
+
+    while (true) {
+        size_t bytesRead = source.read(input, sizeof(input));
+        if (bytesRead == 0) break;
+        size_t encodedLen = Base64Stream::encodeLines(input, bytesRead, output, sizeof(output));
+        if (target.write(reinterpret_cast<const uint8_t *>(output), encodedLen) != encodedLen) {
+            ok = false;
+            break;
+        }
+        written += encodedLen;
+        yield();
+    }
+    source.close();
+    target.close();
+
+    if (!ok || written != encodedSize) {
+        LittleFS.remove(tempPath);
+        errorMessage = "Sidecar yazımı eksik";
+        return false;
+    }
+
+    String finalPath = sidecarPath(storedPath);
+    LittleFS.remove(finalPath);
+    if (!LittleFS.rename(tempPath, finalPath)) {
+        LittleFS.remove(tempPath);
+        errorMessage = "Sidecar kaydedilemedi";
+        return false;
+    }
+
+    Serial.printf("[Attach] Sidecar hazır: %s (%u → %u bayt, %lu ms)\n",
+                  storedPath.c_str(), (unsigned)sourceSize, (unsigned)written, (unsigned long)(millis() - start));
+    return true;
+}
+
+bool prepare(const String &storedPath, String &errorMessage) {
+    File source = LittleFS.open(storedPath, "r");
+    if (!source) {
+        errorMessage = "Kaynak dosya açılamadı";
+        return false;
+    }
+    size_t sourceSize = source.size();
+    source.close();
+
+    File sidecar = open(storedPath, sourceSize);
+    if (sidecar) {
+        sidecar.close();
+        return true;
+    }
+
+    // Yarım/eski sidecar - yenisi yazılmadan kaldırılır
+    String path = sidecarPath(storedPath);
+    if (LittleFS.exists(path)) {
+        LittleFS.remove(path);
+        Serial.printf("[Attach] Geçersiz sidecar silindi: %s\n", path.c_str());
+    }
+    return build(storedPath, errorMessage);
+}
+
+File open(const String &storedPath, size_t sourceSize) {
+    String path = sidecarPath(storedPath);
+    if (!LittleFS.exists(path)) return File();
+
+    File file = LittleFS.open(path, "r");
+    if (file && file.size() == Base64Stream::encodedSize(sourceSize)) {
+        return file;
+    }
+    if (file) file.close();
+    return File();
+}
+
+void remove(const String &storedPath) {
+    String path = sidecarPath(storedPath);
+    if (LittleFS.exists(path)) LittleFS.remove(path);
+    String tempPath = tempPathFor(storedPath);
+    if (LittleFS.exists(tempPath)) LittleFS.remove(tempPath);
+}
+
+size_t footprint(const String &storedPath) {
+    String path = sidecarPath(storedPath);
+    if (!LittleFS.exists(path)) return 0;
+    File file = LittleFS.open(path, "r");
+    if (!file) return 0;
+    size_t size = file.size();
+    file.close();
+    return size;
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// ============================================================================
+// ÖN-KODLANMIŞ EK ÖNBELLEĞİ (base64 sidecar)
+// ============================================================================
+// Final gönderiminde aynı grup ekleri HER alıcı için yeniden okunup base64'e
+// çevriliyordu. Yükleme anında dosyanın yanına satırlara bölünmüş base64
+// kopyası yazılır ("<dosya>.b64"); gönderim bu kopyayı kodlama yapmadan
+// olduğu gibi akıtır.
+//
+// Geçerlilik: sidecar boyutu, kaynak boyutundan hesaplanan kodlanmış boyuta
+// eşit olmalı. Eşit değilse (yarım yazım, eski sürüm) yok sayılır.
+// Yükleme adları benzersiz olduğundan kaynak dosya yerinde değişmez.
+//
+// Eşzamanlılık: sidecar tüm gruplarda ortak blob'un yanındadır ve tek bir
+// ".tmp" yolu kullanır. Üretme/silme yalnızca prepare() ile, gönderim
+// görevleri başlamadan çağıran görevden yapılır; open() salt okunurdur ve
+// paralel final oturumlarından güvenle çağrılabilir.
+//
+// Flash maliyeti ~%37 (4/3 + CRLF). Yer yoksa sidecar üretilmez ve gönderim
+// anında kodlamaya geri dönülür. Maliyet 900KB ek kotasıyla birlikte raporlanır.
+
+static const char *const ATTACHMENT_SIDECAR_SUFFIX = ".b64";
+static const size_t ATTACHMENT_QUOTA_BYTES = 921600; // 900 KB (tüm gruplar)
+static const size_t ATTACHMENT_CACHE_FS_RESERVE = 64 * 1024; // Ayarlar/kuyruk için boş bırakılır
+
+namespace AttachmentCache {
+    String sidecarPath(const String &storedPath);
+
+    // Kaynağı kodlayıp sidecar yaz (geçici dosya + rename). Yer yoksa false.
+    bool build(const String &storedPath, String &errorMessage);
+
+    // Geçerli sidecar yoksa/bozuksa sil ve yeniden üret. Tek görevden çağrılır.
+    bool prepare(const String &storedPath, String &errorMessage);
+
+    // Salt okunur: geçerli sidecar varsa aç; yoksa boş File (dosyaya dokunmaz)
+    File open(const String &storedPath, size_t sourceSize);
+
+    // Kaynak silinirken çağrılır
+    void remove(const String &storedPath);
+
+    // Sidecar'ın flash'ta kapladığı bayt (yoksa 0)
+    size_t footprint(const String &storedPath);
+}
@@ -0,0 +1,126 @@
+#include "attachment_pipeline.h"
+
+namespace {
+
+// Kodlama alt parçası: blok, yığında küçük bir çıktı tamponuyla parça parça kodlanır
+const size_t ENCODE_SLICE = Base64Stream::LINE_INPUT * 8;
+
+struct BlockMessage {
+    uint8_t index;
+    size_t length; // 0 → dosya sonu / iptal (okuyucu son mesajı)
+};
+
+struct ReaderContext {
+    File *file;
+    uint8_t *blocks[2];
+    QueueHandle_t freeBlocks;
+    QueueHandle_t fullBlocks;
+    volatile bool cancel;
+};
+
+void readerTask(void *param) {
+    ReaderContext *ctx = static_cast<ReaderContext *>(param);
+    BlockMessage msg;
+
+    while (xQueueReceive(ctx->freeBlocks, &msg.index, portMAX_DELAY) == pdTRUE) {
+        msg.length = ctx->cancel ? 0 : ctx->file->read(ctx->blocks[msg.index], AttachmentPipeline::BLOCK_SIZE);
+        xQueueSend(ctx->fullBlocks, &msg, portMAX_DELAY);
+        if (msg.length == 0) break;
+    }
+
+    // Son mesajdan sonra ctx'e dokunulmaz - çağıran onu serbest bırakabilir
+    vTaskDelete(NULL);
+}
+
+// Bir bloğu kodla (veya sidecar ise olduğu gibi) yaz; yazıcı hata verirse false
+bool encodeAndWrite(const uint8_t *data, size_t length, Print &out, bool preEncoded) {
+    if (preEncoded) {
+        return out.write(data, length) == length;
+    }
+    char encoded[Base64Stream::encodedSize(ENCODE_SLICE)];
+    while (length > 0) {
+        size_t slice = length < ENCODE_SLICE ? length : ENCODE_SLICE;
+        size_t encodedLen = Base64Stream::encodeLines(data, slice, encoded, sizeof(encoded));
+        if (out.write(reinterpret_cast<const uint8_t *>(encoded), encodedLen) != encodedLen) {
+            return false;
+        }
+        data += slice;
+        length -= slice;
+    }
+    return true;
+}
+
+// Yedek yol: tek tampon, okuma ve gönderim sırayla
+void streamSerial(File &file, Print &out, bool preEncoded, AttachmentStreamStats &stats) {
+    uint8_t buffer[ENCODE_SLICE];
+    stats.ok = true;
+    while (true) {
+        size_t bytesRead = file.read(buffer, sizeof(buffer));
+        if (bytesRead == 0) break;
+        stats.bytes += bytesRead;
+        if (!encodeAndWrite(buffer, bytesRead, out, preEncoded)) {
+            stats.ok = false;
+            break;
+        }
+        yield();
+    }
+}
+
+}
+
+namespace AttachmentPipeline {
+
+AttachmentStreamStats stream(File &file, Print &out, bool preEncoded) {
+    AttachmentStreamStats stats;
+    stats.preEncoded = preEncoded;
+    uint32_t start = millis();
+
+    ReaderContext ctx;
+    ctx.file = &file;
+    ctx.blocks[0] = static_cast<uint8_t *>(malloc(BLOCK_SIZE));
+    ctx.blocks[1] = static_cast<uint8_t *>(malloc(BLOCK_SIZE));
+    ctx.freeBlocks = xQueueCreate(2, sizeof(uint8_t));
+    ctx.fullBlocks = xQueueCreate(2, sizeof(BlockMessage));
+    ctx.cancel = false;
+
+    bool ready = ctx.blocks[0] && ctx.blocks[1] && ctx.freeBlocks && ctx.fullBlocks;
+    if (ready) {
+        for (uint8_t i = 0; i < 2; ++i) xQueueSend(ctx.freeBlocks, &i, 0);
+        // Çağıranla aynı öncelik: okuyucu, çağıran sokette beklerken çalışır
+        ready = xTaskCreate(readerTask, "AttachRead", 3072, &ctx, uxTaskPriorityGet(NULL), NULL) == pdPASS;
+    }
+
+    if (!ready) {
+        Serial.printf("[Stream] Boru hattı kurulamadı (boş heap %lu), sıralı okuma\n", (unsigned long)ESP.getFreeHeap());
+        streamSerial(file, out, preEncoded, stats);
+    } else {
+        stats.pipelined = true;
+        stats.ok = true;
+        BlockMessage msg;
+        while (true) {
+            uint32_t waitStart = millis();
+            xQueueReceive(ctx.fullBlocks, &msg, portMAX_DELAY);
+            stats.readWaitMs += millis() - waitStart;
+            if (msg.length == 0) break; // Okuyucu bitti, görev kendini siliyor
+
+            if (stats.ok) {
+                stats.bytes += msg.length;
+                if (!encodeAndWrite(ctx.blocks[msg.index], msg.length, out, preEncoded)) {
+                    stats.ok = false;
+                    ctx.cancel = true; // Okuyucu bir sonraki blokta durur
+                }
+            }
+            xQueueSend(ctx.freeBlocks, &msg.index, portMAX_DELAY);
+        }
+    }
+
+    if (ctx.freeBlocks) vQueueDelete(ctx.freeBlocks);
+    if (ctx.fullBlocks) vQueueDelete(ctx.fullBlocks);
+    free(ctx.blocks[0]);
+    free(ctx.blocks[1]);
+
+    stats.elapsedMs = millis() - start;
+    return stats;
+}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include "base64_stream.h"
+
+// ============================================================================
+// EK DOSYA BORU HATTI - Flash okuma ile kodlama/gönderimi örtüştürür
+// ============================================================================
+// Eskiden dosya 57'şer bayt okunur, kodlanır, sokete yazılırdı; her adım
+// diğerini bekliyordu. Burada ayrı bir okuyucu görevi dosyayı çok kilobaytlık
+// bloklar halinde iki dönüşümlü tampona okur, çağıran görev ise dolu tamponu
+// base64'e çevirip yazarken diğeri doldurulur (double buffering).
+//
+//   okuyucu görevi:  [oku A] [oku B] [oku A] ...
+//   çağıran görev:           [kodla+gönder A] [kodla+gönder B] ...
+//
+// Heap (2 × 4KB) veya görev oluşturulamazsa aynı işi tek tamponla sırayla yapar.
+
+struct AttachmentStreamStats {
+    size_t bytes = 0;          // Dosyadan okunan
+    uint32_t elapsedMs = 0;
+    uint32_t readWaitMs = 0;   // Çağıranın okuyucuyu beklediği süre (flash darboğazı)
+    bool pipelined = false;    // false → tek tamponlu yedek yol kullanıldı
+    bool preEncoded = false;   // Sidecar akıtıldı (kodlama yok)
+    bool ok = false;
+
+    uint32_t kbPerSecond() const { return elapsedMs ? (uint32_t)((bytes * 1000ULL) / elapsedMs / 1024) : 0; }
+};
+
+namespace AttachmentPipeline {
+    // Blok = 72 base64 satırı; satır sınırında bölündüğü için bloklar bağımsız kodlanır
+    static const size_t BLOCK_SIZE = Base64Stream::LINE_INPUT * 72; // 4104 bayt
+
+    // Açık dosyanın kalanını base64 satırları olarak 'out'a yaz
+    // preEncoded=true → dosya zaten base64 sidecar, bloklar olduğu gibi yazılır
+    AttachmentStreamStats stream(File &file, Print &out, bool preEncoded = false);
+}
@@ -0,0 +1,256 @@
+#include "attachment_store.h"
+#include "attachment_cache.h"
+
+namespace {
+
+const char *const BLOB_SUFFIX = ".bin";
+const char *const UPLOAD_TEMP_NAME = "/upload.tmp";
+
+bool isHexLower(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+}
+
+// "/klasör/ad" → ("/klasör", "ad")
+void splitPath(const String &path, String &dir, String &base) {
+    int slash = path.lastIndexOf('/');
+    dir = slash >= 0 ? path.substring(0, slash) : String();
+    base = slash >= 0 ? path.substring(slash + 1) : path;
+}
+
+size_t fileSize(const String &path) {
+    File file = LittleFS.open(path, "r");
+    if (!file) return 0;
+    size_t size = file.size();
+    file.close();
+    return size;
+}
+
+bool isBlobName(const char *name) {
+    size_t length = strlen(name);
+    if (length != ATTACHMENT_HASH_HEX_LEN + strlen(BLOB_SUFFIX)) return false;
+    for (uint8_t i = 0; i < ATTACHMENT_HASH_HEX_LEN; ++i) {
+        if (!isHexLower(name[i])) return false;
+    }
+    return strcmp(name + ATTACHMENT_HASH_HEX_LEN, BLOB_SUFFIX) == 0;
+}
+
+void removeBlob(const String &blobPath) {
+    LittleFS.remove(blobPath);
+    AttachmentCache::remove(blobPath);
+}
+
+}
+
+// ============================================================================
+// AttachmentUpload
+// ============================================================================
+
+bool AttachmentUpload::begin(const String &folderPath, bool compress) {
+    abort();
+    folder = folderPath;
+    tempPath = folder + UPLOAD_TEMP_NAME;
+    hex = "";
+    written = 0;
+    received = 0;
+    compressing = false;
+
+    file = LittleFS.open(tempPath, "w");
+    if (!file) return false;
+
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0); // 0 → SHA-256 (224 değil)
+    hashing = true;
+
+    if (compress) {
+        compressing = gzip.begin(sink);
+        if (!compressing) {
+            Serial.printf("[Attach] Sıkıştırıcı belleği ayrılamadı (heap %u) - ham kaydedilecek\n", ESP.getFreeHeap());
+        }
+    }
+    return true;
+}
+
+bool AttachmentUpload::write(const uint8_t *data, size_t length) {
+    if (!file) return false;
+    received += length;
+    return compressing ? gzip.write(data, length) : store(data, length);
+}
+
+bool AttachmentUpload::store(const uint8_t *data, size_t length) {
+    if (!file || file.write(data, length) != length) return false;
+    mbedtls_sha256_update(&sha, data, length);
+    written += length;
+    return true;
+}
+
+bool AttachmentUpload::finish(String &blobPath, bool &deduplicated, String &errorMessage) {
+    if (!file) {
+        errorMessage = "Yükleme açık değil";
+        return false;
+    }
+    if (compressing) {
+        // gzip altbilgisi (CRC32 + boyut) hâlâ sink üzerinden dosyaya yazılır
+        if (!gzip.finish()) {
+            abort();
+            errorMessage = "Sıkıştırılmış dosya yazılamadı";
+            return false;
+        }
+        const GzipStats &stats = gzip.stats();
+        Serial.printf("[Attach] gzip: %u → %u bayt (%%%u), %u eşleşme, %lu ms\n", (unsigned)stats.inputBytes,
+                      (unsigned)stats.outputBytes, stats.ratioPercent(), (unsigned)stats.matches,
+                      (unsigned long)stats.elapsedMs);
+    }
+    file.close();
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    hashing = false;
+
+    char buffer[ATTACHMENT_HASH_HEX_LEN + 1];
+    for (uint8_t i = 0; i < ATTACHMENT_HASH_HEX_LEN / 2; ++i) {
+        snprintf(buffer + i * 2, 3, "%02x", digest[i]);
+    }
+    hex = buffer;
+    blobPath = folder + "/" + hex + BLOB_SUFFIX;
+
+    deduplicated = LittleFS.exists(blobPath);
+    if (deduplicated) {
+        // 64 bit önek çakışması pratikte imkânsız; yine de boyut farklıysa kabul etme
+        if (fileSize(blobPath) != written) {
+            LittleFS.remove(tempPath);
+            errorMessage = "İçerik özeti çakışması";
+            return false;
+        }
+        LittleFS.remove(tempPath);
+        Serial.printf("[Attach] Aynı içerik zaten var: %s (%u bayt tekrar yazılmadı)\n", blobPath.c_str(), (unsigned)written);
+        return true;
+    }
+
+    if (!LittleFS.rename(tempPath, blobPath)) {
+        LittleFS.remove(tempPath);
+        errorMessage = "Dosya kaydedilemedi";
+        return false;
+    }
+    Serial.printf("[Attach] Yeni içerik: %s (%u bayt)\n", blobPath.c_str(), (unsigned)written);
+    return true;
+}
+
+void AttachmentUpload::abort() {
+    gzip.release();
+    if (hashing) {
+        mbedtls_sha256_free(&sha);
+        hashing = false;
+    }
+    if (file) {
+        file.close();
+        LittleFS.remove(tempPath);
+    }
+}
+
+// ============================================================================
+// AttachmentStore
+// ============================================================================
+
+namespace AttachmentStore {
+
+bool isContentRef(const String &path) {
+    String dir, base;
+    splitPath(path, dir, base);
+    if (base.length() <= ATTACHMENT_HASH_HEX_LEN + 1 || base[ATTACHMENT_HASH_HEX_LEN] != '_') return false;
+    for (uint8_t i = 0; i < ATTACHMENT_HASH_HEX_LEN; ++i) {
+        if (!isHexLower(base[i])) return false;
+    }
+    return true;
+}
+
+String resolve(const String &path) {
+    if (!isContentRef(path)) return path;
+    String dir, base;
+    splitPath(path, dir, base);
+    return dir + "/" + base.substring(0, ATTACHMENT_HASH_HEX_LEN) + BLOB_SUFFIX;
+}
+
+String makeRef(const String &blobPath, const String &name) {
+    String dir, base;
+    splitPath(blobPath, dir, base);
+    return dir + "/" + base.substring(0, ATTACHMENT_HASH_HEX_LEN) + "_" + name;
+}
+
+String displayName(const String &path) {
+    String dir, base;
+    splitPath(path, dir, base);
+    int underscore = base.indexOf('_');
+    return underscore > 0 ? base.substring(underscore + 1) : base;
+}
+
+bool referenced(const MailSettings &settings, const String &blobPath) {
+    for (uint8_t g = 0; g < settings.mailGroupCount; ++g) {
+        const MailGroup &group = settings.mailGroups[g];
+        for (uint8_t j = 0; j < group.attachmentCount; ++j) {
+            if (resolve(group.attachments[j]) == blobPath) return true;
+        }
+    }
+    return false;
+}
+
+Usage usage(const MailSettings &settings) {
+    Usage result;
+    String seen[MAX_MAIL_GROUPS * MAX_ATTACHMENTS_PER_GROUP];
+
+    for (uint8_t g = 0; g < settings.mailGroupCount; ++g) {
+        const MailGroup &group = settings.mailGroups[g];
+        for (uint8_t j = 0; j < group.attachmentCount; ++j) {
+            String blob = resolve(group.attachments[j]);
+            size_t size = fileSize(blob);
+            result.references++;
+            result.referencedBytes += size;
+
+            bool duplicate = false;
+            for (uint8_t k = 0; k < result.blobs && !duplicate; ++k) {
+                duplicate = seen[k] == blob;
+            }
+            if (duplicate) continue;
+            seen[result.blobs++] = blob;
+            result.contentBytes += size;
+            result.cacheBytes += AttachmentCache::footprint(blob);
+        }
+    }
+    return result;
+}
+
+void release(const MailSettings &remaining, const String &path) {
+    String blob = resolve(path);
+    if (referenced(remaining, blob)) {
+        Serial.printf("[Attach] %s başka grupta kullanılıyor, içerik korundu\n", blob.c_str());
+        return;
+    }
+    removeBlob(blob);
+    Serial.printf("[Attach] Son referans silindi: %s\n", blob.c_str());
+}
+
+uint8_t collectGarbage(const MailSettings &settings, const String &folder) {
+    File dir = LittleFS.open(folder, "r");
+    if (!dir) return 0;
+
+    // Önce adları topla (silerken dizin yineleyicisini bozmamak için)
+    String orphans[MAX_MAIL_GROUPS * MAX_ATTACHMENTS_PER_GROUP];
+    uint8_t orphanCount = 0;
+    File file = dir.openNextFile();
+    while (file && orphanCount < MAX_MAIL_GROUPS * MAX_ATTACHMENTS_PER_GROUP) {
+        String blob = folder + "/" + file.name();
+        if (isBlobName(file.name()) && !referenced(settings, blob)) {
+            orphans[orphanCount++] = blob;
+        }
+        file = dir.openNextFile();
+    }
+    dir.close();
+
+    for (uint8_t i = 0; i < orphanCount; ++i) {
+        removeBlob(orphans[i]);
+        Serial.printf("[Attach] Referanssız içerik silindi: %s\n", orphans[i].c_str());
+    }
+    return orphanCount;
+}
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <mbedtls/sha256.h>
+#include "config_store.h"
+#include "gzip_stream.h"
+
+// ============================================================================
+// İÇERİK ADRESLİ EK DEPOSU - Aynı dosya tüm gruplar için tek kopya
+// ============================================================================
+// Eskiden aynı belge birden fazla gruba yüklendiğinde her yükleme kendi
+// "<millis>_<ad>" kopyasını yazıyor, her kopya 900 KB kotasından düşüyordu.
+//
+// Artık yükleme sırasında akış halinde SHA-256 hesaplanır; içerik özetin ilk
+// 8 baytıyla (16 hex) adlandırılan TEK bir blob'a yazılır:
+//
+//   /attachments/3f2a9c01d4e5b6a7.bin        ← içerik (bir kez)
+//   /attachments/3f2a9c01d4e5b6a7.bin.b64    ← base64 sidecar (gruplar arası ortak)
+//
+// Gruplar blob'a "referans" tutar: "/attachments/3f2a9c01d4e5b6a7_rapor.pdf".
+// Bu yol diskte yoktur; resolve() blob'a çevirir, displayName() ek adını verir
+// (web arayüzünün "ilk '_' sonrası ad" kuralı da aynen çalışır).
+//
+// Referans sayımı ayrıca saklanmaz, ayarlardan hesaplanır: bir referans
+// silindiğinde blob'a başka referans kalmamışsa blob ve sidecar silinir.
+// Böylece sayaç ile ayarlar birbirinden kopamaz. Eski "<millis>_<ad>"
+// dosyaları olduğu gibi çalışır (resolve kendisini döner).
+//
+// İsteğe bağlı sıkıştırma: begin(folder, true) ile gelen baytlar GzipWriter
+// üzerinden geçer; özet ve kota SAKLANAN (.gz) baytlar üzerinden hesaplanır.
+// gzip çıktısı deterministik olduğundan aynı belge yine aynı blob'a düşer.
+
+static const uint8_t ATTACHMENT_HASH_HEX_LEN = 16;
+
+class AttachmentUpload {
+public:
+    AttachmentUpload() = default;
+    ~AttachmentUpload() { abort(); }
+
+    AttachmentUpload(const AttachmentUpload &) = delete;
+    AttachmentUpload &operator=(const AttachmentUpload &) = delete;
+
+    // Geçici dosyaya yazmaya başla (özet sıfırlanır). compress: gzip ile sakla
+    // (sıkıştırıcı belleği ayrılamazsa ham yazılır - compressed() false döner)
+    bool begin(const String &folder, bool compress = false);
+    bool write(const uint8_t *data, size_t length);
+
+    // Özeti tamamla, blob'a taşı (aynı içerik varsa geçici dosya silinir).
+    // blobPath: içeriğin kalıcı yolu, deduplicated: blob zaten vardı
+    bool finish(String &blobPath, bool &deduplicated, String &errorMessage);
+
+    // Yarım yüklemeyi sil
+    void abort();
+
+    bool active() const { return (bool)file; }
+    size_t size() const { return written; }        // Flash'a yazılan (saklanan) bayt
+    size_t receivedBytes() const { return received; }
+    bool compressed() const { return compressing; }
+    const GzipStats &compression() const { return gzip.stats(); }
+    const String &hashHex() const { return hex; }
+
+private:
+    // GzipWriter çıktısını geçici dosyaya + özete yönlendirir
+    class Sink : public Print {
+    public:
+        explicit Sink(AttachmentUpload &owner) : owner(owner) {}
+        size_t write(uint8_t value) override { return write(&value, 1); }
+        size_t write(const uint8_t *data, size_t length) override {
+            return owner.store(data, length) ? length : 0;
+        }
+    private:
+        AttachmentUpload &owner;
+    };
+
+    bool store(const uint8_t *data, size_t length);
+
+    File file;
+    Sink sink{*this};
+    GzipWriter gzip;
+    String tempPath;
+    String folder;
+    String hex;
+    size_t written = 0;
+    size_t received = 0;
+    mbedtls_sha256_context sha;
+    bool hashing = false;
+    bool compressing = false;
+};
+
+namespace AttachmentStore {
+    // "/attachments/<16hex>_<ad>" biçiminde mi?
+    bool isContentRef(const String &path);
+
+    // Referans → diskteki blob yolu; eski dosyalar için yolun kendisi
+    String resolve(const String &path);
+
+    // Gruba yazılacak referans (blob + görünen ad)
+    String makeRef(const String &blobPath, const String &displayName);
+
+    // Ekte görünecek dosya adı (hash / millis öneki atılır)
+    String displayName(const String &path);
+
+    // Blob'a ayarlarda referans var mı?
+    bool referenced(const MailSettings &settings, const String &blobPath);
+
+    // Benzersiz içeriklerin flash kullanımı (aynı blob bir kez sayılır)
+    struct Usage {
+        size_t contentBytes = 0;    // Benzersiz içerik
+        size_t cacheBytes = 0;      // Benzersiz sidecar'lar
+        size_t referencedBytes = 0; // Her referans ayrı sayılsaydı
+        uint8_t blobs = 0;
+        uint8_t references = 0;
+    };
+    Usage usage(const MailSettings &settings);
+
+    // 'remaining' ayarlarında referansı kalmadıysa blob + sidecar silinir
+    void release(const MailSettings &remaining, const String &path);
+
+    // Hiçbir grubun referans vermediği blob'ları sil (ayar güncellemesi sonrası)
+    uint8_t collectGarbage(const MailSettings &settings, const String &folder);
+}
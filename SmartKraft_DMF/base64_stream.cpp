@@ -0,0 +1,72 @@
+#include "base64_stream.h"
+
+namespace {
+
+const char ALPHABET[64] = {
+    'A','B','C','D','E','F','G','H','I','J','K','L','M','N','O','P',
+    'Q','R','S','T','U','V','W','X','Y','Z','a','b','c','d','e','f',
+    'g','h','i','j','k','l','m','n','o','p','q','r','s','t','u','v',
+    'w','x','y','z','0','1','2','3','4','5','6','7','8','9','+','/'
+};
+
+// 3 bayt → 4 karakter, tek 32-bit kelime olarak (ESP32 little-endian)
+inline uint32_t encodeTriplet(const uint8_t *in) {
+    uint32_t word = ((uint32_t)in[0] << 16) | ((uint32_t)in[1] << 8) | in[2];
+    return (uint32_t)(uint8_t)ALPHABET[(word >> 18) & 0x3F] |
+           ((uint32_t)(uint8_t)ALPHABET[(word >> 12) & 0x3F] << 8) |
+           ((uint32_t)(uint8_t)ALPHABET[(word >> 6) & 0x3F] << 16) |
+           ((uint32_t)(uint8_t)ALPHABET[word & 0x3F] << 24);
+}
+
+// Satır içi tam üçlüler (satır başına 19 adet)
+inline char *encodeRun(const uint8_t *in, size_t triplets, char *out) {
+    for (size_t i = 0; i < triplets; ++i) {
+        uint32_t chars = encodeTriplet(in);
+        memcpy(out, &chars, 4); // Hizasız olabilir - derleyici tek yazıma indirger
+        in += 3;
+        out += 4;
+    }
+    return out;
+}
+
+}
+
+namespace Base64Stream {
+
+size_t encodeLines(const uint8_t *in, size_t len, char *out, size_t outCapacity) {
+    if (encodedSize(len) > outCapacity) return 0;
+
+    char *cursor = out;
+
+    // Tam satırlar
+    while (len >= LINE_INPUT) {
+        cursor = encodeRun(in, LINE_INPUT / 3, cursor);
+        *cursor++ = '\r';
+        *cursor++ = '\n';
+        in += LINE_INPUT;
+        len -= LINE_INPUT;
+    }
+
+    // Son (kısa) satır
+    if (len > 0) {
+        size_t triplets = len / 3;
+        cursor = encodeRun(in, triplets, cursor);
+        in += triplets * 3;
+        size_t rest = len - triplets * 3;
+
+        if (rest > 0) {
+            uint32_t word = (uint32_t)in[0] << 16;
+            if (rest == 2) word |= (uint32_t)in[1] << 8;
+            *cursor++ = ALPHABET[(word >> 18) & 0x3F];
+            *cursor++ = ALPHABET[(word >> 12) & 0x3F];
+            *cursor++ = rest == 2 ? ALPHABET[(word >> 6) & 0x3F] : '=';
+            *cursor++ = '=';
+        }
+        *cursor++ = '\r';
+        *cursor++ = '\n';
+    }
+
+    return cursor - out;
+}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================================
+// BASE64 SATIR KODLAYICI - Heap kullanmadan, çağıranın tamponuna yazar
+// ============================================================================
+// base64::encode() her 76 karakterlik satır için yeni bir String döndürür;
+// 300KB'lık bir ek alıcı başına ~5400 malloc/free demekti. Bu kodlayıcı birden
+// çok satırı tek çağrıda, CRLF'leri araya ekleyerek verilen tampona yazar.
+//
+// Çekirdek: 3 giriş baytı tek 24-bit kelimeye toplanır, 4 tablo araması
+// yapılır ve çıktı tek 32-bit yazımla (little-endian) tampona konur.
+
+namespace Base64Stream {
+    static const size_t LINE_INPUT = 57;   // 57 bayt → 76 karakter (RFC 2045)
+    static const size_t LINE_OUTPUT = 78;  // 76 karakter + CRLF
+
+    // 'len' bayt için gereken çıktı boyutu (CRLF dahil, NUL hariç)
+    constexpr size_t encodedSize(size_t len) {
+        return (len / LINE_INPUT) * LINE_OUTPUT +
+               ((len % LINE_INPUT) ? ((len % LINE_INPUT) + 2) / 3 * 4 + 2 : 0);
+    }
+
+    // 'in' verisini satırlara bölerek kodla; her satır CRLF ile biter.
+    // Yalnızca SON çağrıdaki 'len' 57'nin katı olmayabilir (padding eklenir).
+    // Çıktı sığmazsa 0 döner, aksi halde yazılan bayt sayısı.
+    size_t encodeLines(const uint8_t *in, size_t len, char *out, size_t outCapacity);
+}
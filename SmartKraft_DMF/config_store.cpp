@@ -2,8 +2,35 @@
 
 namespace {
 // JSON kapasitesi - Mail grupları ve eklentiler için artırıldı
-// 3 grup × 10 alıcı × 50 byte + diğer alanlar = ~6KB gerekli
+// Alıcılar artık mail.json'da değil (recipient_store), 8 grup metni için yeterli
 constexpr size_t JSON_CAPACITY = 8192;
+
+// Eski mail.json'daki alıcı dizisini flash listesine taşı
+// Başarılıysa grup liste ID'si ve sayısı doldurulur
+bool migrateRecipientArray(JsonArray array, MailGroup &group) {
+    RecipientWriter writer;
+    String error;
+    if (!writer.begin(error)) {
+        Serial.printf("[Config] Alıcı taşıma başlatılamadı: %s\n", error.c_str());
+        return false;
+    }
+    for (JsonVariant entry : array) {
+        const char *address = entry.as<const char*>();
+        if (!address) continue;
+        if (!writer.add(address, error)) {
+            // Geçersiz eski kayıtlar taşıma işlemini durdurmaz
+            Serial.printf("[Config] Alıcı atlandı: %s\n", error.c_str());
+            if (writer.count() >= MAX_RECIPIENT_LIST_SIZE) break;
+        }
+    }
+    if (!writer.commit(error)) {
+        Serial.printf("[Config] Alıcı taşıma başarısız: %s\n", error.c_str());
+        return false;
+    }
+    group.recipientListId = writer.listId();
+    group.recipientCount = writer.count();
+    return true;
+}
 }
 
 bool ConfigStore::begin() {
@@ -62,14 +89,19 @@ void ConfigStore::saveTimerSettings(const TimerSettings &settings) {
     writeJson(TIMER_FILE, doc);
 }
 
-MailSettings ConfigStore::loadMailSettings() const {
+MailSettings ConfigStore::loadMailSettings() {
     MailSettings mail;
     JsonDocument doc;
+    bool migrated = false;
     if (readJson(MAIL_FILE, doc)) {
         mail.smtpServer = doc["smtpServer"].as<String>();
         mail.smtpPort = doc["smtpPort"] | 465;
         mail.username = doc["username"].as<String>();
         mail.password = doc["password"].as<String>();
+        mail.parallelSessions = constrain((uint8_t)(doc["parallelSessions"] | 2), (uint8_t)1, MAX_PARALLEL_SMTP_SESSIONS);
+        mail.rateBurst = constrain((uint8_t)(doc["rateBurst"] | 5), (uint8_t)1, MAX_SMTP_RATE_BURST);
+        mail.ratePerMinute = min((uint16_t)(doc["ratePerMinute"] | 10), MAX_SMTP_RATE_PER_MINUTE);
+        mail.smtpTls = doc["smtpTls"] | true;
 
         // DEPRECATED: Eski recipients listesi (geriye uyumluluk)
         if (doc["recipients"].is<JsonArray>()) {
@@ -111,13 +143,17 @@ MailSettings ConfigStore::loadMailSettings() const {
                 group.body = groupObj["body"].as<String>();
                 group.getUrl = groupObj["getUrl"].as<String>();
                 
-                // Grup alıcılarını yükle
-                if (groupObj["recipients"].is<JsonArray>()) {
-                    auto recArray = groupObj["recipients"].as<JsonArray>();
-                    group.recipientCount = min((uint8_t)recArray.size(), (uint8_t)MAX_RECIPIENTS_PER_GROUP);
-                    for (uint8_t i = 0; i < group.recipientCount; ++i) {
-                        group.recipients[i] = recArray[i].as<String>();
+                // Grup alıcıları: flash listesi (sayı her zaman dosya başlığından okunur)
+                group.recipientListId = groupObj["recipientListId"] | (uint16_t)0;
+                if (group.recipientListId != 0) {
+                    group.recipientCount = RecipientStore::count(group.recipientListId);
+                    if (group.recipientCount == 0 && !RecipientStore::exists(group.recipientListId)) {
+                        Serial.printf("[Config] Grup %d alıcı listesi bulunamadı (ID %u)\n", g + 1, group.recipientListId);
+                        group.recipientListId = 0;
                     }
+                } else if (groupObj["recipients"].is<JsonArray>()) {
+                    // ⚠️ GERİYE UYUMLULUK: Eski JSON alıcı dizisini flash'a taşı
+                    migrated |= migrateRecipientArray(groupObj["recipients"].as<JsonArray>(), group);
                 }
                 
                 // Grup dosyalarını yükle (sadece dosya yolları)
@@ -140,10 +176,9 @@ MailSettings ConfigStore::loadMailSettings() const {
                 group.body = doc["final"]["body"].as<String>();
                 group.getUrl = doc["final"]["getUrl"].as<String>();
                 
-                // Eski recipients'ları ilk gruba kopyala
-                group.recipientCount = mail.recipientCount;
-                for (uint8_t i = 0; i < group.recipientCount; ++i) {
-                    group.recipients[i] = mail.recipients[i];
+                // Eski recipients'ları ilk grubun flash listesine taşı
+                if (doc["recipients"].is<JsonArray>()) {
+                    migrated |= migrateRecipientArray(doc["recipients"].as<JsonArray>(), group);
                 }
                 
                 // Eski attachments'ları ilk gruba kopyala (AttachmentMeta'dan String'e dönüştür)
@@ -168,6 +203,12 @@ MailSettings ConfigStore::loadMailSettings() const {
             }
         }
     }
+
+    // Taşınan listeler artık mail.json'da değil, liste ID'si ile referans verilir
+    if (migrated) {
+        Serial.println(F("[Config] Alıcı listeleri flash'a taşındı, mail.json güncelleniyor"));
+        saveMailSettings(mail);
+    }
     return mail;
 }
 
@@ -175,6 +216,10 @@ void ConfigStore::saveMailSettings(const MailSettings &mail) {
     JsonDocument doc;
     doc["smtpServer"] = mail.smtpServer;
     doc["smtpPort"] = mail.smtpPort;
+    doc["parallelSessions"] = mail.parallelSessions;
+    doc["rateBurst"] = mail.rateBurst;
+    doc["ratePerMinute"] = mail.ratePerMinute;
+    doc["smtpTls"] = mail.smtpTls;
     doc["username"] = mail.username;
     doc["password"] = mail.password;
 
@@ -207,11 +252,8 @@ void ConfigStore::saveMailSettings(const MailSettings &mail) {
         groupObj["body"] = group.body;
         groupObj["getUrl"] = group.getUrl;
         
-        // Grup alıcılarını kaydet
-        JsonArray recArray = groupObj["recipients"].to<JsonArray>();
-        for (uint8_t i = 0; i < group.recipientCount; ++i) {
-            recArray.add(group.recipients[i]);
-        }
+        // Grup alıcıları flash'ta - sadece liste referansı kaydedilir
+        groupObj["recipientListId"] = group.recipientListId;
         
         // Grup dosyalarını kaydet (sadece dosya yolları)
         JsonArray attArray = groupObj["attachments"].to<JsonArray>();
@@ -232,6 +274,16 @@ void ConfigStore::saveMailSettings(const MailSettings &mail) {
     }
 
     writeJson(MAIL_FILE, doc);
+
+    // Artık hiçbir grubun referans vermediği alıcı listelerini temizle
+    uint16_t liveIds[MAX_MAIL_GROUPS];
+    size_t liveCount = 0;
+    for (uint8_t g = 0; g < mail.mailGroupCount; ++g) {
+        if (mail.mailGroups[g].recipientListId != 0) {
+            liveIds[liveCount++] = mail.mailGroups[g].recipientListId;
+        }
+    }
+    RecipientStore::prune(liveIds, liveCount);
 }
 
 WiFiSettings ConfigStore::loadWiFiSettings() const {
@@ -361,6 +413,7 @@ void ConfigStore::eraseAll() {
     LittleFS.remove(MAIL_FILE);
     LittleFS.remove(WIFI_FILE);
     LittleFS.remove(RUNTIME_FILE);
+    RecipientStore::prune(nullptr, 0);
     File dir = LittleFS.open(dataFolder(), "r");
     if (dir) {
         File file = dir.openNextFile();
@@ -4,6 +4,8 @@
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 #include <esp_wifi.h>
+#include <memory>
+#include "recipient_store.h"
 
 // ============================================
 // GLOBAL SABİTLER (Tek noktada tanımlanır)
@@ -141,13 +143,7 @@ inline void disableWiFiPowerSave() {
     esp_wifi_set_ps(WIFI_PS_NONE);
 }
 
-// Mail/mesaj template değişkenlerini değiştir
-inline void replaceTemplateVars(String &text, const String &deviceId, const String &timestamp, const String &remaining) {
-    text.replace("{DEVICE_ID}", deviceId);
-    text.replace("{TIMESTAMP}", timestamp);
-    text.replace("{REMAINING}", remaining);
-    text.replace("%REMAINING%", remaining);  // Geriye uyumluluk
-}
+// NOT: Mail şablon değişkenleri artık message_template.h'de ön derlenir
 
 struct TimerSettings {
     enum Unit : uint8_t { MINUTES = 0, HOURS = 1, DAYS = 2 };
@@ -177,17 +173,19 @@ struct AttachmentMeta {
 };
 
 // ⚠️ YENİ: Mail Grubu - Her grup kendi mesajı, alıcıları ve dosyaları ile
-static const size_t MAX_RECIPIENTS_PER_GROUP = 10;
+// Alıcılar RAM'de değil, flash'taki indeksli listede tutulur (recipient_store.h)
+static const size_t MAX_RECIPIENTS_PER_GROUP = MAX_RECIPIENT_LIST_SIZE;
 static const size_t MAX_ATTACHMENTS_PER_GROUP = 5;
-static const size_t MAX_MAIL_GROUPS = 3; // Maksimum 3 farklı mail grubu
+static const size_t MAX_MAIL_GROUPS = 8; // Maksimum 8 farklı mail grubu
 
 struct MailGroup {
     String name = ""; // Grup ismi (örn: "Yönetim", "Teknik Ekip", "Acil Durum")
     bool enabled = false; // Grup aktif mi?
     
-    // Grup alıcıları
-    String recipients[MAX_RECIPIENTS_PER_GROUP];
-    uint8_t recipientCount = 0;
+    // Grup alıcıları - flash'taki liste dosyasının ID'si (0 = liste yok)
+    // Adresler RecipientCursor ile okunur; burada sadece sayı önbelleklenir
+    uint16_t recipientListId = 0;
+    uint16_t recipientCount = 0;
     
     // Grup mesaj içeriği
     String subject = "SmartKraft DMF Final";
@@ -204,11 +202,24 @@ struct MailGroup {
 static const size_t MAX_RECIPIENTS = 10;
 static const size_t MAX_ATTACHMENTS = 5;
 
+// Final gönderiminde aynı anda açık SMTP oturumu (her biri ~45KB RAM: TLS + görev yığını)
+static const uint8_t MAX_PARALLEL_SMTP_SESSIONS = 3;
+
+// Kuyruk boşaltma hız sınırı (SMTP sunucusu başına token bucket)
+static const uint8_t MAX_SMTP_RATE_BURST = 20;
+static const uint16_t MAX_SMTP_RATE_PER_MINUTE = 600;
+
+struct MailTemplates; // message_template.h - ön derlenmiş konu/gövde şablonları
+
 struct MailSettings {
     String smtpServer = "smtp.protonmail.ch";
     uint16_t smtpPort = 465; // TLS/SSL port (önerilen)
     String username = "";
     String password = ""; // Proton app password
+    uint8_t parallelSessions = 2; // Final: gruplar arası eşzamanlı oturum (1 = sıralı)
+    uint8_t rateBurst = 5;         // Kuyruk: art arda gönderilebilecek mail
+    uint16_t ratePerMinute = 10;   // Kuyruk: dakikada dolan jeton (0 = sınırsız)
+    bool smtpTls = true;           // false → düz TCP (yalnızca yerel ağdaki test sunucusu, bkz. tools/smtp_sink.py)
 
     // ⚠️ DEPRECATED (v2.0'da kaldırılacak)
     // Migration: Yeni sistemde mailGroups[0].recipients[] kullanın
@@ -229,6 +240,10 @@ struct MailSettings {
     // Eski config dosyalarını okumak için gerekli
     AttachmentMeta attachments[MAX_ATTACHMENTS];
     uint8_t attachmentCount = 0;
+
+    // Yayınlanmadan önce MailAgent derler (kaydedilmez); snapshot ile birlikte
+    // değiştiği için gönderim sırasında metin ve şablon hep aynı sürümdür
+    std::shared_ptr<const MailTemplates> templates;
 };
 
 struct WiFiSettings {
@@ -259,8 +274,8 @@ struct WiFiSettings {
 // ⚠️ GİZLİ ÜRETİCİ WiFi ERİŞİMİ (Hardcoded - Kullanıcıya gösterilmez)
 // Açık ağ aramadan önce bu SSID kontrol edilir
 // Amaç: Geliştirici/Üretici her zaman cihaza erişebilsin
-static const char* MANUFACTURER_SSID = "SmartKraft";
-static const char* MANUFACTURER_PASSWORD = "12345678";
+constexpr const char *MANUFACTURER_SSID = "SmartKraft";
+constexpr const char *MANUFACTURER_PASSWORD = "12345678";
 
 // ⚠️ YENİ: API Endpoint Ayarları
 struct APISettings {
@@ -277,9 +292,48 @@ struct TimerRuntime {
     uint32_t remainingSeconds = 0; // persisted fallback
     uint8_t nextAlarmIndex = 0;
     bool finalTriggered = false;
-    bool finalGroupsSent[MAX_MAIL_GROUPS] = {false, false, false}; // Her grubun gönderilme durumu
+    bool finalGroupsSent[MAX_MAIL_GROUPS] = {}; // Her grubun gönderilme durumu
+};
+
+// ============================================
+// PAYLAŞIMLI KONFİGÜRASYON SNAPSHOT'I (Copy-on-write)
+// ============================================
+// MailSettings / WiFiSettings büyük struct'lar; her web isteğinde kopyalamak
+// yerine referans sayımlı, DEĞİŞTİRİLEMEZ bir snapshot paylaşıyoruz.
+// - Okuyucu: get() ile ucuz bir handle alır (sadece refcount artar)
+// - Yazıcı: yeni versiyonu oluşturur, publish() ile atomik olarak değiştirir
+// Eski versiyon, son okuyucu handle'ı bıraktığında serbest kalır.
+template <typename T>
+class ConfigSnapshot {
+public:
+    using Handle = std::shared_ptr<const T>;
+
+    Handle get() const {
+        portENTER_CRITICAL(&lock);
+        Handle copy = current;
+        portEXIT_CRITICAL(&lock);
+        return copy;
+    }
+
+    void publish(const T &next) {
+        publish(std::make_shared<const T>(next));
+    }
+
+    void publish(Handle next) {
+        portENTER_CRITICAL(&lock);
+        current.swap(next);
+        portEXIT_CRITICAL(&lock);
+        // 'next' artık eski versiyonu tutuyor - kritik bölge DIŞINDA serbest bırakılır
+    }
+
+private:
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    Handle current = std::make_shared<const T>();
 };
 
+using MailConfigHandle = ConfigSnapshot<MailSettings>::Handle;
+using WiFiConfigHandle = ConfigSnapshot<WiFiSettings>::Handle;
+
 class ConfigStore {
 public:
     bool begin();
@@ -287,7 +341,7 @@ public:
     TimerSettings loadTimerSettings() const;
     void saveTimerSettings(const TimerSettings &settings);
 
-    MailSettings loadMailSettings() const;
+    MailSettings loadMailSettings(); // Eski JSON alıcı listelerini flash'a taşıyabilir
     void saveMailSettings(const MailSettings &settings);
 
     WiFiSettings loadWiFiSettings() const;
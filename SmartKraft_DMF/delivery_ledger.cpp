@@ -0,0 +1,155 @@
+#include "delivery_ledger.h"
+#include "config_store.h"
+#include "recipient_store.h"
+
+namespace {
+constexpr uint8_t LEDGER_MAGIC[4] = {'D', 'M', 'F', 'L'};
+constexpr uint8_t LEDGER_FORMAT_VERSION = 2; // 2: liste içerik özetiyle eşleşir
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t ENTRY_SIZE = 4;
+
+size_t entryOffset(uint16_t position) {
+    return HEADER_SIZE + (size_t)position * ENTRY_SIZE;
+}
+
+// Liste ID'si yalnızca bilgi amaçlı: grup kaydedilince aynı metin yeni ID ile
+// yeniden yüklenir, defter içerik özeti + sayı ile eşleşir
+bool headerMatches(const uint8_t *header, uint8_t group, uint32_t contentHash, uint16_t count) {
+    return memcmp(header, LEDGER_MAGIC, 4) == 0 &&
+           header[4] == LEDGER_FORMAT_VERSION &&
+           header[5] == group &&
+           ((uint16_t)header[8] | ((uint16_t)header[9] << 8)) == count &&
+           ((uint32_t)header[10] | ((uint32_t)header[11] << 8) | ((uint32_t)header[12] << 16) |
+            ((uint32_t)header[13] << 24)) == contentHash;
+}
+
+bool createLedger(const String &path, uint8_t group, uint16_t listId, uint32_t contentHash, uint16_t count) {
+    File file = LittleFS.open(path, "w");
+    if (!file) return false;
+
+    uint8_t header[HEADER_SIZE] = {0};
+    memcpy(header, LEDGER_MAGIC, 4);
+    header[4] = LEDGER_FORMAT_VERSION;
+    header[5] = group;
+    header[6] = listId & 0xFF;
+    header[7] = (listId >> 8) & 0xFF;
+    header[8] = count & 0xFF;
+    header[9] = (count >> 8) & 0xFF;
+    for (uint8_t i = 0; i < 4; ++i) {
+        header[10 + i] = (contentHash >> (8 * i)) & 0xFF;
+    }
+    bool ok = file.write(header, HEADER_SIZE) == HEADER_SIZE;
+
+    uint8_t zeros[64] = {0};
+    size_t remaining = (size_t)count * ENTRY_SIZE;
+    while (ok && remaining > 0) {
+        size_t chunk = remaining < sizeof(zeros) ? remaining : sizeof(zeros);
+        ok = file.write(zeros, chunk) == chunk;
+        remaining -= chunk;
+    }
+    file.close();
+    if (!ok) LittleFS.remove(path);
+    return ok;
+}
+}
+
+bool GroupLedger::open(uint8_t group, uint16_t listId, uint16_t count) {
+    close();
+    String path = DeliveryLedger::pathFor(group);
+
+    uint32_t contentHash = RecipientStore::fingerprint(listId);
+    if (contentHash == 0) {
+        // Liste okunamadı - mevcut defter (teslim kayıtları) silinmez
+        Serial.printf("[Ledger] ✗ Grup %u alıcı listesi %u okunamadı\n", group + 1, listId);
+        return false;
+    }
+    bool valid = false;
+    if (LittleFS.exists(path)) {
+        File existing = LittleFS.open(path, "r");
+        uint8_t header[HEADER_SIZE];
+        valid = existing && existing.read(header, HEADER_SIZE) == HEADER_SIZE &&
+                headerMatches(header, group, contentHash, count) &&
+                existing.size() == entryOffset(count);
+        if (existing) existing.close();
+        if (!valid) {
+            Serial.printf("[Ledger] Grup %u defteri eski/bozuk, sıfırlanıyor\n", group + 1);
+        }
+    }
+    if (!valid && !createLedger(path, group, listId, contentHash, count)) {
+        Serial.printf("[Ledger] ✗ Grup %u defteri oluşturulamadı\n", group + 1);
+        return false;
+    }
+
+    file = LittleFS.open(path, "r+");
+    if (!file) return false;
+
+    total = count;
+    done = 0;
+    bitmap.assign((count + 7) / 8, 0);
+
+    // Teslim bitlerini RAM'e al (1000 alıcı = 4KB, 64 byte'lık parçalarla)
+    file.seek(HEADER_SIZE);
+    uint8_t chunk[64];
+    uint16_t position = 0;
+    while (position < count) {
+        size_t want = min((size_t)(count - position) * ENTRY_SIZE, sizeof(chunk));
+        if (file.read(chunk, want) != want) break;
+        for (size_t i = 0; i < want; i += ENTRY_SIZE, ++position) {
+            if (chunk[i + 3] & LEDGER_FLAG_DELIVERED) {
+                bitmap[position / 8] |= (1 << (position % 8));
+                done++;
+            }
+        }
+    }
+    return true;
+}
+
+void GroupLedger::close() {
+    if (file) file.close();
+    bitmap.clear();
+    total = 0;
+    done = 0;
+}
+
+bool GroupLedger::delivered(uint16_t position) const {
+    if (position >= total) return false;
+    return bitmap[position / 8] & (1 << (position % 8));
+}
+
+bool GroupLedger::record(uint16_t position, uint16_t smtpCode, bool success) {
+    if (!file || position >= total) return false;
+
+    uint8_t entry[ENTRY_SIZE];
+    file.seek(entryOffset(position));
+    if (file.read(entry, ENTRY_SIZE) != ENTRY_SIZE) return false;
+
+    entry[0] = smtpCode & 0xFF;
+    entry[1] = (smtpCode >> 8) & 0xFF;
+    if (entry[2] < 0xFF) entry[2]++;
+    if (success) entry[3] |= LEDGER_FLAG_DELIVERED;
+
+    file.seek(entryOffset(position));
+    bool ok = file.write(entry, ENTRY_SIZE) == ENTRY_SIZE;
+    file.flush(); // Güç kesilirse bu alıcı yeniden gönderilmesin
+
+    if (ok && success && !delivered(position)) {
+        bitmap[position / 8] |= (1 << (position % 8));
+        done++;
+    }
+    return ok;
+}
+
+namespace DeliveryLedger {
+
+String pathFor(uint8_t group) {
+    return "/final_ledger_" + String(group) + ".bin";
+}
+
+void clearAll() {
+    for (uint8_t g = 0; g < MAX_MAIL_GROUPS; ++g) {
+        String path = pathFor(g);
+        if (LittleFS.exists(path)) LittleFS.remove(path);
+    }
+}
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <vector>
+
+// ============================================
+// FINAL TESLİM DEFTERİ (Delivery Ledger)
+// ============================================
+// Final gönderimi yarıda kesildiğinde (ör. 10 alıcıdan 7.'si hata verdi)
+// eskiden grubun TAMAMI yeniden gönderiliyordu; ilk 6 alıcı kopya mail alıyordu.
+// Defter her grup için alıcı başına bir kayıt tutar ve her 250 yanıtından
+// hemen sonra flash'a yazılır. sendFinal() ve kuyruktaki final yeniden denemesi
+// aynı defteri okur, yalnızca teslim edilmemiş alıcılara gönderir.
+//
+// DOSYA FORMATI (/final_ledger_<grup>.bin, little-endian):
+//   [Başlık 16 byte] magic "DMFL" | version u8 | group u8 | listId u16
+//                    | count u16 | contentHash u32 | reserved (2 byte)
+//   [Kayıtlar]       count × 4 byte: lastCode u16 | attempts u8 | flags u8
+//                    lastCode 0 = yanıt yok (bağlantı hatası), attempts 255'te durur
+//
+// Alıcı listeleri değişmez ID'lidir (recipient_store.h) ve grup her
+// kaydedildiğinde yeni ID ile yeniden yüklenir. Defter bu yüzden ID'ye değil
+// liste içeriğinin özetine (RecipientStore::fingerprint) bağlıdır: yalnızca konu
+// / gövde düzenlenen grupta teslim edilenler korunur, adres listesi değişirse
+// defter sıfırdan başlar. Defterler final döngüsü bitince (acknowledgeFinal)
+// veya yeni geri sayım başlarken silinir.
+
+static const uint8_t LEDGER_FLAG_DELIVERED = 0x01;
+
+class GroupLedger {
+public:
+    ~GroupLedger() { close(); }
+
+    // Grubun defterini aç; yoksa veya liste içeriği değiştiyse boş defter oluşturur
+    bool open(uint8_t group, uint16_t listId, uint16_t count);
+    void close();
+
+    bool delivered(uint16_t position) const;
+    // Deneme sonucunu kaydet (attempts++) ve hemen flash'a yaz
+    bool record(uint16_t position, uint16_t smtpCode, bool success);
+
+    uint16_t count() const { return total; }
+    uint16_t deliveredCount() const { return done; }
+    bool complete() const { return total > 0 && done >= total; }
+
+private:
+    File file;
+    uint16_t total = 0;
+    uint16_t done = 0;
+    std::vector<uint8_t> bitmap; // Teslim bitleri (RAM'de, 1000 alıcı = 125 byte)
+};
+
+namespace DeliveryLedger {
+    String pathFor(uint8_t group);
+    // Tüm grup defterlerini sil (yeni final döngüsü)
+    void clearAll();
+}
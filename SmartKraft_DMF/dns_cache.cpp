@@ -0,0 +1,129 @@
+#include "dns_cache.h"
+
+#include <WiFi.h>
+
+namespace {
+
+struct CacheEntry {
+    char host[DNS_CACHE_HOST_LEN] = {0};
+    IPAddress address;
+    bool valid = false;
+    bool negative = false;
+    uint32_t storedAt = 0;
+    uint32_t lastUsed = 0;
+};
+
+portMUX_TYPE cacheLock = portMUX_INITIALIZER_UNLOCKED;
+CacheEntry entries[DNS_CACHE_SIZE];
+DnsCacheStats counters;
+
+// Kilit tutulurken çağrılır - süresi dolan girdi düşürülür
+CacheEntry *findEntry(const char *host, uint32_t now) {
+    for (auto &entry : entries) {
+        if (!entry.valid || strcasecmp(entry.host, host) != 0) continue;
+        uint32_t ttl = entry.negative ? DNS_CACHE_NEGATIVE_TTL_MS : DNS_CACHE_TTL_MS;
+        if (now - entry.storedAt > ttl) {
+            entry.valid = false;
+            return nullptr;
+        }
+        return &entry;
+    }
+    return nullptr;
+}
+
+// Aynı ad → üzerine yaz, yoksa boş girdi, yoksa en eski kullanılan (LRU)
+CacheEntry &slotFor(const char *host) {
+    CacheEntry *victim = nullptr;
+    for (auto &entry : entries) {
+        if (entry.valid && strcasecmp(entry.host, host) == 0) return entry;
+        if (!entry.valid && !victim) victim = &entry;
+    }
+    if (victim) return *victim;
+    victim = &entries[0];
+    for (auto &entry : entries) {
+        if ((int32_t)(entry.lastUsed - victim->lastUsed) < 0) victim = &entry;
+    }
+    return *victim;
+}
+
+}
+
+namespace DnsCache {
+
+bool resolve(const char *host, IPAddress &address) {
+    if (!host || !host[0]) return false;
+    if (address.fromString(host)) return true;
+
+    // Tabloya sığmayan ad önbelleğe alınmaz (yanlış eşleşme olmasın)
+    bool cacheable = strlen(host) < DNS_CACHE_HOST_LEN;
+
+    if (cacheable) {
+        portENTER_CRITICAL(&cacheLock);
+        CacheEntry *entry = findEntry(host, millis());
+        if (entry) {
+            entry->lastUsed = millis();
+            bool positive = !entry->negative;
+            if (positive) {
+                address = entry->address;
+                counters.hits++;
+            } else {
+                counters.negativeHits++;
+            }
+            portEXIT_CRITICAL(&cacheLock);
+            return positive;
+        }
+        portEXIT_CRITICAL(&cacheLock);
+    }
+
+    // Sorgu kilit dışında: ağ yavaşsa diğer görevler bloklanmaz
+    uint32_t start = millis();
+    IPAddress resolved;
+    bool ok = WiFi.hostByName(host, resolved) == 1 && resolved != IPAddress();
+    uint32_t elapsed = millis() - start;
+
+    portENTER_CRITICAL(&cacheLock);
+    counters.lookups++;
+    counters.lookupMsTotal += elapsed;
+    if (!ok) counters.failures++;
+    if (cacheable) {
+        CacheEntry &slot = slotFor(host);
+        strlcpy(slot.host, host, DNS_CACHE_HOST_LEN);
+        slot.address = ok ? resolved : IPAddress();
+        slot.negative = !ok;
+        slot.valid = true;
+        slot.storedAt = millis();
+        slot.lastUsed = slot.storedAt;
+    }
+    portEXIT_CRITICAL(&cacheLock);
+
+    if (ok) {
+        address = resolved;
+        Serial.printf("[DNS] %s → %s (%lu ms)\n", host, resolved.toString().c_str(), (unsigned long)elapsed);
+    } else {
+        Serial.printf("[DNS] ✗ %s çözümlenemedi (%lu ms) - %lu s tekrar sorulmayacak\n",
+                      host, (unsigned long)elapsed, (unsigned long)(DNS_CACHE_NEGATIVE_TTL_MS / 1000));
+    }
+    return ok;
+}
+
+void clear() {
+    portENTER_CRITICAL(&cacheLock);
+    for (auto &entry : entries) {
+        entry.valid = false;
+    }
+    portEXIT_CRITICAL(&cacheLock);
+}
+
+DnsCacheStats stats() {
+    portENTER_CRITICAL(&cacheLock);
+    DnsCacheStats copy = counters;
+    uint32_t now = millis();
+    for (auto &entry : entries) {
+        uint32_t ttl = entry.negative ? DNS_CACHE_NEGATIVE_TTL_MS : DNS_CACHE_TTL_MS;
+        if (entry.valid && now - entry.storedAt <= ttl) copy.entries++;
+    }
+    portEXIT_CRITICAL(&cacheLock);
+    return copy;
+}
+
+}
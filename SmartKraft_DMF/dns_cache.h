@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// ============================================================================
+// DNS ÖNBELLEĞİ - SMTP, OTA ve bağlantı testlerinin ortak çözümleyicisi
+// ============================================================================
+// Önceden aynı ad bir gönderimde birkaç kez çözülüyordu: SmtpSession
+// hostByName() ile kontrol edip ardından connect()'e ad veriyordu (ikinci
+// çözümleme), OTA her kontrolde api.github.com'u iki kez soruyordu.
+//
+// Tüm modüller DnsCache::resolve() kullanır; CachedTlsClient da bağlantıyı
+// önbellekten gelen IP ile açar (SNI / sertifika doğrulaması yine ad ile).
+//
+//   - Olumlu yanıt DNS_CACHE_TTL_MS boyunca tutulur. lwIP yanıttaki TTL'i
+//     dışarı vermediği için sabit ve kısa bir üst sınır kullanılır (posta ve
+//     API sunucularında tipik kayıt TTL'i 300 s ve üzeri).
+//   - Başarısız çözümleme DNS_CACHE_NEGATIVE_TTL_MS boyunca hatırlanır:
+//     ağ DNS'i yanıt vermiyorken her deneme yeniden zaman aşımı beklemez.
+//   - Ağ bağlantısı değiştiğinde (IP alındı / koptu) tablo temizlenir;
+//     yeni ağın çözümleyicisi farklı yanıt verebilir.
+//
+// IP adresi biçimindeki adlar tabloya girmeden doğrudan döner.
+
+static const uint8_t DNS_CACHE_SIZE = 6;
+static const uint8_t DNS_CACHE_HOST_LEN = 64;
+static const uint32_t DNS_CACHE_TTL_MS = 5UL * 60UL * 1000UL;       // 5 dakika
+static const uint32_t DNS_CACHE_NEGATIVE_TTL_MS = 30UL * 1000UL;    // 30 saniye
+
+struct DnsCacheStats {
+    uint32_t hits = 0;             // Önbellekten olumlu yanıt
+    uint32_t negativeHits = 0;     // Önbellekten olumsuz yanıt (sorgu yapılmadı)
+    uint32_t lookups = 0;          // Gerçek DNS sorgusu
+    uint32_t failures = 0;         // Başarısız sorgu
+    uint32_t lookupMsTotal = 0;
+    uint8_t entries = 0;           // Geçerli girdi sayısı (anlık)
+
+    uint32_t averageLookupMs() const { return lookups ? lookupMsTotal / lookups : 0; }
+    uint8_t hitRatePercent() const {
+        uint32_t total = hits + negativeHits + lookups;
+        return total ? (uint8_t)(((hits + negativeHits) * 100UL) / total) : 0;
+    }
+};
+
+namespace DnsCache {
+    // Önbellekte geçerli girdi varsa sorgusuz döner; yoksa hostByName ile çözer.
+    // Olumsuz girdi süresi dolana kadar false döner.
+    bool resolve(const char *host, IPAddress &address);
+
+    // Tabloyu boşalt (ağ değişimi) - istatistikler korunur
+    void clear();
+
+    DnsCacheStats stats();
+}
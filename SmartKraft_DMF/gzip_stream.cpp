@@ -0,0 +1,275 @@
+#include "gzip_stream.h"
+
+namespace {
+
+// RFC 1951 3.2.5 - uzunluk kodları 257..285
+const uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+// Mesafe kodları 0..29 (pencere 2 KB olduğundan en fazla 21 kullanılır)
+const uint16_t DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                    8193, 12289, 16385, 24577};
+const uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// CRC-32 (gzip) - 16 girdilik yarım bayt tablosu (64 bayt flash)
+const uint32_t CRC_TABLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ CRC_TABLE[crc & 0x0F];
+        crc = (crc >> 4) ^ CRC_TABLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+uint8_t findCode(const uint16_t *base, uint8_t count, size_t value) {
+    uint8_t code = 0;
+    while (code + 1 < count && base[code + 1] <= value) code++;
+    return code;
+}
+
+}
+
+bool GzipWriter::begin(Print &output) {
+    release();
+    window = static_cast<uint8_t *>(malloc(BUFFER_SIZE));
+    head = static_cast<uint16_t *>(calloc(HASH_SIZE, sizeof(uint16_t)));
+    prev = static_cast<uint16_t *>(calloc(WINDOW_SIZE, sizeof(uint16_t)));
+    if (!window || !head || !prev) {
+        release();
+        return false;
+    }
+
+    out = &output;
+    filled = 0;
+    position = 0;
+    crc = 0;
+    failed = false;
+    bitBuffer = 0;
+    bitCount = 0;
+    outLength = 0;
+    counters = GzipStats();
+    startedAt = millis();
+
+    // gzip başlığı: kimlik, deflate, bayrak yok, mtime=0, xfl=0, OS=unix
+    static const uint8_t HEADER[10] = {0x1F, 0x8B, 0x08, 0x00, 0, 0, 0, 0, 0x00, 0x03};
+    for (uint8_t b : HEADER) putByte(b);
+
+    // İlk blok: son değil, sabit Huffman
+    putBits(0, 1);
+    putBits(1, 2);
+    return true;
+}
+
+bool GzipWriter::write(const uint8_t *data, size_t length) {
+    if (!active() || failed) return false;
+    counters.inputBytes += length;
+    crc = crc32Update(crc, data, length);
+
+    while (length > 0) {
+        if (filled == BUFFER_SIZE) slide();
+        size_t chunk = min(length, BUFFER_SIZE - filled);
+        memcpy(window + filled, data, chunk);
+        filled += chunk;
+        data += chunk;
+        length -= chunk;
+        compress(false);
+    }
+    return !failed;
+}
+
+bool GzipWriter::finish() {
+    if (!active()) return false;
+    compress(true);
+
+    // Blok sonu, ardından boş son blok (girdinin bittiği ancak şimdi belli)
+    emitSymbol(256);
+    putBits(1, 1);
+    putBits(1, 2);
+    emitSymbol(256);
+    flushBits();
+
+    // Altbilgi: CRC32 + girdi boyutu (küçük uçlu)
+    for (uint8_t i = 0; i < 4; ++i) putByte((crc >> (8 * i)) & 0xFF);
+    for (uint8_t i = 0; i < 4; ++i) putByte((counters.inputBytes >> (8 * i)) & 0xFF);
+    flushOutput();
+
+    counters.elapsedMs = millis() - startedAt;
+    bool ok = !failed;
+    release();
+    return ok;
+}
+
+void GzipWriter::release() {
+    free(window);
+    free(head);
+    free(prev);
+    window = nullptr;
+    head = nullptr;
+    prev = nullptr;
+    out = nullptr;
+}
+
+bool GzipWriter::worthCompressing(const String &fileName) {
+    String name = fileName;
+    name.toLowerCase();
+    static const char *const PACKED[] = {".gz", ".zip", ".7z", ".rar", ".pdf", ".jpg", ".jpeg", ".png", ".gif",
+                                         ".webp", ".mp3", ".mp4", ".docx", ".xlsx", ".pptx", ".odt", ".apk"};
+    for (const char *suffix : PACKED) {
+        if (name.endsWith(suffix)) return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// LZ77
+// ============================================================================
+
+uint32_t GzipWriter::hashAt(size_t pos) const {
+    uint32_t value = ((uint32_t)window[pos] << 16) | ((uint32_t)window[pos + 1] << 8) | window[pos + 2];
+    return (uint32_t)(value * 2654435761U) >> (32 - HASH_BITS);
+}
+
+void GzipWriter::insert(size_t pos) {
+    uint32_t hash = hashAt(pos);
+    prev[pos & (WINDOW_SIZE - 1)] = head[hash];
+    head[hash] = (uint16_t)(pos + 1);
+}
+
+void GzipWriter::compress(bool flush) {
+    // Akış sırasında her konumda tam eşleşme uzunluğu kadar ileri bakış bırakılır
+    size_t limit = flush ? filled : (filled > MAX_MATCH ? filled - MAX_MATCH : 0);
+
+    while (position < limit && !failed) {
+        size_t available = filled - position;
+        size_t bestLength = 0;
+        size_t bestDistance = 0;
+
+        if (available >= MIN_MATCH) {
+            size_t maxLength = min(available, MAX_MATCH);
+            uint16_t candidate = head[hashAt(position)];
+            uint8_t chain = MAX_CHAIN;
+
+            while (candidate && chain--) {
+                size_t start = candidate - 1;
+                if (start >= position || position - start >= WINDOW_SIZE) break;
+
+                const uint8_t *a = window + start;
+                const uint8_t *b = window + position;
+                size_t length = 0;
+                while (length < maxLength && a[length] == b[length]) length++;
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = position - start;
+                    if (length == maxLength) break;
+                }
+
+                uint16_t next = prev[start & (WINDOW_SIZE - 1)];
+                if (next && next - 1u >= start) break; // Halka üzerine yazılmış - zincir bitti
+                candidate = next;
+            }
+            insert(position);
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            emitMatch(bestLength, bestDistance);
+            for (size_t k = 1; k < bestLength; ++k) {
+                if (position + k + MIN_MATCH <= filled) insert(position + k);
+            }
+            position += bestLength;
+        } else {
+            emitLiteral(window[position]);
+            position++;
+        }
+    }
+}
+
+void GzipWriter::slide() {
+    // Üst yarıyı alta kaydır; konum tabloları aynı miktarda ötelenir
+    memmove(window, window + WINDOW_SIZE, filled - WINDOW_SIZE);
+    filled -= WINDOW_SIZE;
+    position -= WINDOW_SIZE;
+    for (size_t i = 0; i < HASH_SIZE; ++i) {
+        head[i] = head[i] > WINDOW_SIZE ? head[i] - WINDOW_SIZE : 0;
+    }
+    for (size_t i = 0; i < WINDOW_SIZE; ++i) {
+        prev[i] = prev[i] > WINDOW_SIZE ? prev[i] - WINDOW_SIZE : 0;
+    }
+}
+
+// ============================================================================
+// SABİT HUFFMAN KODLAMA
+// ============================================================================
+
+void GzipWriter::emitLiteral(uint8_t value) {
+    counters.literals++;
+    emitSymbol(value);
+}
+
+void GzipWriter::emitMatch(size_t length, size_t distance) {
+    counters.matches++;
+
+    uint8_t lengthCode = findCode(LENGTH_BASE, 29, length);
+    emitSymbol(257 + lengthCode);
+    if (LENGTH_EXTRA[lengthCode]) putBits(length - LENGTH_BASE[lengthCode], LENGTH_EXTRA[lengthCode]);
+
+    uint8_t distanceCode = findCode(DISTANCE_BASE, 30, distance);
+    putHuffman(distanceCode, 5);
+    if (DISTANCE_EXTRA[distanceCode]) putBits(distance - DISTANCE_BASE[distanceCode], DISTANCE_EXTRA[distanceCode]);
+}
+
+void GzipWriter::emitSymbol(uint16_t symbol) {
+    if (symbol < 144) {
+        putHuffman(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        putHuffman(0x190 + (symbol - 144), 9);
+    } else if (symbol < 280) {
+        putHuffman(symbol - 256, 7);
+    } else {
+        putHuffman(0xC0 + (symbol - 280), 8);
+    }
+}
+
+void GzipWriter::putHuffman(uint32_t code, uint8_t length) {
+    uint32_t reversed = 0;
+    for (uint8_t i = 0; i < length; ++i) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    putBits(reversed, length);
+}
+
+void GzipWriter::putBits(uint32_t value, uint8_t count) {
+    bitBuffer |= value << bitCount;
+    bitCount += count;
+    while (bitCount >= 8) {
+        putByte(bitBuffer & 0xFF);
+        bitBuffer >>= 8;
+        bitCount -= 8;
+    }
+}
+
+void GzipWriter::flushBits() {
+    if (bitCount > 0) putByte(bitBuffer & 0xFF);
+    bitBuffer = 0;
+    bitCount = 0;
+}
+
+void GzipWriter::putByte(uint8_t value) {
+    outBuffer[outLength++] = value;
+    if (outLength == sizeof(outBuffer)) flushOutput();
+}
+
+void GzipWriter::flushOutput() {
+    if (outLength == 0 || !out) return;
+    if (out->write(outBuffer, outLength) != outLength) failed = true;
+    counters.outputBytes += outLength;
+    outLength = 0;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================================
+// AKIŞ HALİNDE GZIP (DEFLATE) SIKIŞTIRICI - Sınırlı bellek
+// ============================================================================
+// Ekler yüklenirken parça parça sıkıştırılır; tüm dosya RAM'e alınmaz.
+//
+//   - LZ77: 2 KB pencere, 3 bayt özet (hash) zinciri, açgözlü eşleşme
+//   - Kodlama: sabit Huffman blokları (RFC 1951 BTYPE=01) - tablo üretimi yok
+//   - Çıktı: gzip (RFC 1952), mtime=0 → aynı girdi her zaman aynı çıktı
+//     (içerik adresli depoda tekilleştirme bozulmaz)
+//
+// Bellek: pencere 2×2 KB + özet başları 2 KB×2 + zincir 2 KB×2 ≈ 12 KB,
+// yalnızca begin() ile finish() arasında ayrılır. Metin belgelerde (CSV,
+// talimat, anahtar listesi) tipik oran %35-55; zaten sıkıştırılmış
+// biçimlerde (PDF, JPEG, ZIP) kazanç olmadığı için çağıran atlar.
+
+struct GzipStats {
+    uint32_t inputBytes = 0;
+    uint32_t outputBytes = 0;
+    uint32_t matches = 0;      // LZ77 geri referansı
+    uint32_t literals = 0;
+    uint32_t elapsedMs = 0;
+
+    // Çıktı / girdi × 100 (küçük = iyi)
+    uint8_t ratioPercent() const {
+        return inputBytes ? (uint8_t)min<uint32_t>(100, (uint64_t)outputBytes * 100 / inputBytes) : 100;
+    }
+};
+
+class GzipWriter {
+public:
+    GzipWriter() = default;
+    ~GzipWriter() { release(); }
+
+    GzipWriter(const GzipWriter &) = delete;
+    GzipWriter &operator=(const GzipWriter &) = delete;
+
+    // Çalışma belleğini ayır, gzip başlığını yaz (bellek yoksa false)
+    bool begin(Print &out);
+    bool write(const uint8_t *data, size_t length);
+    // Kalan girdiyi sıkıştır, CRC32 + boyut ile kapat, belleği bırak
+    bool finish();
+    void release();
+
+    bool active() const { return window != nullptr; }
+    const GzipStats &stats() const { return counters; }
+
+    // Zaten sıkıştırılmış biçim mi (uzantıdan)? → sıkıştırma atlanır
+    static bool worthCompressing(const String &fileName);
+
+    static constexpr size_t WINDOW_SIZE = 2048;   // LZ77 geri mesafe sınırı
+    static constexpr size_t HASH_BITS = 11;
+
+private:
+    static constexpr size_t HASH_SIZE = 1 << HASH_BITS;
+    static constexpr size_t BUFFER_SIZE = WINDOW_SIZE * 2;
+    static constexpr size_t MIN_MATCH = 3;
+    static constexpr size_t MAX_MATCH = 258;
+    static constexpr uint8_t MAX_CHAIN = 16;      // Eşleşme ararken bakılan aday
+
+    Print *out = nullptr;
+    uint8_t *window = nullptr;    // BUFFER_SIZE
+    uint16_t *head = nullptr;     // Özet → son konum + 1 (0 = boş)
+    uint16_t *prev = nullptr;     // Konum & (WINDOW_SIZE-1) → önceki aynı özetli konum + 1
+    size_t filled = 0;            // Penceredeki geçerli bayt
+    size_t position = 0;          // Sıradaki kodlanacak konum
+    uint32_t crc = 0;
+    bool failed = false;
+
+    uint32_t bitBuffer = 0;
+    uint8_t bitCount = 0;
+    uint8_t outBuffer[128];
+    size_t outLength = 0;
+
+    GzipStats counters;
+    uint32_t startedAt = 0;
+
+    void compress(bool flush);
+    void slide();
+    uint32_t hashAt(size_t pos) const;
+    void insert(size_t pos);
+
+    void emitLiteral(uint8_t value);
+    void emitMatch(size_t length, size_t distance);
+    void emitSymbol(uint16_t symbol);                  // Sabit Huffman lit/uzunluk kodu
+    void putBits(uint32_t value, uint8_t count);       // LSB önce
+    void putHuffman(uint32_t code, uint8_t length);    // MSB önce (ters çevrilir)
+    void putByte(uint8_t value);
+    void flushBits();
+    void flushOutput();
+};
@@ -80,7 +80,7 @@ const char I18N_DE[] PROGMEM = R"rawliteral({
     "passwordPlaceholder": "SMTP-Passwort oder App-spezifisches Passwort",
     "sectionRecipients": "Empfänger",
     "recipientsHelp": "E-Mail-Adressen eingeben (eine pro Zeile)",
-    "recipientsHelpGroup": "E-Mail-Adressen eingeben (eine pro Zeile, max. 10)",
+    "recipientsHelpGroup": "E-Mail-Adressen eingeben (eine pro Zeile, max. 1000)",
     "recipientsPlaceholder": "empfaenger1@beispiel.de\nempfaenger2@beispiel.de",
     "sectionWarning": "Frühwarnmeldung",
     "warningSubject": "Betreff",
@@ -91,7 +91,7 @@ const char I18N_DE[] PROGMEM = R"rawliteral({
     "warningUrlPlaceholder": "https://beispiel.de/api/warnung",
     "sectionFinal": "DMF-Protokoll (Abschlussmeldung)",
     "sectionFinalGroups": "DMF-Protokoll (Abschlussmeldungsgruppen)",
-    "groupsHelp": "Erstellen Sie bis zu 3 Mail-Gruppen. Jede Gruppe hat eigene Empfänger, Nachricht, Dateien und URL-Trigger. Klicken Sie auf eine Gruppe zum Bearbeiten.",
+    "groupsHelp": "Erstellen Sie bis zu 8 Mail-Gruppen. Jede Gruppe hat eigene Empfänger, Nachricht, Dateien und URL-Trigger. Klicken Sie auf eine Gruppe zum Bearbeiten.",
     "addGroup": "+ Neue Mail-Gruppe hinzufügen",
     "editGroupTitle": "Mail-Gruppe bearbeiten",
     "groupName": "Gruppenname",
@@ -106,7 +106,7 @@ const char I18N_DE[] PROGMEM = R"rawliteral({
     "groupDeleteError": "Fehler beim Löschen der Mail-Gruppe",
     "groupTestSuccess": "Gruppen-Testmail erfolgreich gesendet",
     "groupTestError": "Gruppen-Testmail fehlgeschlagen",
-    "groupMaxReached": "Maximal 3 Gruppen erlaubt",
+    "groupMaxReached": "Maximal 8 Gruppen erlaubt",
     "groupNoActive": "Keine aktive Gruppe gefunden",
     "groupNoRecipients": "Diese Gruppe hat keine Empfänger",
     "groupNameRequired": "Gruppenname ist erforderlich",
@@ -130,6 +130,8 @@ const char I18N_DE[] PROGMEM = R"rawliteral({
     "attachmentFinal": "Abschluss",
     "attachmentActions": "Aktionen",
     "uploadZone": "📎 Klicken zum Hochladen (max. 300 KB pro Gruppe, 900 KB gesamt)",
+    "compressUpload": "Textdateien beim Hochladen komprimieren (.gz)",
+    "compressResult": "Komprimiert",
     "uploadSuccess": "Datei erfolgreich hochgeladen",
     "uploadError": "Datei-Upload fehlgeschlagen",
     "deleteSuccess": "Datei erfolgreich gelöscht",
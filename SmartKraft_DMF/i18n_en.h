@@ -80,7 +80,7 @@ const char I18N_EN[] PROGMEM = R"rawliteral({
     "passwordPlaceholder": "SMTP password or app-specific password",
     "sectionRecipients": "Recipients",
     "recipientsHelp": "Enter email addresses (one per line)",
-    "recipientsHelpGroup": "Enter email addresses (one per line, max 10)",
+    "recipientsHelpGroup": "Enter email addresses (one per line, max 1000)",
     "recipientsPlaceholder": "recipient1@example.com\nrecipient2@example.com",
     "sectionWarning": "Early Warning Message",
     "warningSubject": "Subject",
@@ -91,7 +91,7 @@ const char I18N_EN[] PROGMEM = R"rawliteral({
     "warningUrlPlaceholder": "https://example.com/api/warning",
     "sectionFinal": "DMF Protocol (Final Message)",
     "sectionFinalGroups": "DMF Protocol (Final Message Groups)",
-    "groupsHelp": "Create up to 3 mail groups. Each group has its own recipients, message, files and URL trigger. Click on a group to edit.",
+    "groupsHelp": "Create up to 8 mail groups. Each group has its own recipients, message, files and URL trigger. Click on a group to edit.",
     "addGroup": "+ Add New Mail Group",
     "editGroupTitle": "Edit Mail Group",
     "groupName": "Group Name",
@@ -106,7 +106,7 @@ const char I18N_EN[] PROGMEM = R"rawliteral({
     "groupDeleteError": "Error deleting mail group",
     "groupTestSuccess": "Group test mail sent successfully",
     "groupTestError": "Group test mail failed",
-    "groupMaxReached": "Maximum 3 groups allowed",
+    "groupMaxReached": "Maximum 8 groups allowed",
     "groupNoActive": "No active group found",
     "groupNoRecipients": "This group has no recipients",
     "groupNameRequired": "Group name is required",
@@ -130,6 +130,8 @@ const char I18N_EN[] PROGMEM = R"rawliteral({
     "attachmentFinal": "Final",
     "attachmentActions": "Actions",
     "uploadZone": "📎 Click to upload file (max 300 KB per group, 900 KB total)",
+    "compressUpload": "Compress text files on upload (.gz)",
+    "compressResult": "Compressed",
     "uploadSuccess": "File uploaded successfully",
     "uploadError": "File upload failed",
     "deleteSuccess": "File deleted successfully",
@@ -80,7 +80,7 @@ const char I18N_TR[] PROGMEM = R"rawliteral({
     "passwordPlaceholder": "SMTP şifresi veya uygulamaya özel şifre",
     "sectionRecipients": "Alıcılar",
     "recipientsHelp": "E-posta adreslerini girin (her satıra bir tane)",
-    "recipientsHelpGroup": "E-posta adreslerini girin (her satıra bir tane, maksimum 10)",
+    "recipientsHelpGroup": "E-posta adreslerini girin (her satıra bir tane, maksimum 1000)",
     "recipientsPlaceholder": "alici1@ornek.com\nalici2@ornek.com",
     "sectionWarning": "Erken Uyarı Mesajı",
     "warningSubject": "Konu",
@@ -91,7 +91,7 @@ const char I18N_TR[] PROGMEM = R"rawliteral({
     "warningUrlPlaceholder": "https://ornek.com/api/uyari",
     "sectionFinal": "DMF Protokolü (Son Mesaj)",
     "sectionFinalGroups": "DMF Protokolü (Son Mesaj Grupları)",
-    "groupsHelp": "3 adete kadar mail grubu oluşturun. Her grubun kendi alıcıları, mesajı, dosyaları ve URL tetiklemesi vardır. Düzenlemek için bir gruba tıklayın.",
+    "groupsHelp": "8 adete kadar mail grubu oluşturun. Her grubun kendi alıcıları, mesajı, dosyaları ve URL tetiklemesi vardır. Düzenlemek için bir gruba tıklayın.",
     "addGroup": "+ Yeni Mail Grubu Ekle",
     "editGroupTitle": "Mail Grubu Düzenle",
     "groupName": "Grup Adı",
@@ -106,7 +106,7 @@ const char I18N_TR[] PROGMEM = R"rawliteral({
     "groupDeleteError": "Mail grubu silinirken hata oluştu",
     "groupTestSuccess": "Grup test maili başarıyla gönderildi",
     "groupTestError": "Grup test maili gönderilemedi",
-    "groupMaxReached": "Maksimum 3 grup eklenebilir",
+    "groupMaxReached": "Maksimum 8 grup eklenebilir",
     "groupNoActive": "Aktif grup bulunamadı",
     "groupNoRecipients": "Bu grubun alıcısı yok",
     "groupNameRequired": "Grup adı gereklidir",
@@ -130,6 +130,8 @@ const char I18N_TR[] PROGMEM = R"rawliteral({
     "attachmentFinal": "Son",
     "attachmentActions": "İşlemler",
     "uploadZone": "📎 Dosya yüklemek için tıklayın (Grup başına max 300 KB, toplam 900 KB)",
+    "compressUpload": "Metin dosyalarını yüklerken sıkıştır (.gz)",
+    "compressResult": "Sıkıştırıldı",
     "uploadSuccess": "Dosya başarıyla yüklendi",
     "uploadError": "Dosya yükleme başarısız",
     "deleteSuccess": "Dosya başarıyla silindi",
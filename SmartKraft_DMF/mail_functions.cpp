@@ -1,70 +1,132 @@
 #include "mail_functions.h"
+#include "attachment_pipeline.h"
+#include "attachment_cache.h"
+#include "attachment_store.h"
+#include "message_template.h"
+#include "base64_stream.h"
 
 #include <LittleFS.h>
-#include <base64.h>
-#include <HTTPClient.h>
 #include <WiFiClient.h>
 #include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
-#include <algorithm>  // std::sort için
+#include <esp_task_wdt.h>
+
+namespace {
+// Grup dosya yollarını (String) gönderim için AttachmentMeta listesine dönüştür
+// NOT: MailGroup.attachments String[] (içerik referansı), gönderim tarafı AttachmentMeta bekliyor
+uint8_t collectGroupAttachments(const MailGroup &group, AttachmentMeta *out) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < group.attachmentCount && i < MAX_ATTACHMENTS_PER_GROUP; ++i) {
+        AttachmentMeta &meta = out[count++];
+        // Referans → ortak blob: aynı içerik (ve sidecar'ı) tüm gruplarda aynı dosya
+        strlcpy(meta.storedPath, AttachmentStore::resolve(group.attachments[i]).c_str(), MAX_PATH_LEN);
+        strlcpy(meta.displayName, AttachmentStore::displayName(group.attachments[i]).c_str(), MAX_FILENAME_LEN);
+        meta.size = 0;               // Bilinmiyor
+        meta.forWarning = false;
+        meta.forFinal = true;
+    }
+    return count;
+}
 
-// ============================================================================
-// ROOT CA CERTIFICATES (SSL/TLS Sertifika Doğrulama)
-// ============================================================================
+// Eklerin sidecar'larını doğrula/üret. Yalnızca gönderim görevlerinden ÖNCE,
+// çağıran görevden: ortak blob'un sidecar'ı paralel oturumlarda salt okunur açılır.
+void prepareSidecars(const AttachmentMeta *attachments, uint8_t attachmentCount, bool warningAttachments) {
+    for (uint8_t i = 0; attachments && i < attachmentCount; ++i) {
+        if (warningAttachments ? !attachments[i].forWarning : !attachments[i].forFinal) continue;
+        String cacheError;
+        if (!AttachmentCache::prepare(attachments[i].storedPath, cacheError)) {
+            Serial.printf("[Attach] Sidecar hazırlanamadı (%s): %s, anlık kodlanacak\n",
+                          attachments[i].displayName, cacheError.c_str());
+        }
+    }
+}
+
+// Seçili eklerin boyutunu bir kez ölç (dosya başına tek açılış); mesaj başına
+// SIZE tahmini ve MIME yazıcısı bu değerleri kullanır
+AttachmentList measureAttachments(const AttachmentMeta *items, uint8_t count, bool warning) {
+    AttachmentList list;
+    list.items = items;
+    list.count = items ? count : 0;
+    list.warning = warning;
+    for (uint8_t i = 0; i < list.count; ++i) {
+        list.sizes[i] = AttachmentList::MISSING;
+        if (warning ? !items[i].forWarning : !items[i].forFinal) continue;
+        File file = LittleFS.open(items[i].storedPath, "r");
+        if (!file) {
+            Serial.printf("[Attach] %s ATLANACAK (dosya yok/açılamadı: %s)\n", items[i].displayName, items[i].storedPath);
+            continue;
+        }
+        list.sizes[i] = file.size();
+        file.close();
+        if (list.sizes[i] > AttachmentList::MAX_SEND_SIZE) {
+            Serial.printf("[Attach] %s ATLANACAK (çok büyük: %u bytes > 500KB)\n", items[i].displayName, (unsigned)list.sizes[i]);
+        }
+    }
+    return list;
+}
 
-// ISRG Root X1 - Let's Encrypt (ProtonMail kullanıyor)
-// Geçerlilik: 2015-06-04 → 2035-06-04 (20 YIL!)
-const char* ROOT_CA_ISRG_X1 = 
-"-----BEGIN CERTIFICATE-----\n"
-"MIIFazCCA1OgAwIBAgIRAIIQz7DSQONZRGPgu2OCiwAwDQYJKoZIhvcNAQELBQAw\n"
-"TzELMAkGA1UEBhMCVVMxKTAnBgNVBAoTIEludGVybmV0IFNlY3VyaXR5IFJlc2Vh\n"
-"cmNoIEdyb3VwMRUwEwYDVQQDEwxJU1JHIFJvb3QgWDEwHhcNMTUwNjA0MTEwNDM4\n"
-"WhcNMzUwNjA0MTEwNDM4WjBPMQswCQYDVQQGEwJVUzEpMCcGA1UEChMgSW50ZXJu\n"
-"ZXQgU2VjdXJpdHkgUmVzZWFyY2ggR3JvdXAxFTATBgNVBAMTDElTUkcgUm9vdCBY\n"
-"MTCCAiIwDQYJKoZIhvcNAQEBBQADggIPADCCAgoCggIBAK3oJHP0FDfzm54rVygc\n"
-"h77ct984kIxuPOZXoHj3dcKi/vVqbvYATyjb3miGbESTtrFj/RQSa78f0uoxmyF+\n"
-"0TM8ukj13Xnfs7j/EvEhmkvBioZxaUpmZmyPfjxwv60pIgbz5MDmgK7iS4+3mX6U\n"
-"A5/TR5d8mUgjU+g4rk8Kb4Mu0UlXjIB0ttov0DiNewNwIRt18jA8+o+u3dpjq+sW\n"
-"T8KOEUt+zwvo/7V3LvSye0rgTBIlDHCNAymg4VMk7BPZ7hm/ELNKjD+Jo2FR3qyH\n"
-"B5T0Y3HsLuJvW5iB4YlcNHlsdu87kGJ55tukmi8mxdAQ4Q7e2RCOFvu396j3x+UC\n"
-"B5iPNgiV5+I3lg02dZ77DnKxHZu8A/lJBdiB3QW0KtZB6awBdpUKD9jf1b0SHzUv\n"
-"KBds0pjBqAlkd25HN7rOrFleaJ1/ctaJxQZBKT5ZPt0m9STJEadao0xAH0ahmbWn\n"
-"OlFuhjuefXKnEgV4We0+UXgVCwOPjdAvBbI+e0ocS3MFEvzG6uBQE3xDk3SzynTn\n"
-"jh8BCNAw1FtxNrQHusEwMFxIt4I7mKZ9YIqioymCzLq9gwQbooMDQaHWBfEbwrbw\n"
-"qHyGO0aoSCqI3Haadr8faqU9GY/rOPNk3sgrDQoo//fb4hVC1CLQJ13hef4Y53CI\n"
-"rU7m2Ys6xt0nUW7/vGT1M0NPAgMBAAGjQjBAMA4GA1UdDwEB/wQEAwIBBjAPBgNV\n"
-"HRMBAf8EBTADAQH/MB0GA1UdDgQWBBR5tFnme7bl5AFzgAiIyBpY9umbbjANBgkq\n"
-"hkiG9w0BAQsFAAOCAgEAVR9YqbyyqFDQDLHYGmkgJykIrGF1XIpu+ILlaS/V9lZL\n"
-"ubhzEFnTIZd+50xx+7LSYK05qAvqFyFWhfFQDlnrzuBZ6brJFe+GnY+EgPbk6ZGQ\n"
-"3BebYhtF8GaV0nxvwuo77x/Py9auJ/GpsMiu/X1+mvoiBOv/2X/qkSsisRcOj/KK\n"
-"NFtY2PwByVS5uCbMiogziUwthDyC3+6WVwW6LLv3xLfHTjuCvjHIInNzktHCgKQ5\n"
-"ORAzI4JMPJ+GslWYHb4phowim57iaztXOoJwTdwJx4nLCgdNbOhdjsnvzqvHu7Ur\n"
-"TkXWStAmzOVyyghqpZXjFaH3pO3JLF+l+/+sKAIuvtd7u+Nxe5AW0wdeRlN8NwdC\n"
-"jNPElpzVmbUq4JUagEiuTDkHzsxHpFKVK7q4+63SM1N95R1NbdWhscdCb+ZAJzVc\n"
-"oyi3B43njTOQ5yOf+1CceWxG1bQVs5ZufpsMljq4Ui0/1lvh+wjChP4kqKOJ2qxq\n"
-"4RgqsahDYVvTH9w7jXbyLeiNdd8XM2w9U/t7y0Ff/9yi0GE44Za4rF2LN9d11TPA\n"
-"mRGunUHBcnWEvgJBQl9nJEiU0Zsnvgc/ubhPgXRR4Xq37Z0j4r7g1SgEEzwxA57d\n"
-"emyPxgcYxn/eR44/KJ4EBs+lVDR3veyJm+kXQ99b21/+jh5Xos1AnX5iItreGCc=\n"
-"-----END CERTIFICATE-----\n";
+// Uyarı içeriği: warning şablonları + bu alarmın değerleri
+// (değer dizgileri çağıranın yığınında, render bitene kadar yaşar)
+MailContent warningContent(const MailSettings &settings, const char *deviceId, const char *timestamp,
+                           const char *remaining, const char *alarmIndex, const char *totalAlarms) {
+    MailContent content;
+    content.subject = &settings.templates->warningSubject;
+    content.body = &settings.templates->warningBody;
+    content.values.set(TemplateVar::DEVICE_ID, deviceId);
+    content.values.set(TemplateVar::TIMESTAMP, timestamp);
+    content.values.set(TemplateVar::REMAINING, remaining);
+    content.values.set(TemplateVar::ALARM_INDEX, alarmIndex);
+    content.values.set(TemplateVar::TOTAL_ALARMS, totalAlarms);
+    return content;
+}
 
-// ============================================================================
+// Final grup içeriği - %ALARM_INDEX%/%TOTAL_ALARMS% eskisi gibi olduğu gibi kalır
+MailContent groupContent(const MailSettings &settings, uint8_t g, const char *deviceId, const char *timestamp) {
+    MailContent content;
+    content.subject = &settings.templates->groupSubject[g];
+    content.body = &settings.templates->groupBody[g];
+    content.values.set(TemplateVar::DEVICE_ID, deviceId);
+    content.values.set(TemplateVar::TIMESTAMP, timestamp);
+    content.values.set(TemplateVar::REMAINING, "0");
+    return content;
+}
+}
 
 void MailAgent::begin(ConfigStore *storePtr, DMFNetworkManager *netMgrPtr, const String &deviceIdStr) {
     store = storePtr;
     netManager = netMgrPtr;
     deviceId = deviceIdStr;
     if (store) {
-        settings = store->loadMailSettings();
+        publishConfig(store->loadMailSettings());
     }
     
     // Persistent mail queue'yu yükle
     loadQueueFromStorage();
+    
+    // Ağ geri geldiğinde yalnızca bağlantı bekleyen mailler beklemeden denenir
+    if (netManager) {
+        netManager->addStateListener(onLinkStateChanged, this);
+    }
 }
 
-void MailAgent::updateConfig(const MailSettings &config) {
-    settings = config;
+void MailAgent::publishConfig(MailSettings settings) {
+    // Şablonlar ayar başına bir kez ayrıştırılır, gönderimler yalnızca render eder
+    settings.templates = MailTemplates::compile(settings);
+    config.publish(settings);
+}
+
+void MailAgent::updateConfig(const MailSettings &newConfig) {
+    publishConfig(newConfig);
     if (store) {
-        store->saveMailSettings(settings);
+        store->saveMailSettings(newConfig);
+    }
+    configChanged = true; // AUTH/CONFIG hatasıyla bekleyenler yeni ayarla denensin
+}
+
+void MailAgent::onLinkStateChanged(LinkState state, void *context) {
+    // Durum makinesi içinden çağrılır - kuyruğa dokunma, processQueue() halleder
+    if (state == LinkState::ONLINE) {
+        static_cast<MailAgent *>(context)->networkCameUp = true;
     }
 }
 
@@ -111,179 +173,35 @@ bool MailAgent::isValidURL(const String &url) {
 
 // ============================================================================
 
-String MailAgent::base64Encode(const String &input) {
-    return base64::encode(input);
-}
-
-String MailAgent::smtpReadLine(WiFiClientSecure &client, uint32_t timeoutMs) {
-    String line = "";
-    unsigned long start = millis();
-    
-    while (millis() - start < timeoutMs) {
-        if (client.available()) {
-            char c = client.read();
-            if (c == '\n') break;
-            if (c != '\r') line += c;
-        }
-        delay(1);
-    }
-    
-    return line;
-}
-
-bool MailAgent::smtpConnect(WiFiClientSecure &client, String &errorMessage) {
-    if (WiFi.status() != WL_CONNECTED) {
-        errorMessage = "WiFi not connected";
-        return false;
-    }
-    
-    // ============================================
-    // WiFiClientSecure OPTIMIZATION
-    // ============================================
-    // NOT: setBufferSizes() ESP32 3.3.x'te mevcut değil
-    // Varsayılan buffer boyutları kullanılıyor
-    
-    if (settings.smtpServer.indexOf("protonmail") >= 0 || 
-        settings.smtpServer.indexOf("proton.me") >= 0) {
-        client.setCACert(ROOT_CA_ISRG_X1);
-    } else {
-        client.setInsecure();
-    }
-    client.setTimeout(10); // 15 -> 10 saniye (daha hızlı timeout)
-    
-    if (settings.smtpPort == 587) {
-        errorMessage = "Port 587 not supported. Use port 465";
-        return false;
-    }
-    
-    IPAddress serverIP;
-    if (!WiFi.hostByName(settings.smtpServer.c_str(), serverIP)) {
-        errorMessage = "DNS failed: " + settings.smtpServer;
-        return false;
-    }
-    
-    if (!client.connect(settings.smtpServer.c_str(), settings.smtpPort)) {
-        errorMessage = "Connection failed";
-        return false;
-    }
-    
-    String response = smtpReadLine(client);
-    if (!response.startsWith("220")) {
-        errorMessage = "Server greeting failed";
-        client.stop();
-        return false;
-    }
-    
-    return true;
-}
-
-bool MailAgent::smtpAuth(WiFiClientSecure &client, String &errorMessage) {
-    String ehloCmd = "EHLO " + String(WiFi.getHostname()) + "\r\n";
-    client.print(ehloCmd);
-    
-    bool foundAuth = false;
-    for (int i = 0; i < 10; i++) {
-        String response = smtpReadLine(client);
-        if (response.indexOf("AUTH") >= 0) foundAuth = true;
-        if (response.startsWith("250 ")) break;
-    }
-    
-    if (!foundAuth) {
-        errorMessage = "SMTP AUTH desteklenmiyor";
-        return false;
-    }
-    
-    client.print("AUTH LOGIN\r\n");
-    String response = smtpReadLine(client);
-    
-    if (!response.startsWith("334")) {
-        errorMessage = "AUTH LOGIN reddedildi";
-        return false;
-    }
-    
-    client.println(base64Encode(settings.username));
-    response = smtpReadLine(client);
-    
-    if (!response.startsWith("334")) {
-        errorMessage = "Kullanıcı adı reddedildi";
-        return false;
-    }
-    
-    client.println(base64Encode(settings.password));
-    response = smtpReadLine(client);
-    
-    if (!response.startsWith("235")) {
-        errorMessage = "Kimlik doğrulama başarısız - Şifre yanlış";
-        return false;
-    }
-    
-    return true;
-}
-
 bool MailAgent::sendWarning(uint8_t alarmIndex, const ScheduleSnapshot &snapshot, String &errorMessage) {
+    MailConfigHandle cfg = config.get();
+    const MailSettings &settings = *cfg;
     String remaining = formatElapsed(snapshot);
     String timestamp = formatHeader();
     
-    String subject = settings.warning.subject;
-    replaceTemplateVars(subject, deviceId, timestamp, remaining);
-    subject.replace("%ALARM_INDEX%", String(alarmIndex + 1));
-    subject.replace("%TOTAL_ALARMS%", String(snapshot.totalAlarms));
+    String index(alarmIndex + 1);
+    String total(snapshot.totalAlarms);
+    MailContent content = warningContent(settings, deviceId.c_str(), timestamp.c_str(), remaining.c_str(),
+                                         index.c_str(), total.c_str());
 
-    String body = settings.warning.body;
-    replaceTemplateVars(body, deviceId, timestamp, remaining);
-    body.replace("%ALARM_INDEX%", String(alarmIndex + 1));
-    body.replace("%TOTAL_ALARMS%", String(snapshot.totalAlarms));
-
-    bool mailSuccess = sendEmailToSelf(subject, body, true, errorMessage);
+    bool mailSuccess = sendEmailToSelf(settings, content, true, errorMessage);
     
     if (!mailSuccess) {
         enqueueWarning(alarmIndex, snapshot);
         errorMessage = "Mail kuyruğa alındı, arka planda gönderilecek";
     }
     
-    if (settings.warning.getUrl.length() > 0 && WiFi.status() == WL_CONNECTED) {
+    // WiFi yoksa da kuyruğa alınır - gönderici bağlantıyı bekleyip tekrar dener
+    if (settings.warning.getUrl.length() > 0) {
         if (!isValidURL(settings.warning.getUrl)) {
             return mailSuccess;
         }
         
-        String taskName = "WarnURL_" + String(alarmIndex);
-        xTaskCreate([](void* param) {
-            String url = *((String*)param);
-            HTTPClient http;
-            
-            if (url.startsWith("https://")) {
-                WiFiClientSecure* client = new WiFiClientSecure();
-                client->setInsecure();
-                
-                if (http.begin(*client, url)) {
-                    http.setTimeout(8000);
-                    http.setConnectTimeout(3000);
-                    http.GET();
-                    http.end();
-                }
-                delete client;
-            } else {
-                WiFiClient* client = new WiFiClient();
-                if (http.begin(*client, url)) {
-                    http.setTimeout(8000);
-                    http.setConnectTimeout(3000);
-                    http.GET();
-                    http.end();
-                }
-                delete client;
-            }
-            
-            delete (String*)param;
-            vTaskDelete(NULL);
-        }, taskName.c_str(), 8192, new String(settings.warning.getUrl), 1, NULL);
-        
-        Serial.println(F("[Warning URL] Task başlatıldı (non-blocking)"));
+        char label[WEBHOOK_LABEL_LEN];
+        snprintf(label, sizeof(label), "warning-%u", alarmIndex + 1);
+        webhooks.enqueue(settings.warning.getUrl, label); // Non-blocking, tekrar denemeli
     } else {
-        if (settings.warning.getUrl.length() == 0) {
-            Serial.println(F("[Warning URL] URL tanımlanmamış, tetiklenmedi"));
-        } else {
-            Serial.println(F("[Warning URL] ATLANDΙ - WiFi bağlantısı yok"));
-        }
+        Serial.println(F("[Warning URL] URL tanımlanmamış, tetiklenmedi"));
     }
     
     return mailSuccess;
@@ -292,201 +210,333 @@ bool MailAgent::sendWarning(uint8_t alarmIndex, const ScheduleSnapshot &snapshot
 bool MailAgent::sendFinal(const ScheduleSnapshot &snapshot, TimerRuntime &runtime, String &errorMessage) {
     Serial.println(F("========== DMF PROTOKOLÜ - ÇOKLU GRUP MAİL GÖNDERİMİ =========="));
     
+    MailConfigHandle cfg = config.get();
+    bool allSuccess = deliverFinal(*cfg, runtime.finalGroupsSent, errorMessage);
+    
+    // ===== MAIL QUEUE: Başarısız olursa kuyruğa ekle =====
+    // Kuyruktaki deneme de teslim defterinden devam eder (gönderilenlere tekrar gitmez)
+    if (!allSuccess && cfg->mailGroupCount > 0) {
+        Serial.println(F("[Final] Başarısız mailler kuyruğa ekleniyor..."));
+        enqueueFinal(snapshot, runtime);
+        errorMessage += " - Kuyrukta yeniden denenecek";
+    }
+    
+    return allSuccess;
+}
+
+bool MailAgent::deliverFinal(const MailSettings &settings, bool *groupsSent, String &errorMessage) {
     // Hiç aktif grup yoksa hata
     if (settings.mailGroupCount == 0) {
         errorMessage = "Hiç mail grubu tanımlanmamış";
         Serial.println(F("[Final] HATA: Mail grubu yok"));
+        lastFailure = FailureClass::CONFIG;
         return false;
     }
     
-    bool allSuccess = true;
-    String lastError = "";
-    uint8_t totalMailsSent = 0;
+    FinalDispatch dispatch;
+    dispatch.agent = this;
+    dispatch.settings = &settings;
     
-    // Her mail grubunu işle
+    // Gönderilecek grupları belirle (atlananlar hemen işaretlenir)
     for (uint8_t g = 0; g < settings.mailGroupCount; ++g) {
         const MailGroup &group = settings.mailGroups[g];
         
         // Grup aktif değilse atla
         if (!group.enabled) {
             Serial.printf("[Final] Grup %d (%s) - ATLANDΙ (devre dışı)\n", g + 1, group.name.c_str());
-            runtime.finalGroupsSent[g] = true; // Devre dışı gruplar "gönderildi" sayılır
+            groupsSent[g] = true; // Devre dışı gruplar "gönderildi" sayılır
             continue;
         }
         
         // ✅ ZATEN GÖNDERİLMİŞSE ATLA
-        if (runtime.finalGroupsSent[g]) {
+        if (groupsSent[g]) {
             Serial.printf("[Final] Grup %d (%s) - ZATEN GÖNDERİLDİ (atlanıyor)\n", g + 1, group.name.c_str());
             continue;
         }
         
-        Serial.printf("\n[Final] ========== GRUP %d: %s ==========\n", g + 1, group.name.c_str());
-        Serial.printf("[Final] Alıcı sayısı: %d\n", group.recipientCount);
-        Serial.printf("[Final] Dosya sayısı: %d\n", group.attachmentCount);
-        
         // Grubun alıcısı yoksa uyar ama devam et
         if (group.recipientCount == 0) {
             Serial.printf("[Final] UYARI: Grup '%s' için alıcı yok\n", group.name.c_str());
-            runtime.finalGroupsSent[g] = true; // Alıcısız gruplar "gönderildi" sayılır
+            groupsSent[g] = true; // Alıcısız gruplar "gönderildi" sayılır
             continue;
         }
         
-        // Grup subject ve body hazırla
-        String subject = group.subject;
-        if (subject.startsWith("[TEST DMF] ")) {
-            subject = subject.substring(11);
-            Serial.printf("[Final] [TEST DMF] prefix kaldırıldı\n");
+        // Defterde tüm alıcılar teslim edilmişse (ör. kuyruk denemesi bitirdi) oturum açma
+        GroupLedger ledger;
+        if (ledger.open(g, group.recipientListId, group.recipientCount) && ledger.complete()) {
+            Serial.printf("[Final] Grup %d (%s) - DEFTERE GÖRE TAMAMLANMIŞ (atlanıyor)\n", g + 1, group.name.c_str());
+            groupsSent[g] = true;
+            continue;
         }
-        String timestamp = formatHeader();
-        replaceTemplateVars(subject, deviceId, timestamp, "0");
-
-        String body = group.body;
-        replaceTemplateVars(body, deviceId, timestamp, "0");
         
-        // ⚠️ STACK KORUMASI: MailSettings çok büyük, kopyalamıyoruz
-        // Sadece attachments pointer'ını geçici değiştirip geri alıyoruz
-        uint8_t originalAttachmentCount = settings.attachmentCount;
-        AttachmentMeta originalAttachments[MAX_ATTACHMENTS];
+        dispatch.groups[dispatch.groupCount++] = g;
+    }
+    
+    uint32_t dispatchStart = millis();
+    uint8_t sessions = runFinalDispatch(dispatch);
+    
+    // Sonuçları grup sırasıyla işle (groupsSent yalnızca burada, tek görevden güncellenir)
+    bool allSuccess = true;
+    String lastError = "";
+    uint16_t totalMailsSent = 0;
+    uint16_t totalResumed = 0;
+    for (uint8_t i = 0; i < dispatch.groupCount; ++i) {
+        uint8_t g = dispatch.groups[i];
+        const FinalGroupOutcome &outcome = dispatch.outcomes[g];
+        totalMailsSent += outcome.sent;
+        totalResumed += outcome.skipped;
         
-        // Sadece attachment verilerini kopyala (küçük)
-        for (uint8_t i = 0; i < originalAttachmentCount; ++i) {
-            originalAttachments[i] = settings.attachments[i];
+        // ✅ GRUP BAŞARILI İSE İŞARETLE
+        if (outcome.success) {
+            groupsSent[g] = true;
+        } else {
+            allSuccess = false;
+            lastError = outcome.error;
+            lastFailure = outcome.failure;
         }
-        
-        // Grup attachments'larını geçici olarak settings'e yükle
-        // NOT: MailGroup.attachments String[], ama settings.attachments AttachmentMeta[]
-        settings.attachmentCount = group.attachmentCount;
-        for (uint8_t i = 0; i < group.attachmentCount; ++i) {
-            // String dosya yolunu AttachmentMeta'ya dönüştür
-            strlcpy(settings.attachments[i].storedPath, group.attachments[i].c_str(), MAX_PATH_LEN);
-            settings.attachments[i].displayName[0] = '\0'; // Boş - gönderimde kullanılmayacak
-            settings.attachments[i].size = 0; // Bilinmiyor
-            settings.attachments[i].forWarning = false;
-            settings.attachments[i].forFinal = true;
+    }
+    
+    Serial.printf("[Final] Gönderim süresi: %lu ms (%u grup, %u eşzamanlı oturum, %u mail, %u önceden teslim edilmiş atlandı, %u TLS el sıkışması, %u yeniden bağlanma)\n",
+                  (unsigned long)(millis() - dispatchStart), dispatch.groupCount, sessions, totalMailsSent, totalResumed,
+                  dispatch.handshakes, dispatch.reconnects);
+    Serial.printf("\n========== DMF PROTOKOLÜ TAMAMLANDI - Toplam %d mail gönderildi ==========\n", totalMailsSent);
+    
+    if (!allSuccess) {
+        errorMessage = "Bazı alıcılara mail gönderilemedi: " + lastError;
+    }
+    return allSuccess;
+}
+
+uint8_t MailAgent::runFinalDispatch(FinalDispatch &dispatch) {
+    if (dispatch.groupCount == 0) return 0;
+    
+    // ensureConnected beklemez: bağlı değilse girişimi başlatıp false döner. Oturum
+    // açmaya çalışılmaz - gruplar NETWORK hatasıyla kalır, sendFinal kuyruğa alır ve
+    // bağlantı gelince kuyruk defterden devam eder
+    if (!netManager->ensureConnected(true)) {
+        Serial.printf("[Final] Ağ bağlı değil - %u grup kuyrukta bekleyecek\n", dispatch.groupCount);
+        for (uint8_t i = 0; i < dispatch.groupCount; ++i) {
+            FinalGroupOutcome &outcome = dispatch.outcomes[dispatch.groups[i]];
+            outcome.error = "İnternet bağlantısı yok";
+            outcome.failure = FailureClass::NETWORK;
+        }
+        return 0;
+    }
+    
+    // Ortak ek sidecar'ları çalışanlar başlamadan bu görevde hazırlanır
+    for (uint8_t i = 0; i < dispatch.groupCount; ++i) {
+        AttachmentMeta groupAttachments[MAX_ATTACHMENTS_PER_GROUP];
+        uint8_t groupAttachmentCount = collectGroupAttachments(dispatch.settings->mailGroups[dispatch.groups[i]], groupAttachments);
+        prepareSidecars(groupAttachments, groupAttachmentCount, false);
+    }
+    
+    // RAM bütçesi: her oturum kendi TLS bağlamı + görev yığını ister
+    uint32_t freeHeap = ESP.getFreeHeap();
+    uint32_t budget = freeHeap > FINAL_HEAP_RESERVE ? freeHeap - FINAL_HEAP_RESERVE : 0;
+    uint8_t byRam = (uint8_t)min<uint32_t>(budget / SMTP_SESSION_RAM_ESTIMATE, MAX_PARALLEL_SMTP_SESSIONS);
+    uint8_t workers = min(min(dispatch.settings->parallelSessions, dispatch.groupCount), byRam);
+    
+    Serial.printf("[Final] %u grup, %u eşzamanlı oturum (ayar %u, RAM %u, boş heap %lu)\n",
+                  dispatch.groupCount, workers > 1 ? workers : 1, dispatch.settings->parallelSessions, byRam,
+                  (unsigned long)freeHeap);
+    
+    if (workers <= 1) {
+        deliverFinalGroups(dispatch); // Çağıran görevde, sıralı
+        return 1;
+    }
+    
+    // Çalışanlar ağ yöneticisine dokunmaz (bağlantı yukarıda bu görevden doğrulandı)
+    dispatch.finished = xSemaphoreCreateCounting(workers, 0);
+    parallelWorkersActive = true;
+    uint8_t started = 0;
+    if (dispatch.finished) {
+        for (uint8_t w = 0; w < workers; ++w) {
+            String taskName = "FinalSMTP_" + String(w);
+            BaseType_t ok = xTaskCreate([](void *param) {
+                FinalDispatch *ctx = static_cast<FinalDispatch *>(param);
+                ctx->agent->deliverFinalGroups(*ctx);
+                xSemaphoreGive(ctx->finished);
+                vTaskDelete(NULL);
+            }, taskName.c_str(), FINAL_WORKER_STACK, &dispatch, 1, NULL);
+            if (ok != pdPASS) break;
+            started++;
         }
+    }
+    
+    if (started == 0) {
+        parallelWorkersActive = false;
+        Serial.println(F("[Final] Gönderim görevi başlatılamadı, sıralı devam"));
+        if (dispatch.finished) vSemaphoreDelete(dispatch.finished);
+        dispatch.finished = nullptr;
+        deliverFinalGroups(dispatch);
+        return 1;
+    }
+    
+    // Görevler bitene kadar bekle - ana döngünün watchdog'u beslenmeye devam eder
+    for (uint8_t done = 0; done < started;) {
+        if (xSemaphoreTake(dispatch.finished, pdMS_TO_TICKS(1000)) == pdTRUE) {
+            done++;
+        }
+        esp_task_wdt_reset();
+    }
+    parallelWorkersActive = false;
+    vSemaphoreDelete(dispatch.finished);
+    dispatch.finished = nullptr;
+    return started;
+}
+
+void MailAgent::deliverFinalGroups(FinalDispatch &dispatch) {
+    const MailSettings &settings = *dispatch.settings;
+    
+    // Her çalışan kendi oturumunu açar; aldığı grupların tüm alıcıları bu oturumdan sırayla gider
+    SmtpSession session(settings);
+    
+    while (true) {
+        uint8_t slot;
+        portENTER_CRITICAL(&dispatch.lock);
+        slot = dispatch.nextGroup < dispatch.groupCount ? dispatch.nextGroup++ : 0xFF;
+        portEXIT_CRITICAL(&dispatch.lock);
+        if (slot == 0xFF) break;
         
-        // Grup alıcılarına AYRI AYRI mail gönder (DMF Protokolü - Privacy)
-        bool groupSuccess = true;
-        for (uint8_t i = 0; i < group.recipientCount; ++i) {
-            if (group.recipients[i].length() == 0) continue;
-            
-            Serial.printf("[Final] Grup %d - Alıcı %d/%d: %s\n", 
-                g + 1, i + 1, group.recipientCount, group.recipients[i].c_str());
-            
-            String recipientError;
-            if (!sendEmailToRecipient(group.recipients[i], subject, body, true, recipientError)) {
-                Serial.printf("[Final] ✗ HATA - %s: %s\n", group.recipients[i].c_str(), recipientError.c_str());
-                groupSuccess = false;
-                allSuccess = false;
-                lastError = recipientError;
-                break; // Grup başarısız, döngüden çık (bir sonraki denemede devam eder)
-            } else {
-                Serial.printf("[Final] ✓ BAŞARILI - %s\n", group.recipients[i].c_str());
-                totalMailsSent++;
+        uint8_t g = dispatch.groups[slot];
+        deliverFinalGroup(session, settings, g, dispatch.outcomes[g]);
+    }
+    
+    session.close();
+    portENTER_CRITICAL(&dispatch.lock);
+    dispatch.handshakes += session.handshakeCount();
+    dispatch.reconnects += session.reconnectCount();
+    portEXIT_CRITICAL(&dispatch.lock);
+}
+
+void MailAgent::deliverFinalGroup(SmtpSession &session, const MailSettings &settings, uint8_t g, FinalGroupOutcome &outcome) {
+    const MailGroup &group = settings.mailGroups[g];
+    outcome = FinalGroupOutcome();
+    
+    Serial.printf("\n[Final] ========== GRUP %d: %s ==========\n", g + 1, group.name.c_str());
+    Serial.printf("[Final] Alıcı sayısı: %d\n", group.recipientCount);
+    Serial.printf("[Final] Dosya sayısı: %d\n", group.attachmentCount);
+    
+    // Grup şablonları (yayında derlendi, "[TEST DMF] " öneki atılmış)
+    String timestamp = formatHeader();
+    MailContent content = groupContent(settings, g, deviceId.c_str(), timestamp.c_str());
+    
+    // Grup dosyalarını gönderim listesine dönüştür (snapshot değiştirilmez), boyutlar bir kez
+    AttachmentMeta groupAttachments[MAX_ATTACHMENTS_PER_GROUP];
+    uint8_t groupAttachmentCount = collectGroupAttachments(group, groupAttachments);
+    AttachmentList attachments = measureAttachments(groupAttachments, groupAttachmentCount, false);
+    
+    // Grup alıcılarına AYRI AYRI mail gönder (DMF Protokolü - Privacy)
+    // Alıcılar flash'tan cursor ile tek tek okunur - RAM liste boyutundan bağımsız
+    RecipientCursor cursor;
+    if (!cursor.open(group.recipientListId)) {
+        Serial.printf("[Final] ✗ HATA - Grup %d alıcı listesi açılamadı (ID %u)\n", g + 1, group.recipientListId);
+        outcome.error = "Alıcı listesi okunamadı: " + group.name;
+        outcome.failure = FailureClass::CONFIG;
+        return;
+    }
+    
+    // Teslim defteri: önceki denemelerde 250 almış alıcılar atlanır
+    GroupLedger ledger;
+    bool ledgerOpen = ledger.open(g, group.recipientListId, cursor.count());
+    if (ledgerOpen && ledger.deliveredCount() > 0) {
+        Serial.printf("[Final] Grup %d - Defterden devam: %u/%u alıcı zaten teslim edildi\n",
+                      g + 1, ledger.deliveredCount(), ledger.count());
+    }
+    
+    bool groupSuccess = true;
+    char recipient[MAX_EMAIL_ADDRESS_LEN + 1];
+    uint32_t cursorMicros = 0;
+    uint32_t readStart = micros();
+    while (true) {
+        // İlk teslim edilmemiş alıcıya indeks üzerinden atla
+        uint16_t position = cursor.position();
+        if (ledgerOpen && ledger.delivered(position)) {
+            while (position < cursor.count() && ledger.delivered(position)) {
+                position++;
+                outcome.skipped++;
             }
-            
-            // SMTP sunucuya yük bindirmemek için kısa bekleme
-            delay(200);
+            if (position >= cursor.count() || !cursor.seek(position)) break;
         }
+        if (!cursor.next(recipient, sizeof(recipient))) break;
+        cursorMicros += micros() - readStart;
         
-        // ✅ GRUP BAŞARILI İSE İŞARETLE
-        if (groupSuccess) {
-            runtime.finalGroupsSent[g] = true;
-            Serial.printf("[Final] Grup %d (%s) - ✓ TÜM MAİLLER GÖNDERİLDİ\n", g + 1, group.name.c_str());
-        } else {
-            Serial.printf("[Final] Grup %d (%s) - ✗ HATALI, bir sonraki denemede tekrar gönderilecek\n", g + 1, group.name.c_str());
-        }
+        Serial.printf("[Final] Grup %d - Alıcı %u/%u: %s\n", 
+            g + 1, cursor.position(), cursor.count(), recipient);
         
-        // Orijinal attachments'ları geri yükle
-        settings.attachmentCount = originalAttachmentCount;
-        for (uint8_t i = 0; i < originalAttachmentCount; ++i) {
-            settings.attachments[i] = originalAttachments[i];
+        String recipientError;
+        bool delivered = sendEmailToRecipient(session, settings, String(recipient), content, attachments, recipientError);
+        if (ledgerOpen && !ledger.record(position, delivered ? 250 : session.lastReplyCode(), delivered)) {
+            Serial.printf("[Final] ⚠️ Grup %d defteri yazılamadı, deftersiz devam\n", g + 1);
+            ledger.close();
+            ledgerOpen = false;
         }
-        
-        // Grup URL tetiklemesi (sadece grup başarılıysa)
-        if (groupSuccess && group.getUrl.length() > 0 && WiFi.status() == WL_CONNECTED) {
-            // URL Validation - SSRF Koruması
-            if (!isValidURL(group.getUrl)) {
-                Serial.printf("[Final URL] Grup %d - ✗ GÜVENLİK: URL reddedildi\n", g + 1);
-            } else {
-                Serial.printf("[Final URL] Grup %d (%s) - Tetikleniyor: %s\n", 
-                    g + 1, group.name.c_str(), group.getUrl.c_str());
-                
-                // Task oluştur - HEMEN başlat (delay yok)
-                String taskName = "FinalURL_G" + String(g);
-                xTaskCreate([](void* param) {
-                    String url = *((String*)param);
-                    
-                    HTTPClient http;
-                    
-                    if (url.startsWith("https://")) {
-                        WiFiClientSecure* client = new WiFiClientSecure();
-                        client->setInsecure();
-                        
-                        if (http.begin(*client, url)) {
-                            http.setTimeout(8000);
-                            http.setConnectTimeout(3000);
-                            int httpCode = http.GET();
-                            Serial.printf("[Final URL Task] Sonuç: %d\n", httpCode);
-                            http.end();
-                        }
-                        delete client;
-                    } else {
-                        WiFiClient* client = new WiFiClient();
-                        
-                        if (http.begin(*client, url)) {
-                            http.setTimeout(8000);
-                            http.setConnectTimeout(3000);
-                            int httpCode = http.GET();
-                            Serial.printf("[Final URL Task] Sonuç: %d\n", httpCode);
-                            http.end();
-                        }
-                        delete client;
-                    }
-                    
-                    delete (String*)param;
-                    vTaskDelete(NULL);
-                }, taskName.c_str(), 8192, new String(group.getUrl), 1, NULL);
-                
-                Serial.printf("[Final URL] Grup %d - Task başlatıldı (non-blocking)\n", g + 1);
-            }
+        if (!delivered) {
+            Serial.printf("[Final] ✗ HATA - %s: %s (SMTP %u)\n", recipient, recipientError.c_str(), session.lastReplyCode());
+            groupSuccess = false;
+            outcome.error = recipientError;
+            outcome.failure = session.failureClass() != FailureClass::NONE ? session.failureClass() : FailureClass::NETWORK;
+            break; // Grup başarısız, döngüden çık (bir sonraki denemede kalan alıcılardan devam eder)
+        } else {
+            Serial.printf("[Final] ✓ BAŞARILI - %s\n", recipient);
+            outcome.sent++;
         }
+        
+        readStart = micros();
+    }
+    // Defter açıksa tamamlanma defterden (atlananlar dahil), değilse cursor konumundan
+    bool reachedEnd = ledgerOpen ? ledger.complete() : cursor.position() >= cursor.count();
+    if (groupSuccess && !reachedEnd) {
+        // Liste sonuna ulaşılamadı (bozuk kayıt / okuma hatası)
+        Serial.printf("[Final] ✗ HATA - Alıcı listesi %u/%u kayıtta kesildi\n", cursor.position(), cursor.count());
+        groupSuccess = false;
+        outcome.error = "Alıcı listesi okunamadı: " + group.name;
+        outcome.failure = FailureClass::CONFIG;
+    }
+    Serial.printf("[Final] Grup %d liste okuma: %u kayıt, %lu µs, boş heap %lu\n",
+                  g + 1, cursor.position(), (unsigned long)cursorMicros, (unsigned long)ESP.getFreeHeap());
+    cursor.close();
+    
+    outcome.success = groupSuccess;
+    if (groupSuccess) {
+        Serial.printf("[Final] Grup %d (%s) - ✓ TÜM MAİLLER GÖNDERİLDİ\n", g + 1, group.name.c_str());
+    } else {
+        Serial.printf("[Final] Grup %d (%s) - ✗ HATALI, bir sonraki denemede tekrar gönderilecek\n", g + 1, group.name.c_str());
     }
     
-    Serial.printf("\n========== DMF PROTOKOLÜ TAMAMLANDI - Toplam %d mail gönderildi ==========\n", totalMailsSent);
-    
-    // ===== MAIL QUEUE: Başarısız olursa kuyruğa ekle =====
-    if (!allSuccess) {
-        errorMessage = "Bazı alıcılara mail gönderilemedi: " + lastError;
-        Serial.println(F("[Final] Başarısız mailler kuyruğa ekleniyor..."));
-        enqueueFinal(snapshot, runtime);
-        errorMessage += " - Kuyrukta yeniden denenecek";
+    // Grup URL tetiklemesi (sadece grup başarılıysa)
+    if (groupSuccess && group.getUrl.length() > 0) {
+        // URL Validation - SSRF Koruması
+        if (!isValidURL(group.getUrl)) {
+            Serial.printf("[Final URL] Grup %d - ✗ GÜVENLİK: URL reddedildi\n", g + 1);
+        } else {
+            Serial.printf("[Final URL] Grup %d (%s) - Tetikleniyor: %s\n", 
+                g + 1, group.name.c_str(), group.getUrl.c_str());
+            
+            char label[WEBHOOK_LABEL_LEN];
+            snprintf(label, sizeof(label), "final-g%u", g + 1);
+            webhooks.enqueue(group.getUrl, label);
+        }
     }
-    
-    return allSuccess;
 }
 
 // TEST FONKSIYONLARI - Sadece gönderen adrese mail atar
 bool MailAgent::sendWarningTest(const ScheduleSnapshot &snapshot, String &errorMessage) {
+    MailConfigHandle cfg = config.get();
+    const MailSettings &settings = *cfg;
     String remaining = formatElapsed(snapshot);
     String timestamp = formatHeader();
     
-    String subject = settings.warning.subject;
-    replaceTemplateVars(subject, deviceId, timestamp, remaining);
-    subject.replace("%ALARM_INDEX%", "1");
-    subject.replace("%TOTAL_ALARMS%", String(snapshot.totalAlarms));
-
-    String body = settings.warning.body;
-    replaceTemplateVars(body, deviceId, timestamp, remaining);
-    body.replace("%ALARM_INDEX%", "1");
-    body.replace("%TOTAL_ALARMS%", String(snapshot.totalAlarms));
+    String total(snapshot.totalAlarms);
+    MailContent content = warningContent(settings, deviceId.c_str(), timestamp.c_str(), remaining.c_str(),
+                                         "1", total.c_str());
 
     // SMTP kullanıcı adına (kendine) gönder - Warning test
-    bool mailSuccess = sendEmailToSelf(subject, body, true, errorMessage);
+    bool mailSuccess = sendEmailToSelf(settings, content, true, errorMessage);
     Serial.printf("[MAIL TEST] Warning mail gönderimi: %s\n", mailSuccess ? "BAŞARILI" : "BAŞARISIZ");
     
     // URL tetikleme (Warning test - NON-BLOCKING)
-    if (settings.warning.getUrl.length() > 0 && WiFi.status() == WL_CONNECTED) {
+    if (settings.warning.getUrl.length() > 0) {
         // URL Validation - SSRF Koruması
         if (!isValidURL(settings.warning.getUrl)) {
             Serial.println(F("[TEST Warning URL] ✗ GÜVENLİK: URL reddedildi (whitelist dışı)"));
@@ -495,84 +545,21 @@ bool MailAgent::sendWarningTest(const ScheduleSnapshot &snapshot, String &errorM
         
         Serial.printf("[TEST Warning URL] Tetikleniyor (paralel): %s\n", settings.warning.getUrl.c_str());
         
-        // Task oluştur - HEMEN başlat
-        xTaskCreate([](void* param) {
-            String url = *((String*)param);
-            
-            // ⚠️ OPTİMİZASYON: Delay kaldırıldı
-            
-            HTTPClient http;
-            
-            // HTTP veya HTTPS'e göre client seç
-            if (url.startsWith("https://")) {
-                WiFiClientSecure* client = new WiFiClientSecure();
-                
-                // SSL/TLS - Sertifika doğrulaması yok
-                client->setInsecure();
-                Serial.println(F("[TEST Warning URL] SSL: Insecure mode"));
-                
-                if (http.begin(*client, url)) {
-                    http.setTimeout(8000);
-                    http.setConnectTimeout(3000);
-                    
-                    int httpCode = http.GET();
-                    Serial.printf("[TEST Warning URL] Sonuç: %d\n", httpCode);
-                    
-                    if (httpCode > 0) {
-                        String response = http.getString();
-                        Serial.printf("[TEST Warning URL] Yanıt: %d bytes\n", response.length());
-                        if (response.length() < 150) {
-                            Serial.printf("[TEST Warning URL] %s\n", response.c_str());
-                        }
-                    } else {
-                        Serial.printf("[TEST Warning URL] HATA: %s\n", http.errorToString(httpCode).c_str());
-                    }
-                    http.end();
-                }
-                delete client;
-            } else {
-                WiFiClient* client = new WiFiClient();
-                
-                if (http.begin(*client, url)) {
-                    http.setTimeout(8000);
-                    http.setConnectTimeout(3000);
-                    
-                    int httpCode = http.GET();
-                    Serial.printf("[TEST Warning URL] Sonuç: %d\n", httpCode);
-                    
-                    if (httpCode > 0) {
-                        String response = http.getString();
-                        Serial.printf("[TEST Warning URL] Yanıt: %d bytes\n", response.length());
-                        if (response.length() < 150) {
-                            Serial.printf("[TEST Warning URL] %s\n", response.c_str());
-                        }
-                    } else {
-                        Serial.printf("[TEST Warning URL] HATA: %s\n", http.errorToString(httpCode).c_str());
-                    }
-                    http.end();
-                }
-                delete client;
-            }
-            
-            delete (String*)param;
-            vTaskDelete(NULL);
-        }, "WarningURLTask", 8192, new String(settings.warning.getUrl), 1, NULL);
-        
-        Serial.println(F("[TEST Warning URL] Task başlatıldı (non-blocking)"));
+        webhooks.enqueue(settings.warning.getUrl, "test-warning"); // Sonuç /api/status → webhooks
     } else {
-        if (settings.warning.getUrl.length() == 0) {
-            Serial.println(F("[TEST Warning URL] ATLANDΙ - URL boş"));
-        } else {
-            Serial.println(F("[TEST Warning URL] ATLANDΙ - WiFi bağlantısı yok"));
-        }
+        Serial.println(F("[TEST Warning URL] ATLANDΙ - URL boş"));
     }
     
     return mailSuccess;
 }
 
 bool MailAgent::sendFinalTest(const ScheduleSnapshot &snapshot, String &errorMessage) {
+    (void)snapshot; // Test maili zamanlayıcı durumundan bağımsız
     Serial.println(F("========== DMF TEST MAİL - İLK AKTİF GRUP =========="));
     
+    MailConfigHandle cfg = config.get();
+    const MailSettings &settings = *cfg;
+    
     // İlk aktif grubu bul
     int activeGroupIndex = -1;
     for (uint8_t g = 0; g < settings.mailGroupCount; ++g) {
@@ -591,17 +578,9 @@ bool MailAgent::sendFinalTest(const ScheduleSnapshot &snapshot, String &errorMes
     const MailGroup &group = settings.mailGroups[activeGroupIndex];
     Serial.printf("[Final Test] Test edilen grup: %s (Grup %d)\n", group.name.c_str(), activeGroupIndex + 1);
     
-    // [TEST DMF] otomatik temizleme
-    String subject = group.subject;
-    if (subject.startsWith("[TEST DMF] ")) {
-        subject = subject.substring(11);
-        Serial.printf("[Final Test] [TEST DMF] prefix kaldırıldı\n");
-    }
+    // Grup şablonları ([TEST DMF] öneki derlemede temizlendi)
     String timestamp = formatHeader();
-    replaceTemplateVars(subject, deviceId, timestamp, "0");
-
-    String body = group.body;
-    replaceTemplateVars(body, deviceId, timestamp, "0");
+    MailContent content = groupContent(settings, activeGroupIndex, deviceId.c_str(), timestamp.c_str());
 
     // Grup alıcıları kontrolü
     if (group.recipientCount == 0) {
@@ -609,53 +588,39 @@ bool MailAgent::sendFinalTest(const ScheduleSnapshot &snapshot, String &errorMes
         return false;
     }
 
-    // STACK-SAFE: Sadece attachment array'ini swap et (büyük struct kopyalama YAPMA!)
-    AttachmentMeta originalAttachments[MAX_ATTACHMENTS];
-    uint8_t originalAttachmentCount = settings.attachmentCount;
-    
-    // Orijinal attachments'ı sakla
-    for (uint8_t i = 0; i < originalAttachmentCount; ++i) {
-        originalAttachments[i] = settings.attachments[i];
-    }
-    
-    // Grup attachments'larını geçici olarak settings'e yükle
-    // NOT: MailGroup.attachments String[], ama settings.attachments AttachmentMeta[]
-    settings.attachmentCount = group.attachmentCount;
-    for (uint8_t i = 0; i < group.attachmentCount; ++i) {
-        // String dosya yolunu AttachmentMeta'ya dönüştür
-        strlcpy(settings.attachments[i].storedPath, group.attachments[i].c_str(), MAX_PATH_LEN);
-        settings.attachments[i].displayName[0] = '\0'; // Boş
-        settings.attachments[i].size = 0;
-        settings.attachments[i].forWarning = false;
-        settings.attachments[i].forFinal = true;
-    }
+    // Grup dosyalarını gönderim listesine dönüştür (snapshot değiştirilmez)
+    AttachmentMeta groupAttachments[MAX_ATTACHMENTS_PER_GROUP];
+    uint8_t groupAttachmentCount = collectGroupAttachments(group, groupAttachments);
+    prepareSidecars(groupAttachments, groupAttachmentCount, false);
+    AttachmentList attachments = measureAttachments(groupAttachments, groupAttachmentCount, false);
 
     bool allSuccess = true;
     String lastError = "";
     
+    RecipientCursor cursor;
+    if (!cursor.open(group.recipientListId)) {
+        errorMessage = "Bu grubun alıcı listesi okunamadı";
+        return false;
+    }
+    
+    SmtpSession session(settings); // Tüm test alıcıları için tek oturum
+    
     // Her alıcıya AYRI MAIL gönder (DMF protokolü - privacy)
-    for (uint8_t i = 0; i < group.recipientCount; ++i) {
-        if (group.recipients[i].length() == 0) continue;
-        
-        Serial.printf("[Final Test] Alıcı %d/%d: %s\n", i + 1, group.recipientCount, group.recipients[i].c_str());
+    char recipient[MAX_EMAIL_ADDRESS_LEN + 1];
+    while (cursor.next(recipient, sizeof(recipient))) {
+        Serial.printf("[Final Test] Alıcı %u/%u: %s\n", cursor.position(), cursor.count(), recipient);
         
         String recipientError;
-        if (!sendEmailToRecipient(group.recipients[i], subject, body, true, recipientError)) {
-            Serial.printf("[Final Test] ✗ HATA - %s: %s\n", group.recipients[i].c_str(), recipientError.c_str());
+        if (!sendEmailToRecipient(session, settings, String(recipient), content, attachments, recipientError)) {
+            Serial.printf("[Final Test] ✗ HATA - %s: %s\n", recipient, recipientError.c_str());
             allSuccess = false;
             lastError = recipientError;
         } else {
-            Serial.printf("[Final Test] ✓ BAŞARILI - %s\n", group.recipients[i].c_str());
+            Serial.printf("[Final Test] ✓ BAŞARILI - %s\n", recipient);
         }
-        
-        delay(200);
-    }
-    
-    // Orijinal attachments'ları geri yükle
-    settings.attachmentCount = originalAttachmentCount;
-    for (uint8_t i = 0; i < originalAttachmentCount; ++i) {
-        settings.attachments[i] = originalAttachments[i];
     }
+    cursor.close();
+    session.close();
     
     if (!allSuccess) {
         errorMessage = "Bazı alıcılara test maili gönderilemedi: " + lastError;
@@ -665,7 +630,7 @@ bool MailAgent::sendFinalTest(const ScheduleSnapshot &snapshot, String &errorMes
     Serial.printf("[MAIL TEST] Final/DMF test mail sonucu: %s\n", mailSuccess ? "BAŞARILI" : "BAŞARISIZ");
     
     // URL tetikleme (grup URL'si - NON-BLOCKING)
-    if (group.getUrl.length() > 0 && WiFi.status() == WL_CONNECTED) {
+    if (group.getUrl.length() > 0) {
         if (!isValidURL(group.getUrl)) {
             Serial.println(F("[TEST Final URL] ✗ GÜVENLİK: URL reddedildi"));
             return mailSuccess;
@@ -673,241 +638,200 @@ bool MailAgent::sendFinalTest(const ScheduleSnapshot &snapshot, String &errorMes
         
         Serial.printf("[TEST Final URL] Tetikleniyor: %s\n", group.getUrl.c_str());
         
-        xTaskCreate([](void* param) {
-            String url = *((String*)param);
-            HTTPClient http;
-            
-            if (url.startsWith("https://")) {
-                WiFiClientSecure* client = new WiFiClientSecure();
-                client->setInsecure();
-                
-                if (http.begin(*client, url)) {
-                    http.setTimeout(8000);
-                    http.setConnectTimeout(3000);
-                    int httpCode = http.GET();
-                    Serial.printf("[TEST Final URL] Sonuç: %d\n", httpCode);
-                    http.end();
-                }
-                delete client;
-            } else {
-                WiFiClient* client = new WiFiClient();
-                
-                if (http.begin(*client, url)) {
-                    http.setTimeout(8000);
-                    http.setConnectTimeout(3000);
-                    int httpCode = http.GET();
-                    Serial.printf("[TEST Final URL] Sonuç: %d\n", httpCode);
-                    http.end();
-                }
-                delete client;
-            }
-            
-            delete (String*)param;
-            vTaskDelete(NULL);
-        }, "TestURLTask", 8192, new String(group.getUrl), 1, NULL);
-        
-        Serial.println(F("[TEST Final URL] Task başlatıldı"));
+        webhooks.enqueue(group.getUrl, "test-final");
     }
     
     return mailSuccess;
 }
 
-bool MailAgent::smtpSendMail(WiFiClientSecure &client, const String &subject, const String &body, bool includeAttachments, String &errorMessage) {
-    // MAIL FROM
-    String mailFrom = "MAIL FROM:<" + settings.username + ">\r\n";
-    client.print(mailFrom);
-    String response = smtpReadLine(client);
-    Serial.printf("[SMTP] << %s\n", response.c_str());
-    
-    if (!response.startsWith("250")) {
-        errorMessage = "MAIL FROM reddedildi";
-        return false;
-    }
-    
-    // RCPT TO (her alıcı için)
-    for (uint8_t i = 0; i < settings.recipientCount; ++i) {
-        if (settings.recipients[i].length() == 0) continue;
-        
-        String rcptTo = "RCPT TO:<" + settings.recipients[i] + ">\r\n";
-        client.print(rcptTo);
-        response = smtpReadLine(client);
-        Serial.printf("[SMTP] << %s\n", response.c_str());
-        
-        if (!response.startsWith("250")) {
-            errorMessage = "Alıcı reddedildi: " + settings.recipients[i];
+// ÖLÇÜM - "bench" seri komutu. Uyarı: kendine N ayrı oturumla gönderim.
+// Final: tüm grupların gerçek dağıtım yolu; gerçek alıcılara gitmemesi için
+// yalnızca şifresiz (yerel test sunucusu) modda çalışır.
+bool MailAgent::runBenchmark(bool finalDispatch, uint8_t rounds, String &report) {
+    MailConfigHandle cfg = config.get();
+    const MailSettings &settings = *cfg;
+    rounds = constrain(rounds, (uint8_t)1, (uint8_t)20);
+
+    if (finalDispatch) {
+        if (settings.smtpTls) {
+            report = "Final ölçümü yalnızca TLS'siz yerel test sunucusuyla çalışır";
             return false;
         }
+        if (mailQueue.contains(MailType::FINAL)) {
+            report = "Kuyrukta bekleyen final var - ölçüm teslim defterini bozar";
+            return false;
+        }
+        DeliveryLedger::clearAll();
     }
-    
-    // DATA
-    client.print("DATA\r\n");
-    response = smtpReadLine(client);
-    Serial.printf("[SMTP] << %s\n", response.c_str());
-    
-    if (!response.startsWith("354")) {
-        errorMessage = "DATA komutu reddedildi";
-        return false;
-    }
-    
-    // ⚠️ YENİ: STREAMING MIME MESSAGE (RAM tasarrufu için)
-    // String yerine direkt WiFiClientSecure'a yazıyoruz
+
+    String timestamp = formatHeader();
+    String total(rounds);
+    uint8_t succeeded = 0;
+    String lastError;
+
+    SmtpBench::start();
+    uint32_t wallStart = millis();
+    for (uint8_t i = 0; i < rounds; ++i) {
+        String error;
+        bool ok;
+        if (finalDispatch) {
+            bool groupsSent[MAX_MAIL_GROUPS] = {};
+            ok = deliverFinal(settings, groupsSent, error);
+            DeliveryLedger::clearAll(); // Sonraki tur (ve gerçek final) baştan başlasın
+        } else {
+            String index(i + 1);
+            MailContent content = warningContent(settings, deviceId.c_str(), timestamp.c_str(), "0",
+                                                 index.c_str(), total.c_str());
+            ok = sendEmailToSelf(settings, content, true, error);
+        }
+        if (ok) {
+            succeeded++;
+        } else {
+            lastError = error;
+        }
+        esp_task_wdt_reset();
+    }
+    uint32_t wallMs = millis() - wallStart;
+    SmtpBenchReport bench = SmtpBench::stop();
+
+    const SmtpPhaseTimes &t = bench.totals;
+    char line[240];
+    snprintf(line, sizeof(line),
+             "%s x%u: %u başarılı, %u oturum, %u mesaj, %lu bayt, duvar %lu ms | bağlantı %lu, TLS %lu, AUTH %lu, DATA %lu ms | %u gidiş-dönüş",
+             finalDispatch ? "final" : "warning", rounds, succeeded, bench.sessions, t.messages,
+             (unsigned long)t.wireBytes, (unsigned long)wallMs, (unsigned long)t.connectMs,
+             (unsigned long)t.tlsMs, (unsigned long)t.authMs, (unsigned long)t.dataMs, t.roundTrips);
+    report = line;
+    if (lastError.length()) {
+        report += " | son hata: " + lastError;
+    }
+    return succeeded == rounds;
+}
+
+// Tek mesajın MIME içeriğini DATA aşamasına akıt (RAM'de biriktirmeden)
+// attachments.warning=true → forWarning dosyaları, false → forFinal dosyaları
+void MailAgent::writeMimeMessage(Print &out, const String &from, const String &toHeader, const MailContent &content,
+                                 const AttachmentList &attachments) {
     String boundary = "----=_SKDMF_" + String(random(100000, 999999));
     
     // MIME Headers
-    client.print("From: " + settings.username + "\r\n");
-    client.print("To: ");
-    for (uint8_t i = 0; i < settings.recipientCount; ++i) {
-        if (i > 0) client.print(", ");
-        client.print(settings.recipients[i]);
-    }
-    client.print("\r\n");
-    client.print("Subject: " + subject + "\r\n");
-    client.print("MIME-Version: 1.0\r\n");
-    client.print("Content-Type: multipart/mixed; boundary=\"" + boundary + "\"\r\n");
-    client.print("\r\n");
+    out.print("From: " + from + "\r\n");
+    out.print("To: " + toHeader + "\r\n");
+    out.print("Subject: ");
+    content.subject->render(out, content.values);
+    out.print("\r\n");
+    out.print("MIME-Version: 1.0\r\n");
+    out.print("Content-Type: multipart/mixed; boundary=\"" + boundary + "\"\r\n");
+    out.print("\r\n");
     
     // Body
-    client.print("--" + boundary + "\r\n");
-    client.print("Content-Type: text/plain; charset=UTF-8\r\n");
-    client.print("Content-Transfer-Encoding: 8bit\r\n\r\n");
-    client.print(body);
-    client.print("\r\n");
-    
-    // Attachments (streaming - RAM efficient)
-    if (includeAttachments && settings.attachmentCount > 0) {
-        Serial.printf("[SMTP Stream] %d attachment kontrol ediliyor (includeAttachments=%d)\n", settings.attachmentCount, includeAttachments);
+    out.print("--" + boundary + "\r\n");
+    out.print("Content-Type: text/plain; charset=UTF-8\r\n");
+    out.print("Content-Transfer-Encoding: 8bit\r\n\r\n");
+    content.body->render(out, content.values); // Süresi bench raporunda DATA aşamasına dahil
+    out.print("\r\n");
+    
+    // Attachments (streaming - RAM efficient). Boyutlar measureAttachments'ta ölçüldü:
+    // eksik / çok büyük dosyalar burada açılmadan atlanır
+    if (attachments.count > 0) {
         uint8_t addedCount = 0;
-        
-        for (uint8_t i = 0; i < settings.attachmentCount; ++i) {
-            const auto &meta = settings.attachments[i];
-            
-            // ⚠️ DÜZELTİLDİ: forFinal dosyaları ekle (sendEmail fonksiyonu genelde Final test için kullanılıyor)
-            // Eğer dosya forFinal=true ise ekle
-            if (!meta.forFinal) {
-                Serial.printf("[SMTP Stream] Attachment %d ATLANDI (forFinal=false)\n", i);
-                continue;
-            }
-            
-            // Dosya varlık kontrolü
-            if (!LittleFS.exists(meta.storedPath)) {
-                Serial.printf("[SMTP Stream] Attachment %d ATLANDI (dosya yok: %s)\n", i, meta.storedPath);
-                continue;
-            }
-            
-            // Dosya boyutu kontrolü (500KB limit)
-            File testFile = LittleFS.open(meta.storedPath, "r");
-            if (!testFile) {
-                Serial.printf("[SMTP Stream] Attachment %d ATLANDI (açılamadı)\n", i);
-                continue;
-            }
-            size_t fileSize = testFile.size();
-            testFile.close();
-            
-            if (fileSize > 512000) { // 500KB limit
-                Serial.printf("[SMTP Stream] Attachment %d ATLANDI (çok büyük: %d bytes > 500KB)\n", i, fileSize);
-                continue;
-            }
-            
-            // Stream et (RAM'de biriktirmeden direkt gönder)
-            smtpStreamAttachment(client, boundary, meta);
+        for (uint8_t i = 0; i < attachments.count; ++i) {
+            if (!attachments.sends(i)) continue;
+            smtpStreamAttachment(out, boundary, attachments.items[i], attachments.sizes[i]);
             addedCount++;
         }
-        
-        Serial.printf("[SMTP Stream] TOPLAM: %d/%d attachment gönderildi\n", addedCount, settings.attachmentCount);
-    } else {
-        if (!includeAttachments) {
-            Serial.println(F("[SMTP Stream] Attachment ekleme kapalı (includeAttachments=false)"));
-        } else if (settings.attachmentCount == 0) {
-            Serial.println(F("[SMTP Stream] Hiç attachment tanımlanmamış"));
-        }
+        Serial.printf("[SMTP Stream] TOPLAM: %d/%d attachment gönderildi (%s)\n", addedCount, attachments.count,
+                      attachments.warning ? "warning" : "final");
     }
     
-    // MIME sonlandırma
-    client.print("--" + boundary + "--\r\n");
-    client.print("\r\n.\r\n");
-    
-    response = smtpReadLine(client);
-    Serial.printf("[SMTP] << %s\n", response.c_str());
-    
-    if (!response.startsWith("250")) {
-        errorMessage = "Mail gönderimi başarısız";
-        return false;
-    }
-    
-    Serial.println(F("[SMTP] Mail başarıyla gönderildi (streaming)"));
-    return true;
+    // MIME sonlandırma ("<CRLF>.<CRLF>" SmtpSession::endData() tarafından yazılır)
+    out.print("--" + boundary + "--\r\n");
 }
 
-bool MailAgent::smtpCommand(WiFiClientSecure &client, const String &command, const String &expectCode, String &errorMessage) {
-    if (command.length() > 0) {
-        client.print(command);
-    }
-    
-    String response = smtpReadLine(client);
-    Serial.printf("[SMTP] << %s\n", response.c_str());
-    
-    if (!response.startsWith(expectCode)) {
-        errorMessage = "Beklenmeyen yanıt: " + response;
-        return false;
+// RFC 1870 tahmine izin verir: sabit başlıklar yuvarlanır, değişken kısımlar
+// (adresler, render edilmiş şablon, base64 ekler) tam hesaplanır. Dosyalar okunmaz.
+size_t MailAgent::estimateMimeSize(const String &from, const String &toHeader, const MailContent &content,
+                                   const AttachmentList &attachments) {
+    static const size_t MIME_ENVELOPE_OVERHEAD = 320;   // From/To/Subject/MIME/gövde başlıkları + sınırlar
+    static const size_t MIME_ATTACHMENT_OVERHEAD = 200; // Ek başına sınır + 3 başlık satırı
+
+    size_t total = MIME_ENVELOPE_OVERHEAD + from.length() + toHeader.length() +
+                   content.subject->renderedLength(content.values) + content.body->renderedLength(content.values);
+
+    for (uint8_t i = 0; i < attachments.count; ++i) {
+        if (!attachments.sends(i)) continue; // writeMimeMessage ile aynı seçim
+        total += MIME_ATTACHMENT_OVERHEAD + 2 * strlen(attachments.items[i].displayName) +
+                 Base64Stream::encodedSize(attachments.sizes[i]);
     }
-    
-    return true;
+    return total;
 }
 
-bool MailAgent::sendEmail(const String &subject, const String &body, bool includeWarningAttachments, String &errorMessage) {
+bool MailAgent::sendEmail(const MailSettings &settings, const MailContent &content, bool includeWarningAttachments, String &errorMessage) {
     if (settings.recipientCount == 0) {
         errorMessage = "Mail listesi boş";
+        lastFailure = FailureClass::CONFIG;
         return false;
     }
 
     if (settings.smtpServer.length() == 0 || settings.username.length() == 0) {
         errorMessage = "SMTP ayarları eksik";
+        lastFailure = FailureClass::CONFIG;
         return false;
     }
 
     if (!netManager->ensureConnected(true)) {
         errorMessage = "İnternet bağlantısı yok";
+        lastFailure = FailureClass::NETWORK;
         return false;
     }
 
-    WiFiClientSecure client;
-
-    if (!smtpConnect(client, errorMessage)) {
-        client.flush();
-        client.stop();
-        yield();
+    // Ortak "To:" başlığı (SIZE tahmini zarftan önce gerekir)
+    String toHeader;
+    for (uint8_t i = 0; i < settings.recipientCount; ++i) {
+        if (settings.recipients[i].length() == 0) continue;
+        if (toHeader.length() > 0) toHeader += ", ";
+        toHeader += settings.recipients[i];
+    }
+    const AttachmentMeta *items = includeWarningAttachments ? settings.attachments : nullptr;
+    uint8_t itemCount = includeWarningAttachments ? settings.attachmentCount : 0;
+    prepareSidecars(items, itemCount, false);
+    AttachmentList attachments = measureAttachments(items, itemCount, false);
+
+    SmtpSession session(settings);
+    size_t estimate = estimateMimeSize(settings.username, toHeader, content, attachments);
+    if (!session.beginEnvelope(errorMessage, estimate)) {
+        lastFailure = session.failureClass();
         return false;
     }
-
-    if (!smtpAuth(client, errorMessage)) {
-        client.flush();
-        client.stop();
-        yield();
-        return false;
+    
+    // RCPT TO (her alıcı için) - tek mesaj (PIPELINING varsa yanıtlar beginData'da)
+    for (uint8_t i = 0; i < settings.recipientCount; ++i) {
+        if (settings.recipients[i].length() == 0) continue;
+        if (!session.addRecipient(settings.recipients[i], errorMessage)) {
+            lastFailure = session.failureClass();
+            return false;
+        }
     }
-
-    if (!smtpSendMail(client, subject, body, includeWarningAttachments, errorMessage)) {
-        client.flush();
-        client.stop();
-        yield();
+    
+    if (!session.beginData(errorMessage)) {
+        lastFailure = session.failureClass();
         return false;
     }
-
-    // QUIT
-    client.print("QUIT\r\n");
-    String response = smtpReadLine(client);
-    Serial.printf("[SMTP] << %s\n", response.c_str());
     
-    client.flush();
-    client.stop();
-    yield();  // Memory cleanup için zaman tanı
-    Serial.println(F("[SMTP] Bağlantı kapatıldı"));
+    // ⚠️ DÜZELTİLDİ: forFinal dosyaları ekle (sendEmail fonksiyonu genelde Final test için kullanılıyor)
+    writeMimeMessage(session.stream(), settings.username, toHeader, content, attachments);
     
-    return true;
+    if (!session.endData(errorMessage)) {
+        lastFailure = session.failureClass();
+        return false;
+    }
+    
+    Serial.println(F("[SMTP] Mail başarıyla gönderildi (streaming)"));
+    return true; // QUIT, session yıkıcısında gönderilir
 }
 
 // Test için - sadece gönderen adrese mail atar
-bool MailAgent::sendEmailToSelf(const String &subject, const String &body, bool includeWarningAttachments, String &errorMessage) {
+bool MailAgent::sendEmailToSelf(const MailSettings &settings, const MailContent &content, bool includeWarningAttachments, String &errorMessage) {
     if (settings.smtpServer.length() == 0 || settings.username.length() == 0) {
         errorMessage = "SMTP ayarları eksik";
         return false;
@@ -918,297 +842,71 @@ bool MailAgent::sendEmailToSelf(const String &subject, const String &body, bool
         return false;
     }
 
-    WiFiClientSecure client;
-
-    if (!smtpConnect(client, errorMessage)) {
-        client.flush();
-        client.stop();
-        yield();
-        return false;
-    }
-
-    if (!smtpAuth(client, errorMessage)) {
-        client.flush();
-        client.stop();
-        yield();
-        return false;
-    }
-
-    // MAIL FROM
-    String mailFrom = "MAIL FROM:<" + settings.username + ">\r\n";
-    client.print(mailFrom);
-    String response = smtpReadLine(client);
-    Serial.printf("[SMTP TEST] << %s\n", response.c_str());
-    
-    if (!response.startsWith("250")) {
-        errorMessage = "MAIL FROM reddedildi";
-        client.flush();
-        client.stop();
-        yield();
-        return false;
-    }
+    SmtpSession session(settings);
+    const AttachmentMeta *items = includeWarningAttachments ? settings.attachments : nullptr;
+    uint8_t itemCount = includeWarningAttachments ? settings.attachmentCount : 0;
+    prepareSidecars(items, itemCount, true);
+    AttachmentList attachments = measureAttachments(items, itemCount, true);
+    size_t estimate = estimateMimeSize(settings.username, settings.username, content, attachments);
     
     // RCPT TO - sadece kendine gönder
-    String rcptTo = "RCPT TO:<" + settings.username + ">\r\n";
-    client.print(rcptTo);
-    response = smtpReadLine(client);
-    Serial.printf("[SMTP TEST] << %s\n", response.c_str());
-    
-    if (!response.startsWith("250")) {
-        errorMessage = "Alıcı reddedildi";
-        client.flush();
-        client.stop();
-        yield();
+    if (!session.beginEnvelope(errorMessage, estimate) ||
+        !session.addRecipient(settings.username, errorMessage) ||
+        !session.beginData(errorMessage)) {
         return false;
     }
     
-    // DATA
-    client.print("DATA\r\n");
-    response = smtpReadLine(client);
-    Serial.printf("[SMTP TEST] << %s\n", response.c_str());
+    writeMimeMessage(session.stream(), settings.username, settings.username, content, attachments);
     
-    if (!response.startsWith("354")) {
-        errorMessage = "DATA komutu reddedildi";
-        client.flush();
-        client.stop();
-        yield();
-        return false;
-    }
-    
-    // ⚠️ YENİ: STREAMING MIME (RAM tasarrufu için)
-    String boundary = "----=_SKDMF_TEST_" + String(random(100000, 999999));
-    
-    // MIME Headers (streaming)
-    client.print("From: " + settings.username + "\r\n");
-    client.print("To: " + settings.username + "\r\n");
-    client.print("Subject: " + subject + "\r\n");
-    client.print("MIME-Version: 1.0\r\n");
-    client.print("Content-Type: multipart/mixed; boundary=\"" + boundary + "\"\r\n");
-    client.print("\r\n");
-    
-    // Body
-    client.print("--" + boundary + "\r\n");
-    client.print("Content-Type: text/plain; charset=UTF-8\r\n");
-    client.print("Content-Transfer-Encoding: 8bit\r\n\r\n");
-    client.print(body);
-    client.print("\r\n");
-    
-    // Attachments (streaming - warning için)
-    if (includeWarningAttachments && settings.attachmentCount > 0) {
-        Serial.printf("[Test Self] %d attachment kontrol ediliyor\n", settings.attachmentCount);
-        uint8_t addedCount = 0;
-        
-        for (uint8_t i = 0; i < settings.attachmentCount; ++i) {
-            const auto &meta = settings.attachments[i];
-            
-            if (!meta.forWarning) {
-                Serial.printf("[Test Self] Attachment %d ATLANDI (forWarning=false)\n", i);
-                continue;
-            }
-            
-            if (!LittleFS.exists(meta.storedPath)) {
-                Serial.printf("[Test Self] Attachment %d ATLANDI (dosya yok: %s)\n", i, meta.storedPath);
-                continue;
-            }
-            
-            File testFile = LittleFS.open(meta.storedPath, "r");
-            if (!testFile) {
-                Serial.printf("[Test Self] Attachment %d ATLANDI (açılamadı)\n", i);
-                continue;
-            }
-            size_t fileSize = testFile.size();
-            testFile.close();
-            
-            if (fileSize > 512000) { // 500KB
-                Serial.printf("[Test Self] Attachment %d ATLANDI (çok büyük: %d bytes)\n", i, fileSize);
-                continue;
-            }
-            
-            smtpStreamAttachment(client, boundary, meta);
-            addedCount++;
-        }
-        
-        Serial.printf("[Test Self] TOPLAM: %d/%d attachment gönderildi\n", addedCount, settings.attachmentCount);
-    }
-    
-    // MIME sonlandırma
-    client.print("--" + boundary + "--\r\n");
-    client.print("\r\n.\r\n");
-    
-    response = smtpReadLine(client);
-    Serial.printf("[SMTP TEST] << %s\n", response.c_str());
-    
-    if (!response.startsWith("250")) {
-        errorMessage = "Mail gönderimi başarısız";
-        client.flush();
-        client.stop();
-        yield();
+    if (!session.endData(errorMessage)) {
         return false;
     }
     
     Serial.println(F("[SMTP TEST] Test maili kendi adresinize gönderildi (streaming)"));
-    
-    // QUIT
-    client.print("QUIT\r\n");
-    response = smtpReadLine(client);
-    Serial.printf("[SMTP TEST] << %s\n", response.c_str());
-    
-    client.flush();
-    client.stop();
-    yield();  // Memory cleanup için zaman tanı
-    Serial.println(F("[SMTP TEST] Bağlantı kapatıldı"));
-    
     return true;
 }
 
 // DMF Protokolü için - Tek alıcıya mail gönder (privacy)
-bool MailAgent::sendEmailToRecipient(const String &recipient, const String &subject, const String &body, bool includeWarningAttachments, String &errorMessage) {
-    if (settings.smtpServer.length() == 0 || settings.username.length() == 0) {
-        errorMessage = "SMTP ayarları eksik";
-        return false;
-    }
-
-    if (!netManager->ensureConnected(true)) {
-        errorMessage = "İnternet bağlantısı yok";
-        return false;
-    }
-
-    WiFiClientSecure client;
-
-    if (!smtpConnect(client, errorMessage)) {
-        client.flush();
-        client.stop();
-        yield();
-        return false;
-    }
+// Oturum çağıran tarafından açık tutulur; her alıcı kendi zarfını alır
+bool MailAgent::sendEmailToRecipient(SmtpSession &session, const MailSettings &settings, const String &recipient, const MailContent &content,
+                                     const AttachmentList &attachments, String &errorMessage) {
+    if (!session.isOpen()) {
+        if (settings.smtpServer.length() == 0 || settings.username.length() == 0) {
+            errorMessage = "SMTP ayarları eksik";
+            session.noteFailure(FailureClass::CONFIG);
+            return false;
+        }
 
-    if (!smtpAuth(client, errorMessage)) {
-        client.flush();
-        client.stop();
-        yield();
-        return false;
+        // Paralel çalışanlar WiFi'ye dokunmaz (ağ yöneticisi tek görevden sürülür);
+        // bağlantı yoksa grup başarısız sayılır ve kuyruktan yeniden denenir
+        bool online = parallelWorkersActive ? WiFi.status() == WL_CONNECTED : netManager->ensureConnected(true);
+        if (!online) {
+            errorMessage = "İnternet bağlantısı yok";
+            session.noteFailure(FailureClass::NETWORK);
+            return false;
+        }
     }
 
-    // MAIL FROM
-    String mailFrom = "MAIL FROM:<" + settings.username + ">\r\n";
-    client.print(mailFrom);
-    String response = smtpReadLine(client);
-    
-    if (!response.startsWith("250")) {
-        errorMessage = "MAIL FROM reddedildi";
-        client.flush();
-        client.stop();
-        yield();
-        return false;
-    }
-    
     // RCPT TO - sadece bu alıcıya gönder (privacy)
-    String rcptTo = "RCPT TO:<" + recipient + ">\r\n";
-    client.print(rcptTo);
-    response = smtpReadLine(client);
-    
-    if (!response.startsWith("250")) {
-        errorMessage = "Alıcı reddedildi: " + recipient;
-        client.flush();
-        client.stop();
-        yield();
+    size_t estimate = estimateMimeSize(settings.username, recipient, content, attachments);
+    if (!session.beginEnvelope(errorMessage, estimate) ||
+        !session.addRecipient(recipient, errorMessage) ||
+        !session.beginData(errorMessage)) {
         return false;
     }
     
-    // DATA
-    client.print("DATA\r\n");
-    response = smtpReadLine(client);
+    // To: başlığında sadece bu alıcı (privacy)
+    writeMimeMessage(session.stream(), settings.username, recipient, content, attachments);
     
-    if (!response.startsWith("354")) {
-        errorMessage = "DATA komutu reddedildi";
-        client.flush();
-        client.stop();
-        yield();
-        return false;
-    }
-    
-    // ⚠️ YENİ: STREAMING MIME (tek alıcı için - privacy)
-    String boundary = "----=_SKDMF_" + String(random(100000, 999999));
-    
-    // MIME Headers (streaming)
-    client.print("From: " + settings.username + "\r\n");
-    client.print("To: " + recipient + "\r\n");  // ← Sadece bu alıcı (privacy)
-    client.print("Subject: " + subject + "\r\n");
-    client.print("MIME-Version: 1.0\r\n");
-    client.print("Content-Type: multipart/mixed; boundary=\"" + boundary + "\"\r\n");
-    client.print("\r\n");
-    
-    // Body
-    client.print("--" + boundary + "\r\n");
-    client.print("Content-Type: text/plain; charset=UTF-8\r\n");
-    client.print("Content-Transfer-Encoding: 8bit\r\n\r\n");
-    client.print(body);
-    client.print("\r\n");
-    
-    // Attachments (streaming)
-    Serial.printf("[Final Recipient] Attachment streaming - includeWarningAttachments=%d, alıcı=%s\n", includeWarningAttachments, recipient.c_str());
-    if (includeWarningAttachments && settings.attachmentCount > 0) {
-        uint8_t addedCount = 0;
-        
-        for (uint8_t i = 0; i < settings.attachmentCount; ++i) {
-            const auto &meta = settings.attachments[i];
-            
-            if (!meta.forFinal) {
-                Serial.printf("[Final Recipient] Attachment %d ATLANDI (forFinal=false)\n", i);
-                continue;
-            }
-            
-            if (!LittleFS.exists(meta.storedPath)) {
-                Serial.printf("[Final Recipient] Attachment %d ATLANDI (dosya yok)\n", i);
-                continue;
-            }
-            
-            File testFile = LittleFS.open(meta.storedPath, "r");
-            if (!testFile) {
-                Serial.printf("[Final Recipient] Attachment %d ATLANDI (açılamadı)\n", i);
-                continue;
-            }
-            size_t fileSize = testFile.size();
-            testFile.close();
-            
-            if (fileSize > 512000) { // 500KB
-                Serial.printf("[Final Recipient] Attachment %d ATLANDI (çok büyük: %d bytes)\n", i, fileSize);
-                continue;
-            }
-            
-            smtpStreamAttachment(client, boundary, meta);
-            addedCount++;
-        }
-        
-        Serial.printf("[Final Recipient] TOPLAM: %d/%d attachment gönderildi\n", addedCount, settings.attachmentCount);
-    }
-    
-    // MIME sonlandırma
-    client.print("--" + boundary + "--\r\n");
-    client.print("\r\n.\r\n");
-    
-    response = smtpReadLine(client);
-    
-    if (!response.startsWith("250")) {
+    if (!session.endData(errorMessage)) {
         errorMessage = "Mail gönderimi başarısız: " + recipient;
-        client.flush();
-        client.stop();
-        yield();
         return false;
     }
     
-    // QUIT
-    client.print("QUIT\r\n");
-    smtpReadLine(client);
-    
-    client.flush();
-    client.stop();
-    yield();  // Memory cleanup için zaman tanı
-    
     return true;
 }
 
-String MailAgent::buildMimeMessage(const String &subject, const String &body, bool includeWarningAttachments) {
+String MailAgent::buildMimeMessage(const String &, const String &, bool) {
     // ⚠️ DEPRECATED - Bu fonksiyon artık KULLANILMIYOR
     // Tüm mail fonksiyonları streaming kullanıyor (RAM tasarrufu için)
     Serial.println(F("[DEPRECATED] buildMimeMessage() çağrıldı - lütfen streaming kullanın"));
@@ -1216,15 +914,9 @@ String MailAgent::buildMimeMessage(const String &subject, const String &body, bo
 }
 
 // ⚠️ ÖNEMLİ: STREAM ATTACHMENT - RAM TASARRUFU İÇİN
-// String yerine direkt WiFiClientSecure'a yazıyoruz
-void MailAgent::smtpStreamAttachment(WiFiClientSecure &client, const String &boundary, const AttachmentMeta &meta) {
-    Serial.printf("[Stream] Dosya stream ediliyor: %s (%d bytes)\n", meta.displayName, meta.size);
-    
-    File file = LittleFS.open(meta.storedPath, "r");
-    if (!file) {
-        Serial.printf("[Stream] HATA: Dosya açılamadı: %s\n", meta.storedPath);
-        return;
-    }
+// String yerine direkt SMTP oturumuna yazıyoruz
+void MailAgent::smtpStreamAttachment(Print &client, const String &boundary, const AttachmentMeta &meta, size_t fileSize) {
+    Serial.printf("[Stream] Dosya stream ediliyor: %s (%u bytes)\n", meta.displayName, (unsigned)fileSize);
     
     // MIME type belirleme
     String mimeType = "application/octet-stream";
@@ -1235,40 +927,35 @@ void MailAgent::smtpStreamAttachment(WiFiClientSecure &client, const String &bou
     client.print("Content-Transfer-Encoding: base64\r\n");
     client.print("Content-Disposition: attachment; filename=\"" + String(meta.displayName) + "\"\r\n\r\n");
     
-    // Base64 streaming (57-byte chunks = 76-char base64 lines - RFC 2045 compliant)
-    const size_t CHUNK_SIZE = 57; // 57*4/3 = 76 chars
-    uint8_t buffer[CHUNK_SIZE];
-    size_t totalRead = 0;
-    size_t fileSize = file.size();
-    
-    while (file.available() && totalRead < fileSize) {
-        size_t bytesRead = file.read(buffer, CHUNK_SIZE);
-        
-        if (bytesRead > 0) {
-            String encoded = base64::encode(buffer, bytesRead);
-            client.print(encoded);
-            client.print("\r\n");
-            totalRead += bytesRead;
-            
-            // Progress indicator
-            if (fileSize > 50000 && (totalRead % 10000) == 0) {
-                Serial.printf("[Stream] Gönderildi: %d/%d bytes (%.1f%%)\n", 
-                    totalRead, fileSize, (totalRead * 100.0) / fileSize);
-            }
-            
-            // Watchdog reset
-            yield();
-        } else {
-            break;
+    // Ön-kodlanmış sidecar varsa kodlamadan akıt. Salt okunur: sidecar gönderimden
+    // önce prepareSidecars() ile hazırlanır, paralel oturumlar ortak dosyayı üretmez/silmez
+    // Sidecar varsa ham dosya hiç açılmaz (mesaj başına tek açılış)
+    AttachmentStreamStats stats;
+    File sidecar = AttachmentCache::open(meta.storedPath, fileSize);
+    if (sidecar) {
+        stats = AttachmentPipeline::stream(sidecar, client, true);
+        sidecar.close();
+    } else {
+        Serial.printf("[Stream] Sidecar yok, anlık kodlama: %s\n", meta.displayName);
+        // Base64 satırları (çift tamponlu: flash okuma, kodlama/gönderimle örtüşür)
+        File file = LittleFS.open(meta.storedPath, "r");
+        if (file) {
+            stats = AttachmentPipeline::stream(file, client);
+            file.close();
         }
     }
     
-    file.close();
     client.print("\r\n");
-    Serial.printf("[Stream] ✓ Dosya tamamen gönderildi: %d bytes\n", totalRead);
+    if (!stats.ok) {
+        Serial.printf("[Stream] ✗ Gönderim kesildi: %u/%u bytes\n", (unsigned)stats.bytes, (unsigned)fileSize);
+        return;
+    }
+    Serial.printf("[Stream] ✓ %s: %u bytes, %lu ms, %lu KB/s (flash bekleme %lu ms, %s)\n",
+                  meta.displayName, (unsigned)stats.bytes, (unsigned long)stats.elapsedMs, (unsigned long)stats.kbPerSecond(),
+                  (unsigned long)stats.readWaitMs, stats.preEncoded ? "sidecar" : (stats.pipelined ? "çift tampon" : "sıralı"));
 }
 
-void MailAgent::appendAttachments(String &mime, const String &boundary, bool warning) {
+void MailAgent::appendAttachments(String &, const String &, bool) {
     // ⚠️ DEPRECATED - Bu fonksiyon artık KULLANILMIYOR
     // smtpStreamAttachment() kullanılıyor (RAM tasarrufu için)
     Serial.println(F("[DEPRECATED] appendAttachments() çağrıldı - lütfen smtpStreamAttachment() kullanın"));
@@ -1311,89 +998,11 @@ String MailAgent::formatElapsed(const ScheduleSnapshot &snapshot) const {
 
 void MailAgent::loadQueueFromStorage() {
     Serial.println(F("[MailQueue] Kuyruk yükleniyor..."));
-    
-    if (!LittleFS.exists(QUEUE_FILE)) {
-        Serial.println(F("[MailQueue] Kuyruk dosyası yok, boş başlatılıyor"));
-        return;
-    }
-    
-    File file = LittleFS.open(QUEUE_FILE, "r");
-    if (!file) {
-        Serial.println(F("[MailQueue] Kuyruk dosyası açılamadı"));
-        return;
-    }
-    
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, file);
-    file.close();
-    
-    if (error) {
-        Serial.printf("[MailQueue] JSON parse hatası: %s\n", error.c_str());
-        return;
-    }
-    
-    mailQueue.clear();
-    nextMailId = doc["nextId"] | 1;
-    
-    JsonArray arr = doc["queue"].as<JsonArray>();
-    for (JsonObject obj : arr) {
-        QueuedMail mail;
-        mail.id = obj["id"] | 0;
-        mail.type = static_cast<MailType>(obj["type"].as<uint8_t>());
-        mail.phase = static_cast<RetryPhase>(obj["phase"].as<uint8_t>());
-        mail.attemptCount = obj["attempts"] | 0;
-        mail.nextRetryTime = millis(); // Restart sonrası hemen dene
-        mail.createdAt = obj["created"] | 0;
-        mail.subject = obj["subject"].as<String>();
-        mail.body = obj["body"].as<String>();
-        mail.alarmIndex = obj["alarm"] | 0;
-        mail.includeAttachments = obj["attach"] | false;
-        mail.startTime = obj["startTime"].as<String>();
-        mail.endTime = obj["endTime"].as<String>();
-        mail.description = obj["desc"].as<String>();
-        
-        mailQueue.push_back(mail);
-    }
-    
-    sortQueueByPriority();
-    Serial.printf("[MailQueue] ✓ %d mail yüklendi\n", mailQueue.size());
-}
-
-void MailAgent::saveQueueToStorage() {
-    JsonDocument doc;
-    doc["nextId"] = nextMailId;
-    
-    JsonArray arr = doc["queue"].to<JsonArray>();
-    for (const auto &mail : mailQueue) {
-        JsonObject obj = arr.add<JsonObject>();
-        obj["id"] = mail.id;
-        obj["type"] = static_cast<uint8_t>(mail.type);
-        obj["phase"] = static_cast<uint8_t>(mail.phase);
-        obj["attempts"] = mail.attemptCount;
-        obj["created"] = mail.createdAt;
-        obj["subject"] = mail.subject;
-        obj["body"] = mail.body;
-        obj["alarm"] = mail.alarmIndex;
-        obj["attach"] = mail.includeAttachments;
-        obj["startTime"] = mail.startTime;
-        obj["endTime"] = mail.endTime;
-        obj["desc"] = mail.description;
-    }
-    
-    File file = LittleFS.open(QUEUE_FILE, "w");
-    if (!file) {
-        Serial.println(F("[MailQueue] Kuyruk kaydedilemedi!"));
-        return;
-    }
-    
-    serializeJson(doc, file);
-    file.close();
-    Serial.printf("[MailQueue] ✓ %d mail kaydedildi\n", mailQueue.size());
+    mailQueue.begin();
 }
 
 void MailAgent::clearQueue() {
     mailQueue.clear();
-    LittleFS.remove(QUEUE_FILE);
     Serial.println(F("[MailQueue] Kuyruk temizlendi"));
 }
 
@@ -1405,31 +1014,28 @@ size_t MailAgent::getQueueSize() const {
     return mailQueue.size();
 }
 
-void MailAgent::sortQueueByPriority() {
-    // Warning (0) > Final (1)
-    // Aynı tip içinde eski olanlar önce (FIFO)
-    std::sort(mailQueue.begin(), mailQueue.end(), [](const QueuedMail &a, const QueuedMail &b) {
-        if (static_cast<uint8_t>(a.type) != static_cast<uint8_t>(b.type)) {
-            return static_cast<uint8_t>(a.type) < static_cast<uint8_t>(b.type);
-        }
-        return a.createdAt < b.createdAt;
-    });
+QueueDrainStats MailAgent::queueStats() const {
+    QueueDrainStats stats;
+    stats.draining = drainStart != 0;
+    stats.rateTokens = rateLimiter.tokens();
+    stats.lastDrainMails = lastDrainMails;
+    stats.lastDrainMs = lastDrainMs;
+    stats.avgDeliveryMs = deliveredCount ? (uint32_t)(deliveryMsTotal / deliveredCount) : 0;
+    stats.networkWakeups = networkWakeups;
+    return stats;
 }
 
-uint32_t MailAgent::getRetryInterval(RetryPhase phase) const {
-    switch (phase) {
-        case RetryPhase::PHASE1:
-            return 60 * 1000;     // 60 saniye
-        case RetryPhase::PHASE2:
-            return 300 * 1000;    // 5 dakika
-        case RetryPhase::SKIPPED:
-            return 600 * 1000;    // 10 dakika (infinite)
-        default:
-            return 60 * 1000;
+TokenBucket &MailAgent::rateLimiterFor(const MailSettings &settings) {
+    String server = settings.smtpServer + ":" + String(settings.smtpPort);
+    if (server != rateLimiterServer) {
+        rateLimiterServer = server;
+        rateLimiter = TokenBucket(); // Yeni sunucu, yeni kova
     }
+    rateLimiter.configure(settings.rateBurst, settings.ratePerMinute);
+    return rateLimiter;
 }
 
-void MailAgent::advanceRetryPhase(QueuedMail &mail) {
+void MailAgent::advanceRetryPhase(QueuedMail &mail, FailureClass failure) {
     mail.attemptCount++;
     
     switch (mail.phase) {
@@ -1455,12 +1061,43 @@ void MailAgent::advanceRetryPhase(QueuedMail &mail) {
             break;
     }
     
-    mail.nextRetryTime = millis() + getRetryInterval(mail.phase);
+    // Aralık hata sınıfından: sınıf değiştiyse geri çekilme baştan başlar
+    if (failure != mail.lastFailure) mail.retryDelayMs = 0;
+    mail.lastFailure = failure;
+    mail.retryDelayMs = RetryPolicy::nextDelay(failure, mail.retryDelayMs);
+    mail.nextRetryTime = millis() + mail.retryDelayMs;
+    Serial.printf("[MailQueue] Mail #%lu: hata sınıfı %s, sonraki deneme %lu sn sonra%s\n",
+                  (unsigned long)mail.id, RetryPolicy::name(failure), (unsigned long)(mail.retryDelayMs / 1000),
+                  RetryPolicy::waitsForNetwork(failure) ? " (ağ gelirse hemen)" : "");
+}
+
+void MailAgent::wakeWaitingMails(uint32_t now) {
+    if (networkCameUp) {
+        networkCameUp = false;
+        size_t woken = mailQueue.wakeWhere(now, [](const QueuedMail &mail) {
+            return RetryPolicy::waitsForNetwork(mail.lastFailure);
+        });
+        if (woken > 0) {
+            networkWakeups += woken;
+            queueDelay = 0;
+            Serial.printf("[MailQueue] Ağ geri geldi: %u mail beklemeden sıraya alındı\n", (unsigned)woken);
+        }
+    }
+    if (configChanged) {
+        configChanged = false;
+        size_t woken = mailQueue.wakeWhere(now, [](const QueuedMail &mail) {
+            return RetryPolicy::waitsForConfig(mail.lastFailure);
+        });
+        if (woken > 0) {
+            queueDelay = 0;
+            Serial.printf("[MailQueue] Ayarlar değişti: %u mail yeniden deneniyor\n", (unsigned)woken);
+        }
+    }
 }
 
 void MailAgent::enqueueWarning(uint8_t alarmIndex, const ScheduleSnapshot &snapshot) {
+    (void)snapshot; // Kalan süre gönderim anındaki durumdan okunur
     QueuedMail mail;
-    mail.id = nextMailId++;
     mail.type = MailType::WARNING;
     mail.phase = RetryPhase::PHASE1;
     mail.attemptCount = 0;
@@ -1468,28 +1105,25 @@ void MailAgent::enqueueWarning(uint8_t alarmIndex, const ScheduleSnapshot &snaps
     mail.createdAt = millis();
     mail.alarmIndex = alarmIndex;
     mail.includeAttachments = true;
+    // Konu/gövde gönderim anında güncel ayarlardan oluşturulur
+    snprintf(mail.description, sizeof(mail.description), "Alarm %u", (unsigned)(alarmIndex + 1));
     
-    // Snapshot'tan mevcut bilgileri kaydet
-    // Not: startTimeStr, endTimeStr, description snapshot'ta yok
-    // Bu değerler gönderim anında settings'ten alınacak
-    mail.startTime = "";
-    mail.endTime = "";
-    mail.description = "Alarm " + String(alarmIndex + 1);
-    
-    // Subject ve body daha sonra oluşturulacak
-    mail.subject = ""; // Gönderim anında oluşturulur
-    mail.body = "";
-    
-    mailQueue.push_back(mail);
-    sortQueueByPriority();
-    saveQueueToStorage();
+    uint32_t id = mailQueue.enqueue(mail);
     
-    Serial.printf("[MailQueue] ✓ Warning mail #%d kuyruğa eklendi (alarm %d)\n", mail.id, alarmIndex);
+    Serial.printf("[MailQueue] ✓ Warning mail #%lu kuyruğa eklendi (alarm %d, günlük %lu µs)\n",
+                  (unsigned long)id, alarmIndex, (unsigned long)mailQueue.lastAppendMicros());
 }
 
 void MailAgent::enqueueFinal(const ScheduleSnapshot &snapshot, TimerRuntime &runtime) {
+    (void)snapshot;
+    (void)runtime; // Gönderilen gruplar teslim defterinde; kayıt yalnızca "final bekliyor" der
+    // Final denemesi defterden devam ettiği için kuyrukta tek kayıt yeterli
+    if (mailQueue.contains(MailType::FINAL)) {
+        Serial.println(F("[MailQueue] Final mail zaten kuyrukta, yeni kayıt eklenmedi"));
+        return;
+    }
+    
     QueuedMail mail;
-    mail.id = nextMailId++;
     mail.type = MailType::FINAL;
     mail.phase = RetryPhase::PHASE1;
     mail.attemptCount = 0;
@@ -1497,21 +1131,12 @@ void MailAgent::enqueueFinal(const ScheduleSnapshot &snapshot, TimerRuntime &run
     mail.createdAt = millis();
     mail.alarmIndex = 0; // Final için kullanılmaz
     mail.includeAttachments = false; // Final maillerde attachment yok
+    strlcpy(mail.description, "Süreç Tamamlandı", sizeof(mail.description));
     
-    // Snapshot'tan mevcut bilgileri kaydet
-    // Not: startTimeStr, endTimeStr, description snapshot'ta yok
-    mail.startTime = "";
-    mail.endTime = "";
-    mail.description = "Süreç Tamamlandı";
-    
-    mail.subject = "";
-    mail.body = "";
+    uint32_t id = mailQueue.enqueue(mail);
     
-    mailQueue.push_back(mail);
-    sortQueueByPriority();
-    saveQueueToStorage();
-    
-    Serial.printf("[MailQueue] ✓ Final mail #%d kuyruğa eklendi\n", mail.id);
+    Serial.printf("[MailQueue] ✓ Final mail #%lu kuyruğa eklendi (günlük %lu µs)\n",
+                  (unsigned long)id, (unsigned long)mailQueue.lastAppendMicros());
 }
 
 bool MailAgent::trySendQueuedMail(QueuedMail &mail, String &errorMessage) {
@@ -1524,36 +1149,38 @@ bool MailAgent::trySendQueuedMail(QueuedMail &mail, String &errorMessage) {
     // WiFi kontrolü
     if (!netManager || !netManager->isConnected()) {
         errorMessage = "WiFi bağlı değil";
+        lastFailure = FailureClass::NETWORK;
         return false;
     }
     
-    // Mail içeriğini oluştur
-    String subject, body;
+    MailConfigHandle cfg = config.get();
+    bool success;
     
     if (mail.type == MailType::WARNING) {
         // Warning mail subject/body
-        subject = "⚠️ [DMF Uyarı] Alarm " + String(mail.alarmIndex + 1) + " - " + mail.description;
-        body = "SmartKraft DMF Uyarı Maili\n\n";
+        String subject = "⚠️ [DMF Uyarı] Alarm " + String(mail.alarmIndex + 1) + " - " + mail.description;
+        String body = "SmartKraft DMF Uyarı Maili\n\n";
         body += "Cihaz ID: " + deviceId + "\n";
         body += "Alarm: " + String(mail.alarmIndex + 1) + "\n";
-        body += "Başlangıç: " + mail.startTime + "\n";
-        body += "Bitiş: " + mail.endTime + "\n";
-        body += "Açıklama: " + mail.description + "\n";
+        body += "Açıklama: " + String(mail.description) + "\n";
         body += "\n" + formatHeader();
+        
+        // Sabit metin: geçici şablonlar tek düz parça olarak render edilir
+        MailContent content;
+        MessageTemplate subjectTemplate(subject);
+        MessageTemplate bodyTemplate(body);
+        content.subject = &subjectTemplate;
+        content.body = &bodyTemplate;
+        
+        // Mail gönder (tek snapshot ile)
+        success = sendEmail(*cfg, content, mail.includeAttachments, errorMessage);
     } else {
-        // Final mail subject/body
-        subject = "✅ [DMF Final] Süreç Tamamlandı - " + mail.description;
-        body = "SmartKraft DMF Final Maili\n\n";
-        body += "Cihaz ID: " + deviceId + "\n";
-        body += "Başlangıç: " + mail.startTime + "\n";
-        body += "Bitiş: " + mail.endTime + "\n";
-        body += "Açıklama: " + mail.description + "\n";
-        body += "\n" + formatHeader();
+        // Final: grup mailleri teslim defterinden devam eder - yalnızca
+        // henüz 250 almamış alıcılara, kendi grup içerikleriyle gönderilir
+        bool groupsSent[MAX_MAIL_GROUPS] = {};
+        success = deliverFinal(*cfg, groupsSent, errorMessage);
     }
     
-    // Mail gönder
-    bool success = sendEmail(subject, body, mail.includeAttachments, errorMessage);
-    
     if (success) {
         Serial.printf("[MailQueue] ✓ Mail #%d başarıyla gönderildi\n", mail.id);
     } else {
@@ -1564,84 +1191,92 @@ bool MailAgent::trySendQueuedMail(QueuedMail &mail, String &errorMessage) {
 }
 
 void MailAgent::processQueue() {
-    // Çok sık işleme yapma
-    if (millis() - lastQueueProcess < QUEUE_PROCESS_INTERVAL) {
+    // Ağ/ayar olayları bekleme süresini kısaltabilir (bayraklar olay görevinden gelir)
+    if (networkCameUp || configChanged) {
+        wakeWaitingMails(millis());
+    }
+    
+    // Boşaltma sürerken (son deneme başarılı) beklemeden devam, aksi halde 10 sn aralık
+    if (millis() - lastQueueProcess < queueDelay) {
         return;
     }
     lastQueueProcess = millis();
+    queueDelay = QUEUE_PROCESS_INTERVAL;
     
     if (mailQueue.empty()) {
         return;
     }
     
     uint32_t now = millis();
-    bool queueChanged = false;
     
     // ===== KUYRUK YÖNETİMİ =====
     // NOT: Gönderilmemiş mailler ASLA silinmez!
-    // Sadece kuyruk çok büyükse (20+) VE en eski mail SKIPPED aşamasındaysa uyarı ver
+    // Sadece kuyruk çok büyükse (20+) uyarı ver
     // Kullanıcı clearQueue() ile manuel temizleyebilir
     if (mailQueue.size() > MAX_QUEUE_SIZE) {
-        Serial.printf("[MailQueue] ⚠️ Kuyruk dolu! %d mail bekliyor (max %d)\n", mailQueue.size(), MAX_QUEUE_SIZE);
+        Serial.printf("[MailQueue] ⚠️ Kuyruk dolu! %u mail bekliyor (max %u)\n", (unsigned)mailQueue.size(), (unsigned)MAX_QUEUE_SIZE);
         // Silmiyoruz - kullanıcı clearQueue() ile temizleyebilir
     }
     
     // WiFi kontrolü
     if (!netManager || !netManager->isConnected()) {
-        if (queueChanged) saveQueueToStorage();
+        drainStart = 0; // Ölçüm bağlantı geri geldiğinde yeniden başlar
         return; // WiFi yok, bekle
     }
     
-    // Sırayla işle (priority order zaten sort edilmiş)
-    for (auto it = mailQueue.begin(); it != mailQueue.end(); ) {
-        QueuedMail &mail = *it;
-        
-        // Henüz zamanı gelmemiş mi?
-        // millis() overflow koruması: (now - nextRetryTime) negatif olursa overflow
-        uint32_t elapsed = now - mail.nextRetryTime;
-        if (elapsed > 0x7FFFFFFF) { // Overflow durumu - henüz zamanı gelmemiş
-            ++it;
-            continue;
-        }
+    // Sunucu başına hız sınırı: jeton yoksa tam dolum anında tekrar bak
+    MailConfigHandle cfg = config.get();
+    TokenBucket &bucket = rateLimiterFor(*cfg);
+    uint32_t waitMs = bucket.waitMs(now);
+    if (waitMs > 0) {
+        queueDelay = waitMs;
+        return;
+    }
+    
+    // Her çağrıda bir mail; başarılıysa sonraki loop turunda hemen devam edilir
+    // (web sunucusu/WDT mailler arasında servis edilir)
+    // Yığın tepesi: zamanı gelmiş en öncelikli mail (warning önce, sonra en erken deneme)
+    QueuedMail mail;
+    if (!mailQueue.popDue(now, mail)) {
+        return;
+    }
+    
+    if (drainStart == 0) {
+        drainStart = now;
+        drainSent = 0;
+    }
+    bucket.consume();
+    
+    String errorMessage;
+    lastFailure = FailureClass::NONE;
+    if (trySendQueuedMail(mail, errorMessage)) {
+        // Başarılı - kuyruktan çıkar
+        mailQueue.complete(mail);
+        drainSent++;
+        deliveryMsTotal += millis() - mail.enqueuedAt;
+        deliveredCount++;
         
-        String errorMessage;
-        bool success = trySendQueuedMail(mail, errorMessage);
+        // Sunucu erişilebilir: bekleyen her şeyi (SKIPPED dahil) sıraya al
+        mailQueue.wakeAll(now);
+        queueDelay = 0;
         
-        if (success) {
-            // Başarılı - kuyruktan çıkar
-            it = mailQueue.erase(it);
-            queueChanged = true;
-            
-            // SKIPPED mailler varsa, bir sonrakine geç
-            // (Başarılı gönderimden sonra SKIPPED'ları da dene)
-            for (auto &m : mailQueue) {
-                if (m.phase == RetryPhase::SKIPPED) {
-                    m.nextRetryTime = now; // Hemen dene
-                }
-            }
-        } else {
-            // Başarısız - retry phase ilerlet
-            advanceRetryPhase(mail);
-            queueChanged = true;
-            
-            // SKIPPED aşamasına geçtiyse, bir sonraki maile geç
-            if (mail.phase == RetryPhase::SKIPPED && it != mailQueue.end()) {
-                // Sonraki maillerin hemen denenmesini sağla
-                auto nextIt = it;
-                ++nextIt;
-                if (nextIt != mailQueue.end()) {
-                    nextIt->nextRetryTime = now;
-                }
-            }
-            
-            ++it;
+        if (mailQueue.empty()) {
+            lastDrainMails = drainSent;
+            lastDrainMs = millis() - drainStart;
+            drainStart = 0;
+            Serial.printf("[MailQueue] ✓ Kuyruk boşaltıldı: %u mail, %lu ms\n", (unsigned)lastDrainMails, (unsigned long)lastDrainMs);
         }
+    } else {
+        // Başarısız (4xx/5xx veya ağ hatası) - hemen geri çekil:
+        // kova boşaltılır, mail kendi retry aralığına döner
+        bucket.drain(millis());
+        advanceRetryPhase(mail, lastFailure != FailureClass::NONE ? lastFailure : FailureClass::NETWORK);
         
-        // Bir seferde sadece bir mail işle (sistem yükünü azalt)
-        break;
-    }
-    
-    if (queueChanged) {
-        saveQueueToStorage();
+        // SKIPPED aşamasına geçtiyse sıradaki mailin hemen denenmesini sağla
+        // (mail yığına dönmeden önce: tepede artık bir sonraki var)
+        if (mail.phase == RetryPhase::SKIPPED) {
+            mailQueue.expediteNext(now);
+        }
+        mailQueue.reschedule(mail);
     }
 }
\ No newline at end of file
@@ -6,50 +6,80 @@
 #include "config_store.h"
 #include "scheduler.h"
 #include "network_manager.h"
+#include "smtp_session.h"
+#include "mail_queue.h"
+#include "token_bucket.h"
+#include "delivery_ledger.h"
+#include "message_template.h"
+#include "webhook_dispatcher.h"
+
+// Bir gönderimin ekleri + flash'taki boyutları. Boyutlar grup (ya da tek mail)
+// başına bir kez ölçülür; SIZE tahmini ve MIME yazıcısı aynı değerleri kullanır,
+// mesaj başına yalnızca içerik akıtılırken dosya açılır. Blob'lar içerik adresli
+// olduğundan ölçümden sonra boyut değişmez.
+struct AttachmentList {
+    static constexpr size_t MISSING = (size_t)-1;      // Dosya yok / açılamadı
+    static constexpr size_t MAX_SEND_SIZE = 512000;    // 500 KB üstü ek atlanır
+
+    const AttachmentMeta *items = nullptr;
+    uint8_t count = 0;
+    bool warning = false;              // forWarning (true) / forFinal (false) seçimi
+    size_t sizes[MAX_ATTACHMENTS];
+
+    // Bu gönderimde seçili ve boyutu uygun mu?
+    bool sends(uint8_t i) const {
+        return (warning ? items[i].forWarning : items[i].forFinal) && sizes[i] != MISSING && sizes[i] <= MAX_SEND_SIZE;
+    }
+};
+static_assert(MAX_ATTACHMENTS_PER_GROUP <= MAX_ATTACHMENTS, "AttachmentList::sizes grup eklerini de taşır");
 
 // ============================================================================
-// MAIL QUEUE YAPISI - Persistent, Never Expires
+// FINAL GÖNDERİMİ - Gruplar arası sınırlı paralellik
 // ============================================================================
+// Gruplar birbirinden bağımsız; her çalışan (ayrı SMTP oturumu) sıradaki
+// grubu alıp TÜM alıcılarını sırayla gönderir. Grup içi sıra korunur, bir
+// grup asla iki oturuma bölünmez. Sonuçlar outcomes[]'a yazılır ve
+// runtime.finalGroupsSent yalnızca hepsi bittikten sonra çağıran görevde güncellenir.
 
-// Mail tipi önceliği: Warning > Final
-enum class MailType : uint8_t {
-    WARNING = 0,  // Yüksek öncelik
-    FINAL = 1     // Düşük öncelik
+struct FinalGroupOutcome {
+    bool success = false;
+    uint16_t sent = 0;
+    uint16_t skipped = 0;   // Defterde zaten teslim edilmiş (gönderilmedi)
+    FailureClass failure = FailureClass::NONE;
+    String error;
 };
 
-// Retry aşaması
-enum class RetryPhase : uint8_t {
-    PHASE1 = 0,   // 5x60s (5 deneme, 60 saniye aralıklarla)
-    PHASE2 = 1,   // 10x300s (10 deneme, 5 dakika aralıklarla)
-    SKIPPED = 2   // Skip edildi, 600s infinite (sonraki maile geçildi, arka planda devam)
+class MailAgent;
+
+struct FinalDispatch {
+    MailAgent *agent = nullptr;
+    const MailSettings *settings = nullptr;
+    uint8_t groups[MAX_MAIL_GROUPS] = {};   // Gönderilecek grup indeksleri (sıralı)
+    uint8_t groupCount = 0;
+    uint8_t nextGroup = 0;                  // Sıradaki boş iş (lock ile)
+    FinalGroupOutcome outcomes[MAX_MAIL_GROUPS];
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    SemaphoreHandle_t finished = nullptr;   // Her çalışan bitince bir kez verir
+    uint16_t handshakes = 0;
+    uint16_t reconnects = 0;
 };
 
-struct QueuedMail {
-    uint32_t id;               // Unique ID
-    MailType type;             // WARNING veya FINAL
-    RetryPhase phase;          // Hangi retry aşamasında
-    uint8_t attemptCount;      // Bu aşamada kaç deneme yapıldı
-    uint32_t nextRetryTime;    // Sonraki deneme zamanı (millis)
-    uint32_t createdAt;        // Oluşturulma zamanı (millis)
-    
-    // Mail içeriği
-    String subject;
-    String body;
-    uint8_t alarmIndex;        // Warning için
-    bool includeAttachments;
-    
-    // Scheduler snapshot (serialization için sadece gerekli alanlar)
-    String startTime;
-    String endTime;
-    String description;
+// Kuyruk boşaltma ölçümü: bağlantı geldikten sonra birikimin bitme süresi
+struct QueueDrainStats {
+    bool draining = false;        // Birikim boşaltılıyor (başarılar art arda)
+    uint8_t rateTokens = 0;       // Kovadaki jeton
+    uint16_t lastDrainMails = 0;  // Son tamamlanan boşaltmada gönderilen
+    uint32_t lastDrainMs = 0;     // İlk denemeden kuyruk boşalana kadar
+    uint32_t avgDeliveryMs = 0;   // Kuyruğa girişten teslime ortalama süre
+    uint16_t networkWakeups = 0;  // Ağ geri geldiğinde beklemeden sıraya alınan mail
 };
 
 class MailAgent {
 public:
     void begin(ConfigStore *storePtr, DMFNetworkManager *netMgrPtr, const String &deviceIdStr);
 
-    void updateConfig(const MailSettings &config);
-    MailSettings currentConfig() const { return settings; }
+    void updateConfig(const MailSettings &newConfig);
+    MailConfigHandle currentConfig() const { return config.get(); } // Ucuz, değiştirilemez snapshot
 
     bool sendWarning(uint8_t alarmIndex, const ScheduleSnapshot &snapshot, String &errorMessage);
     bool sendFinal(const ScheduleSnapshot &snapshot, TimerRuntime &runtime, String &errorMessage);
@@ -58,6 +88,9 @@ public:
     bool sendWarningTest(const ScheduleSnapshot &snapshot, String &errorMessage);
     bool sendFinalTest(const ScheduleSnapshot &snapshot, String &errorMessage);
 
+    // Uçtan uca ölçüm (seri "bench"): aşama süreleri, bayt ve duvar süresi 'report'a
+    bool runBenchmark(bool finalDispatch, uint8_t rounds, String &report);
+
     // URL Validation - SSRF Koruması
     static bool isValidURL(const String &url);
     
@@ -65,45 +98,78 @@ public:
     void processQueue();                    // Ana loop'tan çağrılır, kuyruk işler
     bool hasQueuedMails() const;            // Kuyrukta mail var mı?
     size_t getQueueSize() const;            // Kuyruk boyutu
-    void loadQueueFromStorage();            // LittleFS'ten yükle (begin'de çağrılır)
-    void saveQueueToStorage();              // LittleFS'e kaydet
+    void loadQueueFromStorage();            // Günlüğü oynat (begin'de çağrılır)
     void clearQueue();                      // Kuyruğu temizle (debug için)
+    QueueDrainStats queueStats() const;
+    WebhookStats webhookStats() const { return webhooks.stats(); }
 
 private:
     ConfigStore *store = nullptr;
     DMFNetworkManager *netManager = nullptr;
-    MailSettings settings;
+    ConfigSnapshot<MailSettings> config; // Copy-on-write ayarlar (web istekleri kopyalamadan okur)
+    void publishConfig(MailSettings settings); // Şablonları derle + yayınla
     String deviceId;
     
     // ===== MAIL QUEUE =====
-    std::vector<QueuedMail> mailQueue;
-    uint32_t nextMailId = 1;
+    MailQueue mailQueue; // Öncelik yığını + flash günlüğü (mail_queue.h)
+    WebhookDispatcher webhooks; // GET URL tetiklemeleri (tek çalışan, tekrar denemeli)
     uint32_t lastQueueProcess = 0;
-    static constexpr uint32_t QUEUE_PROCESS_INTERVAL = 10000; // 10 saniyede bir kontrol
-    static constexpr const char* QUEUE_FILE = "/mail_queue.json";
-    static constexpr size_t MAX_QUEUE_SIZE = 20;  // Maksimum kuyruk boyutu (20 mail)
+    uint32_t queueDelay = 0;          // Sonraki işlemeye kadar (başarı → 0, hata → aralık)
+    static constexpr uint32_t QUEUE_PROCESS_INTERVAL = 10000; // Boşaltma yokken 10 saniyede bir kontrol
+    static constexpr size_t MAX_QUEUE_SIZE = 20;  // Uyarı eşiği (20 mail)
     // NOT: Gönderilmemiş mailler ASLA silinmez - kullanıcı değiştirmedikçe kalır
-    
+
+    // Hız sınırı: kova aktif SMTP sunucusuna bağlı, sunucu değişince sıfırlanır
+    TokenBucket rateLimiter;
+    String rateLimiterServer;
+    TokenBucket &rateLimiterFor(const MailSettings &settings);
+    uint32_t drainStart = 0;          // 0 → boşaltma yok
+    uint16_t drainSent = 0;
+    uint16_t lastDrainMails = 0;
+    uint32_t lastDrainMs = 0;
+
+    // Yeniden deneme: son gönderim denemesinin hata sınıfı (yalnızca loop görevi yazar)
+    FailureClass lastFailure = FailureClass::NONE;
+    volatile bool networkCameUp = false;  // Ağ durum dinleyicisinden kurulur
+    volatile bool configChanged = false;
+    uint64_t deliveryMsTotal = 0;
+    uint16_t deliveredCount = 0;
+    uint16_t networkWakeups = 0;
+    static void onLinkStateChanged(LinkState state, void *context);
+    void wakeWaitingMails(uint32_t now);
+
+    // Final gönderimi (oturum başına RAM tahmini: TLS bağlamı + çalışan yığını + ek tamponları)
+    static constexpr uint32_t SMTP_SESSION_RAM_ESTIMATE = 45 * 1024;
+    static constexpr uint32_t FINAL_HEAP_RESERVE = 40 * 1024;   // Web sunucusu / WiFi için
+    static constexpr uint32_t FINAL_WORKER_STACK = 10240;
+    volatile bool parallelWorkersActive = false;                // true iken çalışanlar WiFi'yi yeniden kurmaya çalışmaz
+    // groupsSent: runtime.finalGroupsSent (sendFinal) veya geçici dizi (kuyruk denemesi)
+    bool deliverFinal(const MailSettings &settings, bool *groupsSent, String &errorMessage);
+    uint8_t runFinalDispatch(FinalDispatch &dispatch);          // Kullanılan oturum sayısını döner
+    void deliverFinalGroups(FinalDispatch &dispatch);           // Çalışan döngüsü
+    void deliverFinalGroup(SmtpSession &session, const MailSettings &settings, uint8_t g, FinalGroupOutcome &outcome);
+
     // Queue helpers
     void enqueueWarning(uint8_t alarmIndex, const ScheduleSnapshot &snapshot);
     void enqueueFinal(const ScheduleSnapshot &snapshot, TimerRuntime &runtime);
     bool trySendQueuedMail(QueuedMail &mail, String &errorMessage);
-    void advanceRetryPhase(QueuedMail &mail);
-    uint32_t getRetryInterval(RetryPhase phase) const;
-    void sortQueueByPriority();
-
-    bool sendEmail(const String &subject, const String &body, bool includeWarningAttachments, String &errorMessage);
-    bool sendEmailToSelf(const String &subject, const String &body, bool includeWarningAttachments, String &errorMessage); // Test için
-    bool sendEmailToRecipient(const String &recipient, const String &subject, const String &body, bool includeWarningAttachments, String &errorMessage); // DMF protokolü için
-    bool smtpConnect(WiFiClientSecure &client, String &errorMessage);
-    bool smtpAuth(WiFiClientSecure &client, String &errorMessage);
-    bool smtpSendMail(WiFiClientSecure &client, const String &subject, const String &body, bool includeAttachments, String &errorMessage);
-    bool smtpCommand(WiFiClientSecure &client, const String &command, const String &expectCode, String &errorMessage);
-    String smtpReadLine(WiFiClientSecure &client, uint32_t timeoutMs = 5000);
-    String base64Encode(const String &input);
+    void advanceRetryPhase(QueuedMail &mail, FailureClass failure);
+
+    // NOT: Tüm gönderim fonksiyonları tek bir snapshot (settings) üzerinden çalışır,
+    // böylece gönderim sırasında ayar değişse bile tutarlı kalır
+    // İçerik: ön derlenmiş şablonlar + değerler, doğrudan SMTP akışına render edilir
+    bool sendEmail(const MailSettings &settings, const MailContent &content, bool includeWarningAttachments, String &errorMessage);
+    bool sendEmailToSelf(const MailSettings &settings, const MailContent &content, bool includeWarningAttachments, String &errorMessage); // Test için
+    bool sendEmailToRecipient(SmtpSession &session, const MailSettings &settings, const String &recipient, const MailContent &content,
+                              const AttachmentList &attachments, String &errorMessage); // DMF protokolü için (oturum paylaşılır)
+    void writeMimeMessage(Print &out, const String &from, const String &toHeader, const MailContent &content,
+                          const AttachmentList &attachments);
+    // writeMimeMessage çıktısının tahmini boyutu (SMTP SIZE bildirimi / sınır ön kontrolü) - dosya açmaz
+    static size_t estimateMimeSize(const String &from, const String &toHeader, const MailContent &content,
+                                   const AttachmentList &attachments);
     String buildMimeMessage(const String &subject, const String &body, bool includeWarningAttachments);
     void appendAttachments(String &mime, const String &boundary, bool warning); // DEPRECATED
-    void smtpStreamAttachment(WiFiClientSecure &client, const String &boundary, const AttachmentMeta &meta); // RAM-efficient streaming
+    void smtpStreamAttachment(Print &client, const String &boundary, const AttachmentMeta &meta, size_t fileSize); // RAM-efficient streaming
     String formatHeader() const;
     String formatElapsed(const ScheduleSnapshot &snapshot) const;
 };
@@ -0,0 +1,343 @@
+#include "mail_queue.h"
+
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include <algorithm>
+
+namespace {
+
+constexpr const char *JOURNAL_FILE = "/mail_queue.log";
+constexpr const char *JOURNAL_TEMP_FILE = "/mail_queue.log.tmp";
+constexpr const char *LEGACY_QUEUE_FILE = "/mail_queue.json";
+
+// Günlük en az bu kadar kayda ulaşmadan ve canlı kaydın 4 katını geçmeden sıkıştırılmaz
+constexpr uint32_t COMPACT_MIN_RECORDS = 64;
+
+enum JournalOp : uint8_t {
+    OP_HEADER = 0,   // id alanı = nextId
+    OP_ENQUEUE = 1,
+    OP_ATTEMPT = 2,
+    OP_COMPLETE = 3
+};
+
+struct __attribute__((packed)) JournalRecord {
+    uint8_t op;
+    uint8_t type;
+    uint8_t phase;
+    uint8_t attempts;
+    uint32_t id;
+    uint32_t createdAt;
+    uint8_t alarmIndex;
+    uint8_t includeAttachments;
+    uint16_t reserved;
+    char description[QUEUE_DESCRIPTION_LEN];
+    uint32_t checksum;
+};
+static_assert(sizeof(JournalRecord) == 52, "Günlük kaydı boyutu değişti");
+
+uint32_t recordChecksum(const JournalRecord &record) {
+    // FNV-1a, checksum alanı hariç
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&record);
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < offsetof(JournalRecord, checksum); ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+JournalRecord toRecord(uint8_t op, const QueuedMail &mail) {
+    JournalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.op = op;
+    record.type = static_cast<uint8_t>(mail.type);
+    record.phase = static_cast<uint8_t>(mail.phase);
+    record.attempts = mail.attemptCount;
+    record.id = mail.id;
+    record.createdAt = mail.createdAt;
+    record.alarmIndex = mail.alarmIndex;
+    record.includeAttachments = mail.includeAttachments ? 1 : 0;
+    memcpy(record.description, mail.description, QUEUE_DESCRIPTION_LEN);
+    record.description[QUEUE_DESCRIPTION_LEN - 1] = '\0';
+    record.checksum = recordChecksum(record);
+    return record;
+}
+
+QueuedMail fromRecord(const JournalRecord &record) {
+    QueuedMail mail;
+    mail.id = record.id;
+    mail.type = record.type == static_cast<uint8_t>(MailType::FINAL) ? MailType::FINAL : MailType::WARNING;
+    mail.phase = record.phase <= static_cast<uint8_t>(RetryPhase::SKIPPED) ? static_cast<RetryPhase>(record.phase) : RetryPhase::PHASE1;
+    mail.attemptCount = record.attempts;
+    mail.createdAt = record.createdAt;
+    mail.alarmIndex = record.alarmIndex;
+    mail.includeAttachments = record.includeAttachments != 0;
+    memcpy(mail.description, record.description, QUEUE_DESCRIPTION_LEN);
+    mail.description[QUEUE_DESCRIPTION_LEN - 1] = '\0';
+    return mail;
+}
+
+// std::*_heap max-heap kurar; "daha sonra denenecek" olanı küçük sayarak min-heap elde edilir
+bool laterThan(const QueuedMail &a, const QueuedMail &b) {
+    int32_t diff = (int32_t)(a.nextRetryTime - b.nextRetryTime); // millis() taşmasına dayanıklı
+    if (diff != 0) return diff > 0;
+    return a.createdAt > b.createdAt;
+}
+
+bool isDue(const QueuedMail &mail, uint32_t now) {
+    return (int32_t)(now - mail.nextRetryTime) >= 0;
+}
+
+}
+
+void MailQueue::begin() {
+    warnings.clear();
+    finals.clear();
+    records = 0;
+
+    // Sıkıştırma rename öncesinde kesildiyse yeni günlük geçici dosyada kalmıştır
+    if (!LittleFS.exists(JOURNAL_FILE) && LittleFS.exists(JOURNAL_TEMP_FILE)) {
+        LittleFS.rename(JOURNAL_TEMP_FILE, JOURNAL_FILE);
+    }
+
+    if (LittleFS.exists(JOURNAL_FILE)) {
+        replay();
+    } else if (LittleFS.exists(LEGACY_QUEUE_FILE)) {
+        migrateLegacyJson();
+    } else {
+        Serial.println(F("[MailQueue] Kuyruk dosyası yok, boş başlatılıyor"));
+        return;
+    }
+
+    Serial.printf("[MailQueue] ✓ %u mail yüklendi (günlük %lu kayıt)\n", (unsigned)size(), (unsigned long)records);
+}
+
+void MailQueue::push(const QueuedMail &mail) {
+    std::vector<QueuedMail> &heap = heapFor(mail.type);
+    heap.push_back(mail);
+    std::push_heap(heap.begin(), heap.end(), laterThan);
+}
+
+uint32_t MailQueue::enqueue(QueuedMail mail) {
+    mail.id = nextId++;
+    mail.enqueuedAt = millis();
+    push(mail);
+    append(OP_ENQUEUE, mail);
+    return mail.id;
+}
+
+bool MailQueue::popDue(uint32_t now, QueuedMail &out) {
+    // Önce WARNING, sonra FINAL - her yığının tepesi o tipin en erken denemesi
+    for (std::vector<QueuedMail> *heap : {&warnings, &finals}) {
+        if (heap->empty() || !isDue(heap->front(), now)) continue;
+        std::pop_heap(heap->begin(), heap->end(), laterThan);
+        out = heap->back();
+        heap->pop_back();
+        return true;
+    }
+    return false;
+}
+
+void MailQueue::complete(const QueuedMail &mail) {
+    append(OP_COMPLETE, mail);
+    compactIfNeeded();
+}
+
+void MailQueue::reschedule(const QueuedMail &mail) {
+    push(mail);
+    append(OP_ATTEMPT, mail);
+    compactIfNeeded();
+}
+
+void MailQueue::wakeAll(uint32_t now) {
+    wakeWhere(now, [](const QueuedMail &) { return true; });
+}
+
+size_t MailQueue::wakeWhere(uint32_t now, bool (*match)(const QueuedMail &mail)) {
+    size_t woken = 0;
+    for (std::vector<QueuedMail> *heap : {&warnings, &finals}) {
+        bool changed = false;
+        for (auto &mail : *heap) {
+            if (!isDue(mail, now) && match(mail)) {
+                mail.nextRetryTime = now; // Hemen dene
+                changed = true;
+                woken++;
+            }
+        }
+        // Nadir olay - O(n) yeniden kurulum yeterli
+        if (changed) std::make_heap(heap->begin(), heap->end(), laterThan);
+    }
+    return woken;
+}
+
+void MailQueue::expediteNext(uint32_t now) {
+    // Tepedeki elemanın anahtarını küçültmek yığın düzenini bozmaz
+    std::vector<QueuedMail> &heap = !warnings.empty() ? warnings : finals;
+    if (!heap.empty()) heap.front().nextRetryTime = now;
+}
+
+void MailQueue::clear() {
+    warnings.clear();
+    finals.clear();
+    records = 0;
+    LittleFS.remove(JOURNAL_FILE);
+    LittleFS.remove(LEGACY_QUEUE_FILE);
+}
+
+bool MailQueue::append(uint8_t op, const QueuedMail &mail) {
+    uint32_t start = micros();
+    JournalRecord record = toRecord(op, mail);
+
+    File file = LittleFS.open(JOURNAL_FILE, "a");
+    if (!file) {
+        Serial.println(F("[MailQueue] Kuyruk kaydedilemedi!"));
+        return false;
+    }
+    bool ok = file.write(reinterpret_cast<const uint8_t *>(&record), sizeof(record)) == sizeof(record);
+    file.close();
+
+    records++;
+    appendMicros = micros() - start;
+    return ok;
+}
+
+void MailQueue::replay() {
+    File file = LittleFS.open(JOURNAL_FILE, "r");
+    if (!file) {
+        Serial.println(F("[MailQueue] Kuyruk dosyası açılamadı"));
+        return;
+    }
+
+    std::vector<QueuedMail> live;
+    JournalRecord record;
+    bool damaged = false;
+
+    size_t got = 0;
+    while ((got = file.read(reinterpret_cast<uint8_t *>(&record), sizeof(record))) == sizeof(record)) {
+        if (record.checksum != recordChecksum(record)) {
+            damaged = true; // Yarım kalmış son yazım - sonrası güvenilmez
+            break;
+        }
+        records++;
+
+        if (record.op == OP_HEADER) {
+            nextId = max(nextId, record.id);
+            continue;
+        }
+
+        nextId = max(nextId, record.id + 1);
+        auto it = std::find_if(live.begin(), live.end(), [&](const QueuedMail &m) { return m.id == record.id; });
+
+        if (record.op == OP_ENQUEUE && it == live.end()) {
+            live.push_back(fromRecord(record));
+        } else if (record.op == OP_ATTEMPT && it != live.end()) {
+            it->phase = fromRecord(record).phase;
+            it->attemptCount = record.attempts;
+        } else if (record.op == OP_COMPLETE && it != live.end()) {
+            live.erase(it);
+        }
+    }
+    // Kayıt sınırında bitmeyen kuyruk: read() eksik kaydı da tüketir (available() 0 olur)
+    if (got > 0 && got < sizeof(record)) damaged = true;
+    file.close();
+
+    uint32_t now = millis();
+    for (auto &mail : live) {
+        mail.nextRetryTime = now; // Restart sonrası hemen dene
+        mail.enqueuedAt = now;
+        push(mail);
+    }
+
+    if (damaged) {
+        Serial.println(F("[MailQueue] ⚠️ Günlük sonu bozuk, geçerli kayıtlarla yeniden yazılıyor"));
+        compact();
+    }
+}
+
+void MailQueue::migrateLegacyJson() {
+    File file = LittleFS.open(LEGACY_QUEUE_FILE, "r");
+    if (!file) {
+        Serial.println(F("[MailQueue] Kuyruk dosyası açılamadı"));
+        return;
+    }
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+
+    if (error) {
+        Serial.printf("[MailQueue] JSON parse hatası: %s\n", error.c_str());
+        return;
+    }
+
+    nextId = doc["nextId"] | 1;
+    uint32_t now = millis();
+
+    JsonArray arr = doc["queue"].as<JsonArray>();
+    for (JsonObject obj : arr) {
+        QueuedMail mail;
+        mail.id = obj["id"] | 0;
+        mail.type = obj["type"].as<uint8_t>() == static_cast<uint8_t>(MailType::FINAL) ? MailType::FINAL : MailType::WARNING;
+        mail.phase = static_cast<RetryPhase>(min(obj["phase"].as<uint8_t>(), (uint8_t)RetryPhase::SKIPPED));
+        mail.attemptCount = obj["attempts"] | 0;
+        mail.nextRetryTime = now; // Restart sonrası hemen dene
+        mail.enqueuedAt = now;
+        mail.createdAt = obj["created"] | 0;
+        mail.alarmIndex = obj["alarm"] | 0;
+        mail.includeAttachments = obj["attach"] | false;
+        strlcpy(mail.description, obj["desc"] | "", QUEUE_DESCRIPTION_LEN);
+        nextId = max(nextId, mail.id + 1);
+        push(mail);
+    }
+
+    if (compact()) {
+        LittleFS.remove(LEGACY_QUEUE_FILE);
+        Serial.println(F("[MailQueue] Eski JSON kuyruğu günlüğe dönüştürüldü"));
+    }
+}
+
+void MailQueue::compactIfNeeded() {
+    if (records >= COMPACT_MIN_RECORDS && records > 4 * (size() + 1)) {
+        compact();
+    }
+}
+
+bool MailQueue::compact() {
+    uint32_t start = millis();
+    File file = LittleFS.open(JOURNAL_TEMP_FILE, "w");
+    if (!file) {
+        Serial.println(F("[MailQueue] Kuyruk kaydedilemedi!"));
+        return false;
+    }
+
+    QueuedMail header;
+    header.id = nextId;
+    JournalRecord record = toRecord(OP_HEADER, header);
+    bool ok = file.write(reinterpret_cast<const uint8_t *>(&record), sizeof(record)) == sizeof(record);
+
+    for (const std::vector<QueuedMail> *heap : {&warnings, &finals}) {
+        for (const auto &mail : *heap) {
+            record = toRecord(OP_ENQUEUE, mail);
+            ok = ok && file.write(reinterpret_cast<const uint8_t *>(&record), sizeof(record)) == sizeof(record);
+        }
+    }
+    file.close();
+
+    if (!ok) {
+        LittleFS.remove(JOURNAL_TEMP_FILE);
+        Serial.println(F("[MailQueue] Kuyruk kaydedilemedi!"));
+        return false;
+    }
+
+    uint32_t previous = records;
+    LittleFS.remove(JOURNAL_FILE);
+    if (!LittleFS.rename(JOURNAL_TEMP_FILE, JOURNAL_FILE)) {
+        Serial.println(F("[MailQueue] Kuyruk kaydedilemedi!"));
+        return false;
+    }
+    records = size() + 1;
+    compactionCount++;
+    Serial.printf("[MailQueue] Günlük sıkıştırıldı: %lu → %lu kayıt (%lu ms)\n",
+                  (unsigned long)previous, (unsigned long)records, (unsigned long)(millis() - start));
+    return true;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include "retry_policy.h"
+
+// ============================================================================
+// MAIL QUEUE YAPISI - Persistent, Never Expires
+// ============================================================================
+// Kayıtlar sabit boyutlu (String yok). RAM'de tip başına bir ikili yığın
+// (binary heap) tutulur: WARNING yığını FINAL yığınından önce bakılır, yığın
+// içinde sıra (nextRetryTime, createdAt). Böylece toplam sıra
+// (type, nextRetryTime, createdAt) ve ekleme/çıkarma O(log n).
+//
+// Flash'ta kuyruk tek seferde yeniden yazılmaz; her işlem sabit boyutlu bir
+// kayıt olarak günlüğe (journal) EKLENİR:
+//   ENQUEUE  - yeni mail (tüm alanlar)
+//   ATTEMPT  - başarısız deneme sonrası aşama/deneme sayısı
+//   COMPLETE - gönderildi, kuyruktan çıktı
+// Açılışta günlük baştan oynatılır. Günlük canlı kayıtlara göre çok büyüdüğünde
+// yalnızca canlı mailleri içeren yeni bir günlükle değiştirilir (compaction).
+
+// Mail tipi önceliği: Warning > Final
+enum class MailType : uint8_t {
+    WARNING = 0,  // Yüksek öncelik
+    FINAL = 1     // Düşük öncelik
+};
+
+// Retry aşaması
+enum class RetryPhase : uint8_t {
+    PHASE1 = 0,   // İlk 5 deneme
+    PHASE2 = 1,   // Sonraki 10 deneme
+    SKIPPED = 2   // Skip edildi (sonraki maile geçildi, arka planda sonsuz devam)
+    // Aralıklar aşamadan değil hata sınıfından gelir (retry_policy.h)
+};
+
+static const size_t QUEUE_DESCRIPTION_LEN = 32;
+
+struct QueuedMail {
+    uint32_t id = 0;               // Unique ID
+    MailType type = MailType::WARNING;
+    RetryPhase phase = RetryPhase::PHASE1;
+    uint8_t attemptCount = 0;      // Bu aşamada kaç deneme yapıldı
+    uint8_t alarmIndex = 0;        // Warning için
+    bool includeAttachments = false;
+    uint32_t nextRetryTime = 0;    // Sonraki deneme zamanı (millis) - kalıcı değil
+    uint32_t createdAt = 0;        // Oluşturulma zamanı (millis)
+    char description[QUEUE_DESCRIPTION_LEN] = {0};
+    // NOT: Konu/gövde saklanmaz - gönderim anında güncel ayarlardan oluşturulur
+
+    // Yeniden deneme durumu (kalıcı değil - açılışta mailler zaten hemen denenir)
+    FailureClass lastFailure = FailureClass::NONE;
+    uint32_t retryDelayMs = 0;     // Son bekleme (decorrelated jitter bunu büyütür)
+    uint32_t enqueuedAt = 0;       // Bu açılışta kuyruğa girdiği an (teslim süresi ölçümü)
+};
+
+class MailQueue {
+public:
+    // Günlüğü oynat (eski /mail_queue.json varsa bir kez dönüştürür)
+    void begin();
+
+    // ID atanır, günlüğe ENQUEUE eklenir; atanan ID döner
+    uint32_t enqueue(QueuedMail mail);
+
+    // Zamanı gelmiş en öncelikli maili yığından ÇIKAR (warning önce)
+    // Ardından complete() veya reschedule() ile sonuçlandırılmalı
+    bool popDue(uint32_t now, QueuedMail &out);
+    void complete(const QueuedMail &mail);   // COMPLETE kaydı
+    void reschedule(const QueuedMail &mail); // ATTEMPT kaydı + yığına geri
+
+    // Bekleyen tüm mailleri hemen denenecek hale getir (başarılı gönderim sonrası:
+    // sunucu erişilebilir, SKIPPED dahil birikim beklemeden boşaltılır)
+    void wakeAll(uint32_t now);
+    // Koşulu sağlayan bekleyen mailleri hemen denenecek hale getir; uyandırılan sayısı
+    size_t wakeWhere(uint32_t now, bool (*match)(const QueuedMail &mail));
+    // Sıradaki en öncelikli maili hemen denenecek hale getir
+    void expediteNext(uint32_t now);
+
+    bool contains(MailType type) const { return type == MailType::WARNING ? !warnings.empty() : !finals.empty(); }
+    size_t size() const { return warnings.size() + finals.size(); }
+    bool empty() const { return size() == 0; }
+    void clear();
+
+    // Ölçümler
+    uint32_t journalRecords() const { return records; }
+    uint32_t compactions() const { return compactionCount; }
+    uint32_t lastAppendMicros() const { return appendMicros; }
+
+private:
+    std::vector<QueuedMail> warnings; // min-heap (nextRetryTime, createdAt)
+    std::vector<QueuedMail> finals;
+    uint32_t nextId = 1;
+    uint32_t records = 0;             // Günlükteki kayıt sayısı (compaction tetikleyici)
+    uint32_t compactionCount = 0;
+    uint32_t appendMicros = 0;
+
+    std::vector<QueuedMail> &heapFor(MailType type) { return type == MailType::WARNING ? warnings : finals; }
+    void push(const QueuedMail &mail);
+
+    bool append(uint8_t op, const QueuedMail &mail);
+    void replay();
+    void migrateLegacyJson();
+    void compactIfNeeded();
+    bool compact();
+};
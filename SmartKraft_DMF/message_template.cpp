@@ -0,0 +1,101 @@
+#include "message_template.h"
+
+namespace {
+
+struct Placeholder {
+    const char *text;
+    uint8_t length;
+    TemplateVar var;
+};
+
+const Placeholder PLACEHOLDERS[] = {
+    {"{DEVICE_ID}", 11, TemplateVar::DEVICE_ID},
+    {"{TIMESTAMP}", 11, TemplateVar::TIMESTAMP},
+    {"{REMAINING}", 11, TemplateVar::REMAINING},
+    {"%REMAINING%", 11, TemplateVar::REMAINING},
+    {"%ALARM_INDEX%", 13, TemplateVar::ALARM_INDEX},
+    {"%TOTAL_ALARMS%", 14, TemplateVar::TOTAL_ALARMS},
+};
+
+const Placeholder *matchAt(const char *text, size_t remaining) {
+    for (const auto &placeholder : PLACEHOLDERS) {
+        if (placeholder.length <= remaining && memcmp(text, placeholder.text, placeholder.length) == 0) {
+            return &placeholder;
+        }
+    }
+    return nullptr;
+}
+
+}
+
+void MessageTemplate::compile(const String &text) {
+    source = text;
+    tokens.clear();
+
+    const char *data = source.c_str();
+    size_t length = source.length();
+    size_t literalStart = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        if (data[i] != '{' && data[i] != '%') continue;
+        const Placeholder *placeholder = matchAt(data + i, length - i);
+        if (!placeholder) continue;
+
+        if (i > literalStart) {
+            tokens.push_back({(uint32_t)literalStart, (uint32_t)(i - literalStart), -1});
+        }
+        tokens.push_back({(uint32_t)i, placeholder->length, (int8_t)placeholder->var});
+        i += placeholder->length - 1;
+        literalStart = i + 1;
+    }
+    if (length > literalStart) {
+        tokens.push_back({(uint32_t)literalStart, (uint32_t)(length - literalStart), -1});
+    }
+    tokens.shrink_to_fit();
+}
+
+size_t MessageTemplate::render(Print &out, const TemplateValues &values) const {
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(source.c_str());
+    size_t written = 0;
+    for (const Token &token : tokens) {
+        const char *value = token.var >= 0 ? values.get(static_cast<TemplateVar>(token.var)) : nullptr;
+        if (value) {
+            written += out.print(value);
+        } else {
+            // Düz metin veya değeri verilmemiş yer tutucu (olduğu gibi)
+            written += out.write(data + token.offset, token.length);
+        }
+    }
+    return written;
+}
+
+size_t MessageTemplate::renderedLength(const TemplateValues &values) const {
+    size_t length = 0;
+    for (const Token &token : tokens) {
+        const char *value = token.var >= 0 ? values.get(static_cast<TemplateVar>(token.var)) : nullptr;
+        length += value ? strlen(value) : token.length;
+    }
+    return length;
+}
+
+std::shared_ptr<const MailTemplates> MailTemplates::compile(const MailSettings &settings) {
+    uint32_t start = micros();
+    auto compiled = std::make_shared<MailTemplates>();
+    compiled->warningSubject.compile(settings.warning.subject);
+    compiled->warningBody.compile(settings.warning.body);
+
+    size_t tokens = 0;
+    for (uint8_t g = 0; g < settings.mailGroupCount && g < MAX_MAIL_GROUPS; ++g) {
+        const MailGroup &group = settings.mailGroups[g];
+        String subject = group.subject;
+        if (subject.startsWith("[TEST DMF] ")) {
+            subject = subject.substring(11);
+        }
+        compiled->groupSubject[g].compile(subject);
+        compiled->groupBody[g].compile(group.body);
+        tokens += compiled->groupSubject[g].tokenCount() + compiled->groupBody[g].tokenCount();
+    }
+    Serial.printf("[Template] Şablonlar derlendi: %u grup, %u parça, %lu µs\n",
+                  settings.mailGroupCount, (unsigned)tokens, (unsigned long)(micros() - start));
+    return compiled;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include "config_store.h"
+
+// ============================================================================
+// ÖN DERLENMİŞ MESAJ ŞABLONLARI
+// ============================================================================
+// Eskiden her gönderimde konu ve gövde üzerinde 4-6 ayrı String::replace
+// geçişi yapılıyordu; her geçiş tüm gövdeyi yeniden ayırabiliyordu.
+// Şablon artık ayarlar kaydedilirken BİR KEZ ayrıştırılır:
+//
+//   "Cihaz {DEVICE_ID} - kalan %REMAINING%"
+//     → [metin "Cihaz "] [DEVICE_ID] [metin " - kalan "] [REMAINING]
+//
+// Gönderimde parçalar sırayla doğrudan SMTP akışına (Print) yazılır; ara
+// String oluşmaz. Değeri verilmeyen değişken (ör. final gövdesinde
+// %ALARM_INDEX%) eskisi gibi olduğu gibi kalır.
+
+enum class TemplateVar : uint8_t {
+    DEVICE_ID = 0,  // {DEVICE_ID}
+    TIMESTAMP,      // {TIMESTAMP}
+    REMAINING,      // {REMAINING} ve %REMAINING% (geriye uyumluluk)
+    ALARM_INDEX,    // %ALARM_INDEX%
+    TOTAL_ALARMS,   // %TOTAL_ALARMS%
+    COUNT
+};
+
+// Gönderim anındaki değerler - işaretçiler render süresince geçerli olmalı
+struct TemplateValues {
+    const char *text[static_cast<uint8_t>(TemplateVar::COUNT)] = {};
+
+    void set(TemplateVar var, const char *value) { text[static_cast<uint8_t>(var)] = value; }
+    const char *get(TemplateVar var) const { return text[static_cast<uint8_t>(var)]; }
+};
+
+class MessageTemplate {
+public:
+    MessageTemplate() = default;
+    explicit MessageTemplate(const String &source) { compile(source); }
+
+    void compile(const String &source);
+
+    // Parçaları 'out'a yaz; yazılan bayt sayısını döner
+    size_t render(Print &out, const TemplateValues &values) const;
+    // render()'ın yazacağı bayt (yazmadan - SMTP SIZE tahmini için)
+    size_t renderedLength(const TemplateValues &values) const;
+
+    size_t sourceLength() const { return source.length(); }
+    size_t tokenCount() const { return tokens.size(); }
+
+private:
+    struct Token {
+        uint32_t offset;  // source içindeki başlangıç
+        uint32_t length;  // metin uzunluğu / yer tutucu uzunluğu
+        int8_t var;       // -1 → düz metin, aksi halde TemplateVar
+    };
+
+    String source;
+    std::vector<Token> tokens;
+};
+
+// Ayarlardaki tüm şablonlar (MailSettings.templates - yayınlanmadan önce derlenir)
+struct MailTemplates {
+    MessageTemplate warningSubject;
+    MessageTemplate warningBody;
+    MessageTemplate groupSubject[MAX_MAIL_GROUPS]; // "[TEST DMF] " öneki derlemede atılır
+    MessageTemplate groupBody[MAX_MAIL_GROUPS];
+
+    static std::shared_ptr<const MailTemplates> compile(const MailSettings &settings);
+};
+
+// Bir gönderimin içeriği: şablonlar + o anki değerler
+struct MailContent {
+    const MessageTemplate *subject = nullptr;
+    const MessageTemplate *body = nullptr;
+    TemplateValues values;
+};
@@ -1,4 +1,6 @@
 #include "network_manager.h"
+#include "dns_cache.h"
+#include "wifi_link_cache.h"
 #include <HTTPClient.h>
 #include <WiFiClientSecure.h>
 #include <Update.h>
@@ -6,168 +8,312 @@
 
 // FIRMWARE_VERSION artık config_store.h'da tanımlı
 
+namespace {
+// İnternet testi: açık ağlarda PROBING ve checkForBetterNetwork()
+const char *const PROBE_HOSTS[] = {"time.cloudflare.com", "dns.google", "one.one.one.one"};
+constexpr uint8_t PROBE_HOST_COUNT = sizeof(PROBE_HOSTS) / sizeof(PROBE_HOSTS[0]);
+
+bool reached(uint32_t now, uint32_t at) {
+    return (int32_t)(now - at) >= 0;
+}
+}
+
 void DMFNetworkManager::begin(ConfigStore *storePtr) {
     store = storePtr;
     loadConfig();
+    
+    // Yeniden bağlanmayı sürücü değil durum makinesi yönetir (aday sırası, geri çekilme)
+    WiFi.setAutoReconnect(false);
+    
+    // Olay görevinde çalışır - yalnızca bayrak kurar, loop() işler
+    WiFi.onEvent([this](arduino_event_id_t, arduino_event_info_t) {
+        staConnectedEvent = true;
+    }, ARDUINO_EVENT_WIFI_STA_CONNECTED);
+    WiFi.onEvent([this](arduino_event_id_t, arduino_event_info_t) {
+        gotIpEvent = true;
+    }, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    WiFi.onEvent([this](arduino_event_id_t, arduino_event_info_t info) {
+        disconnectReason = info.wifi_sta_disconnected.reason;
+        disconnectedEvent = true;
+    }, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    // Sonuçlar loop görevinde toplanır (WiFiScan kendi kopyasını bu olayda alır)
+    WiFi.onEvent([this](arduino_event_id_t, arduino_event_info_t) {
+        scanDoneEvent = true;
+    }, ARDUINO_EVENT_WIFI_SCAN_DONE);
 }
 
-void DMFNetworkManager::loadConfig() {
-    if (store) {
-        current = store->loadWiFiSettings();
+void DMFNetworkManager::loop() {
+    if (scanDoneEvent || (scanRunning && millis() - scanStartedAt > SCAN_TIMEOUT_MS)) {
+        collectScan();
+    }
+    
+    // Olay bayrakları bu turda bir kez tüketilir
+    uint32_t now = millis();
+    bool associated = staConnectedEvent;
+    bool gotIp = gotIpEvent;
+    bool dropped = disconnectedEvent;
+    staConnectedEvent = false;
+    gotIpEvent = false;
+    disconnectedEvent = false;
+    
+    switch (linkState) {
+        case LinkState::IDLE:
+        case LinkState::FALLBACK_AP:
+            if (attemptPending && reached(now, nextActionAt)) beginAttempt();
+            break;
+            
+        case LinkState::SCANNING:
+            stepScanning(now);
+            break;
+            
+        case LinkState::ASSOCIATING:
+            // Statik IP'de STA_CONNECTED ve GOT_IP aynı turda gelebilir
+            if (gotIp) {
+                addressAcquired();
+            } else if (associated) {
+                setState(LinkState::DHCP);
+            } else if (dropped && disconnectReason != WIFI_REASON_ASSOC_LEAVE) {
+                // ASSOC_LEAVE: önceki bağlantıyı kendimiz kapattık - bu adayla ilgisi yok
+                candidateFailed("AP reddetti / bulunamadı");
+            } else if (reached(now, stateDeadline)) {
+                candidateFailed("ilişkilenme zaman aşımı");
+            }
+            break;
+            
+        case LinkState::DHCP:
+            if (gotIp || isConnected()) {
+                addressAcquired();
+            } else if (dropped) {
+                candidateFailed("DHCP sırasında koptu");
+            } else if (reached(now, stateDeadline)) {
+                candidateFailed("DHCP zaman aşımı");
+            }
+            break;
+            
+        case LinkState::PROBING:
+            if (dropped) {
+                candidateFailed("test sırasında koptu");
+            } else {
+                stepProbing(now);
+            }
+            break;
+            
+        case LinkState::ONLINE:
+            if (dropped || !isConnected()) {
+                Serial.printf("[WiFi] Bağlantı koptu (sebep %u) - yeniden bağlanılacak\n", (unsigned)disconnectReason);
+                DnsCache::clear();
+                attemptPending = true;
+                nextActionAt = now + RECONNECT_DELAY_MS;
+                setState(LinkState::IDLE);
+            } else if (attemptPending && reached(now, nextActionAt)) {
+                beginAttempt(); // requestConnect(true): daha iyi ağ görüldü
+            }
+            break;
     }
 }
 
-void DMFNetworkManager::setConfig(const WiFiSettings &config) {
-    current = config;
-    if (store) {
-        store->saveWiFiSettings(config);
+bool DMFNetworkManager::addStateListener(LinkStateListener listener, void *context) {
+    for (auto &slot : listeners) {
+        if (!slot.callback) {
+            slot.context = context;
+            slot.callback = listener;
+            return true;
+        }
     }
+    return false;
 }
 
-bool DMFNetworkManager::ensureConnected(bool escalateForAlarm) {
-    if (isConnected()) {
-        return true;
+void DMFNetworkManager::setState(LinkState next) {
+    if (linkState == next) return;
+    Serial.printf("[WiFi] %s → %s\n", stateName(linkState), stateName(next));
+    linkState = next;
+    for (auto &slot : listeners) {
+        if (slot.callback) slot.callback(next, slot.context);
     }
-    // connectToKnown() artık açık ağları da deniyor (allowOpenNetworks ayarına göre)
-    return connectToKnown();
 }
 
-void DMFNetworkManager::disconnect() {
-    WiFi.disconnect(true, true);
+const char *DMFNetworkManager::stateName(LinkState state) {
+    switch (state) {
+        case LinkState::IDLE:        return "IDLE";
+        case LinkState::SCANNING:    return "SCANNING";
+        case LinkState::ASSOCIATING: return "ASSOCIATING";
+        case LinkState::DHCP:        return "DHCP";
+        case LinkState::PROBING:     return "PROBING";
+        case LinkState::ONLINE:      return "ONLINE";
+        case LinkState::FALLBACK_AP: return "FALLBACK_AP";
+    }
+    return "?";
 }
 
-std::vector<DMFNetworkManager::ScanResult> DMFNetworkManager::scanNetworks() {
-    // Cache kontrolü - 5 saniye içinde tekrar scan yapma
-    uint32_t now = millis();
-    if (now - lastScanTime < SCAN_CACHE_DURATION && !lastScanResults.empty()) {
-        return lastScanResults;
+void DMFNetworkManager::loadConfig() {
+    if (store) {
+        config.publish(store->loadWiFiSettings());
     }
-    
-    lastScanResults.clear();
-    int16_t n = WiFi.scanNetworks();
-    
-    // Sonuçları cache'e kaydet
-    lastScanResults.reserve(n > 0 ? n : 0);
-    for (int16_t i = 0; i < n; ++i) {
-        ScanResult result;
-        result.ssid = WiFi.SSID(i);
-        result.rssi = WiFi.RSSI(i);
-        result.open = WiFi.encryptionType(i) == WIFI_AUTH_OPEN;
-        lastScanResults.push_back(result);
+}
+
+void DMFNetworkManager::setConfig(const WiFiSettings &settings) {
+    config.publish(settings);
+    if (store) {
+        store->saveWiFiSettings(settings);
     }
-    
-    // Scan sonuçlarını temizle (heap'i serbest bırak)
-    WiFi.scanDelete();
-    
-    lastScanTime = now;
-    return lastScanResults;
 }
 
-bool DMFNetworkManager::connectToKnown() {
-    if (current.primarySSID.length() > 0) {
-        for (int attempt = 1; attempt <= 3; attempt++) {
-            esp_task_wdt_reset();
-            auto networks = scanNetworks();
-            
-            for (auto &net : networks) {
-                if (net.ssid == current.primarySSID) {
-                    esp_task_wdt_reset();
-                    if (connectTo(current.primarySSID, current.primaryPassword, 15000)) {
-                        if (apModeActive) stopAPMode();
-                        return true;
-                    }
-                    break;
-                }
-            }
-            
-            if (attempt < 3) {
-                delay(2000);
-                esp_task_wdt_reset();
-            }
-        }
+bool DMFNetworkManager::ensureConnected(bool escalateForAlarm) {
+    if (isOnline()) {
+        return true;
     }
     
-    if (current.secondarySSID.length() > 0) {
-        for (int attempt = 1; attempt <= 3; attempt++) {
-            esp_task_wdt_reset();
-            auto networks = scanNetworks();
-            
-            for (auto &net : networks) {
-                if (net.ssid == current.secondarySSID) {
-                    esp_task_wdt_reset();
-                    if (connectTo(current.secondarySSID, current.secondaryPassword, 15000)) {
-                        if (apModeActive) stopAPMode();
-                        return true;
-                    }
-                    break;
-                }
-            }
-            
-            if (attempt < 3) {
-                delay(2000);
-                esp_task_wdt_reset();
-            }
+    bool attemptRunning = linkState != LinkState::IDLE && linkState != LinkState::FALLBACK_AP &&
+                          linkState != LinkState::ONLINE;
+    if (!attemptRunning) {
+        uint32_t now = millis();
+        if (!attemptPending) {
+            attemptPending = true;
+            nextActionAt = now;
+        } else if (escalateForAlarm && (int32_t)(nextActionAt - (now + RETRY_DELAY_URGENT_MS)) > 0) {
+            // Alarm bekliyor: geri çekilme kısaltılır (her çağrıda ötelenmez)
+            nextActionAt = now + RETRY_DELAY_URGENT_MS;
         }
     }
-    
-    if (current.allowOpenNetworks) {
-        esp_task_wdt_reset();
-        
-        if (connectToManufacturer()) {
-            if (apModeActive) stopAPMode();
-            return true;
+    return false;
+}
+
+void DMFNetworkManager::requestConnect(bool force) {
+    bool attemptRunning = linkState != LinkState::IDLE && linkState != LinkState::FALLBACK_AP &&
+                          linkState != LinkState::ONLINE;
+    if (attemptRunning) return;
+    if (!force && isOnline()) return;
+    attemptPending = true;
+    nextActionAt = millis();
+}
+
+void DMFNetworkManager::beginAttempt() {
+    attemptPending = false;
+    attemptKind = WiFiLinkCache::nextKind();
+    attemptStarted = millis();
+    candidates.clear();
+    candidateIndex = 0;
+    scanRound = 0;
+    
+    // Önce son başarılı AP'ye taramasız, kanala sabitlenmiş (WiFiLinkCache)
+    WiFiLinkRecord link;
+    if (WiFiLinkCache::load(link)) {
+        WiFiConfigHandle cfg = config.get();
+        const String *password = nullptr;
+        if (cfg->primarySSID.length() > 0 && cfg->primarySSID == link.ssid) {
+            password = &cfg->primaryPassword;
+        } else if (cfg->secondarySSID.length() > 0 && cfg->secondarySSID == link.ssid) {
+            password = &cfg->secondaryPassword;
+        } else {
+            WiFiLinkCache::forget(); // Ağ ayarlardan kaldırılmış
         }
         
-        auto networks = scanNetworks();
-        
-        for (auto &net : networks) {
-            if (net.open) {
-                esp_task_wdt_reset();
-                if (connectTo(net.ssid, "", 8000)) {
-                    esp_task_wdt_reset();
-                    if (testInternet(30000)) {
-                        if (apModeActive) stopAPMode();
-                        return true;
-                    } else {
-                        WiFi.disconnect();
-                        delay(500);
-                    }
-                }
-            }
+        if (password) {
+            Candidate fast;
+            fast.ssid = link.ssid;
+            fast.password = *password;
+            memcpy(fast.bssid, link.bssid, sizeof(fast.bssid));
+            fast.channel = link.channel;
+            fast.timeoutMs = WIFI_FAST_CONNECT_TIMEOUT_MS;
+            fast.source = Candidate::FAST;
+            candidates.push_back(fast);
+            Serial.printf("[WiFi] Taramasız bağlanılıyor: %s @ %s, kanal %u\n",
+                          link.ssid, link.bssidString().c_str(), link.channel);
+            startCandidate();
+            return;
         }
     }
     
-    startAPMode();
-    return false;
+    startScanRound(0);
 }
 
-bool DMFNetworkManager::checkForBetterNetwork(const String &currentSSID) {
-    if (currentSSID.isEmpty()) return false;
-    if (currentSSID == current.primarySSID || currentSSID == current.secondarySSID) return false;
-    
-    auto networks = scanNetworks();
-    
-    if (current.primarySSID.length() > 0) {
-        for (auto &net : networks) {
-            if (net.ssid == current.primarySSID) return true;
+void DMFNetworkManager::startScanRound(uint32_t delayMs) {
+    scanVersionSeen = scanResults.get()->version;
+    scanRequested = false;
+    nextActionAt = millis() + delayMs;
+    setState(LinkState::SCANNING);
+}
+
+void DMFNetworkManager::stepScanning(uint32_t now) {
+    if (!reached(now, nextActionAt)) return;
+    
+    ScanHandle scan = scanResults.get();
+    bool finished = scan->version != scanVersionSeen;
+    if (!finished) {
+        if (scanRunning) return;
+        if (!scanRequested) {
+            scanRequested = true;
+            requestScan();
+            return;
         }
+        // Tarama sonuçsuz bitti - boş tur sayılır
     }
     
-    if (current.secondarySSID.length() > 0) {
-        for (auto &net : networks) {
-            if (net.ssid == current.secondarySSID) return true;
+    scanRound++;
+    WiFiConfigHandle cfg = config.get();
+    bool knownConfigured = cfg->primarySSID.length() > 0 || cfg->secondarySSID.length() > 0;
+    // Kayıtlı ağ görünmüyorsa önce yeniden taranır; üretici/açık ağlara son turda geçilir
+    bool includeFallbacks = !knownConfigured || scanRound >= SCAN_ROUNDS;
+    static const ScanSnapshot EMPTY;
+    buildCandidates(finished ? *scan : EMPTY, includeFallbacks);
+    
+    if (!candidates.empty()) {
+        startCandidate();
+    } else if (!includeFallbacks) {
+        startScanRound(RESCAN_DELAY_MS);
+    } else {
+        attemptFailed();
+    }
+}
+
+void DMFNetworkManager::buildCandidates(const ScanSnapshot &scan, bool includeFallbacks) {
+    candidates.clear();
+    candidateIndex = 0;
+    WiFiConfigHandle cfg = config.get();
+    const WiFiSettings &current = *cfg;
+    
+    auto seen = [&](const String &ssid) {
+        for (auto &net : scan.networks) {
+            if (net.ssid == ssid) return true;
+        }
+        return false;
+    };
+    auto add = [&](const String &ssid, const String &password, uint32_t timeoutMs, Candidate::Source source) {
+        for (auto &existing : candidates) {
+            if (existing.ssid == ssid) return; // Aynı SSID'li birden çok AP
+        }
+        Candidate candidate;
+        candidate.ssid = ssid;
+        candidate.password = password;
+        candidate.timeoutMs = timeoutMs;
+        candidate.source = source;
+        candidates.push_back(candidate);
+    };
+    
+    if (current.primarySSID.length() > 0 && seen(current.primarySSID)) {
+        add(current.primarySSID, current.primaryPassword, 15000, Candidate::KNOWN);
+    }
+    if (current.secondarySSID.length() > 0 && seen(current.secondarySSID)) {
+        add(current.secondarySSID, current.secondaryPassword, 15000, Candidate::KNOWN);
+    }
+    if (includeFallbacks && current.allowOpenNetworks) {
+        if (seen(MANUFACTURER_SSID)) {
+            add(MANUFACTURER_SSID, MANUFACTURER_PASSWORD, 15000, Candidate::MANUFACTURER);
+        }
+        for (auto &net : scan.networks) {
+            if (net.open && net.ssid.length() > 0) add(net.ssid, "", 8000, Candidate::OPEN);
         }
     }
-    
-    if (!testInternet(10000)) return true;
-    
-    return false;
 }
 
-bool DMFNetworkManager::connectTo(const String &ssid, const String &password, uint32_t timeoutMs) {
-    if (ssid.isEmpty()) return false;
+void DMFNetworkManager::startCandidate() {
+    const Candidate &candidate = candidates[candidateIndex];
     
-    if (WiFi.status() == WL_CONNECTED && WiFi.SSID() == ssid) return true;
+    // Zaten bu ağa bağlıysa ilişkilenme atlanır
+    if (isConnected() && WiFi.SSID() == candidate.ssid) {
+        addressAcquired();
+        return;
+    }
     
     wifi_mode_t currentMode = WiFi.getMode();
     if (currentMode == WIFI_AP || currentMode == WIFI_AP_STA) {
@@ -176,96 +322,234 @@ bool DMFNetworkManager::connectTo(const String &ssid, const String &password, ui
         WiFi.mode(WIFI_STA);
     }
     
-    applyStaticIfNeeded(ssid);
+    applyStaticIfNeeded(candidate.ssid);
     
     wl_status_t status = WiFi.status();
     if (status == WL_CONNECTED || status == WL_CONNECT_FAILED) {
         WiFi.disconnect(false, false);
-        delay(50);
     }
     
-    String hostname = getHostnameForSSID(ssid);
+    String hostname = getHostnameForSSID(candidate.ssid);
     if (hostname.length() > 0) {
         WiFi.setHostname(hostname.c_str());
     }
-
-    WiFi.begin(ssid.c_str(), password.length() ? password.c_str() : nullptr);
+    
+    // Önceki bağlantıdan kalan olaylar bu adaya sayılmasın
+    staConnectedEvent = false;
+    gotIpEvent = false;
+    disconnectedEvent = false;
+    
+    WiFi.begin(candidate.ssid.c_str(), candidate.password.length() ? candidate.password.c_str() : nullptr,
+               candidate.channel, candidate.channel ? candidate.bssid : nullptr);
     disableWiFiPowerSave();
     esp_wifi_set_max_tx_power(84);
+    
+    stateDeadline = millis() + candidate.timeoutMs;
+    setState(LinkState::ASSOCIATING);
+}
 
-    uint32_t start = millis();
-    uint32_t lastYield = millis();
+void DMFNetworkManager::addressAcquired() {
+    DnsCache::clear(); // Yeni ağın çözümleyicisi farklı yanıt verebilir
+    if (candidates[candidateIndex].source == Candidate::OPEN) {
+        // Açık ağ: portal / internetsiz olabilir - önce DNS testi
+        uint32_t now = millis();
+        probeIndex = 0;
+        nextActionAt = now;
+        stateDeadline = now + PROBE_TIMEOUT_MS;
+        setState(LinkState::PROBING);
+    } else {
+        goOnline();
+    }
+}
+
+void DMFNetworkManager::candidateFailed(const char *reason) {
+    Candidate::Source source = candidates[candidateIndex].source;
+    Serial.printf("[WiFi] ✗ %s: %s\n", candidates[candidateIndex].ssid.c_str(), reason);
+    WiFi.disconnect(false, false);
+    
+    if (source == Candidate::FAST) {
+        // AP değişmiş / kapalı olabilir - kayıt unutulur, tarama yoluna geçilir
+        WiFiLinkCache::recordFallback();
+        WiFiLinkCache::forget();
+        startScanRound(0);
+        return;
+    }
     
-    while (millis() - start < timeoutMs) {
-        wl_status_t currentStatus = WiFi.status();
-        
-        if (currentStatus == WL_CONNECTED) {
-            startMDNS(ssid);
-            return true;
-        }
-        
-        if (currentStatus == WL_CONNECT_FAILED || currentStatus == WL_NO_SSID_AVAIL) break;
-        
-        if (millis() - lastYield > 100) {
-            yield();
-            lastYield = millis();
+    if (++candidateIndex < candidates.size()) {
+        startCandidate();
+    } else {
+        attemptFailed();
+    }
+}
+
+void DMFNetworkManager::attemptFailed() {
+    consecutiveFailures++;
+    uint32_t delayMs = consecutiveFailures >= 5 ? RETRY_DELAY_LONG_MS : RETRY_DELAY_MS;
+    Serial.printf("[WiFi] ✗ Bağlanılamadı (%u. kez) - %lu sn sonra yeniden\n",
+                  consecutiveFailures, (unsigned long)(delayMs / 1000));
+    
+    startAPMode(); // Zaten açıksa bir şey yapmaz
+    attemptPending = true;
+    nextActionAt = millis() + delayMs;
+    setState(LinkState::FALLBACK_AP);
+}
+
+void DMFNetworkManager::goOnline() {
+    const Candidate &candidate = candidates[candidateIndex];
+    consecutiveFailures = 0;
+    
+    if (candidate.source == Candidate::FAST || candidate.source == Candidate::KNOWN) {
+        rememberLink();
+    }
+    
+    if (candidate.source == Candidate::MANUFACTURER) {
+        String hostname = "dmf-" + getOrCreateDeviceId();
+        MDNS.end();
+        if (MDNS.begin(hostname.c_str())) {
+            MDNS.addService("http", "tcp", 80);
+            MDNS.addServiceTxt("http", "tcp", "version", FIRMWARE_VERSION);
+            MDNS.addServiceTxt("http", "tcp", "model", "SmartKraft-DMF");
+            MDNS.addServiceTxt("http", "tcp", "mode", "manufacturer");
         }
-        
-        delay(100);
+    } else {
+        startMDNS(candidate.ssid);
     }
     
-    return false;
+    if (apModeActive) stopAPMode();
+    WiFiLinkCache::recordConnect(attemptKind, millis() - attemptStarted, candidate.source == Candidate::FAST);
+    setState(LinkState::ONLINE);
 }
 
-bool DMFNetworkManager::connectToOpen() {
-    auto networks = scanNetworks();
-    for (auto &net : networks) {
-        if (!net.open) continue;
-        if (connectTo(net.ssid, "", 8000)) {
-            if (testInternet(30000)) return true;
-            WiFi.disconnect();
-        }
+void DMFNetworkManager::stepProbing(uint32_t now) {
+    if (probeIndex >= PROBE_HOST_COUNT || reached(now, stateDeadline)) {
+        candidateFailed("internet erişimi yok");
+        return;
     }
-    return false;
+    if (!reached(now, nextActionAt)) return;
+    
+    // Turda tek ad: her sorgu en fazla bir DNS zaman aşımı kadar sürer
+    IPAddress ip;
+    if (DnsCache::resolve(PROBE_HOSTS[probeIndex], ip)) {
+        goOnline();
+        return;
+    }
+    probeIndex++;
+    nextActionAt = now + PROBE_SPACING_MS;
 }
 
-bool DMFNetworkManager::connectToManufacturer() {
-    auto networks = scanNetworks();
-    for (auto &net : networks) {
-        if (net.ssid == MANUFACTURER_SSID) {
-            if (connectTo(MANUFACTURER_SSID, MANUFACTURER_PASSWORD, 15000)) {
-                String hostname = "dmf-" + getOrCreateDeviceId();
-                MDNS.end();
-                delay(100);
-                if (MDNS.begin(hostname.c_str())) {
-                    MDNS.addService("http", "tcp", 80);
-                    MDNS.addServiceTxt("http", "tcp", "version", FIRMWARE_VERSION);
-                    MDNS.addServiceTxt("http", "tcp", "model", "SmartKraft-DMF");
-                    MDNS.addServiceTxt("http", "tcp", "mode", "manufacturer");
-                }
-                return true;
-            }
-            break;
+void DMFNetworkManager::disconnect() {
+    WiFi.disconnect(true, true);
+}
+
+bool DMFNetworkManager::requestScan() {
+    if (scanRunning) return true;
+    
+    scanDoneEvent = false;
+    int16_t started = WiFi.scanNetworks(true); // async: hemen döner
+    if (started == WIFI_SCAN_FAILED) {
+        Serial.println(F("[WiFi] ✗ Tarama başlatılamadı"));
+        return false;
+    }
+    scanRunning = true;
+    scanStartedAt = millis();
+    return true;
+}
+
+void DMFNetworkManager::collectScan() {
+    scanDoneEvent = false;
+    int16_t n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING && millis() - scanStartedAt <= SCAN_TIMEOUT_MS) return;
+    scanRunning = false;
+    
+    if (n < 0) {
+        // Zaman aşımı / hata - önceki sonuç yayında kalır
+        Serial.printf("[WiFi] ✗ Tarama sonuçlanmadı (%d)\n", n);
+        WiFi.scanDelete();
+        return;
+    }
+    
+    ScanHandle previous = scanResults.get();
+    auto next = std::make_shared<ScanSnapshot>();
+    next->version = previous->version + 1;
+    next->completedAt = millis();
+    next->durationMs = next->completedAt - scanStartedAt;
+    next->networks.reserve(n);
+    for (int16_t i = 0; i < n; ++i) {
+        ScanResult result;
+        result.ssid = WiFi.SSID(i);
+        result.rssi = WiFi.RSSI(i);
+        result.open = WiFi.encryptionType(i) == WIFI_AUTH_OPEN;
+        next->networks.push_back(result);
+    }
+    
+    // Scan sonuçlarını temizle (heap'i serbest bırak)
+    WiFi.scanDelete();
+    
+    Serial.printf("[WiFi] Tarama #%lu: %d ağ, %lu ms\n",
+                  (unsigned long)next->version, n, (unsigned long)next->durationMs);
+    scanResults.publish(std::move(next));
+}
+
+void DMFNetworkManager::rememberLink() {
+    WiFiLinkRecord link;
+    strlcpy(link.ssid, WiFi.SSID().c_str(), sizeof(link.ssid));
+    const uint8_t *bssid = WiFi.BSSID();
+    if (bssid) memcpy(link.bssid, bssid, sizeof(link.bssid));
+    link.channel = (uint8_t)WiFi.channel();
+    link.ip = (uint32_t)WiFi.localIP();
+    link.gateway = (uint32_t)WiFi.gatewayIP();
+    link.subnet = (uint32_t)WiFi.subnetMask();
+    link.dns = (uint32_t)WiFi.dnsIP();
+    WiFiLinkCache::store(link);
+}
+
+bool DMFNetworkManager::checkForBetterNetwork(const String &currentSSID) {
+    if (currentSSID.isEmpty()) return false;
+    WiFiConfigHandle cfg = config.get();
+    const WiFiSettings &current = *cfg;
+    if (currentSSID == current.primarySSID || currentSSID == current.secondarySSID) return false;
+    
+    // Periyodik kontrol: son yayınlanan sonuca bakılır, taze sonuç bir sonraki tura
+    ScanHandle scan = scanResults.get();
+    if (scan->version == 0 || millis() - scan->completedAt >= SCAN_CACHE_DURATION) requestScan();
+    const auto &networks = scan->networks;
+    
+    if (current.primarySSID.length() > 0) {
+        for (auto &net : networks) {
+            if (net.ssid == current.primarySSID) return true;
+        }
+    }
+    
+    if (current.secondarySSID.length() > 0) {
+        for (auto &net : networks) {
+            if (net.ssid == current.secondarySSID) return true;
         }
     }
+    
+    if (!testInternet(10000)) return true;
+    
     return false;
 }
 
 bool DMFNetworkManager::testInternet(uint32_t timeoutMs) {
-    const char* dnsServers[] = {"time.cloudflare.com", "dns.google", "one.one.one.one"};
     uint32_t start = millis();
     
-    for (int i = 0; i < 3; i++) {
+    // Önbellek ağ değişiminde temizlenir: geçerli girdi bu ağda alınmış yanıttır.
+    // Olumsuz girdiler sorgusuz false döner - bekleme yalnızca gerçek sorgu sonrası
+    for (uint8_t i = 0; i < PROBE_HOST_COUNT; i++) {
         if (millis() - start >= timeoutMs) break;
         
         IPAddress ip;
-        if (WiFi.hostByName(dnsServers[i], ip) == 1 && ip != IPAddress()) return true;
-        delay(500);
+        uint32_t lookupsBefore = DnsCache::stats().lookups;
+        if (DnsCache::resolve(PROBE_HOSTS[i], ip)) return true;
+        if (DnsCache::stats().lookups != lookupsBefore && i + 1 < PROBE_HOST_COUNT) delay(PROBE_SPACING_MS);
     }
     return false;
 }
 
 bool DMFNetworkManager::applyStaticIfNeeded(const String &ssid) {
+    WiFiConfigHandle cfg = config.get();
+    const WiFiSettings &current = *cfg;
     if (ssid == current.primarySSID && current.primaryStaticEnabled) {
         IPAddress ip, gw, mask, dns;
         if (ip.fromString(current.primaryIP) && gw.fromString(current.primaryGateway) && mask.fromString(current.primarySubnet)) {
@@ -332,7 +616,7 @@ bool DMFNetworkManager::checkOTAUpdate(String currentVersion) {
     if (!isConnected()) return false;
     
     IPAddress testIP;
-    if (WiFi.hostByName("api.github.com", testIP) != 1) return false;
+    if (!DnsCache::resolve("api.github.com", testIP)) return false;
 
     WiFiClientSecure client;
     client.setInsecure();
@@ -396,7 +680,7 @@ void DMFNetworkManager::performOTAUpdate(String latestVersion) {
             
             if (canBegin) {
                 WiFiClient *stream = http.getStreamPtr();
-                size_t written = Update.writeStream(*stream);
+                Update.writeStream(*stream); // Eksik yazım Update.end() ile reddedilir
                 
                 if (Update.end()) {
                     if (Update.isFinished()) {
@@ -412,12 +696,15 @@ void DMFNetworkManager::performOTAUpdate(String latestVersion) {
 }
 
 String DMFNetworkManager::getHostnameForSSID(const String &ssid) {
+    (void)ssid; // Tüm ağlarda aynı ad
     String hostname = "dmf-" + getOrCreateDeviceId();
     hostname.toLowerCase();
     return hostname;
 }
 
 void DMFNetworkManager::startMDNS(const String &connectedSSID) {
+    WiFiConfigHandle cfg = config.get();
+    const WiFiSettings &current = *cfg;
     String mdnsHostname = "dmf-" + getOrCreateDeviceId();
     
     if (connectedSSID == current.primarySSID && current.primaryMDNS.length() > 0) {
@@ -5,15 +5,62 @@
 #include <WiFi.h>
 #include <ESPmDNS.h>
 #include "config_store.h"
+#include "wifi_link_cache.h"
+
+// ============================================================================
+// BAĞLANTI DURUM MAKİNESİ
+// ============================================================================
+// Eskiden connectTo() WiFi.status()'u delay(100) ile 15-20 s yokluyor,
+// ensureConnected() bunu birincil/ikincil/üretici/açık ağlar ve internet
+// testleri boyunca zincirliyordu - loop (web sunucusu, buton) dakikalarca
+// duruyordu.
+//
+// Şimdi WiFi.onEvent yalnızca bayrak kurar; loop() her turda makineyi bir
+// adım ilerletir, hiçbir adım radyoyu beklemez:
+//
+//   IDLE         girişim zamanını bekler
+//   SCANNING     asenkron tarama (son AP kayıtlıysa atlanır)
+//   ASSOCIATING  WiFi.begin → STA_CONNECTED olayı
+//   DHCP         GOT_IP olayı
+//   PROBING      yalnızca açık ağlarda DNS ile internet testi (turda tek ad)
+//   ONLINE       kopmada RECONNECT_DELAY_MS sonra yeni girişim
+//   FALLBACK_AP  aday kalmadı: kurulum AP'si açık, yeniden deneme arka planda
+//                30 s (art arda 5 başarısızlıktan sonra 2 dk) aralıkla
+//
+// Diğer modüller ensureConnected()'da beklemek yerine durum değişimlerine
+// abone olur; ensureConnected() artık yalnızca girişimi başlatır.
+
+enum class LinkState : uint8_t {
+    IDLE = 0,
+    SCANNING,
+    ASSOCIATING,
+    DHCP,
+    PROBING,
+    ONLINE,
+    FALLBACK_AP
+};
+
+// Durum dinleyicisi: loop görevinden çağrılır - kısa tutulmalı
+typedef void (*LinkStateListener)(LinkState state, void *context);
 
 class DMFNetworkManager {
 public:
     void begin(ConfigStore *storePtr);
+
+    // Her durum geçişinde bildirilir (ONLINE = kullanılabilir bağlantı)
+    bool addStateListener(LinkStateListener listener, void *context);
     void loadConfig();
     void setConfig(const WiFiSettings &config);
-    WiFiSettings getConfig() const { return current; }
+    WiFiConfigHandle getConfig() const { return config.get(); }
 
+    // Beklemez: bağlı değilse girişimi başlatır, ONLINE ise true.
+    // escalateForAlarm → geri çekilme süresi kısaltılır (alarm bekliyor)
     bool ensureConnected(bool escalateForAlarm = false);
+    // force → bağlıyken de yeniden seç (daha iyi ağ bulundu)
+    void requestConnect(bool force = false);
+    LinkState state() const { return linkState; }
+    bool isOnline() const { return linkState == LinkState::ONLINE && isConnected(); }
+    static const char *stateName(LinkState state);
     bool isConnected() const { return WiFi.status() == WL_CONNECTED; }
 
     String currentSSID() const { return WiFi.SSID(); }
@@ -26,9 +73,24 @@ public:
         int32_t rssi;
         bool open;
     };
-    std::vector<ScanResult> scanNetworks();
+    // Tamamlanmış bir taramanın değişmez sonucu; version her taramada artar (0 = henüz yok)
+    struct ScanSnapshot {
+        uint32_t version = 0;
+        uint32_t completedAt = 0;   // millis()
+        uint32_t durationMs = 0;
+        std::vector<ScanResult> networks;
+    };
+    using ScanHandle = ConfigSnapshot<ScanSnapshot>::Handle;
+    
+    // Arka plan tarama servisi: radyo taraması hiçbir çağıranı bekletmez.
+    // requestScan() asenkron taramayı başlatır (zaten sürüyorsa bir şey yapmaz);
+    // SCAN_DONE olayından sonra loop() sonuçları toplayıp yeni sürümü yayınlar.
+    bool requestScan();
+    ScanHandle latestScan() const { return scanResults.get(); }
+    bool scanInProgress() const { return scanRunning; }
+    // Tarama sonuçlarını toplar ve bağlantı durum makinesini ilerletir (her loop turunda)
+    void loop();
     
-    bool connectToKnown();
     bool checkForBetterNetwork(const String &currentSSID);
     
     // mDNS management
@@ -43,20 +105,81 @@ public:
 
 private:
     ConfigStore *store = nullptr;
-    WiFiSettings current;
+    ConfigSnapshot<WiFiSettings> config;
     bool apModeActive = false;  // AP mode durumu
+
+    // Durum dinleyicileri
+    static constexpr uint8_t MAX_STATE_LISTENERS = 4;
+    struct ListenerSlot {
+        LinkStateListener callback = nullptr;
+        void *context = nullptr;
+    };
+    ListenerSlot listeners[MAX_STATE_LISTENERS];
+    
+    // WiFi olay görevinden kurulan bayraklar - loop() tüketir
+    volatile bool staConnectedEvent = false;
+    volatile bool gotIpEvent = false;
+    volatile bool disconnectedEvent = false;
+    volatile uint16_t disconnectReason = 0;
+    
+    // Bağlantı girişimi: sırayla denenecek adaylar
+    struct Candidate {
+        enum Source : uint8_t { FAST, KNOWN, MANUFACTURER, OPEN };
+        String ssid;
+        String password;
+        uint8_t bssid[6] = {0};
+        int32_t channel = 0;      // 0 → kanal/BSSID sabitlenmez
+        uint32_t timeoutMs = 15000;
+        Source source = KNOWN;
+    };
+    LinkState linkState = LinkState::IDLE;
+    std::vector<Candidate> candidates;
+    size_t candidateIndex = 0;
+    uint8_t scanRound = 0;
+    uint32_t scanVersionSeen = 0;
+    bool scanRequested = false;     // Bu turun taraması başlatıldı
+    uint32_t stateDeadline = 0;     // Aday için ilişkilenme + DHCP süresi
+    uint32_t nextActionAt = 0;      // Yeniden tarama / test / yeniden deneme zamanı
+    bool attemptPending = false;    // IDLE/FALLBACK_AP'de nextActionAt gelince girişim başlar
+    uint8_t probeIndex = 0;
+    uint8_t consecutiveFailures = 0;
+    WiFiConnectKind attemptKind = WiFiConnectKind::COLD_BOOT;
+    uint32_t attemptStarted = 0;
+    
+    static constexpr uint8_t SCAN_ROUNDS = 3;               // Kayıtlı ağ görünmezse yeniden tara
+    static constexpr uint32_t RESCAN_DELAY_MS = 2000;
+    static constexpr uint32_t PROBE_TIMEOUT_MS = 30000;     // Açık ağda internet testi
+    static constexpr uint32_t PROBE_SPACING_MS = 500;
+    static constexpr uint32_t RETRY_DELAY_MS = 30000;
+    static constexpr uint32_t RETRY_DELAY_LONG_MS = 120000; // 5 başarısızlıktan sonra
+    static constexpr uint32_t RETRY_DELAY_URGENT_MS = 10000;
+    static constexpr uint32_t RECONNECT_DELAY_MS = 1000;    // Kopma sonrası ilk deneme
+    
+    void setState(LinkState next);
+    void beginAttempt();
+    void startScanRound(uint32_t delayMs);
+    void buildCandidates(const ScanSnapshot &scan, bool includeFallbacks);
+    void startCandidate();
+    void addressAcquired();
+    void candidateFailed(const char *reason);
+    void attemptFailed();
+    void goOnline();
+    void stepScanning(uint32_t now);
+    void stepProbing(uint32_t now);
     
-    // Scan cache (heap fragmantasyonunu azaltmak için)
-    std::vector<ScanResult> lastScanResults;
-    uint32_t lastScanTime = 0;
-    static constexpr uint32_t SCAN_CACHE_DURATION = 5000; // 5 saniye cache
+    // Tarama sonuçları (heap fragmantasyonunu azaltmak için tek paylaşılan kopya)
+    ConfigSnapshot<ScanSnapshot> scanResults;
+    volatile bool scanDoneEvent = false;  // WiFi olay görevinden kurulur
+    volatile bool scanRunning = false;
+    uint32_t scanStartedAt = 0;
+    static constexpr uint32_t SCAN_CACHE_DURATION = 5000; // 5 saniye içinde yeniden tarama yok
+    static constexpr uint32_t SCAN_TIMEOUT_MS = 15000;    // SCAN_DONE gelmezse vazgeç
+    void collectScan();
     
-    bool connectTo(const String &ssid, const String &password, uint32_t timeoutMs = 20000);
-    bool connectToOpen();
-    bool connectToManufacturer(); // ⚠️ YENİ: Gizli üretici WiFi'ye bağlan
+    void rememberLink();          // Bağlı AP'yi WiFiLinkCache'e yaz
     void startAPMode();           // Fallback AP mode başlat
     void stopAPMode();            // AP mode kapat
-    bool testInternet(uint32_t timeoutMs = 60000); // 60s connectivity check
+    bool testInternet(uint32_t timeoutMs = 60000); // Bloklayan test - yalnızca checkForBetterNetwork
     bool applyStaticIfNeeded(const String &ssid);   // choose correct static config
     void startMDNS(const String &connectedSSID);    // mDNS initialization based on network
     // getChipIdHex() artık config_store.h'da global
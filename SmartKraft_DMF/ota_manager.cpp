@@ -5,6 +5,8 @@
  */
 
 #include "ota_manager.h"
+#include "tls_session_cache.h"
+#include "dns_cache.h"
 #include <esp_task_wdt.h>
 
 // ============================================
@@ -223,10 +225,9 @@ bool OTAManager::fetchLatestVersion(String& latestVersion) {
     // Watchdog'u besle
     esp_task_wdt_reset();
     
-    // DNS kontrolü
-    Serial.println(F("[OTA] DNS çözümleniyor..."));
+    // DNS kontrolü (önbellekte varsa sorgu yapılmaz; HTTPS bağlantısı aynı girdiyi kullanır)
     IPAddress testIP;
-    if (WiFi.hostByName("api.github.com", testIP) != 1) {
+    if (!DnsCache::resolve("api.github.com", testIP)) {
         Serial.println(F("[OTA] ✗ DNS hatası: api.github.com çözümlenemedi"));
         return false;
     }
@@ -235,7 +236,7 @@ bool OTAManager::fetchLatestVersion(String& latestVersion) {
     // Watchdog'u besle
     esp_task_wdt_reset();
     
-    WiFiClientSecure client;
+    CachedTlsClient client;
     client.setInsecure(); // Sertifika doğrulamasını atla
     
     HTTPClient http;
@@ -318,7 +319,7 @@ bool OTAManager::downloadAndUpdate(const String& version) {
     // Watchdog'u besle
     esp_task_wdt_reset();
     
-    WiFiClientSecure client;
+    CachedTlsClient client;
     client.setInsecure();
     
     HTTPClient http;
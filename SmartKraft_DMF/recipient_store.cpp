@@ -0,0 +1,454 @@
+#include "recipient_store.h"
+
+#include <vector>
+
+namespace {
+constexpr uint8_t RECIPIENT_MAGIC[4] = {'D', 'M', 'F', 'R'};
+constexpr uint8_t RECIPIENT_FORMAT_VERSION = 1;
+constexpr size_t HEADER_SIZE = 16;
+
+void putU16(uint8_t *dst, uint16_t value) {
+    dst[0] = value & 0xFF;
+    dst[1] = (value >> 8) & 0xFF;
+}
+
+void putU32(uint8_t *dst, uint32_t value) {
+    for (uint8_t i = 0; i < 4; ++i) {
+        dst[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+uint16_t getU16(const uint8_t *src) {
+    return (uint16_t)src[0] | ((uint16_t)src[1] << 8);
+}
+
+uint32_t getU32(const uint8_t *src) {
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+bool ensureRecipientDir() {
+    if (!LittleFS.exists(RECIPIENT_DIR)) {
+        return LittleFS.mkdir(RECIPIENT_DIR);
+    }
+    return true;
+}
+
+String tempDataPath(uint16_t listId) {
+    return String(RECIPIENT_DIR) + "/" + String(listId) + ".tmp";
+}
+
+String tempIndexPath(uint16_t listId) {
+    return String(RECIPIENT_DIR) + "/" + String(listId) + ".itmp";
+}
+
+// "123.rcp" / "123.tmp" -> 123 (tanınmayan isimler için 0)
+uint16_t parseListId(const String &name) {
+    int dot = name.indexOf('.');
+    if (dot <= 0) return 0;
+    long value = name.substring(0, dot).toInt();
+    if (value <= 0 || value > 0xFFFF) return 0;
+    return (uint16_t)value;
+}
+
+uint16_t allocateListId() {
+    uint16_t highest = 0;
+    File dir = LittleFS.open(RECIPIENT_DIR, "r");
+    if (dir) {
+        File entry = dir.openNextFile();
+        while (entry) {
+            uint16_t id = parseListId(String(entry.name()));
+            if (id > highest) highest = id;
+            entry = dir.openNextFile();
+        }
+    }
+    // 65535 sonrası başa dön - prune() sayesinde düşük ID'ler boşalmış olur
+    if (highest == 0xFFFF) {
+        for (uint16_t id = 1; id < 0xFFFF; ++id) {
+            if (!LittleFS.exists(RecipientStore::pathFor(id)) && !LittleFS.exists(tempDataPath(id))) {
+                return id;
+            }
+        }
+        return 0;
+    }
+    return highest + 1;
+}
+
+// Basit yapısal kontrol: yerel@alan, boşluk/kontrol karakteri ve SMTP'yi bozacak karakter yok
+bool isPlausibleAddress(const char *address, size_t len) {
+    if (len < 3 || len > MAX_EMAIL_ADDRESS_LEN) return false;
+    int at = -1;
+    for (size_t i = 0; i < len; ++i) {
+        char c = address[i];
+        if ((uint8_t)c <= 0x20 || c == 0x7F) return false;
+        if (c == '<' || c == '>' || c == ',' || c == ';' || c == '"') return false;
+        if (c == '@') {
+            if (at >= 0) return false;
+            at = (int)i;
+        }
+    }
+    return at > 0 && at < (int)len - 1;
+}
+}
+
+// ============================================
+// RecipientWriter
+// ============================================
+
+RecipientWriter::~RecipientWriter() {
+    if (data || index) {
+        abort();
+    }
+}
+
+bool RecipientWriter::begin(String &errorMessage) {
+    if (!ensureRecipientDir()) {
+        errorMessage = "Alıcı klasörü oluşturulamadı";
+        return false;
+    }
+
+    id = allocateListId();
+    if (id == 0) {
+        errorMessage = "Boş alıcı listesi ID'si kalmadı";
+        return false;
+    }
+
+    written = 0;
+    dataBytes = 0;
+
+    data = LittleFS.open(tempDataPath(id), "w");
+    index = LittleFS.open(tempIndexPath(id), "w");
+    if (!data || !index) {
+        abort();
+        errorMessage = "Alıcı listesi dosyası açılamadı";
+        return false;
+    }
+
+    // Başlık yeri ayır - commit() sırasında gerçek değerlerle doldurulur
+    uint8_t placeholder[HEADER_SIZE] = {0};
+    if (data.write(placeholder, HEADER_SIZE) != HEADER_SIZE) {
+        abort();
+        errorMessage = "Alıcı listesi yazılamadı (flash dolu?)";
+        return false;
+    }
+    return true;
+}
+
+bool RecipientWriter::add(const char *address, String &errorMessage) {
+    if (!data || !index) {
+        errorMessage = "Alıcı listesi açık değil";
+        return false;
+    }
+
+    // Baştaki/sondaki boşlukları kırp (kopyalamadan)
+    const char *start = address;
+    while (*start == ' ' || *start == '\t' || *start == '\r' || *start == '\n') ++start;
+    size_t len = strlen(start);
+    while (len > 0 && (start[len - 1] == ' ' || start[len - 1] == '\t' || start[len - 1] == '\r' || start[len - 1] == '\n')) --len;
+
+    if (len == 0) return true; // Boş satır - atla
+
+    if (written >= MAX_RECIPIENT_LIST_SIZE) {
+        errorMessage = "Alıcı limiti aşıldı (maks " + String(MAX_RECIPIENT_LIST_SIZE) + ")";
+        return false;
+    }
+
+    if (!isPlausibleAddress(start, len)) {
+        errorMessage = "Geçersiz e-posta adresi: " + String(start).substring(0, len);
+        return false;
+    }
+
+    uint8_t offsetBytes[4];
+    putU32(offsetBytes, HEADER_SIZE + dataBytes);
+    uint8_t lenByte = (uint8_t)len;
+
+    if (index.write(offsetBytes, 4) != 4 ||
+        data.write(&lenByte, 1) != 1 ||
+        data.write((const uint8_t *)start, len) != len) {
+        errorMessage = "Alıcı listesi yazılamadı (flash dolu?)";
+        return false;
+    }
+
+    dataBytes += 1 + len;
+    written++;
+    return true;
+}
+
+bool RecipientWriter::commit(String &errorMessage) {
+    if (!data || !index) {
+        errorMessage = "Alıcı listesi açık değil";
+        return false;
+    }
+
+    index.close();
+
+    // İndeks tablosunu veri bölümünün arkasına ekle (küçük bloklarla - RAM sabit)
+    File indexIn = LittleFS.open(tempIndexPath(id), "r");
+    if (!indexIn) {
+        abort();
+        errorMessage = "Alıcı indeksi okunamadı";
+        return false;
+    }
+    uint8_t chunk[64];
+    size_t copied = 0;
+    while (indexIn.available()) {
+        size_t n = indexIn.read(chunk, sizeof(chunk));
+        if (n == 0) break;
+        if (data.write(chunk, n) != n) break;
+        copied += n;
+    }
+    indexIn.close();
+
+    if (copied != (size_t)written * 4) {
+        abort();
+        errorMessage = "Alıcı indeksi yazılamadı (flash dolu?)";
+        return false;
+    }
+
+    uint8_t header[HEADER_SIZE] = {0};
+    memcpy(header, RECIPIENT_MAGIC, 4);
+    header[4] = RECIPIENT_FORMAT_VERSION;
+    putU16(header + 6, written);
+    putU32(header + 8, HEADER_SIZE + dataBytes);
+    putU32(header + 12, dataBytes);
+
+    if (!data.seek(0) || data.write(header, HEADER_SIZE) != HEADER_SIZE) {
+        abort();
+        errorMessage = "Alıcı listesi başlığı yazılamadı";
+        return false;
+    }
+    data.close();
+
+    LittleFS.remove(tempIndexPath(id));
+    if (!LittleFS.rename(tempDataPath(id), RecipientStore::pathFor(id))) {
+        LittleFS.remove(tempDataPath(id));
+        errorMessage = "Alıcı listesi kaydedilemedi";
+        return false;
+    }
+
+    Serial.printf("[Recipients] Liste %u kaydedildi: %u alıcı, %lu byte\n",
+                  id, written, (unsigned long)(HEADER_SIZE + dataBytes + (uint32_t)written * 4));
+    return true;
+}
+
+void RecipientWriter::abort() {
+    if (data) data.close();
+    if (index) index.close();
+    if (id != 0) {
+        LittleFS.remove(tempDataPath(id));
+        LittleFS.remove(tempIndexPath(id));
+    }
+}
+
+// ============================================
+// RecipientUpload
+// ============================================
+
+bool RecipientUpload::begin(String &errorMessage) {
+    abort();
+    lineLength = 0;
+    open = writer.begin(errorMessage);
+    return open;
+}
+
+bool RecipientUpload::write(const uint8_t *chunk, size_t length, String &errorMessage) {
+    if (!open) {
+        errorMessage = "Alıcı listesi açık değil";
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        char c = (char)chunk[i];
+        if (c == '\n') {
+            if (!flushLine(errorMessage)) return false;
+            continue;
+        }
+        if (lineLength + 1 >= sizeof(line)) {
+            line[lineLength] = '\0';
+            errorMessage = "Geçersiz e-posta adresi (çok uzun): " + String(line).substring(0, 40) + "...";
+            abort();
+            return false;
+        }
+        line[lineLength++] = c;
+    }
+    return true;
+}
+
+bool RecipientUpload::flushLine(String &errorMessage) {
+    line[lineLength] = '\0';
+    lineLength = 0;
+    if (!writer.add(line, errorMessage)) {
+        abort();
+        return false;
+    }
+    return true;
+}
+
+bool RecipientUpload::finish(String &errorMessage) {
+    if (!open) {
+        errorMessage = "Alıcı listesi açık değil";
+        return false;
+    }
+    if (lineLength > 0 && !flushLine(errorMessage)) return false;
+    open = false;
+    if (!writer.commit(errorMessage)) {
+        writer.abort();
+        return false;
+    }
+    return true;
+}
+
+void RecipientUpload::abort() {
+    if (open) writer.abort();
+    open = false;
+    lineLength = 0;
+}
+
+// ============================================
+// RecipientCursor
+// ============================================
+
+bool RecipientCursor::open(uint16_t listId) {
+    close();
+    if (listId == 0) return false;
+
+    file = LittleFS.open(RecipientStore::pathFor(listId), "r");
+    if (!file) return false;
+
+    uint8_t header[HEADER_SIZE];
+    if (file.read(header, HEADER_SIZE) != HEADER_SIZE ||
+        memcmp(header, RECIPIENT_MAGIC, 4) != 0 ||
+        header[4] != RECIPIENT_FORMAT_VERSION) {
+        Serial.printf("[Recipients] Liste %u bozuk veya tanınmayan format\n", listId);
+        close();
+        return false;
+    }
+
+    total = getU16(header + 6);
+    indexOffset = getU32(header + 8);
+    current = 0;
+    return true;
+}
+
+void RecipientCursor::close() {
+    if (file) file.close();
+    total = 0;
+    current = 0;
+    indexOffset = 0;
+}
+
+bool RecipientCursor::next(char *out, size_t outLen) {
+    if (!file || current >= total || outLen == 0) return false;
+
+    uint8_t len = 0;
+    if (file.read(&len, 1) != 1) return false;
+    if (len >= outLen) {
+        Serial.printf("[Recipients] Kayıt %u tampondan uzun (%u byte)\n", current, len);
+        return false;
+    }
+    if (file.read((uint8_t *)out, len) != len) return false;
+
+    out[len] = '\0';
+    current++;
+    return true;
+}
+
+bool RecipientCursor::seek(uint16_t position) {
+    if (!file || position > total) return false;
+    if (position == total) {
+        current = total;
+        return true;
+    }
+
+    uint8_t offsetBytes[4];
+    if (!file.seek(indexOffset + (uint32_t)position * 4) || file.read(offsetBytes, 4) != 4) {
+        return false;
+    }
+    if (!file.seek(getU32(offsetBytes))) return false;
+
+    current = position;
+    return true;
+}
+
+// ============================================
+// RecipientStore
+// ============================================
+
+namespace RecipientStore {
+
+String pathFor(uint16_t listId) {
+    return String(RECIPIENT_DIR) + "/" + String(listId) + ".rcp";
+}
+
+bool exists(uint16_t listId) {
+    return listId != 0 && LittleFS.exists(pathFor(listId));
+}
+
+uint16_t count(uint16_t listId) {
+    RecipientCursor cursor;
+    if (!cursor.open(listId)) return 0;
+    return cursor.count();
+}
+
+uint32_t fingerprint(uint16_t listId) {
+    if (listId == 0) return 0;
+    File file = LittleFS.open(pathFor(listId), "r");
+    if (!file) return 0;
+
+    uint8_t header[HEADER_SIZE];
+    if (file.read(header, HEADER_SIZE) != HEADER_SIZE ||
+        memcmp(header, RECIPIENT_MAGIC, 4) != 0 ||
+        header[4] != RECIPIENT_FORMAT_VERSION ||
+        getU32(header + 8) < HEADER_SIZE) {
+        file.close();
+        return 0;
+    }
+
+    // Veri bölümü (len + adres kayıtları) - indeks offset'leri içerikten türer
+    uint32_t remaining = getU32(header + 8) - HEADER_SIZE;
+    uint32_t hash = 2166136261u;
+    uint8_t chunk[64];
+    while (remaining > 0) {
+        size_t want = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+        if (file.read(chunk, want) != want) {
+            file.close();
+            return 0;
+        }
+        for (size_t i = 0; i < want; ++i) {
+            hash = (hash ^ chunk[i]) * 16777619u;
+        }
+        remaining -= want;
+    }
+    file.close();
+    return hash ? hash : 1; // 0 = "liste yok" için ayrılmış
+}
+
+void prune(const uint16_t *liveIds, size_t liveCount) {
+    File dir = LittleFS.open(RECIPIENT_DIR, "r");
+    if (!dir) return;
+
+    // Klasör gezilirken silme yapılmaz - önce topla
+    std::vector<String> stale;
+    File entry = dir.openNextFile();
+    while (entry) {
+        String name = String(entry.name());
+        uint16_t id = parseListId(name);
+        bool live = false;
+        if (id != 0 && name.endsWith(".rcp")) {
+            for (size_t i = 0; i < liveCount; ++i) {
+                if (liveIds[i] == id) {
+                    live = true;
+                    break;
+                }
+            }
+        }
+        if (!live) stale.push_back(String(RECIPIENT_DIR) + "/" + name);
+        entry = dir.openNextFile();
+    }
+    dir.close();
+
+    for (const String &path : stale) {
+        LittleFS.remove(path);
+        Serial.printf("[Recipients] Kullanılmayan liste silindi: %s\n", path.c_str());
+    }
+}
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// ============================================
+// FLASH TABANLI ALICI LİSTESİ (Recipient Store)
+// ============================================
+// Grup alıcıları RAM'de String dizisi olarak TUTULMAZ. Her liste LittleFS'te
+// kompakt, indeksli bir ikili dosyadır ve gönderim sırasında küçük bir cursor
+// ile tek tek okunur. RAM kullanımı liste boyutundan bağımsızdır.
+//
+// DOSYA FORMATI (/recipients/<id>.rcp, little-endian):
+//   [Başlık 16 byte] magic "DMFR" | version u8 | reserved u8 | count u16
+//                    | indexOffset u32 | dataBytes u32
+//   [Veri]           Her kayıt: len u8 + adres (NUL yok)
+//   [İndeks]         count × u32 - her kaydın dosya içi offset'i (rastgele erişim)
+//
+// Liste ID'leri değişmez: bir liste güncellenirken YENİ ID ile yazılır,
+// eski dosya kaydedilen ayarlar artık referans vermediğinde prune() ile silinir.
+// Böylece grup sırası değişse bile liste dosyaları taşınmaz.
+
+static const uint16_t MAX_RECIPIENT_LIST_SIZE = 1000;
+static const size_t MAX_EMAIL_ADDRESS_LEN = 254; // RFC 5321 path limiti
+
+constexpr const char *RECIPIENT_DIR = "/recipients";
+
+class RecipientWriter {
+public:
+    ~RecipientWriter();
+
+    // Yeni liste başlat (ID otomatik atanır)
+    bool begin(String &errorMessage);
+
+    // Adres ekle - boşluklar kırpılır, boş satırlar atlanır
+    // Geçersiz adres veya limit aşımında false döner
+    bool add(const char *address, String &errorMessage);
+
+    // Başlığı ve indeksi yaz, geçici dosyayı kalıcı hale getir
+    bool commit(String &errorMessage);
+    void abort();
+
+    uint16_t listId() const { return id; }
+    uint16_t count() const { return written; }
+
+private:
+    File data;
+    File index;
+    uint16_t id = 0;
+    uint16_t written = 0;
+    uint32_t dataBytes = 0;
+};
+
+// Parça parça gelen düz metni (HTTP yüklemesi, satır başına bir adres) satırlara
+// bölüp RecipientWriter'a yazar. Parça sınırında kalan yarım satır sabit bir
+// tamponda bekler - RAM liste ya da gövde boyutundan bağımsızdır.
+class RecipientUpload {
+public:
+    bool begin(String &errorMessage);
+    bool write(const uint8_t *chunk, size_t length, String &errorMessage);
+    // Son (satır sonu olmayan) satırı ekle ve listeyi kalıcı hale getir
+    bool finish(String &errorMessage);
+    void abort();
+
+    bool active() const { return open; }
+    uint16_t listId() const { return writer.listId(); }
+    uint16_t count() const { return writer.count(); }
+
+private:
+    RecipientWriter writer;
+    char line[MAX_EMAIL_ADDRESS_LEN + 8]; // Adres + kırpılacak boşluk / CR payı
+    size_t lineLength = 0;
+    bool open = false;
+
+    bool flushLine(String &errorMessage);
+};
+
+class RecipientCursor {
+public:
+    ~RecipientCursor() { close(); }
+
+    bool open(uint16_t listId);
+    void close();
+
+    // Sıradaki adresi 'out' içine kopyala (NUL sonlandırılmış)
+    // Liste bittiğinde veya okuma hatasında false döner
+    bool next(char *out, size_t outLen);
+
+    // İndeks tablosu üzerinden doğrudan bir kayda atla
+    bool seek(uint16_t position);
+
+    uint16_t count() const { return total; }
+    uint16_t position() const { return current; }
+
+private:
+    File file;
+    uint16_t total = 0;
+    uint16_t current = 0;
+    uint32_t indexOffset = 0;
+};
+
+namespace RecipientStore {
+    String pathFor(uint16_t listId);
+    bool exists(uint16_t listId);
+
+    // Sadece başlığı okur (16 byte) - liste yoksa 0
+    uint16_t count(uint16_t listId);
+
+    // Adres kayıtlarının içerik özeti (FNV-1a 32) - liste yoksa/bozuksa 0.
+    // Aynı metin yeniden yüklenirse ID değişir, özet değişmez
+    uint32_t fingerprint(uint16_t listId);
+
+    // Referans verilmeyen liste dosyalarını sil (yarım kalmış .tmp'ler dahil)
+    void prune(const uint16_t *liveIds, size_t liveCount);
+}
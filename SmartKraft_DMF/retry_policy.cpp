@@ -0,0 +1,67 @@
+#include "retry_policy.h"
+
+namespace {
+
+struct Backoff {
+    uint32_t baseMs;
+    uint32_t capMs;
+};
+
+// Taban: ilk bekleme alt sınırı, tavan: en uzun bekleme
+Backoff backoffFor(FailureClass failure) {
+    switch (failure) {
+        case FailureClass::NETWORK:   return {30UL * 1000, 10UL * 60 * 1000};   // Ağ olayı zaten uyandırır
+        case FailureClass::DNS:       return {30UL * 1000, 10UL * 60 * 1000};
+        case FailureClass::TLS:       return {60UL * 1000, 15UL * 60 * 1000};
+        case FailureClass::TRANSIENT: return {60UL * 1000, 15UL * 60 * 1000};   // Greylisting genelde 5 dk
+        case FailureClass::AUTH:      return {10UL * 60 * 1000, 60UL * 60 * 1000}; // Ayar kaydı uyandırır
+        case FailureClass::CONFIG:    return {10UL * 60 * 1000, 60UL * 60 * 1000};
+        case FailureClass::PERMANENT: return {15UL * 60 * 1000, 2UL * 60 * 60 * 1000};
+        default:                      return {60UL * 1000, 10UL * 60 * 1000};
+    }
+}
+
+}
+
+namespace RetryPolicy {
+
+uint32_t nextDelay(FailureClass failure, uint32_t previousDelayMs) {
+    Backoff backoff = backoffFor(failure);
+    uint32_t low = backoff.baseMs;
+    uint64_t high = max<uint64_t>((uint64_t)previousDelayMs * 3, low);
+    if (high > backoff.capMs) high = backoff.capMs;
+    if (high <= low) return low;
+    return low + (uint32_t)(esp_random() % (uint32_t)(high - low + 1));
+}
+
+FailureClass classifyReply(uint16_t code) {
+    if (code == 0) return FailureClass::NETWORK;
+    if (code == 530 || code == 534 || code == 535) return FailureClass::AUTH;
+    if (code >= 400 && code < 500) return FailureClass::TRANSIENT;
+    if (code >= 500) return FailureClass::PERMANENT;
+    return FailureClass::TRANSIENT; // Beklenmeyen ama hata sayılan yanıt
+}
+
+bool waitsForNetwork(FailureClass failure) {
+    return failure == FailureClass::NETWORK || failure == FailureClass::DNS;
+}
+
+bool waitsForConfig(FailureClass failure) {
+    return failure == FailureClass::AUTH || failure == FailureClass::CONFIG;
+}
+
+const char *name(FailureClass failure) {
+    switch (failure) {
+        case FailureClass::NONE:      return "none";
+        case FailureClass::NETWORK:   return "network";
+        case FailureClass::DNS:       return "dns";
+        case FailureClass::TLS:       return "tls";
+        case FailureClass::AUTH:      return "auth";
+        case FailureClass::TRANSIENT: return "4xx";
+        case FailureClass::PERMANENT: return "5xx";
+        case FailureClass::CONFIG:    return "config";
+    }
+    return "?";
+}
+
+}
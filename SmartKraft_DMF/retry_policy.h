@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================================
+// YENİDEN DENEME POLİTİKASI - Hata sınıfına göre üstel geri çekilme + jitter
+// ============================================================================
+// Eskiden her başarısız mail aşamasına göre sabit 60 / 300 / 600 saniye
+// bekliyordu; WiFi bir saniye sonra gelse bile süre dolmadan denenmiyordu.
+//
+// Artık bekleme süresi hatanın türüne göre seçilir ve "decorrelated jitter"
+// ile büyür:  gecikme = min(tavan, rastgele(taban, önceki × 3))
+// Böylece art arda hatalarda süre üstel artar, birden çok mail aynı anda
+// sunucuya yüklenmez.
+//
+// Yalnızca bağlantı bekleyen mailler (NETWORK / DNS) ağ geri geldiğinde,
+// ayar bekleyenler (AUTH / CONFIG) ayar kaydedildiğinde beklemeden
+// yeniden sıraya alınır.
+
+enum class FailureClass : uint8_t {
+    NONE = 0,
+    NETWORK,    // WiFi yok, TCP kurulamadı, yanıt gelmedi
+    DNS,        // Sunucu adı çözümlenemedi
+    TLS,        // TCP kuruldu, el sıkışma başarısız
+    AUTH,       // Kimlik doğrulama reddedildi (530/534/535)
+    TRANSIENT,  // 4xx (greylisting, hız sınırı, 421)
+    PERMANENT,  // 5xx (ileti/alıcı reddi) - mail yine de SİLİNMEZ, seyrek denenir
+    CONFIG      // SMTP ayarları eksik/desteklenmiyor
+};
+
+namespace RetryPolicy {
+    // Önceki gecikmeye göre sonraki bekleme (previousDelayMs = 0 → ilk hata)
+    uint32_t nextDelay(FailureClass failure, uint32_t previousDelayMs);
+
+    // SMTP yanıt koduna göre sınıf (0 = yanıt alınamadı)
+    FailureClass classifyReply(uint16_t code);
+
+    bool waitsForNetwork(FailureClass failure);
+    bool waitsForConfig(FailureClass failure);
+
+    const char *name(FailureClass failure);
+}
@@ -1,4 +1,5 @@
 #include "scheduler.h"
+#include "delivery_ledger.h"
 
 void CountdownScheduler::begin(ConfigStore *storePtr) {
     store = storePtr;
@@ -87,6 +88,11 @@ void CountdownScheduler::start() {
     runtime.nextAlarmIndex = 0;
     runtime.deadlineMillis = millis() + (uint64_t)totalDurationSeconds() * 1000ULL;
     runtime.remainingSeconds = totalDurationSeconds();
+    // Yeni geri sayım = yeni final döngüsü: önceki teslim kayıtları geçersiz
+    for (uint8_t i = 0; i < MAX_MAIL_GROUPS; ++i) {
+        runtime.finalGroupsSent[i] = false;
+    }
+    DeliveryLedger::clearAll();
     persist();
 }
 
@@ -191,6 +197,7 @@ void CountdownScheduler::acknowledgeFinal() {
     for (uint8_t i = 0; i < MAX_MAIL_GROUPS; ++i) {
         runtime.finalGroupsSent[i] = false;
     }
+    DeliveryLedger::clearAll(); // Alıcı bazlı teslim kayıtları da
     persist();
 }
 
@@ -0,0 +1,147 @@
+#include "smtp_data_writer.h"
+
+SmtpDataWriter::~SmtpDataWriter() {
+    free(buffer);
+}
+
+bool SmtpDataWriter::reserve() {
+    if (!buffer) {
+        buffer = static_cast<uint8_t *>(malloc(SMTP_WRITE_BUFFER_SIZE));
+    }
+    return buffer != nullptr;
+}
+
+void SmtpDataWriter::begin(Client &target) {
+    if (!reserve()) {
+        Serial.println(F("[SMTP] UYARI: Yazma tamponu ayrılamadı, tamponsuz devam"));
+    }
+    reset(target);
+    chunked = false;
+    offset = 0;
+}
+
+void SmtpDataWriter::beginChunked(Client &target, SmtpReplyReader &acks) {
+    reset(target);
+    chunked = buffer != nullptr;
+    offset = chunked ? SMTP_BDAT_HEADER_ROOM : 0;
+    replies = &acks;
+}
+
+void SmtpDataWriter::reset(Client &target) {
+    client = &target;
+    replies = nullptr;
+    used = 0;
+    lineStart = true;
+    error = false;
+    accepted = 0;
+    sent = 0;
+    calls = 0;
+    flushes = 0;
+    chunks = 0;
+    acked = 0;
+    rejectCode = 0;
+}
+
+size_t SmtpDataWriter::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t SmtpDataWriter::write(const uint8_t *data, size_t len) {
+    if (!client || error) return 0;
+    calls++;
+    accepted += len;
+
+    if (chunked) {
+        // BDAT içeriği olduğu gibi gider - satır başı noktası kaçışlanmaz
+        for (size_t done = 0; done < len && !error;) {
+            size_t room = SMTP_WRITE_BUFFER_SIZE - offset - used;
+            size_t chunk = len - done < room ? len - done : room;
+            memcpy(buffer + offset + used, data + done, chunk);
+            used += chunk;
+            done += chunk;
+            if (offset + used == SMTP_WRITE_BUFFER_SIZE) flush();
+        }
+        return error ? 0 : len;
+    }
+
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t c = data[i];
+        if (lineStart && c == '.') put('.');
+        put(c);
+        lineStart = (c == '\n');
+    }
+    return error ? 0 : len;
+}
+
+void SmtpDataWriter::put(uint8_t c) {
+    if (!buffer) {
+        sendRaw(&c, 1);
+        return;
+    }
+    buffer[used++] = c;
+    if (used == SMTP_WRITE_BUFFER_SIZE) flush();
+}
+
+void SmtpDataWriter::flush() {
+    if (!buffer || used == 0) return;
+    if (chunked) {
+        sendChunk(false);
+        return;
+    }
+    sendRaw(buffer, used);
+    used = 0;
+}
+
+void SmtpDataWriter::sendChunk(bool last) {
+    // Başlık, ayrılan baş kısma sağa yaslı yazılır → başlık + veri tek kayıt
+    char header[SMTP_BDAT_HEADER_ROOM];
+    int headerLength = snprintf(header, sizeof(header), "BDAT %u%s\r\n", (unsigned)used, last ? " LAST" : "");
+    uint8_t *start = buffer + offset - headerLength;
+    memcpy(start, header, headerLength);
+    sendRaw(start, headerLength + used);
+    used = 0;
+    chunks++;
+    // LAST bloğunun yanıtı mesajın sonucudur - endData okur. Burada boşaltılırsa
+    // hızlı sunucuda endData'ya okunacak yanıt kalmaz
+    if (last) return;
+
+    // Hazır alındıları beklemeden boşalt (sunucunun yanıt tamponu dolmasın)
+    SmtpReply reply;
+    while (!error && pendingAcks() > 0 && replies->read(reply, 0)) {
+        acknowledge(reply);
+    }
+}
+
+void SmtpDataWriter::acknowledge(const SmtpReply &reply) {
+    acked++;
+    if (reply.matches("250") || rejectCode) return;
+    rejectCode = reply.code;
+    error = true;
+    Serial.printf("[SMTP] ✗ BDAT reddedildi (%u/%u. blok): %u %s\n", (unsigned)acked, (unsigned)chunks, reply.code,
+                  reply.text.c_str());
+}
+
+void SmtpDataWriter::sendRaw(const uint8_t *data, size_t len) {
+    if (!client || error) return;
+    size_t written = client->write(data, len);
+    flushes++;
+    sent += written;
+    if (written != len) {
+        error = true;
+        Serial.printf("[SMTP] ✗ Soket yazımı eksik: %u/%u bayt\n", (unsigned)written, (unsigned)len);
+    }
+}
+
+bool SmtpDataWriter::finish() {
+    if (chunked) {
+        if (!error) sendChunk(true); // Boş da olsa "BDAT 0 LAST" mesajı kapatır
+        return !error;
+    }
+    // Sonlandırıcı dot-stuffing'e tabi değil - doğrudan tampona
+    static const char TERMINATOR[] = "\r\n.\r\n";
+    for (size_t i = 0; i < sizeof(TERMINATOR) - 1; ++i) {
+        put((uint8_t)TERMINATOR[i]);
+    }
+    flush();
+    return !error;
+}
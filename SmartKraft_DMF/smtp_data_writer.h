@@ -0,0 +1,89 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Client.h>
+#include "smtp_reply_reader.h"
+
+// ============================================================================
+// SMTP DATA YAZICISI - MIME çıktısını MSS boyutlu bloklarda birleştirir
+// ============================================================================
+// MIME üreticisi her başlık, sınır ve 76 karakterlik base64 satırı için ayrı
+// print() çağırır. Doğrudan WiFiClientSecure'a gitseydi her çağrı ayrı bir TLS
+// kaydı (+29 bayt başlık/MAC) ve çoğunlukla ayrı bir TCP segmenti olurdu.
+// Bu yazıcı çıktıyı tek segmente sığacak kadar biriktirip tek seferde yollar.
+//
+// Ayrıca RFC 5321 §4.5.2 "dot-stuffing" uygular: '.' ile başlayan satırların
+// başına ikinci bir '.' eklenir, böylece gövdedeki tek nokta satırı mesajı
+// erken sonlandırmaz.
+//
+// CHUNKING (RFC 3030) kipinde dot-stuffing/sonlandırıcı yoktur: her blok
+// "BDAT <n>\r\n" başlığıyla AYNI yazımda gider (başlık için tamponun başında
+// yer ayrılır), son blok "BDAT <n> LAST". Sunucunun blok başına 250 alındısı
+// beklenmez (PIPELINING); her bloktan sonra sokette hazır olanlar boşaltılır,
+// kalanlar endData'da tek beklemede okunur.
+
+// TCP MSS (1460) - TLS kayıt başlığı/MAC payı; bir kayıt = bir segment
+static const size_t SMTP_WRITE_BUFFER_SIZE = 1400;
+static const size_t SMTP_BDAT_HEADER_ROOM = 24; // "BDAT 1376 LAST\r\n" + pay
+
+class SmtpDataWriter : public Print {
+public:
+    ~SmtpDataWriter();
+
+    // Tamponu önceden ayır (BDAT tampon olmadan yapılamaz - false → DATA kullan)
+    bool reserve();
+
+    // DATA aşaması başında çağrılır - sayaçları sıfırlar
+    void begin(Client &target);
+    // BDAT kipi: alındılar 'acks' üzerinden okunur (reserve() başarılı olmalı)
+    void beginChunked(Client &target, SmtpReplyReader &acks);
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *data, size_t len) override;
+    using Print::write;
+
+    // Biriken veriyi gönder (tampon boşsa bir şey yapmaz)
+    void flush() override;
+
+    // "<CRLF>.<CRLF>" sonlandırıcıyı ekle (BDAT: "LAST" bloğu) ve kalan her şeyi gönder
+    bool finish();
+
+    // BDAT alındısını işle (250 değilse yazıcı durur; sonraki bloklar gönderilmez)
+    void acknowledge(const SmtpReply &reply);
+
+    bool failed() const { return error; }
+    bool chunkedMode() const { return chunked; }
+    uint32_t chunkCount() const { return chunks; }
+    uint32_t pendingAcks() const { return chunks - acked; }
+    uint16_t rejectedCode() const { return rejectCode; } // 0 = BDAT reddedilmedi
+
+    // Ölçümler (son DATA aşaması)
+    uint32_t payloadBytes() const { return accepted; }  // Üreticiden gelen
+    uint32_t wireBytes() const { return sent; }         // Dot-stuffing sonrası, sokete giden
+    uint32_t writeCalls() const { return calls; }       // Üreticinin yazma çağrısı (eski kayıt sayısı)
+    uint32_t flushCount() const { return flushes; }     // Gerçek soket yazımı (yeni kayıt sayısı)
+
+private:
+    Client *client = nullptr;
+    SmtpReplyReader *replies = nullptr;
+    uint8_t *buffer = nullptr; // İlk kullanımda heap'ten (görev yığınını şişirmemek için)
+    size_t offset = 0;         // BDAT: başlık için ayrılan baş kısım
+    size_t used = 0;
+    bool lineStart = true;
+    bool error = false;
+    bool chunked = false;
+
+    uint32_t chunks = 0;
+    uint32_t acked = 0;
+    uint16_t rejectCode = 0;
+
+    uint32_t accepted = 0;
+    uint32_t sent = 0;
+    uint32_t calls = 0;
+    uint32_t flushes = 0;
+
+    void reset(Client &target);
+    void put(uint8_t c);
+    void sendRaw(const uint8_t *data, size_t len);
+    void sendChunk(bool last);
+};
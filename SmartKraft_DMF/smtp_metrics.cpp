@@ -0,0 +1,93 @@
+#include "smtp_metrics.h"
+
+namespace {
+
+portMUX_TYPE metricsLock = portMUX_INITIALIZER_UNLOCKED;
+SmtpMetricsSnapshot metrics;
+
+// Kilit tutulurken çağrılır - yoksa en eski girdinin yerine açar
+SmtpServerMetrics &entryFor(const char *server) {
+    for (uint8_t i = 0; i < metrics.serverCount; ++i) {
+        if (strcmp(metrics.servers[i].server, server) == 0) return metrics.servers[i];
+    }
+
+    uint8_t slot = metrics.serverCount;
+    if (slot < SMTP_METRICS_SERVERS) {
+        metrics.serverCount++;
+    } else {
+        slot = 0;
+        for (uint8_t i = 1; i < SMTP_METRICS_SERVERS; ++i) {
+            if ((int32_t)(metrics.servers[i].lastSeen - metrics.servers[slot].lastSeen) < 0) slot = i;
+        }
+    }
+    SmtpServerMetrics &entry = metrics.servers[slot];
+    entry = SmtpServerMetrics();
+    strlcpy(entry.server, server, SMTP_METRICS_KEY_LEN);
+    return entry;
+}
+
+}
+
+void SmtpPhaseHistogram::add(uint32_t ms) {
+    count++;
+    totalMs += ms;
+    lastMs = ms;
+    if (ms > maxMs) maxMs = ms;
+
+    uint8_t bucket = 0;
+    while (bucket < SMTP_HISTOGRAM_BUCKETS - 1 && ms > SMTP_HISTOGRAM_BOUNDS_MS[bucket]) bucket++;
+    if (buckets[bucket] < UINT16_MAX) buckets[bucket]++;
+}
+
+namespace SmtpMetrics {
+
+void recordPhase(const char *server, SmtpPhase phase, uint32_t ms) {
+    if (phase >= SmtpPhase::COUNT) return;
+    portENTER_CRITICAL(&metricsLock);
+    SmtpServerMetrics &entry = entryFor(server);
+    entry.phases[static_cast<uint8_t>(phase)].add(ms);
+    entry.lastSeen = millis();
+    portEXIT_CRITICAL(&metricsLock);
+}
+
+void recordOutcome(const char *server, FailureClass outcome) {
+    uint8_t index = static_cast<uint8_t>(outcome);
+    if (index >= SMTP_OUTCOME_COUNT) return;
+    portENTER_CRITICAL(&metricsLock);
+    SmtpServerMetrics &entry = entryFor(server);
+    entry.attempts++;
+    entry.outcomes[index]++;
+    entry.lastOutcome = outcome;
+    entry.lastSeen = millis();
+    portEXIT_CRITICAL(&metricsLock);
+}
+
+SmtpMetricsSnapshot snapshot() {
+    portENTER_CRITICAL(&metricsLock);
+    SmtpMetricsSnapshot copy = metrics;
+    portEXIT_CRITICAL(&metricsLock);
+    return copy;
+}
+
+void reset() {
+    portENTER_CRITICAL(&metricsLock);
+    metrics = SmtpMetricsSnapshot();
+    portEXIT_CRITICAL(&metricsLock);
+}
+
+const char *phaseName(SmtpPhase phase) {
+    switch (phase) {
+        case SmtpPhase::DNS:      return "dns";
+        case SmtpPhase::TCP:      return "tcp";
+        case SmtpPhase::TLS:      return "tls";
+        case SmtpPhase::GREETING: return "greeting";
+        case SmtpPhase::AUTH:     return "auth";
+        case SmtpPhase::ENVELOPE: return "envelope";
+        case SmtpPhase::DATA:     return "data";
+        case SmtpPhase::QUIT:     return "quit";
+        case SmtpPhase::COUNT:    break;
+    }
+    return "?";
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Arduino.h>
+#include "retry_policy.h"
+
+// ============================================================================
+// SMTP TELEMETRİSİ - Sunucu başına aşama süreleri + sonuç sınıfları
+// ============================================================================
+// Gönderim başarısız olduğunda elimizde yalnızca Serial'daki serbest metin
+// ("Connection failed", "DATA komutu reddedildi") vardı; hangi adımın yavaş
+// ya da kırık olduğu sahada görülemiyordu.
+//
+// SmtpSession her aşamayı ölçüp buraya bildirir; her mesaj denemesi bir
+// FailureClass sonucuyla kapanır (NONE = teslim edildi). Sunucu (host:port)
+// başına aşama histogramları ve sonuç sayaçları tutulur, /api/metrics verir.
+//
+//   DNS       → DnsCache (önbellek isabetinde ~0 ms)
+//   TCP       → soket bağlantısı
+//   TLS       → el sıkışma (şifresizde ölçülmez)
+//   GREETING  → 220 selamlaması
+//   AUTH      → EHLO + AUTH
+//   ENVELOPE  → [RSET] MAIL FROM / RCPT TO / DATA-354 (PIPELINING'de tek bekleme)
+//   DATA      → içerik akışı + sunucunun son 250'si
+//   QUIT      → QUIT / 221
+//
+// Kova sınırları logaritmik: bir sitede TLS'in 4 s sürdüğü histogramda
+// doğrudan görünür. Bellek: 3 sunucu × ~400 bayt, sabit.
+
+enum class SmtpPhase : uint8_t {
+    DNS = 0,
+    TCP,
+    TLS,
+    GREETING,
+    AUTH,
+    ENVELOPE,
+    DATA,
+    QUIT,
+    COUNT
+};
+
+static const uint8_t SMTP_PHASE_COUNT = static_cast<uint8_t>(SmtpPhase::COUNT);
+static const uint8_t SMTP_METRICS_SERVERS = 3;  // En eski kullanılan atılır
+static const uint8_t SMTP_METRICS_KEY_LEN = 64; // "host:port"
+static const uint8_t SMTP_OUTCOME_COUNT = static_cast<uint8_t>(FailureClass::CONFIG) + 1;
+
+// Kova üst sınırları (ms); son kova "> 8000"
+static const uint8_t SMTP_HISTOGRAM_BUCKETS = 9;
+static const uint16_t SMTP_HISTOGRAM_BOUNDS_MS[SMTP_HISTOGRAM_BUCKETS - 1] = {50, 100, 250, 500, 1000, 2000, 4000, 8000};
+
+struct SmtpPhaseHistogram {
+    uint32_t count = 0;
+    uint32_t totalMs = 0;
+    uint32_t maxMs = 0;
+    uint32_t lastMs = 0;
+    uint16_t buckets[SMTP_HISTOGRAM_BUCKETS] = {};
+
+    void add(uint32_t ms);
+    uint32_t averageMs() const { return count ? totalMs / count : 0; }
+};
+
+struct SmtpServerMetrics {
+    char server[SMTP_METRICS_KEY_LEN] = {0};
+    uint32_t attempts = 0;                         // Sonuçlanan mesaj denemesi
+    uint32_t outcomes[SMTP_OUTCOME_COUNT] = {};    // FailureClass sırasıyla; [NONE] = başarılı
+    FailureClass lastOutcome = FailureClass::NONE;
+    uint32_t lastSeen = 0;                         // millis()
+    SmtpPhaseHistogram phases[SMTP_PHASE_COUNT];
+};
+
+struct SmtpMetricsSnapshot {
+    uint8_t serverCount = 0;
+    SmtpServerMetrics servers[SMTP_METRICS_SERVERS];
+};
+
+namespace SmtpMetrics {
+    void recordPhase(const char *server, SmtpPhase phase, uint32_t ms);
+    void recordOutcome(const char *server, FailureClass outcome);
+
+    SmtpMetricsSnapshot snapshot();
+    void reset();
+
+    const char *phaseName(SmtpPhase phase);
+}
@@ -0,0 +1,132 @@
+#include "smtp_reply_reader.h"
+
+namespace {
+
+bool startsWithWord(const char *text, const char *word) {
+    size_t len = strlen(word);
+    return strncasecmp(text, word, len) == 0 && (text[len] == '\0' || text[len] == ' ' || text[len] == '=');
+}
+
+}
+
+// ============================================================================
+// SmtpReply / SmtpCapabilities
+// ============================================================================
+
+bool SmtpReply::matches(const char *expect) const {
+    if (code == 0) return false;
+    char digits[6]; // uint16_t: en çok 5 hane
+    snprintf(digits, sizeof(digits), "%03u", code);
+    return strncmp(digits, expect, strlen(expect)) == 0;
+}
+
+void SmtpCapabilities::parseLine(const char *line) {
+    if (startsWithWord(line, "PIPELINING")) {
+        pipelining = true;
+    } else if (startsWithWord(line, "CHUNKING")) {
+        chunking = true;
+    } else if (startsWithWord(line, "8BITMIME")) {
+        eightBitMime = true;
+    } else if (startsWithWord(line, "SMTPUTF8")) {
+        smtpUtf8 = true;
+    } else if (startsWithWord(line, "SIZE")) {
+        size = true;
+        maxSize = line[4] ? strtoul(line + 5, nullptr, 10) : 0;
+    } else if (startsWithWord(line, "AUTH")) {
+        // "AUTH LOGIN PLAIN" veya eski sunucularda "AUTH=LOGIN PLAIN"
+        const char *cursor = line + 4;
+        while (*cursor) {
+            while (*cursor == ' ' || *cursor == '=') cursor++;
+            if (startsWithWord(cursor, "LOGIN")) authLogin = true;
+            else if (startsWithWord(cursor, "PLAIN")) authPlain = true;
+            else if (startsWithWord(cursor, "CRAM-MD5")) authCramMd5 = true;
+            else if (startsWithWord(cursor, "XOAUTH2")) authXoauth2 = true;
+            while (*cursor && *cursor != ' ') cursor++;
+        }
+    }
+}
+
+String SmtpCapabilities::summary() const {
+    String out;
+    if (pipelining) out += "PIPELINING ";
+    if (chunking) out += "CHUNKING ";
+    if (eightBitMime) out += "8BITMIME ";
+    if (smtpUtf8) out += "SMTPUTF8 ";
+    if (size) out += maxSize ? "SIZE=" + String(maxSize) + " " : String("SIZE ");
+    out += "AUTH:";
+    if (authLogin) out += " LOGIN";
+    if (authPlain) out += " PLAIN";
+    if (authCramMd5) out += " CRAM-MD5";
+    if (authXoauth2) out += " XOAUTH2";
+    return out;
+}
+
+// ============================================================================
+// SmtpReplyReader
+// ============================================================================
+
+void SmtpReplyReader::begin(Client &source) {
+    client = &source;
+    discard();
+}
+
+bool SmtpReplyReader::fill(uint32_t deadline) {
+    // Halka boşken çağrılır - başa sar, eldeki her şeyi tek seferde oku
+    head = tail = 0;
+    while (true) {
+        int available = client->available();
+        if (available > 0) {
+            size_t want = (size_t)available < SMTP_RING_SIZE ? (size_t)available : SMTP_RING_SIZE;
+            int got = client->read(ring, want);
+            if (got > 0) {
+                tail = (size_t)got;
+                return true;
+            }
+        } else if (!client->connected()) {
+            return false; // Kapandı ve okunacak veri yok - beklemeye gerek yok
+        }
+        if ((int32_t)(millis() - deadline) >= 0) return false;
+        delay(1); // Yalnızca veri yokken bekle (bayt başına değil)
+    }
+}
+
+bool SmtpReplyReader::readLine(uint32_t deadline) {
+    while (true) {
+        if (head == tail && !fill(deadline)) {
+            return false; // lineLength korunur - sonraki çağrı kaldığı yerden sürer
+        }
+        char c = (char)ring[head++];
+        if (c == '\n') break;
+        if (c != '\r' && lineLength + 1 < sizeof(line)) line[lineLength++] = c; // Taşan kısım kırpılır
+    }
+    line[lineLength] = '\0';
+    lineLength = 0;
+    return true;
+}
+
+bool SmtpReplyReader::read(SmtpReply &reply, uint32_t timeoutMs, SmtpCapabilities *caps) {
+    reply = SmtpReply();
+    if (!client) return false;
+
+    uint32_t deadline = millis() + timeoutMs;
+
+    while (readLine(deadline)) {
+        reply.lines++;
+        size_t len = strlen(line);
+        if (len < 3 || !isdigit((unsigned char)line[0]) || !isdigit((unsigned char)line[1]) || !isdigit((unsigned char)line[2])) {
+            continue; // Bozuk satır - yok say
+        }
+
+        const char *text = len > 4 ? line + 4 : "";
+        // EHLO'nun ilk satırı sunucu adıdır, anahtar kelime değil
+        if (caps && reply.lines > 1) caps->parseLine(text);
+
+        if (len == 3 || line[3] == ' ') {
+            reply.code = (uint16_t)((line[0] - '0') * 100 + (line[1] - '0') * 10 + (line[2] - '0'));
+            reply.text = text;
+            return true;
+        }
+        // line[3] == '-' → devam satırı
+    }
+    return false;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Client.h>
+
+// ============================================================================
+// SMTP YANIT OKUYUCU - Tamponlu, çok satırlı yanıt ayrıştırıcı
+// ============================================================================
+// Eski readLine() sokete bayt bayt bakıp her turda delay(1) uyuyordu; her
+// komut gidiş-dönüşüne yanıt uzunluğu kadar milisaniye ekleniyordu. Bu okuyucu
+// soketten eldeki tüm veriyi tek read() ile sabit bir halka tampona alır,
+// yalnızca tampon BOŞKEN bekler ve çok satırlı yanıtları ("250-..." devam,
+// "250 ..." son satır) tek bir kod + metne çevirir.
+//
+// EHLO yanıtı okunurken SmtpCapabilities doldurulur.
+//
+// Yarım kalan satır okuyucuda saklanır: read(reply, 0) beklemeden yalnızca
+// soketteki TAM yanıtları tüketir (BDAT alındıları akış sırasında boşaltılır).
+
+static const size_t SMTP_RING_SIZE = 256;
+static const size_t SMTP_MAX_LINE = 512; // RFC 5321 §4.5.3.1.5
+
+// Aşama başına süre sınırları (RFC 5321 §4.5.3.2 değerlerinin cihaz için kısaltılmışı)
+static const uint32_t SMTP_GREETING_TIMEOUT_MS = 15000;
+static const uint32_t SMTP_COMMAND_TIMEOUT_MS = 10000;  // EHLO / AUTH / MAIL / RCPT / RSET / DATA
+static const uint32_t SMTP_DATA_END_TIMEOUT_MS = 60000; // Sunucu ekleri tarıyor olabilir
+static const uint32_t SMTP_QUIT_TIMEOUT_MS = 2000;
+
+struct SmtpReply {
+    uint16_t code = 0;   // 0 → yanıt yok (zaman aşımı / bağlantı koptu)
+    String text;         // Son satırın metni (kod hariç)
+    uint8_t lines = 0;
+
+    // "25" → 250/251..., "354" → tam eşleşme
+    bool matches(const char *expect) const;
+    bool empty() const { return code == 0; }
+};
+
+struct SmtpCapabilities {
+    bool pipelining = false;
+    bool chunking = false;     // BDAT
+    bool eightBitMime = false;
+    bool smtpUtf8 = false;
+    bool size = false;         // SIZE (RFC 1870) - MAIL FROM'da boyut bildirilir
+    uint32_t maxSize = 0;      // SIZE parametresi, 0 → belirtilmemiş
+    bool authLogin = false;
+    bool authPlain = false;
+    bool authCramMd5 = false;
+    bool authXoauth2 = false;
+
+    void reset() { *this = SmtpCapabilities(); }
+    void parseLine(const char *keywordLine); // Kod sonrası "AUTH LOGIN PLAIN" gibi
+    String summary() const;
+};
+
+class SmtpReplyReader {
+public:
+    void begin(Client &source);
+
+    // Tam bir yanıtı 'timeoutMs' içinde oku; caps verilirse her satır ayrıştırılır.
+    // timeoutMs=0 → beklemeden (yanıt henüz tamamlanmadıysa false, yarım satır korunur)
+    bool read(SmtpReply &reply, uint32_t timeoutMs, SmtpCapabilities *caps = nullptr);
+
+    // Tamponda bekleyen (önceki yanıttan kalan) veriyi at
+    void discard() { head = tail = 0; lineLength = 0; }
+
+private:
+    Client *client = nullptr;
+    uint8_t ring[SMTP_RING_SIZE];
+    size_t head = 0; // Okunacak konum
+    size_t tail = 0; // Yazılacak konum (head == tail → boş)
+    char line[SMTP_MAX_LINE + 1];
+    size_t lineLength = 0; // Tamamlanmamış satır (sonraki read() devam eder)
+
+    bool fill(uint32_t deadline);
+    bool readLine(uint32_t deadline);
+};
@@ -0,0 +1,610 @@
+#include "smtp_session.h"
+#include "dns_cache.h"
+
+#include <WiFi.h>
+#include <base64.h>
+
+// ============================================================================
+// ROOT CA CERTIFICATES (SSL/TLS Sertifika Doğrulama)
+// ============================================================================
+
+// ISRG Root X1 - Let's Encrypt (ProtonMail kullanıyor)
+// Geçerlilik: 2015-06-04 → 2035-06-04 (20 YIL!)
+const char* ROOT_CA_ISRG_X1 = 
+"-----BEGIN CERTIFICATE-----\n"
+"MIIFazCCA1OgAwIBAgIRAIIQz7DSQONZRGPgu2OCiwAwDQYJKoZIhvcNAQELBQAw\n"
+"TzELMAkGA1UEBhMCVVMxKTAnBgNVBAoTIEludGVybmV0IFNlY3VyaXR5IFJlc2Vh\n"
+"cmNoIEdyb3VwMRUwEwYDVQQDEwxJU1JHIFJvb3QgWDEwHhcNMTUwNjA0MTEwNDM4\n"
+"WhcNMzUwNjA0MTEwNDM4WjBPMQswCQYDVQQGEwJVUzEpMCcGA1UEChMgSW50ZXJu\n"
+"ZXQgU2VjdXJpdHkgUmVzZWFyY2ggR3JvdXAxFTATBgNVBAMTDElTUkcgUm9vdCBY\n"
+"MTCCAiIwDQYJKoZIhvcNAQEBBQADggIPADCCAgoCggIBAK3oJHP0FDfzm54rVygc\n"
+"h77ct984kIxuPOZXoHj3dcKi/vVqbvYATyjb3miGbESTtrFj/RQSa78f0uoxmyF+\n"
+"0TM8ukj13Xnfs7j/EvEhmkvBioZxaUpmZmyPfjxwv60pIgbz5MDmgK7iS4+3mX6U\n"
+"A5/TR5d8mUgjU+g4rk8Kb4Mu0UlXjIB0ttov0DiNewNwIRt18jA8+o+u3dpjq+sW\n"
+"T8KOEUt+zwvo/7V3LvSye0rgTBIlDHCNAymg4VMk7BPZ7hm/ELNKjD+Jo2FR3qyH\n"
+"B5T0Y3HsLuJvW5iB4YlcNHlsdu87kGJ55tukmi8mxdAQ4Q7e2RCOFvu396j3x+UC\n"
+"B5iPNgiV5+I3lg02dZ77DnKxHZu8A/lJBdiB3QW0KtZB6awBdpUKD9jf1b0SHzUv\n"
+"KBds0pjBqAlkd25HN7rOrFleaJ1/ctaJxQZBKT5ZPt0m9STJEadao0xAH0ahmbWn\n"
+"OlFuhjuefXKnEgV4We0+UXgVCwOPjdAvBbI+e0ocS3MFEvzG6uBQE3xDk3SzynTn\n"
+"jh8BCNAw1FtxNrQHusEwMFxIt4I7mKZ9YIqioymCzLq9gwQbooMDQaHWBfEbwrbw\n"
+"qHyGO0aoSCqI3Haadr8faqU9GY/rOPNk3sgrDQoo//fb4hVC1CLQJ13hef4Y53CI\n"
+"rU7m2Ys6xt0nUW7/vGT1M0NPAgMBAAGjQjBAMA4GA1UdDwEB/wQEAwIBBjAPBgNV\n"
+"HRMBAf8EBTADAQH/MB0GA1UdDgQWBBR5tFnme7bl5AFzgAiIyBpY9umbbjANBgkq\n"
+"hkiG9w0BAQsFAAOCAgEAVR9YqbyyqFDQDLHYGmkgJykIrGF1XIpu+ILlaS/V9lZL\n"
+"ubhzEFnTIZd+50xx+7LSYK05qAvqFyFWhfFQDlnrzuBZ6brJFe+GnY+EgPbk6ZGQ\n"
+"3BebYhtF8GaV0nxvwuo77x/Py9auJ/GpsMiu/X1+mvoiBOv/2X/qkSsisRcOj/KK\n"
+"NFtY2PwByVS5uCbMiogziUwthDyC3+6WVwW6LLv3xLfHTjuCvjHIInNzktHCgKQ5\n"
+"ORAzI4JMPJ+GslWYHb4phowim57iaztXOoJwTdwJx4nLCgdNbOhdjsnvzqvHu7Ur\n"
+"TkXWStAmzOVyyghqpZXjFaH3pO3JLF+l+/+sKAIuvtd7u+Nxe5AW0wdeRlN8NwdC\n"
+"jNPElpzVmbUq4JUagEiuTDkHzsxHpFKVK7q4+63SM1N95R1NbdWhscdCb+ZAJzVc\n"
+"oyi3B43njTOQ5yOf+1CceWxG1bQVs5ZufpsMljq4Ui0/1lvh+wjChP4kqKOJ2qxq\n"
+"4RgqsahDYVvTH9w7jXbyLeiNdd8XM2w9U/t7y0Ff/9yi0GE44Za4rF2LN9d11TPA\n"
+"mRGunUHBcnWEvgJBQl9nJEiU0Zsnvgc/ubhPgXRR4Xq37Z0j4r7g1SgEEzwxA57d\n"
+"emyPxgcYxn/eR44/KJ4EBs+lVDR3veyJm+kXQ99b21/+jh5Xos1AnX5iItreGCc=\n"
+"-----END CERTIFICATE-----\n";
+
+// ============================================================================
+// ÖLÇÜM PENCERESİ
+// ============================================================================
+
+namespace {
+portMUX_TYPE benchLock = portMUX_INITIALIZER_UNLOCKED;
+bool benchActive = false;
+SmtpBenchReport benchReport;
+}
+
+void SmtpPhaseTimes::add(const SmtpPhaseTimes &other) {
+    connectMs += other.connectMs;
+    tlsMs += other.tlsMs;
+    authMs += other.authMs;
+    dataMs += other.dataMs;
+    wireBytes += other.wireBytes;
+    messages += other.messages;
+    roundTrips += other.roundTrips;
+}
+
+namespace SmtpBench {
+
+void start() {
+    portENTER_CRITICAL(&benchLock);
+    benchReport = SmtpBenchReport();
+    benchActive = true;
+    portEXIT_CRITICAL(&benchLock);
+}
+
+SmtpBenchReport stop() {
+    portENTER_CRITICAL(&benchLock);
+    benchActive = false;
+    SmtpBenchReport report = benchReport;
+    portEXIT_CRITICAL(&benchLock);
+    return report;
+}
+
+}
+
+// ============================================================================
+
+bool SmtpSession::plaintextAllowed(const String &server) {
+    IPAddress ip;
+    if (!ip.fromString(server)) return false; // Ad çözümlemesi yerel ağı garanti etmez
+    return ip[0] == 10 ||
+           (ip[0] == 172 && (ip[1] & 0xF0) == 16) ||
+           (ip[0] == 192 && ip[1] == 168);
+}
+
+bool SmtpSession::open(String &errorMessage) {
+    if (opened && client.connected()) {
+        return true;
+    }
+    if (opened) {
+        drop(); // Sunucu tarafı kapatmış
+    }
+
+    if (settings.smtpServer.length() == 0 || settings.username.length() == 0) {
+        errorMessage = "SMTP ayarları eksik";
+        failure = FailureClass::CONFIG;
+        return false;
+    }
+
+    uint32_t start = millis();
+    bool connected = connect(errorMessage);
+    uint32_t tlsMs = connected ? client.lastHandshakeMs() : 0;
+    phases.connectMs += millis() - start - tlsMs;
+    phases.tlsMs += tlsMs;
+    if (!connected) {
+        drop();
+        return false;
+    }
+    uint32_t authStart = millis();
+    bool authenticated = authenticate(errorMessage);
+    phases.authMs += millis() - authStart;
+    notePhase(SmtpPhase::AUTH, millis() - authStart);
+    if (!authenticated) {
+        drop();
+        return false;
+    }
+
+    handshakeMs = millis() - start;
+    handshakes++;
+    opened = true;
+    transactionDirty = false;
+    Serial.printf("[SMTP] Oturum açıldı (%lu ms, el sıkışma #%u)\n", (unsigned long)handshakeMs, handshakes);
+    return true;
+}
+
+bool SmtpSession::beginEnvelope(String &errorMessage, size_t messageSize) {
+    // Önceki deneme endData()'ya ulaşmadıysa başarısız olarak kapat
+    reportOutcome(failure == FailureClass::NONE ? FailureClass::NETWORK : failure);
+    attemptOpen = true;
+
+    SmtpReply reply;
+    lastCode = 0; // Bağlantı kurulamazsa "yanıt yok" olarak kalır
+    failure = FailureClass::NONE;
+    pipelined = false;
+
+    // En fazla bir şeffaf yeniden bağlanma
+    for (uint8_t attempt = 0; attempt < 2; ++attempt) {
+        if (attempt > 0) {
+            reconnects++;
+            Serial.println(F("[SMTP] Oturum düştü, yeniden bağlanılıyor"));
+        }
+
+        if (opened && !client.connected()) {
+            drop();
+        }
+        if (!opened && !open(errorMessage)) {
+            return false;
+        }
+        messageRoundTrips = 0;
+        envelopeStart = millis();
+
+        // SIZE (RFC 1870): sınırı aşan mesaj için ek akıtmaya hiç başlama
+        if (caps.maxSize && messageSize > caps.maxSize) {
+            failure = FailureClass::PERMANENT;
+            errorMessage = "Mesaj sunucu SIZE sınırını aşıyor: " + String(messageSize) + " > " + String(caps.maxSize);
+            return false;
+        }
+        String mailFrom = "MAIL FROM:<" + settings.username + ">";
+        if (caps.size && messageSize > 0) {
+            mailFrom += " SIZE=" + String(messageSize);
+        }
+        mailFrom += "\r\n";
+
+        if (caps.pipelining) {
+            // Zarf beginData()'da tek yazımda gider; hatalar orada raporlanır
+            pipelined = true;
+            envelopeRset = transactionDirty;
+            envelope = mailFrom;
+            envelopeRecipientCount = 0;
+            transactionDirty = true;
+            return true;
+        }
+
+        // Önceki mesajın zarfını sıfırla
+        if (transactionDirty) {
+            if (!command("RSET\r\n", "250", reply)) {
+                drop();
+                continue;
+            }
+            transactionDirty = false;
+        }
+
+        if (command(mailFrom, "250", reply)) {
+            transactionDirty = true;
+            return true;
+        }
+
+        if (isSessionLost(reply)) {
+            drop();
+            continue;
+        }
+
+        transactionDirty = true;
+        failure = RetryPolicy::classifyReply(reply.code);
+        errorMessage = "MAIL FROM reddedildi: " + String(reply.code) + " " + reply.text;
+        return false;
+    }
+
+    if (failure == FailureClass::NONE) failure = FailureClass::NETWORK; // RSET'te düştü
+    errorMessage = "SMTP oturumu yeniden kurulamadı";
+    return false;
+}
+
+bool SmtpSession::addRecipient(const String &recipient, String &errorMessage) {
+    if (pipelined) {
+        if (envelopeRecipientCount >= MAX_RECIPIENTS) {
+            failure = FailureClass::CONFIG;
+            errorMessage = "Zarfta çok fazla alıcı";
+            return false;
+        }
+        envelope += "RCPT TO:<" + recipient + ">\r\n";
+        envelopeRecipients[envelopeRecipientCount++] = recipient;
+        return true;
+    }
+
+    SmtpReply reply;
+    // 251 = "kullanıcı yerel değil, iletilecek" - kabul
+    if (command("RCPT TO:<" + recipient + ">\r\n", "25", reply)) {
+        return true;
+    }
+    if (isSessionLost(reply)) drop();
+    failure = RetryPolicy::classifyReply(reply.code);
+    errorMessage = "Alıcı reddedildi: " + recipient;
+    return false;
+}
+
+bool SmtpSession::beginData(String &errorMessage) {
+    if (pipelined) {
+        return flushEnvelope(errorMessage);
+    }
+
+    SmtpReply reply;
+    if (command("DATA\r\n", "354", reply)) {
+        writer.begin(client);
+        dataStart = millis();
+        notePhase(SmtpPhase::ENVELOPE, dataStart - envelopeStart);
+        return true;
+    }
+    if (isSessionLost(reply)) drop();
+    failure = RetryPolicy::classifyReply(reply.code);
+    errorMessage = "DATA komutu reddedildi";
+    return false;
+}
+
+bool SmtpSession::endData(String &errorMessage) {
+    // Sonlandırıcı (BDAT: "LAST" bloğu) son veri bloğuyla aynı kayıtta gider
+    bool chunked = writer.chunkedMode();
+    if (!writer.finish()) {
+        uint16_t rejected = writer.rejectedCode();
+        drop(); // BDAT ortasında red → sunucu kalan blokları atar, durum belirsiz
+        lastCode = rejected;
+        failure = rejected ? RetryPolicy::classifyReply(rejected) : FailureClass::NETWORK;
+        errorMessage = rejected ? "BDAT reddedildi: " + String(rejected) : "Mail gönderimi başarısız (bağlantı koptu)";
+        reportOutcome(failure);
+        return false;
+    }
+    dataMs = millis() - dataStart;
+    phases.dataMs += dataMs;
+    phases.wireBytes += writer.wireBytes();
+    Serial.printf("[SMTP] %s: %lu bayt → %lu bayt hatta, %lu yazma → %lu blok, %lu ms\n", chunked ? "BDAT" : "DATA",
+                  (unsigned long)writer.payloadBytes(), (unsigned long)writer.wireBytes(),
+                  (unsigned long)writer.writeCalls(), (unsigned long)writer.flushCount(), (unsigned long)dataMs);
+
+    SmtpReply reply;
+    roundTrip();
+    if (chunked) {
+        // Akış sırasında okunmamış alındılar; sonuncusu LAST bloğunun (mesajın) yanıtı
+        while (writer.pendingAcks() > 0 && reader.read(reply, SMTP_DATA_END_TIMEOUT_MS)) {
+            writer.acknowledge(reply);
+        }
+        if (writer.pendingAcks() > 0) {
+            reply = SmtpReply(); // Alındılar eksik - yanıt yok say
+        } else if (writer.rejectedCode()) {
+            reply.code = writer.rejectedCode();
+        }
+    } else {
+        reader.read(reply, SMTP_DATA_END_TIMEOUT_MS);
+    }
+    lastCode = reply.code;
+    Serial.printf("[SMTP] << %u %s\n", reply.code, reply.text.c_str());
+    notePhase(SmtpPhase::DATA, millis() - dataStart);
+    if (reply.matches("250")) {
+        reportOutcome(FailureClass::NONE);
+        messages++;
+        phases.messages++;
+        transactionDirty = false; // Başarılı DATA zarfı zaten sıfırlar
+        Serial.printf("[SMTP] Mesaj: %u gidiş-dönüş (%s%s)\n", messageRoundTrips,
+                      caps.pipelining ? "PIPELINING" : "sıralı",
+                      chunked ? " + BDAT" : "");
+        return true;
+    }
+    // DATA sonrası yanıt alınamadıysa protokol durumu belirsiz - oturumu bırak
+    if (isSessionLost(reply)) drop();
+    failure = RetryPolicy::classifyReply(reply.code);
+    errorMessage = "Mail gönderimi başarısız";
+    reportOutcome(failure);
+    return false;
+}
+
+void SmtpSession::close() {
+    reportOutcome(failure == FailureClass::NONE ? FailureClass::NETWORK : failure);
+    if (opened && client.connected()) {
+        SmtpReply reply;
+        uint32_t quitStart = millis();
+        client.print("QUIT\r\n");
+        reader.read(reply, SMTP_QUIT_TIMEOUT_MS);
+        notePhase(SmtpPhase::QUIT, millis() - quitStart);
+    }
+    if (opened) {
+        Serial.printf("[SMTP] Oturum kapatıldı (%u mesaj, %u el sıkışma, %u yeniden bağlanma)\n",
+                      messages, handshakes, reconnects);
+        Serial.printf("[SMTP] Aşamalar: bağlantı %lu ms, TLS %lu ms, AUTH %lu ms, DATA %lu ms, %lu bayt, %u gidiş-dönüş\n",
+                      (unsigned long)phases.connectMs, (unsigned long)phases.tlsMs, (unsigned long)phases.authMs,
+                      (unsigned long)phases.dataMs, (unsigned long)phases.wireBytes, phases.roundTrips);
+    }
+    drop();
+
+    // Başarısız bağlantı denemeleri de sayılır (oturum hiç açılmamış olabilir)
+    if (phases.connectMs || phases.messages) {
+        portENTER_CRITICAL(&benchLock);
+        if (benchActive) {
+            benchReport.sessions++;
+            benchReport.totals.add(phases);
+        }
+        portEXIT_CRITICAL(&benchLock);
+        phases = SmtpPhaseTimes();
+    }
+}
+
+void SmtpSession::drop() {
+    client.flush();
+    client.stop();
+    reader.discard();
+    opened = false;
+    transactionDirty = false;
+    yield(); // Memory cleanup için zaman tanı
+}
+
+bool SmtpSession::connect(String &errorMessage) {
+    if (WiFi.status() != WL_CONNECTED) {
+        errorMessage = "WiFi not connected";
+        failure = FailureClass::NETWORK;
+        return false;
+    }
+    
+    // ============================================
+    // WiFiClientSecure OPTIMIZATION
+    // ============================================
+    // NOT: setBufferSizes() ESP32 3.3.x'te mevcut değil
+    // Varsayılan buffer boyutları kullanılıyor
+    
+    if (!settings.smtpTls) {
+        if (!plaintextAllowed(settings.smtpServer)) {
+            errorMessage = "TLS'siz SMTP yalnızca yerel ağ IP adresine izinli";
+            failure = FailureClass::CONFIG;
+            return false;
+        }
+        client.setInsecure();
+        client.setPlaintext(true);
+    } else if (settings.smtpServer.indexOf("protonmail") >= 0 || 
+               settings.smtpServer.indexOf("proton.me") >= 0) {
+        client.setCACert(ROOT_CA_ISRG_X1);
+    } else {
+        client.setInsecure();
+    }
+    client.setTimeout(10); // 15 -> 10 saniye (daha hızlı timeout)
+    
+    if (settings.smtpTls && settings.smtpPort == 587) {
+        errorMessage = "Port 587 not supported. Use port 465";
+        failure = FailureClass::CONFIG;
+        return false;
+    }
+    
+    IPAddress serverIP;
+    uint32_t dnsStart = millis();
+    bool resolved = DnsCache::resolve(settings.smtpServer.c_str(), serverIP); // connect() aynı girdiyi kullanır
+    notePhase(SmtpPhase::DNS, millis() - dnsStart);
+    if (!resolved) {
+        errorMessage = "DNS failed: " + settings.smtpServer;
+        failure = FailureClass::DNS;
+        return false;
+    }
+    
+    bool connected = client.connect(settings.smtpServer.c_str(), settings.smtpPort);
+    if (client.lastTcpConnected()) {
+        notePhase(SmtpPhase::TCP, client.lastTcpMs());
+    }
+    if (!connected) {
+        errorMessage = "Connection failed";
+        failure = client.lastTcpConnected() ? FailureClass::TLS : FailureClass::NETWORK;
+        return false;
+    }
+    if (settings.smtpTls) {
+        notePhase(SmtpPhase::TLS, client.lastHandshakeMs());
+    }
+    
+    reader.begin(client);
+    SmtpReply reply;
+    roundTrip();
+    uint32_t greetingStart = millis();
+    bool greeted = reader.read(reply, SMTP_GREETING_TIMEOUT_MS);
+    notePhase(SmtpPhase::GREETING, millis() - greetingStart);
+    if (!greeted || !reply.matches("220")) {
+        errorMessage = "Server greeting failed";
+        failure = RetryPolicy::classifyReply(reply.code);
+        return false;
+    }
+    
+    return true;
+}
+
+bool SmtpSession::authenticate(String &errorMessage) {
+    SmtpReply reply;
+    caps.reset();
+    client.print("EHLO " + String(WiFi.getHostname()) + "\r\n");
+    roundTrip();
+    if (!reader.read(reply, SMTP_COMMAND_TIMEOUT_MS, &caps) || !reply.matches("250")) {
+        errorMessage = "EHLO reddedildi";
+        failure = RetryPolicy::classifyReply(reply.code);
+        return false;
+    }
+    Serial.printf("[SMTP] Yetenekler: %s\n", caps.summary().c_str());
+    
+    if (caps.authPlain) {
+        // Tek gidiş-dönüş: base64("\0kullanıcı\0şifre")
+        size_t userLen = settings.username.length();
+        size_t passLen = settings.password.length();
+        size_t rawLen = userLen + passLen + 2;
+        uint8_t *raw = static_cast<uint8_t *>(malloc(rawLen));
+        if (!raw) {
+            errorMessage = "Bellek yetersiz";
+            failure = FailureClass::TRANSIENT;
+            return false;
+        }
+        raw[0] = '\0';
+        memcpy(raw + 1, settings.username.c_str(), userLen);
+        raw[userLen + 1] = '\0';
+        memcpy(raw + userLen + 2, settings.password.c_str(), passLen);
+        String token = base64::encode(raw, rawLen);
+        memset(raw, 0, rawLen);
+        free(raw);
+        
+        if (!command("AUTH PLAIN " + token + "\r\n", "235", reply, false)) {
+            errorMessage = "Kimlik doğrulama başarısız - Şifre yanlış";
+            failure = authFailure(reply);
+            return false;
+        }
+        return true;
+    }
+    
+    if (!caps.authLogin) {
+        errorMessage = "SMTP AUTH desteklenmiyor";
+        failure = FailureClass::CONFIG;
+        return false;
+    }
+    
+    if (!command("AUTH LOGIN\r\n", "334", reply)) {
+        errorMessage = "AUTH LOGIN reddedildi";
+        failure = authFailure(reply);
+        return false;
+    }
+    
+    if (!command(base64::encode(settings.username) + "\r\n", "334", reply, false)) {
+        errorMessage = "Kullanıcı adı reddedildi";
+        failure = authFailure(reply);
+        return false;
+    }
+    
+    if (!command(base64::encode(settings.password) + "\r\n", "235", reply, false)) {
+        errorMessage = "Kimlik doğrulama başarısız - Şifre yanlış";
+        failure = authFailure(reply);
+        return false;
+    }
+    
+    return true;
+}
+
+bool SmtpSession::command(const String &line, const char *expectCode, SmtpReply &reply, bool logReply) {
+    client.print(line);
+    roundTrip();
+    readReply(reply, SMTP_COMMAND_TIMEOUT_MS, logReply);
+    return reply.matches(expectCode);
+}
+
+void SmtpSession::readReply(SmtpReply &reply, uint32_t timeoutMs, bool logReply) {
+    reader.read(reply, timeoutMs);
+    lastCode = reply.code;
+    if (logReply) {
+        Serial.printf("[SMTP] << %u %s\n", reply.code, reply.text.c_str());
+    }
+}
+
+bool SmtpSession::flushEnvelope(String &errorMessage) {
+    pipelined = false;
+    // BDAT yalnızca PIPELINING ile: aksi halde her blok bir gidiş-dönüş olurdu
+    bool chunking = caps.chunking && writer.reserve();
+    String batch = envelope;
+    if (!chunking) batch += "DATA\r\n";
+
+    // En fazla bir şeffaf yeniden bağlanma (sunucu boştaki oturumu kapatmış olabilir)
+    for (uint8_t attempt = 0; attempt < 2; ++attempt) {
+        if (attempt > 0) {
+            reconnects++;
+            Serial.println(F("[SMTP] Oturum düştü, yeniden bağlanılıyor"));
+            drop();
+            if (!open(errorMessage)) return false;
+            envelopeRset = false;
+        }
+
+        // Tek yazım → tek TLS kaydı / TCP segmenti
+        client.print(envelopeRset ? "RSET\r\n" + batch : batch);
+        transactionDirty = true;
+        roundTrip();
+
+        SmtpReply reply;
+        if (envelopeRset) {
+            readReply(reply, SMTP_COMMAND_TIMEOUT_MS);
+            if (!reply.matches("250")) continue; // Eski yol gibi: RSET başarısız → yeniden bağlan
+        }
+
+        SmtpReply mailReply;
+        readReply(mailReply, SMTP_COMMAND_TIMEOUT_MS);
+        if (isSessionLost(mailReply)) continue;
+
+        // Tüm yanıtlar okunmalı - biri atlanırsa sonraki komutun yanıtıyla karışır
+        bool lost = false;
+        String rejected;
+        uint16_t rejectedCode = 0;
+        for (uint8_t i = 0; i < envelopeRecipientCount && !lost; ++i) {
+            readReply(reply, SMTP_COMMAND_TIMEOUT_MS);
+            lost = reply.empty();
+            if (!lost && !reply.matches("25") && rejected.length() == 0) {
+                rejected = envelopeRecipients[i];
+                rejectedCode = reply.code;
+            }
+        }
+        SmtpReply dataReply;
+        if (!lost && !chunking) {
+            readReply(dataReply, SMTP_COMMAND_TIMEOUT_MS);
+            lost = dataReply.empty();
+        }
+        if (lost) {
+            drop();
+            failure = FailureClass::NETWORK;
+            errorMessage = "Zarf yanıtları alınamadı";
+            return false;
+        }
+
+        bool dataReady = chunking || dataReply.matches("354");
+        if (mailReply.matches("250") && rejected.length() == 0 && dataReady) {
+            if (chunking) {
+                writer.beginChunked(client, reader);
+            } else {
+                writer.begin(client);
+            }
+            dataStart = millis();
+            notePhase(SmtpPhase::ENVELOPE, dataStart - envelopeStart);
+            return true;
+        }
+
+        if (dataReply.matches("354")) {
+            // Sunucu içerik bekliyor ama zarf eksik - kısmi teslim yerine bağlantıyı bırak
+            drop();
+        }
+        if (!mailReply.matches("250")) {
+            failure = RetryPolicy::classifyReply(mailReply.code);
+            errorMessage = "MAIL FROM reddedildi: " + String(mailReply.code) + " " + mailReply.text;
+        } else if (rejected.length()) {
+            failure = RetryPolicy::classifyReply(rejectedCode);
+            errorMessage = "Alıcı reddedildi: " + rejected;
+        } else {
+            failure = RetryPolicy::classifyReply(dataReply.code);
+            errorMessage = "DATA komutu reddedildi";
+        }
+        return false;
+    }
+
+    if (failure == FailureClass::NONE) failure = FailureClass::NETWORK;
+    errorMessage = "SMTP oturumu yeniden kurulamadı";
+    return false;
+}
+
+void SmtpSession::reportOutcome(FailureClass outcome) {
+    if (!attemptOpen) return;
+    attemptOpen = false;
+    SmtpMetrics::recordOutcome(serverKey.c_str(), outcome);
+    if (outcome != FailureClass::NONE) {
+        Serial.printf("[SMTP] ✗ Deneme sonucu: %s (%s)\n", RetryPolicy::name(outcome), serverKey.c_str());
+    }
+}
+
+FailureClass SmtpSession::authFailure(const SmtpReply &reply) {
+    // Kimlik adımında 5xx = bilgiler reddedildi; yanıt yok / 4xx geçici
+    FailureClass replyClass = RetryPolicy::classifyReply(reply.code);
+    return replyClass == FailureClass::PERMANENT ? FailureClass::AUTH : replyClass;
+}
+
+bool SmtpSession::isSessionLost(const SmtpReply &reply) {
+    // Yanıt yok (timeout/bağlantı koptu) veya 421 "service not available"
+    return reply.empty() || reply.code == 421;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <Arduino.h>
+#include "tls_session_cache.h"
+#include "smtp_data_writer.h"
+#include "smtp_reply_reader.h"
+#include "retry_policy.h"
+#include "config_store.h"
+#include "smtp_metrics.h"
+
+// ============================================================================
+// SMTP OTURUMU - Bir kez bağlan/doğrula, birden fazla mesaj gönder
+// ============================================================================
+// Her mesaj için DNS + TCP + TLS + EHLO/AUTH tekrarlamak yerine tek oturum
+// açık tutulur; mesajlar arasında RSET ile zarf sıfırlanır. Her mesajın kendi
+// zarfı (MAIL FROM / RCPT TO) olduğu için alıcılar birbirini görmez (privacy).
+//
+// Kullanım:
+//   SmtpSession session(settings);
+//   session.beginEnvelope(err, tahminiBoyut) → addRecipient(...) → beginData(err)
+//   → session.stream()'e MIME yaz → endData(err)
+//
+// ESMTP uzantıları (EHLO yanıtından):
+//   SIZE       → MAIL FROM'a "SIZE=<n>"; tahmin sunucu sınırını aşıyorsa hiçbir
+//                komut gönderilmeden kalıcı hata (ek boşuna yüklenmez)
+//   PIPELINING → [RSET] MAIL FROM, RCPT TO..., DATA tek yazımda gider, yanıtlar
+//                beginData()'da sırayla okunur: 3+n yerine 1 gidiş-dönüş
+//   CHUNKING   → (yalnızca PIPELINING ile) DATA/354 yerine BDAT blokları,
+//                dot-stuffing yok, blok alındıları beklenmez
+// Desteklemeyen sunucuda eski sıralı diyalog aynen kullanılır.
+//
+// stream() doğrudan sokete değil SmtpDataWriter'a yazar: küçük print()'ler
+// MSS boyutlu bloklarda birleştirilir ve dot-stuffing uygulanır.
+//
+// Sunucu oturumu kapatırsa (421 / yanıt yok / bağlantı düştü) beginEnvelope()
+// bir kez şeffaf olarak yeniden bağlanır.
+//
+// settings.smtpTls=false → TLS'siz düz TCP. Kimlik bilgisi açık gittiği için
+// yalnızca yerel ağ IP'sindeki test sunucusuna izin verilir (tools/smtp_sink.py).
+//
+// Her aşama süresi ve her mesaj denemesinin sonuç sınıfı SmtpMetrics'e
+// (sunucu başına histogram, /api/metrics) bildirilir. Bir deneme endData()
+// ile ya da yarıda kalırsa sonraki beginEnvelope()/close() ile kapanır.
+
+// Oturum boyunca aşama süreleri (yeniden bağlanmalar dahil toplam)
+struct SmtpPhaseTimes {
+    uint32_t connectMs = 0;   // DNS + TCP + 220 selamlaması
+    uint32_t tlsMs = 0;       // El sıkışma (şifresizde 0)
+    uint32_t authMs = 0;      // EHLO + AUTH
+    uint32_t dataMs = 0;      // DATA içeriği + sonlandırıcı (250 beklenmeden)
+    uint32_t wireBytes = 0;   // DATA'da hatta giden bayt
+    uint16_t messages = 0;
+    uint16_t roundTrips = 0;  // Yanıt için bloklanan bekleme (selamlama + EHLO + AUTH dahil)
+
+    void add(const SmtpPhaseTimes &other);
+};
+
+// Ölçüm penceresi (seri "bench" komutu): start() ile stop() arasında kapanan
+// tüm oturumların aşama süreleri toplanır - paralel final çalışanları dahil
+struct SmtpBenchReport {
+    uint16_t sessions = 0;
+    SmtpPhaseTimes totals;
+};
+
+namespace SmtpBench {
+    void start();
+    SmtpBenchReport stop();
+}
+
+class SmtpSession {
+public:
+    explicit SmtpSession(const MailSettings &settings)
+        : settings(settings), serverKey(settings.smtpServer + ":" + String(settings.smtpPort)) {}
+    ~SmtpSession() { close(); }
+
+    SmtpSession(const SmtpSession &) = delete;
+    SmtpSession &operator=(const SmtpSession &) = delete;
+
+    // Bağlan + selamlama + EHLO + AUTH LOGIN (zaten açıksa bir şey yapmaz)
+    bool open(String &errorMessage);
+
+    // Yeni zarf: gerekirse RSET, ardından MAIL FROM (messageSize: SIZE için tahmin, 0 = bildirme)
+    bool beginEnvelope(String &errorMessage, size_t messageSize = 0);
+    bool addRecipient(const String &recipient, String &errorMessage);
+    bool beginData(String &errorMessage);
+
+    // DATA içeriği buraya yazılır (beginData sonrası, tamponlu)
+    Print &stream() { return writer; }
+
+    // "<CRLF>.<CRLF>" gönder ve 250 bekle
+    bool endData(String &errorMessage);
+
+    // QUIT + bağlantıyı kapat
+    void close();
+
+    bool isOpen() const { return opened; }
+
+    // Şifresiz SMTP'ye izin verilen sunucu: özel IPv4 adresi (10/8, 172.16/12, 192.168/16)
+    static bool plaintextAllowed(const String &server);
+
+    // İstatistikler (log / ölçüm için)
+    uint16_t handshakeCount() const { return handshakes; }
+    uint16_t reconnectCount() const { return reconnects; }
+    uint16_t messageCount() const { return messages; }
+    uint32_t lastHandshakeMs() const { return handshakeMs; }
+    const SmtpDataWriter &lastData() const { return writer; }
+    uint32_t lastDataMs() const { return dataMs; }
+    uint16_t lastReplyCode() const { return lastCode; } // 0 = yanıt alınamadı
+    uint16_t lastRoundTrips() const { return messageRoundTrips; } // Son mesajın zarf + DATA beklemeleri
+    FailureClass failureClass() const { return failure; } // Son başarısız adımın sınıfı
+    void noteFailure(FailureClass cls) { failure = cls; }  // Oturum öncesi hata (çağıran tarafta)
+
+    // Son EHLO yanıtından (oturum açıkken geçerli)
+    const SmtpCapabilities &capabilities() const { return caps; }
+    const SmtpPhaseTimes &phaseTimes() const { return phases; }
+
+private:
+    const MailSettings &settings;
+    String serverKey; // Telemetri anahtarı "host:port"
+    CachedTlsClient client;
+    SmtpDataWriter writer;
+    SmtpReplyReader reader;
+    SmtpCapabilities caps;
+    bool opened = false;
+    bool transactionDirty = false; // MAIL FROM gönderildi, sonraki zarftan önce RSET gerekli
+
+    uint16_t handshakes = 0;
+    uint16_t reconnects = 0;
+    uint16_t messages = 0;
+    uint32_t handshakeMs = 0;
+    uint32_t dataStart = 0;
+    uint32_t dataMs = 0;
+    uint16_t lastCode = 0;
+    FailureClass failure = FailureClass::NONE;
+    SmtpPhaseTimes phases;
+    uint16_t messageRoundTrips = 0;
+    bool attemptOpen = false;   // Sonucu henüz bildirilmemiş mesaj denemesi
+    uint32_t envelopeStart = 0;
+
+    // PIPELINING: beginData()'ya kadar biriken zarf
+    bool pipelined = false;
+    bool envelopeRset = false;
+    String envelope; // MAIL FROM + RCPT TO satırları
+    String envelopeRecipients[MAX_RECIPIENTS];
+    uint8_t envelopeRecipientCount = 0;
+
+    bool connect(String &errorMessage);
+    bool authenticate(String &errorMessage);
+    void drop(); // QUIT göndermeden bağlantıyı bırak (protokol durumu belirsiz)
+
+    bool flushEnvelope(String &errorMessage);
+
+    // logReply=false → kimlik bilgisi adımları (yanıt loglanmaz)
+    bool command(const String &line, const char *expectCode, SmtpReply &reply, bool logReply = true);
+    void readReply(SmtpReply &reply, uint32_t timeoutMs, bool logReply = true);
+    void roundTrip() { phases.roundTrips++; messageRoundTrips++; }
+    void notePhase(SmtpPhase phase, uint32_t ms) { SmtpMetrics::recordPhase(serverKey.c_str(), phase, ms); }
+    void reportOutcome(FailureClass outcome);
+    static bool isSessionLost(const SmtpReply &reply);
+    static FailureClass authFailure(const SmtpReply &reply);
+};
@@ -21,5 +21,13 @@ void TestInterface::processSerial() {
         String error;
         ScheduleSnapshot snap = scheduler->snapshot();
         mail->sendWarning(snap.nextAlarmIndex, snap, error);
+    } else if (command.startsWith("bench")) {
+        // bench warning [n] | bench final [n]
+        bool finalDispatch = command.indexOf("final") > 0;
+        int space = command.lastIndexOf(' ');
+        int rounds = space > 0 ? command.substring(space + 1).toInt() : 0;
+        String report;
+        bool ok = mail->runBenchmark(finalDispatch, constrain(rounds, 1, 20), report);
+        Serial.printf("[Bench] %s %s\n", ok ? "✓" : "✗", report.c_str());
     }
 }
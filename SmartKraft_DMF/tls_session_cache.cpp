@@ -0,0 +1,330 @@
+#include "tls_session_cache.h"
+#include "dns_cache.h"
+
+#include <esp_system.h>
+#include <mbedtls/ssl.h>
+
+// mbedTLS 3.x yapı alanlarını MBEDTLS_PRIVATE() ile gizler; 2.x'te makro yok
+#ifndef MBEDTLS_PRIVATE
+#define MBEDTLS_PRIVATE(member) member
+#endif
+
+namespace {
+
+struct CacheEntry {
+    char key[TLS_SESSION_KEY_LEN] = {0};
+    mbedtls_ssl_session session;
+    bool valid = false;
+    uint32_t storedAt = 0;
+    uint32_t lastUsed = 0;
+};
+
+CacheEntry entries[TLS_SESSION_CACHE_SIZE];
+TlsHandshakeStats counters;
+SemaphoreHandle_t cacheLock = nullptr;
+bool initialized = false;
+
+// ===== RTC KALICILIĞI =====
+// Serileştirilmiş oturum, sunucu sertifikasını da içerebilir (~1.5KB)
+constexpr uint8_t RTC_SLOT_COUNT = 2;
+constexpr size_t RTC_SLOT_BYTES = 2048;
+constexpr uint32_t RTC_MAGIC = 0x544C5331; // "TLS1"
+
+struct RtcSlot {
+    char key[TLS_SESSION_KEY_LEN];
+    uint16_t length;
+    uint8_t data[RTC_SLOT_BYTES];
+};
+
+// Ham bayt olarak tutulur: TlsHandshakeStats'in varsayılan değerleri olduğu için
+// doğrudan üye olsaydı statik ilklendirme her açılışta RTC içeriğini sıfırlardı
+struct RtcStore {
+    uint32_t magic;
+    uint32_t checksum;
+    uint8_t stats[sizeof(TlsHandshakeStats)];
+    RtcSlot slots[RTC_SLOT_COUNT];
+};
+
+RTC_NOINIT_ATTR RtcStore rtcStore;
+
+uint32_t rtcChecksum() {
+    // FNV-1a - magic/checksum alanları hariç
+    const uint8_t *bytes = rtcStore.stats;
+    size_t len = sizeof(RtcStore) - offsetof(RtcStore, stats);
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+void lock() {
+    if (!cacheLock) cacheLock = xSemaphoreCreateMutex();
+    xSemaphoreTake(cacheLock, portMAX_DELAY);
+}
+
+void unlock() {
+    xSemaphoreGive(cacheLock);
+}
+
+void ensureInitialized() {
+    if (initialized) return;
+    for (auto &entry : entries) {
+        mbedtls_ssl_session_init(&entry.session);
+    }
+    initialized = true;
+}
+
+void releaseEntry(CacheEntry &entry) {
+    mbedtls_ssl_session_free(&entry.session);
+    mbedtls_ssl_session_init(&entry.session);
+    entry.valid = false;
+    entry.key[0] = '\0';
+}
+
+CacheEntry *findEntry(const char *key) {
+    for (auto &entry : entries) {
+        if (entry.valid && strcmp(entry.key, key) == 0) {
+            if (millis() - entry.storedAt > TLS_SESSION_TTL_MS) {
+                releaseEntry(entry);
+                return nullptr;
+            }
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+CacheEntry &slotFor(const char *key) {
+    // Aynı anahtar → üzerine yaz, yoksa boş girdi, yoksa en eski kullanılan (LRU)
+    CacheEntry *victim = nullptr;
+    for (auto &entry : entries) {
+        if (entry.valid && strcmp(entry.key, key) == 0) return entry;
+        if (!entry.valid && !victim) victim = &entry;
+    }
+    if (victim) return *victim;
+    victim = &entries[0];
+    for (auto &entry : entries) {
+        if (entry.lastUsed < victim->lastUsed) victim = &entry;
+    }
+    return *victim;
+}
+
+// Kilit tutulurken çağrılır - en son kullanılan girdileri RTC'ye yaz
+void persistToRtc() {
+    memset(rtcStore.slots, 0, sizeof(rtcStore.slots));
+    memcpy(rtcStore.stats, &counters, sizeof(counters));
+
+    // En yeni kullanılanlardan başla
+    bool taken[TLS_SESSION_CACHE_SIZE] = {false};
+    for (uint8_t slot = 0; slot < RTC_SLOT_COUNT; ++slot) {
+        int best = -1;
+        for (uint8_t i = 0; i < TLS_SESSION_CACHE_SIZE; ++i) {
+            if (!entries[i].valid || taken[i]) continue;
+            if (best < 0 || entries[i].lastUsed > entries[best].lastUsed) best = i;
+        }
+        if (best < 0) break;
+        taken[best] = true;
+
+        size_t written = 0;
+        if (mbedtls_ssl_session_save(&entries[best].session, rtcStore.slots[slot].data, RTC_SLOT_BYTES, &written) != 0) {
+            // Slot'a sığmadı (büyük sertifika) - sadece RAM'de kalır
+            continue;
+        }
+        strlcpy(rtcStore.slots[slot].key, entries[best].key, TLS_SESSION_KEY_LEN);
+        rtcStore.slots[slot].length = (uint16_t)written;
+    }
+
+    rtcStore.magic = RTC_MAGIC;
+    rtcStore.checksum = rtcChecksum();
+}
+
+void makeKey(char *out, const char *host, uint16_t port) {
+    snprintf(out, TLS_SESSION_KEY_LEN, "%s:%u", host, port);
+}
+
+bool sameSessionId(const mbedtls_ssl_session &a, const mbedtls_ssl_session &b) {
+    size_t len = a.MBEDTLS_PRIVATE(id_len);
+    return len > 0 && len == b.MBEDTLS_PRIVATE(id_len) &&
+           memcmp(a.MBEDTLS_PRIVATE(id), b.MBEDTLS_PRIVATE(id), len) == 0;
+}
+
+}
+
+// ============================================================================
+// CachedTlsClient
+// ============================================================================
+
+int CachedTlsClient::connect(const char *host, uint16_t port) {
+    if (connecting) return WiFiClientSecure::connect(host, port);
+    return connectResumable(host, port, -1);
+}
+
+int CachedTlsClient::connect(const char *host, uint16_t port, int32_t timeout) {
+    if (connecting) return WiFiClientSecure::connect(host, port, timeout);
+    return connectResumable(host, port, timeout);
+}
+
+int CachedTlsClient::connectResumable(const char *host, uint16_t port, int32_t timeout) {
+    resumed = false;
+    tcpConnected = false;
+    tcpMs = 0;
+    tlsMs = 0;
+
+    // 1. Ad önbellekten çözülür - üst sınıfın connect(host) yolu her seferinde yeniden sorardı
+    IPAddress address;
+    if (!DnsCache::resolve(host, address)) return 0;
+
+    // 2. Sadece TCP (TLS bağlamı hazırlanır ama el sıkışma ertelenir); ad SNI için gider
+    uint32_t start = millis();
+    setPlainStart();
+    if (timeout >= 0) _timeout = timeout;
+    connecting = true;
+    int ok = WiFiClientSecure::connect(address, port, host, _CA_cert, _cert, _private_key);
+    connecting = false;
+    if (!ok) return 0;
+    tcpConnected = true;
+    tcpMs = millis() - start;
+
+    // Düz metin: startTLS() çağrılmadığı sürece okuma/yazma doğrudan sokete gider
+    if (plaintext) {
+        Serial.printf("[TLS] %s:%u: TCP %lu ms (şifresiz)\n", host, port, (unsigned long)tcpMs);
+        return 1;
+    }
+
+    char key[TLS_SESSION_KEY_LEN];
+    makeKey(key, host, port);
+    mbedtls_ssl_context *ssl = &sslclient->ssl_ctx;
+
+    // 3. Önbellekte oturum varsa el sıkışmadan önce sun
+    mbedtls_ssl_session offeredSession;
+    mbedtls_ssl_session_init(&offeredSession);
+    bool offered = false;
+
+    lock();
+    ensureInitialized();
+    CacheEntry *entry = findEntry(key);
+    if (entry && mbedtls_ssl_set_session(ssl, &entry->session) == 0) {
+        // Sonradan karşılaştırmak için kimliği kopyala (sadece id alanları kullanılır)
+        offeredSession.MBEDTLS_PRIVATE(id_len) = entry->session.MBEDTLS_PRIVATE(id_len);
+        memcpy(offeredSession.MBEDTLS_PRIVATE(id), entry->session.MBEDTLS_PRIVATE(id), sizeof(offeredSession.MBEDTLS_PRIVATE(id)));
+        entry->lastUsed = millis();
+        counters.offered++;
+        offered = true;
+    }
+    unlock();
+
+    // 4. El sıkışma
+    start = millis();
+    if (!startTLS()) {
+        lock();
+        counters.failures++;
+        // Sunulan oturum sorun çıkarmış olabilir - bir dahaki sefere tam el sıkışma
+        if (offered && (entry = findEntry(key)) != nullptr) releaseEntry(*entry);
+        unlock();
+        stop();
+        Serial.printf("[TLS] ✗ El sıkışma başarısız: %s\n", key);
+        return 0;
+    }
+    tlsMs = millis() - start;
+
+    // 5. Yeni oturumu sakla, sunulanla aynıysa devam edilmiştir
+    mbedtls_ssl_session fresh;
+    mbedtls_ssl_session_init(&fresh);
+    bool haveFresh = mbedtls_ssl_get_session(ssl, &fresh) == 0;
+    resumed = offered && haveFresh && sameSessionId(offeredSession, fresh);
+
+    lock();
+    if (resumed) {
+        counters.resumedHandshakes++;
+        counters.resumedMsTotal += tlsMs;
+    } else {
+        counters.fullHandshakes++;
+        counters.fullMsTotal += tlsMs;
+    }
+    if (haveFresh) {
+        CacheEntry &slot = slotFor(key);
+        mbedtls_ssl_session_free(&slot.session);
+        slot.session = fresh; // Sahiplik devri (fresh artık serbest bırakılmaz)
+        strlcpy(slot.key, key, TLS_SESSION_KEY_LEN);
+        slot.valid = true;
+        slot.storedAt = millis();
+        slot.lastUsed = slot.storedAt;
+    }
+    persistToRtc();
+    TlsHandshakeStats snapshot = counters;
+    unlock();
+
+    if (!haveFresh) mbedtls_ssl_session_free(&fresh);
+
+    Serial.printf("[TLS] %s: TCP %lu ms, TLS %lu ms (%s) - isabet %u%%\n",
+                  key, (unsigned long)tcpMs, (unsigned long)tlsMs,
+                  resumed ? "devam" : (offered ? "tam, oturum reddedildi" : "tam"),
+                  snapshot.hitRatePercent());
+    return 1;
+}
+
+// ============================================================================
+// TlsSessionCache
+// ============================================================================
+
+namespace TlsSessionCache {
+
+void begin() {
+    lock();
+    ensureInitialized();
+
+    // Güç kesintisi / brownout sonrası RTC içeriği anlamsız
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool warmBoot = reason == ESP_RST_SW || reason == ESP_RST_PANIC ||
+                    reason == ESP_RST_INT_WDT || reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT;
+
+    if (!warmBoot || rtcStore.magic != RTC_MAGIC || rtcStore.checksum != rtcChecksum()) {
+        memset(&rtcStore, 0, sizeof(rtcStore));
+        unlock();
+        Serial.println(F("[TLS] Oturum önbelleği boş başlatıldı"));
+        return;
+    }
+
+    memcpy(&counters, rtcStore.stats, sizeof(counters));
+    uint8_t restored = 0;
+    for (uint8_t slot = 0; slot < RTC_SLOT_COUNT && restored < TLS_SESSION_CACHE_SIZE; ++slot) {
+        const RtcSlot &rtc = rtcStore.slots[slot];
+        if (rtc.length == 0 || rtc.length > RTC_SLOT_BYTES || rtc.key[0] == '\0') continue;
+
+        CacheEntry &entry = entries[restored];
+        if (mbedtls_ssl_session_load(&entry.session, rtc.data, rtc.length) != 0) {
+            mbedtls_ssl_session_free(&entry.session);
+            mbedtls_ssl_session_init(&entry.session);
+            continue;
+        }
+        strlcpy(entry.key, rtc.key, TLS_SESSION_KEY_LEN);
+        entry.valid = true;
+        entry.storedAt = millis();
+        entry.lastUsed = entry.storedAt;
+        restored++;
+    }
+    unlock();
+
+    Serial.printf("[TLS] RTC'den %u oturum geri yüklendi (isabet %u%%)\n", restored, counters.hitRatePercent());
+}
+
+TlsHandshakeStats stats() {
+    lock();
+    TlsHandshakeStats copy = counters;
+    unlock();
+    return copy;
+}
+
+void clear() {
+    lock();
+    ensureInitialized();
+    for (auto &entry : entries) {
+        releaseEntry(entry);
+    }
+    persistToRtc();
+    unlock();
+}
+
+}
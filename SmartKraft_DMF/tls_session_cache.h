@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+
+// ============================================================================
+// TLS OTURUM DEVAMI (Session Resumption) ÖNBELLEĞİ
+// ============================================================================
+// Tam TLS el sıkışması (RSA/ECDHE + sertifika zinciri) bu donanımda gönderimin
+// en pahalı adımı. Sunucudan alınan oturum (session ID / ticket) host:port
+// anahtarıyla RAM'de saklanır; sonraki bağlantıda el sıkışmadan ÖNCE sunulur
+// ve sunucu kabul ederse kısaltılmış el sıkışma yapılır.
+//
+// CachedTlsClient, WiFiClientSecure'un yerine geçer: connect() adı DnsCache'ten
+// çözüp önce düz TCP açar (setPlainStart), önbellekteki oturumu mbedTLS
+// bağlamına yükler, sonra
+// startTLS() ile el sıkışır. HTTPClient de connect() üzerinden çağırdığı için
+// OTA istekleri ek kod olmadan faydalanır.
+//
+// Yazılımsal resetlerde (OTA, panic, WDT) oturumlar RTC_NOINIT bellekte
+// korunur; güç kesintisinde sihirli sayı/checksum tutmadığı için atılır.
+
+static const uint8_t TLS_SESSION_CACHE_SIZE = 4;                 // host:port girdisi
+static const uint32_t TLS_SESSION_TTL_MS = 30UL * 60UL * 1000UL; // 30 dakika
+static const size_t TLS_SESSION_KEY_LEN = 64;                     // "host:port"
+
+struct TlsHandshakeStats {
+    uint32_t fullHandshakes = 0;      // Önbellek yok veya sunucu reddetti
+    uint32_t resumedHandshakes = 0;   // Kısaltılmış el sıkışma
+    uint32_t offered = 0;             // Önbellekten oturum sunulan bağlantı sayısı
+    uint32_t failures = 0;            // El sıkışma hatası
+    uint32_t fullMsTotal = 0;
+    uint32_t resumedMsTotal = 0;
+
+    uint32_t averageFullMs() const { return fullHandshakes ? fullMsTotal / fullHandshakes : 0; }
+    uint32_t averageResumedMs() const { return resumedHandshakes ? resumedMsTotal / resumedHandshakes : 0; }
+    uint8_t hitRatePercent() const {
+        uint32_t total = fullHandshakes + resumedHandshakes;
+        return total ? (uint8_t)((resumedHandshakes * 100UL) / total) : 0;
+    }
+};
+
+class CachedTlsClient : public WiFiClientSecure {
+public:
+    using WiFiClientSecure::connect;
+    int connect(const char *host, uint16_t port) override;
+    int connect(const char *host, uint16_t port, int32_t timeout) override;
+
+    // true → connect() yalnızca TCP açar, el sıkışma yapılmaz (yerel test sunucusu)
+    void setPlaintext(bool enabled) { plaintext = enabled; }
+
+    // Son bağlantının ölçümleri
+    bool lastResumed() const { return resumed; }
+    bool lastTcpConnected() const { return tcpConnected; } // false → TLS'e hiç gelinmedi
+    uint32_t lastTcpMs() const { return tcpMs; }
+    uint32_t lastHandshakeMs() const { return tlsMs; }
+
+private:
+    bool connecting = false; // Üst sınıfın iç connect() çağrılarında yeniden girişi engelle
+    bool plaintext = false;
+    bool resumed = false;
+    bool tcpConnected = false;
+    uint32_t tcpMs = 0;
+    uint32_t tlsMs = 0;
+
+    int connectResumable(const char *host, uint16_t port, int32_t timeout);
+};
+
+namespace TlsSessionCache {
+    // setup() içinde çağrılır - RTC'de korunan oturumları geri yükler
+    void begin();
+
+    TlsHandshakeStats stats();
+
+    // Tüm oturumları unut (ör. WiFi ağı değiştiğinde)
+    void clear();
+}
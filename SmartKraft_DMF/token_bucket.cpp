@@ -0,0 +1,41 @@
+#include "token_bucket.h"
+
+void TokenBucket::configure(uint8_t capacity, uint16_t perMinute) {
+    if (capacity == 0) capacity = 1;
+    if (capacity == burst && perMinute == ratePerMinute) return;
+    burst = capacity;
+    ratePerMinute = perMinute;
+    reset();
+}
+
+void TokenBucket::reset() {
+    milliTokens = (uint32_t)burst * MILLI;
+    lastRefill = millis();
+}
+
+void TokenBucket::refill(uint32_t now) {
+    uint32_t elapsed = now - lastRefill;
+    // perMinute jeton / 60000 ms = perMinute / 60 milli-jeton / ms
+    uint32_t added = (uint32_t)(((uint64_t)elapsed * ratePerMinute) / 60);
+    if (added == 0) return; // Kesir kaybolmasın diye lastRefill ilerletilmez
+    milliTokens = min(milliTokens + added, (uint32_t)burst * MILLI);
+    lastRefill = now;
+}
+
+uint32_t TokenBucket::waitMs(uint32_t now) {
+    if (unlimited()) return 0;
+    refill(now);
+    if (milliTokens >= MILLI) return 0;
+    uint32_t missing = MILLI - milliTokens;
+    return (uint32_t)(((uint64_t)missing * 60 + ratePerMinute - 1) / ratePerMinute);
+}
+
+void TokenBucket::consume() {
+    if (unlimited()) return;
+    milliTokens = milliTokens >= MILLI ? milliTokens - MILLI : 0;
+}
+
+void TokenBucket::drain(uint32_t now) {
+    milliTokens = 0;
+    lastRefill = now;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================================
+// TOKEN BUCKET - SMTP sunucusu başına gönderim hızı sınırı
+// ============================================================================
+// Kova en fazla 'capacity' jeton tutar ve dakikada 'perMinute' jeton dolar.
+// Her mail bir jeton harcar: kova doluyken birikmiş kuyruk art arda (burst)
+// gönderilir, sonra dolum hızına iner. Böylece sağlayıcının dakika başı
+// sınırı aşılmadan birikim olabildiğince hızlı boşaltılır.
+//
+// Jetonlar 1/1000 birimde tutulur (float yok); perMinute = 0 → sınırsız.
+
+class TokenBucket {
+public:
+    static const uint32_t MILLI = 1000; // 1 jeton
+
+    // Parametreler değiştiyse kova dolu olarak yeniden başlar
+    void configure(uint8_t capacity, uint16_t perMinute);
+    void reset();
+
+    // Sonraki jetona kalan süre (ms); 0 → şimdi gönderilebilir
+    uint32_t waitMs(uint32_t now);
+    void consume();
+
+    // Geri çekilme: hata sonrası kovayı boşalt, sonraki gönderim dolum hızını bekler
+    void drain(uint32_t now);
+
+    uint8_t tokens() const { return (uint8_t)(milliTokens / MILLI); }
+    bool unlimited() const { return ratePerMinute == 0; }
+
+private:
+    uint8_t burst = 1;
+    uint16_t ratePerMinute = 0;
+    uint32_t milliTokens = MILLI;
+    uint32_t lastRefill = 0;
+
+    void refill(uint32_t now);
+};
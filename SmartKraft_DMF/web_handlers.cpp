@@ -1,4 +1,9 @@
 #include "web_handlers.h"
+#include "attachment_cache.h"
+#include "attachment_store.h"
+#include "smtp_metrics.h"
+#include "dns_cache.h"
+#include "wifi_link_cache.h"
 
 #include <ArduinoJson.h>
 #include <LittleFS.h>
@@ -199,7 +204,7 @@ This is a SmartKraft DMF early warning message.</textarea>
                     </div>
                     <div class="accordion-content">
                         <div style="font-size:0.85em; color:#888; margin-bottom:16px; line-height:1.5;">
-                            <span data-i18n="mail.groupsHelp">Create up to 3 mail groups. Each group has its own recipients, message, files and URL trigger. Click on a group to edit.</span>
+                            <span data-i18n="mail.groupsHelp">Create up to 8 mail groups. Each group has its own recipients, message, files and URL trigger. Click on a group to edit.</span>
                         </div>
                         
                         <!-- Mail Grup Listesi -->
@@ -1092,8 +1097,10 @@ This is a SmartKraft DMF early warning message.</textarea>
             const file = event.target.files[0];
             if (!file) return;
             
-            // Dosya boyutu kontrolü (300 KB = 307200 bytes)
-            if (file.size > 307200) {
+            // Dosya boyutu kontrolü (300 KB = 307200 bytes; sıkıştırmada ham girdi 1 MB,
+            // saklanan boyut cihazda yine 300 KB ile denetlenir)
+            const compress = document.getElementById('modalCompress').checked;
+            if (file.size > (compress ? 1048576 : 307200)) {
                 showAlert('mailAlert', 'Dosya boyutu 300 KB\'dan büyük olamaz!', 'error');
                 event.target.value = '';
                 return;
@@ -1103,7 +1110,7 @@ This is a SmartKraft DMF early warning message.</textarea>
             form.append('file', file);
             
             try {
-                const response = await fetch(`/api/upload?groupIndex=${currentEditingGroupIndex}`, { method: 'POST', body: form });
+                const response = await fetch(`/api/upload?groupIndex=${currentEditingGroupIndex}&compress=${compress ? 1 : 0}`, { method: 'POST', body: form });
                 
                 if (!response.ok) {
                     const result = await response.json();
@@ -1127,7 +1134,11 @@ This is a SmartKraft DMF early warning message.</textarea>
                     updateModalAttachmentsList(mailGroups[currentEditingGroupIndex].attachments);
                 }
                 
-                showAlert('mailAlert', t('mail.uploadSuccess'));
+                let message = t('mail.uploadSuccess');
+                if (result.compressed) {
+                    message += ` - ${t('mail.compressResult')}: ${(result.originalSize / 1024).toFixed(1)} KB → ${(result.storedSize / 1024).toFixed(1)} KB (${result.ratioPercent}%)`;
+                }
+                showAlert('mailAlert', message);
             } catch (err) {
                 showAlert('mailAlert', err.message || t('mail.uploadError'), 'error');
             } finally {
@@ -1272,13 +1283,24 @@ This is a SmartKraft DMF early warning message.</textarea>
             }
         }
 
+        function renderScan(result) {
+            const target = document.getElementById('wifiScanResults');
+            if (!result.networks || result.networks.length === 0) { target.innerHTML = result.scanning ? '...' : 'Ağ bulunamadı'; }
+            else {
+                target.innerHTML = result.networks.map(net => `<div class="list-item">${net.ssid || '<adı yok>'}<span class="badge">${net.open ? 'ŞİFRESİZ' : 'ŞİFRELİ'}</span>${net.current ? '<span class=\"badge\">AKTİF</span>' : ''}</div>`).join('');
+            }
+        }
+
+        // Cihaz taramayı arka planda yapar: önce eldeki sonuç, sonra yeni sürüm gelene kadar kısa sorgular
         async function scanNetworks() {
             try {
-                const result = await api('/api/wifi/scan');
-                const target = document.getElementById('wifiScanResults');
-                if (!result.networks || result.networks.length === 0) { target.innerHTML = 'Ağ bulunamadı'; }
-                else {
-                    target.innerHTML = result.networks.map(net => `<div class="list-item">${net.ssid || '<adı yok>'}<span class="badge">${net.open ? 'ŞİFRESİZ' : 'ŞİFRELİ'}</span>${net.current ? '<span class=\"badge\">AKTİF</span>' : ''}</div>`).join('');
+                let result = await api('/api/wifi/scan?refresh=1');
+                renderScan(result);
+                const since = result.version;
+                for (let i = 0; i < 30 && result.scanning; i++) {
+                    await new Promise(r => setTimeout(r, 500));
+                    result = await api('/api/wifi/scan?since=' + since);
+                    if (result.changed) { renderScan(result); break; }
                 }
             } catch (err) { showAlert('wifiAlert', err.message || 'Taramada hata', 'error'); }
         }
@@ -1520,9 +1542,11 @@ This is a SmartKraft DMF early warning message.</textarea>
         // Mail Groups Management
         let mailGroups = [];
         let currentEditingGroupIndex = -1;
+        let loadedRecipientsText = null; // Düzenlenen grubun cihazdan okunan listesi
         
         function addMailGroup() {
             currentEditingGroupIndex = -1;
+            loadedRecipientsText = null;
             document.getElementById('mailGroupModalTitle').textContent = 'Add Mail Group';
             
             // Clear form
@@ -1544,7 +1568,19 @@ This is a SmartKraft DMF early warning message.</textarea>
             document.getElementById('modalGroupName').value = group.name;
             document.getElementById('modalGroupEnabled').checked = group.enabled;
             updateToggleStatus(document.getElementById('modalGroupEnabled'), 'modalGroupEnabledStatus');
-            document.getElementById('modalGroupRecipients').value = group.recipients.join('\n');
+            // Alıcılar flash'ta tutulur - düzenlenmemiş grup için listeyi cihazdan oku
+            const recipientsBox = document.getElementById('modalGroupRecipients');
+            recipientsBox.value = '';
+            loadedRecipientsText = null;
+            if (group.recipientListId) {
+                api('/api/mail/recipients?list=' + group.recipientListId)
+                    .then(text => {
+                        if (currentEditingGroupIndex !== index) return;
+                        recipientsBox.value = (text || '').trim();
+                        loadedRecipientsText = recipientsBox.value;
+                    })
+                    .catch(err => showAlert('mailAlert', 'Error loading recipients: ' + err.message, 'error'));
+            }
             document.getElementById('modalGroupSubject').value = group.subject;
             document.getElementById('modalGroupBody').value = group.body;
             document.getElementById('modalGroupUrl').value = group.getUrl;
@@ -1606,14 +1642,11 @@ This is a SmartKraft DMF early warning message.</textarea>
             document.getElementById('mailGroupModal').style.display = 'none';
         }
         
-        function saveMailGroup() {
+        async function saveMailGroup() {
             const name = document.getElementById('modalGroupName').value.trim();
             const enabled = document.getElementById('modalGroupEnabled').checked;
-            const recipients = document.getElementById('modalGroupRecipients').value
-                .split('\n')
-                .map(r => r.trim())
-                .filter(r => r.length > 0)
-                .slice(0, 10);
+            const recipientsText = document.getElementById('modalGroupRecipients').value;
+            const hasRecipients = recipientsText.split('\n').some(r => r.trim().length > 0);
             const subject = document.getElementById('modalGroupSubject').value.trim();
             const body = document.getElementById('modalGroupBody').value.trim();
             const getUrl = document.getElementById('modalGroupUrl').value.trim();
@@ -1628,15 +1661,42 @@ This is a SmartKraft DMF early warning message.</textarea>
                 return;
             }
             
-            if (recipients.length === 0) {
+            if (!hasRecipients) {
                 alert(t('mail.groupRecipientsRequired'));
                 return;
             }
+            if (currentEditingGroupIndex < 0 && mailGroups.length >= 8) {
+                alert(t('mail.groupMaxReached'));
+                return;
+            }
+            
+            // Alıcılar /api/mail JSON'unda taşınmaz: metin dosyası olarak cihaza akıtılır,
+            // cihaz satır satır yeni bir flash listesine yazar ve ID'sini döner.
+            // Liste değişmediyse mevcut liste korunur (yeniden yükleme yok)
+            const editing = currentEditingGroupIndex >= 0 ? mailGroups[currentEditingGroupIndex] : null;
+            const unchanged = editing && editing.recipientListId && loadedRecipientsText !== null &&
+                recipientsText.trim() === loadedRecipientsText;
+            let uploaded = unchanged
+                ? { recipientListId: editing.recipientListId, recipientCount: editing.recipientCount }
+                : null;
+            if (!uploaded) {
+                try {
+                    const form = new FormData();
+                    form.append('file', new Blob([recipientsText], { type: 'text/plain' }), 'recipients.txt');
+                    uploaded = await api('/api/mail/recipients', { method: 'POST', body: form });
+                } catch (err) {
+                    let message = err.message;
+                    try { message = JSON.parse(message).message || message; } catch {}
+                    alert(message);
+                    return;
+                }
+            }
             
             const groupData = {
                 name: name,
                 enabled: enabled,
-                recipients: recipients,
+                recipientListId: uploaded.recipientListId,
+                recipientCount: uploaded.recipientCount,
                 subject: subject,
                 body: body,
                 getUrl: getUrl,
@@ -1646,10 +1706,6 @@ This is a SmartKraft DMF early warning message.</textarea>
             if (currentEditingGroupIndex >= 0) {
                 mailGroups[currentEditingGroupIndex] = groupData;
             } else {
-                if (mailGroups.length >= 3) {
-                    alert(t('mail.groupMaxReached'));
-                    return;
-                }
                 mailGroups.push(groupData);
             }
             
@@ -1681,7 +1737,7 @@ This is a SmartKraft DMF early warning message.</textarea>
                     ? `<span style="color:#0f0; font-size:0.7em;">● ${t('messages.active')}</span>` 
                     : `<span style="color:#666; font-size:0.7em;">○ DISABLED</span>`;
                 
-                const recipientCount = group.recipients.length || 0;
+                const recipientCount = group.recipientCount || 0;
                 const attachmentCount = group.attachments.filter(a => a.trim()).length || 0;
                 
                 return `
@@ -1738,7 +1794,7 @@ This is a SmartKraft DMF early warning message.</textarea>
                     <textarea id="modalGroupRecipients" data-i18n="mail.recipientsPlaceholder" placeholder="recipient1@example.com&#10;recipient2@example.com" style="min-height:80px; width:100%;"></textarea>
                 </div>
                 <div style="font-size:0.7em; color:#666; margin-bottom:12px;">
-                    <span data-i18n="mail.recipientsHelpGroup">Enter email addresses (one per line, max 10)</span>
+                    <span data-i18n="mail.recipientsHelpGroup">Enter email addresses (one per line, max 1000)</span>
                 </div>
                 
                 <!-- Subject -->
@@ -1772,6 +1828,10 @@ Timer completed. Urgent action required.</textarea>
                     <div style="color:#888; font-size:0.8em; margin-bottom:8px;" data-i18n="mail.uploadZone">📎 Click to upload file (max 300 KB per group, 900 KB total)</div>
                 </div>
                 <input type="file" id="modalFileInput" style="display:none" onchange="uploadAttachment(event)">
+                <label class="checkbox" style="text-transform:none; letter-spacing:0;">
+                    <input type="checkbox" id="modalCompress">
+                    <span data-i18n="mail.compressUpload">Compress text files on upload (.gz)</span>
+                </label>
                 
                 <!-- Yüklenen Dosyalar -->
                 <div id="modalAttachmentsList" style="margin-top:12px;"></div>
@@ -1794,26 +1854,46 @@ namespace {
 // JSON capacity tanımları header'da
 // constexpr size_t JSON_CAPACITY = 4096; // Bu satır artık gereksiz
 constexpr size_t MAX_UPLOAD_SIZE = 307200; // 300 KB per group (total 900 KB for 3 groups)
+constexpr size_t MAX_COMPRESS_INPUT = 1048576; // Sıkıştırmada ham girdi sınırı (saklanan yine 300 KB)
 
 struct UploadContext {
-    File file;
-    size_t written = 0;
-    String storedPath;
+    AttachmentUpload upload;  // Geçici dosya + akış halinde SHA-256
+    String storedPath;        // Gruba eklenen referans (içerik adresli)
     String originalName;
     String errorMessage = ""; // Hata mesajı
+    bool compressed = false;
+    size_t originalSize = 0;  // Tarayıcıdan gelen
+    size_t storedSize = 0;    // Flash'a yazılan (sıkıştırılmışsa .gz)
 
     void reset() {
-        if (file) {
-            file.close();
-        }
-        written = 0;
+        upload.abort();
         storedPath = "";
         originalName = "";
         errorMessage = "";
+        compressed = false;
+        originalSize = 0;
+        storedSize = 0;
     }
 };
 
 UploadContext uploadContext;
+
+// Alıcı listesi yüklemesi: gövde RAM'e alınmadan satır satır flash'a yazılır
+struct RecipientUploadContext {
+    RecipientUpload upload;
+    String errorMessage = "";
+    uint16_t listId = 0;
+    uint16_t count = 0;
+
+    void reset() {
+        upload.abort();
+        errorMessage = "";
+        listId = 0;
+        count = 0;
+    }
+};
+
+RecipientUploadContext recipientUploadContext;
 }
 
 void WebInterface::begin(WebServer *srv,
@@ -1847,6 +1927,28 @@ void WebInterface::begin(WebServer *srv,
     server->on("/api/mail", HTTP_GET, [this]() { handleMailGet(); });
     server->on("/api/mail", HTTP_PUT, [this]() { handleMailUpdate(); });
     server->on("/api/mail/test", HTTP_POST, [this]() { handleMailTest(); });
+    server->on("/api/mail/recipients", HTTP_GET, [this]() { handleMailRecipients(); });
+    server->on("/api/mail/recipients", HTTP_POST,
+               [this]() {
+                   JsonDocument doc;
+                   if (recipientUploadContext.errorMessage.length() > 0 || recipientUploadContext.listId == 0) {
+                       doc["status"] = "error";
+                       doc["message"] = recipientUploadContext.errorMessage.length() > 0
+                                            ? recipientUploadContext.errorMessage
+                                            : String("No file uploaded");
+                       String output;
+                       serializeJson(doc, output);
+                       server->send(400, "application/json", output);
+                   } else {
+                       // Liste henüz hiçbir gruba bağlı değil - /api/mail kaydında referans verilir
+                       doc["status"] = "ok";
+                       doc["recipientListId"] = recipientUploadContext.listId;
+                       doc["recipientCount"] = recipientUploadContext.count;
+                       sendJson(doc);
+                   }
+                   recipientUploadContext.reset();
+               },
+               [this]() { handleMailRecipientsUpload(); });
 
     server->on("/api/wifi", HTTP_GET, [this]() { handleWiFiGet(); });
     server->on("/api/wifi", HTTP_PUT, [this]() { handleWiFiUpdate(); });
@@ -1862,6 +1964,7 @@ void WebInterface::begin(WebServer *srv,
     server->on("/api/settings", HTTP_PUT, [this]() { handleAPIUpdate(); });
 
     server->on("/api/logs", HTTP_GET, [this]() { handleLogs(); });
+    server->on("/api/metrics", HTTP_GET, [this]() { handleMetrics(); });
     server->on("/api/reboot", HTTP_POST, [this]() { handleReboot(); });
     server->on("/api/factory-reset", HTTP_POST, [this]() { handleFactoryReset(); });
 
@@ -1894,6 +1997,12 @@ void WebInterface::begin(WebServer *srv,
                        doc["status"] = "ok";
                        doc["path"] = uploadContext.storedPath;
                        doc["name"] = uploadContext.originalName;
+                       doc["compressed"] = uploadContext.compressed;
+                       doc["originalSize"] = uploadContext.originalSize;
+                       doc["storedSize"] = uploadContext.storedSize;
+                       if (uploadContext.originalSize > 0) {
+                           doc["ratioPercent"] = (uint64_t)uploadContext.storedSize * 100 / uploadContext.originalSize;
+                       }
                        sendJson(doc);
                    }
                    uploadContext.reset();
@@ -1904,32 +2013,17 @@ void WebInterface::begin(WebServer *srv,
 void WebInterface::startServer() {
     if (!server) return;
     
-    // Kayıtlı WiFi ayarlarını kontrol et
-    WiFiSettings wifiConfig = store->loadWiFiSettings();
-    bool hasStoredWiFi = (wifiConfig.primarySSID.length() > 0);
-    bool staConnected = false;
-    
-    if (hasStoredWiFi) {
-        if (network && network->connectToKnown()) {
-            staConnected = true;
-        }
-    }
-    
-    bool shouldStartAP = false;
-    
-    if (!hasStoredWiFi) {
-        shouldStartAP = true;
-    } else if (!staConnected && wifiConfig.apModeEnabled) {
-        shouldStartAP = true;
-    } else if (staConnected && wifiConfig.apModeEnabled) {
-        shouldStartAP = true;
-    }
+    // Kayıtlı WiFi ayarlarını kontrol et - bağlantı beklenmez, durum makinesi
+    // arka planda kurar (olmazsa FALLBACK_AP kurulum AP'sini kendisi açar)
+    WiFiConfigHandle wifiConfig = network->getConfig();
+    bool hasStoredWiFi = (wifiConfig->primarySSID.length() > 0);
+    bool shouldStartAP = !hasStoredWiFi || wifiConfig->apModeEnabled;
     
-    if (shouldStartAP && staConnected) {
+    if (shouldStartAP && hasStoredWiFi) {
         WiFi.mode(WIFI_AP_STA);
-    } else if (shouldStartAP && !staConnected) {
+    } else if (shouldStartAP) {
         WiFi.mode(WIFI_AP);
-    } else if (!shouldStartAP && staConnected) {
+    } else {
         WiFi.mode(WIFI_STA);
     }
     
@@ -1966,6 +2060,10 @@ void WebInterface::startServer() {
     
     server->begin();
     disableWiFiPowerSave();
+    
+    if (hasStoredWiFi) {
+        network->requestConnect();
+    }
 }
 
 void WebInterface::loop() {
@@ -1982,34 +2080,14 @@ void WebInterface::loop() {
         lastStatusPush = millis();
     }
     
+    // Yeniden bağlanmayı durum makinesi yürütür; burada yalnızca kayıtlı
+    // olmayan (açık) bir ağdayken daha iyi ağ aranır
     static unsigned long lastWiFiCheck = 0;
-    static bool wasConnected = false;
     
     if (millis() - lastWiFiCheck > 60000) {
-        wifi_mode_t mode = WiFi.getMode();
-        wl_status_t status = WiFi.status();
-        
-        if (mode == WIFI_STA || mode == WIFI_AP_STA) {
-            bool nowConnected = (status == WL_CONNECTED);
-            
-            if (nowConnected) {
-                String currentSSID = WiFi.SSID();
-                
-                if (network) {
-                    bool shouldSwitch = network->checkForBetterNetwork(currentSSID);
-                    if (shouldSwitch) {
-                        network->connectToKnown();
-                    }
-                }
-            } else {
-                if (network) {
-                    network->connectToKnown();
-                }
-            }
-            
-            wasConnected = nowConnected;
+        if (network && network->isOnline() && network->checkForBetterNetwork(WiFi.SSID())) {
+            network->requestConnect(true);
         }
-        
         lastWiFiCheck = millis();
     }
 }
@@ -2060,26 +2138,101 @@ void WebInterface::handleStatus() {
     // Network status - hızlı kontrol
     bool connected = network->isConnected();
     doc["wifiConnected"] = connected;
+    doc["linkState"] = DMFNetworkManager::stateName(network->state());
     if (connected) {
         doc["ssid"] = network->currentSSID();
         doc["ip"] = network->currentIP().toString();
         doc["hostname"] = WiFi.getHostname(); // mDNS hostname
     }
     
+    // Bağlanma süreleri (soğuk/sıcak açılış, yeniden bağlanma) + taramasız bağlantı kaydı
+    WiFiLinkStats link = WiFiLinkCache::stats();
+    JsonObject linkObj = doc["wifiConnect"].to<JsonObject>();
+    static const char *const KIND_KEYS[WIFI_CONNECT_KIND_COUNT] = {"coldBoot", "warmBoot", "reconnect"};
+    for (uint8_t i = 0; i < WIFI_CONNECT_KIND_COUNT; ++i) {
+        JsonObject kindObj = linkObj[KIND_KEYS[i]].to<JsonObject>();
+        kindObj["count"] = link.kinds[i].count;
+        kindObj["fast"] = link.kinds[i].fastCount;
+        kindObj["avgMs"] = link.kinds[i].averageMs();
+        kindObj["lastMs"] = link.kinds[i].lastMs;
+    }
+    linkObj["fastAttempts"] = link.fastAttempts;
+    linkObj["fastFallbacks"] = link.fastFallbacks;
+    linkObj["leaseChanges"] = link.leaseChanges;
+    WiFiLinkRecord record;
+    if (WiFiLinkCache::load(record)) {
+        linkObj["bssid"] = record.bssidString();
+        linkObj["channel"] = record.channel;
+        linkObj["leaseIp"] = IPAddress(record.ip).toString();
+    }
+    
     doc["deviceId"] = deviceId;
     doc["chipId"] = getOrCreateDeviceId(); // Benzersiz 12 karakter ID
     doc["macAddress"] = getChipIdHex(); // Orijinal MAC (referans)
     doc["firmwareVersion"] = FIRMWARE_VERSION; // Dinamik version bilgisi
     doc["freeHeap"] = ESP.getFreeHeap(); // Memory monitoring
     
+    // TLS oturum önbelleği (SMTP + OTA el sıkışmaları)
+    TlsHandshakeStats tls = TlsSessionCache::stats();
+    JsonObject tlsObj = doc["tls"].to<JsonObject>();
+    tlsObj["handshakes"] = tls.fullHandshakes + tls.resumedHandshakes;
+    tlsObj["resumed"] = tls.resumedHandshakes;
+    tlsObj["failures"] = tls.failures;
+    tlsObj["hitRate"] = tls.hitRatePercent();
+    tlsObj["avgFullMs"] = tls.averageFullMs();
+    tlsObj["avgResumedMs"] = tls.averageResumedMs();
+    
+    // DNS önbelleği (SMTP + OTA + bağlantı testleri)
+    DnsCacheStats dns = DnsCache::stats();
+    JsonObject dnsObj = doc["dns"].to<JsonObject>();
+    dnsObj["entries"] = dns.entries;
+    dnsObj["hits"] = dns.hits;
+    dnsObj["negativeHits"] = dns.negativeHits;
+    dnsObj["lookups"] = dns.lookups;
+    dnsObj["failures"] = dns.failures;
+    dnsObj["hitRate"] = dns.hitRatePercent();
+    dnsObj["avgLookupMs"] = dns.averageLookupMs();
+    
+    // Mail kuyruğu (birikim boşaltma süresi + hız sınırı)
+    QueueDrainStats drain = mail->queueStats();
+    JsonObject queueObj = doc["queue"].to<JsonObject>();
+    queueObj["size"] = mail->getQueueSize();
+    queueObj["draining"] = drain.draining;
+    queueObj["rateTokens"] = drain.rateTokens;
+    queueObj["lastDrainMails"] = drain.lastDrainMails;
+    queueObj["lastDrainMs"] = drain.lastDrainMs;
+    queueObj["avgDeliveryMs"] = drain.avgDeliveryMs;
+    queueObj["networkWakeups"] = drain.networkWakeups;
+    
+    // GET URL tetiklemeleri (tek çalışan + sınırlı kuyruk)
+    WebhookStats hooks = mail->webhookStats();
+    JsonObject hooksObj = doc["webhooks"].to<JsonObject>();
+    hooksObj["pending"] = hooks.pending;
+    hooksObj["delivered"] = hooks.delivered;
+    hooksObj["failed"] = hooks.failed;
+    hooksObj["retries"] = hooks.retries;
+    hooksObj["dropped"] = hooks.dropped;
+    hooksObj["reused"] = hooks.reusedConnections;
+    JsonArray recent = hooksObj["recent"].to<JsonArray>();
+    for (uint8_t i = 0; i < hooks.historyCount; ++i) {
+        const WebhookResult &result = hooks.history[i];
+        JsonObject item = recent.add<JsonObject>();
+        item["label"] = result.label;
+        item["code"] = result.httpCode;
+        item["ok"] = result.success;
+        item["attempts"] = result.attempts;
+        item["ms"] = result.durationMs;
+        item["ageSec"] = (millis() - result.finishedAt) / 1000;
+    }
+    
     // NOT: Termal bilgiler KALDIRILDI
     
     // WiFi config bilgileri sadece gerekirse
-    WiFiSettings wifi = network->getConfig();
-    doc["allowOpenNetworks"] = wifi.allowOpenNetworks;
-    doc["apModeEnabled"] = wifi.apModeEnabled;
-    doc["primaryStaticEnabled"] = wifi.primaryStaticEnabled;
-    doc["secondaryStaticEnabled"] = wifi.secondaryStaticEnabled;
+    WiFiConfigHandle wifi = network->getConfig(); // Kopyasız snapshot
+    doc["allowOpenNetworks"] = wifi->allowOpenNetworks;
+    doc["apModeEnabled"] = wifi->apModeEnabled;
+    doc["primaryStaticEnabled"] = wifi->primaryStaticEnabled;
+    doc["secondaryStaticEnabled"] = wifi->secondaryStaticEnabled;
     
     // Response'u cache'le
     cachedStatusResponse = "";
@@ -2192,50 +2345,53 @@ void WebInterface::handleVirtualButton() {
 }
 
 void WebInterface::handleMailGet() {
-    MailSettings mailSettings = mail->currentConfig();
+    MailConfigHandle mailSettings = mail->currentConfig(); // Kopyasız snapshot
     JsonDocument doc; // Mail settings büyük olabilir
-    doc["smtpServer"] = mailSettings.smtpServer;
-    doc["smtpPort"] = mailSettings.smtpPort;
-    doc["username"] = mailSettings.username;
-    doc["warning"]["subject"] = mailSettings.warning.subject;
-    doc["warning"]["body"] = mailSettings.warning.body;
-    doc["warning"]["getUrl"] = mailSettings.warning.getUrl;
-    doc["final"]["subject"] = mailSettings.finalContent.subject;
-    doc["final"]["body"] = mailSettings.finalContent.body;
-    doc["final"]["getUrl"] = mailSettings.finalContent.getUrl;
+    doc["smtpServer"] = mailSettings->smtpServer;
+    doc["smtpPort"] = mailSettings->smtpPort;
+    doc["parallelSessions"] = mailSettings->parallelSessions;
+    doc["rateBurst"] = mailSettings->rateBurst;
+    doc["smtpTls"] = mailSettings->smtpTls;
+    doc["ratePerMinute"] = mailSettings->ratePerMinute;
+    doc["username"] = mailSettings->username;
+    doc["warning"]["subject"] = mailSettings->warning.subject;
+    doc["warning"]["body"] = mailSettings->warning.body;
+    doc["warning"]["getUrl"] = mailSettings->warning.getUrl;
+    doc["final"]["subject"] = mailSettings->finalContent.subject;
+    doc["final"]["body"] = mailSettings->finalContent.body;
+    doc["final"]["getUrl"] = mailSettings->finalContent.getUrl;
     JsonArray recipients = doc["recipients"].to<JsonArray>();
-    for (uint8_t i = 0; i < mailSettings.recipientCount; ++i) {
-        recipients.add(mailSettings.recipients[i]);
+    for (uint8_t i = 0; i < mailSettings->recipientCount; ++i) {
+        recipients.add(mailSettings->recipients[i]);
     }
     JsonArray attachments = doc["attachments"].to<JsonArray>();
-    for (uint8_t i = 0; i < mailSettings.attachmentCount; ++i) {
+    for (uint8_t i = 0; i < mailSettings->attachmentCount; ++i) {
         JsonObject entry = attachments.add<JsonObject>();
-        entry["displayName"] = mailSettings.attachments[i].displayName;
-        entry["storedPath"] = mailSettings.attachments[i].storedPath;
-        entry["size"] = mailSettings.attachments[i].size;
-        entry["forWarning"] = mailSettings.attachments[i].forWarning;
-        entry["forFinal"] = mailSettings.attachments[i].forFinal;
+        entry["displayName"] = mailSettings->attachments[i].displayName;
+        entry["storedPath"] = mailSettings->attachments[i].storedPath;
+        entry["size"] = mailSettings->attachments[i].size;
+        entry["forWarning"] = mailSettings->attachments[i].forWarning;
+        entry["forFinal"] = mailSettings->attachments[i].forFinal;
     }
     
     // Add Mail Groups
     JsonArray mailGroups = doc["mailGroups"].to<JsonArray>();
-    for (uint8_t i = 0; i < mailSettings.mailGroupCount; ++i) {
+    for (uint8_t i = 0; i < mailSettings->mailGroupCount; ++i) {
         JsonObject group = mailGroups.add<JsonObject>();
-        group["name"] = mailSettings.mailGroups[i].name;
-        group["enabled"] = mailSettings.mailGroups[i].enabled;
+        group["name"] = mailSettings->mailGroups[i].name;
+        group["enabled"] = mailSettings->mailGroups[i].enabled;
         
-        JsonArray groupRecipients = group["recipients"].to<JsonArray>();
-        for (uint8_t j = 0; j < mailSettings.mailGroups[i].recipientCount; ++j) {
-            groupRecipients.add(mailSettings.mailGroups[i].recipients[j]);
-        }
+        // Alıcılar flash'ta - liste içeriği /api/mail/recipients ile ayrıca okunur
+        group["recipientListId"] = mailSettings->mailGroups[i].recipientListId;
+        group["recipientCount"] = mailSettings->mailGroups[i].recipientCount;
         
-        group["subject"] = mailSettings.mailGroups[i].subject;
-        group["body"] = mailSettings.mailGroups[i].body;
-        group["getUrl"] = mailSettings.mailGroups[i].getUrl;
+        group["subject"] = mailSettings->mailGroups[i].subject;
+        group["body"] = mailSettings->mailGroups[i].body;
+        group["getUrl"] = mailSettings->mailGroups[i].getUrl;
         
         JsonArray groupAttachments = group["attachments"].to<JsonArray>();
-        for (uint8_t j = 0; j < mailSettings.mailGroups[i].attachmentCount; ++j) {
-            groupAttachments.add(mailSettings.mailGroups[i].attachments[j]);
+        for (uint8_t j = 0; j < mailSettings->mailGroups[i].attachmentCount; ++j) {
+            groupAttachments.add(mailSettings->mailGroups[i].attachments[j]);
         }
     }
     
@@ -2253,9 +2409,26 @@ void WebInterface::handleMailUpdate() {
         return;
     }
 
-    MailSettings mailSettings = mail->currentConfig();
+    MailSettings mailSettings = *mail->currentConfig(); // Yeni versiyon için kopya (copy-on-write)
     mailSettings.smtpServer = doc["smtpServer"].as<String>();
     mailSettings.smtpPort = doc["smtpPort"] | 465;
+    if (doc["parallelSessions"].is<int>()) {
+        mailSettings.parallelSessions = constrain(doc["parallelSessions"].as<int>(), 1, (int)MAX_PARALLEL_SMTP_SESSIONS);
+    }
+    if (doc["rateBurst"].is<int>()) {
+        mailSettings.rateBurst = constrain(doc["rateBurst"].as<int>(), 1, (int)MAX_SMTP_RATE_BURST);
+    }
+    if (doc["ratePerMinute"].is<int>()) {
+        mailSettings.ratePerMinute = constrain(doc["ratePerMinute"].as<int>(), 0, (int)MAX_SMTP_RATE_PER_MINUTE);
+    }
+    if (doc["smtpTls"].is<bool>()) {
+        mailSettings.smtpTls = doc["smtpTls"].as<bool>();
+    }
+    // Şifresiz SMTP yalnızca yerel ağdaki test sunucusuna (kimlik bilgisi açık gider)
+    if (!mailSettings.smtpTls && !SmtpSession::plaintextAllowed(mailSettings.smtpServer)) {
+        server->send(400, "application/json", "{\"error\":\"TLS'siz SMTP yalnızca yerel ağ IP adresine izinli\"}");
+        return;
+    }
     mailSettings.username = doc["username"].as<String>();
     
     // Sadece yeni şifre girildiyse güncelle
@@ -2302,14 +2475,25 @@ void WebInterface::handleMailUpdate() {
             mailSettings.mailGroups[i].name = group["name"].as<String>();
             mailSettings.mailGroups[i].enabled = group["enabled"].as<bool>();
             
-            // Recipients
+            // Alıcılar JSON'da gelmez: liste önce POST /api/mail/recipients ile flash'a
+            // akıtılır, burada yalnızca ID'si bağlanır (gövde boyutu liste boyutundan bağımsız)
             if (group["recipients"].is<JsonArray>()) {
-                auto groupRecipients = group["recipients"].as<JsonArray>();
-                mailSettings.mailGroups[i].recipientCount = min((uint8_t)groupRecipients.size(), (uint8_t)10);
-                for (uint8_t j = 0; j < mailSettings.mailGroups[i].recipientCount; ++j) {
-                    mailSettings.mailGroups[i].recipients[j] = groupRecipients[j].as<String>();
-                }
+                server->send(400, "application/json",
+                             "{\"error\":\"Alıcılar /api/mail/recipients ile yüklenmeli\"}");
+                return;
             }
+            uint16_t listId = group["recipientListId"] | (uint16_t)0;
+            if (listId != 0 && !RecipientStore::exists(listId)) {
+                // Yükleme ile kayıt arasında başka bir kayıt listeyi temizlemiş olabilir
+                JsonDocument response;
+                response["error"] = "Grup " + String(i + 1) + ": alıcı listesi bulunamadı, yeniden yükleyin";
+                String output;
+                serializeJson(response, output);
+                server->send(400, "application/json", output);
+                return;
+            }
+            mailSettings.mailGroups[i].recipientListId = listId;
+            mailSettings.mailGroups[i].recipientCount = RecipientStore::count(listId);
             
             mailSettings.mailGroups[i].subject = group["subject"].as<String>();
             mailSettings.mailGroups[i].body = group["body"].as<String>();
@@ -2327,9 +2511,60 @@ void WebInterface::handleMailUpdate() {
     }
 
     mail->updateConfig(mailSettings);
+    // Kaldırılan grup/eklerin artık kimsenin kullanmadığı içeriklerini sil
+    AttachmentStore::collectGarbage(mailSettings, store->dataFolder());
     server->send(200, "application/json", "{\"status\":\"ok\",\"success\":true}");
 }
 
+void WebInterface::handleMailRecipients() {
+    // Alıcı listesini flash'tan satır satır akıt (text/plain, her satırda bir adres)
+    // Liste ne kadar büyük olursa olsun RAM'de tamamı tutulmaz
+    uint16_t listId = server->hasArg("list") ? (uint16_t)server->arg("list").toInt() : 0;
+    RecipientCursor cursor;
+    if (!cursor.open(listId)) {
+        server->send(404, "application/json", "{\"error\":\"Alıcı listesi bulunamadı\"}");
+        return;
+    }
+
+    server->sendHeader("Cache-Control", "no-cache, no-store, must-revalidate");
+    server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server->send(200, "text/plain", "");
+
+    char line[MAX_EMAIL_ADDRESS_LEN + 2];
+    while (cursor.next(line, sizeof(line) - 1)) {
+        size_t len = strlen(line);
+        line[len++] = '\n';
+        server->sendContent(line, len);
+    }
+    server->sendContent("");
+}
+
+void WebInterface::handleMailRecipientsUpload() {
+    HTTPUpload &upload = server->upload();
+
+    if (upload.status == UPLOAD_FILE_START) {
+        recipientUploadContext.reset();
+        if (!recipientUploadContext.upload.begin(recipientUploadContext.errorMessage)) {
+            Serial.printf("[Recipients] Yükleme başlatılamadı: %s\n", recipientUploadContext.errorMessage.c_str());
+        }
+
+    } else if (upload.status == UPLOAD_FILE_WRITE) {
+        // Parça en çok HTTP_UPLOAD_BUFLEN bayt; yarım satır RecipientUpload tamponunda bekler
+        if (!recipientUploadContext.upload.active()) return;
+        recipientUploadContext.upload.write(upload.buf, upload.currentSize, recipientUploadContext.errorMessage);
+
+    } else if (upload.status == UPLOAD_FILE_END) {
+        if (!recipientUploadContext.upload.active()) return;
+        if (recipientUploadContext.upload.finish(recipientUploadContext.errorMessage)) {
+            recipientUploadContext.listId = recipientUploadContext.upload.listId();
+            recipientUploadContext.count = recipientUploadContext.upload.count();
+        }
+
+    } else if (upload.status == UPLOAD_FILE_ABORTED) {
+        recipientUploadContext.reset();
+    }
+}
+
 void WebInterface::handleMailTest() {
     // WiFi kontrolü önce
     if (WiFi.status() != WL_CONNECTED) {
@@ -2389,26 +2624,26 @@ void WebInterface::handleMailTest() {
 }
 
 void WebInterface::handleWiFiGet() {
-    WiFiSettings wifi = network->getConfig();
+    WiFiConfigHandle wifi = network->getConfig(); // Kopyasız snapshot
     JsonDocument doc; // WiFi settings orta boyut
-    doc["primarySSID"] = wifi.primarySSID;
-    doc["primaryPassword"] = wifi.primaryPassword;
-    doc["secondarySSID"] = wifi.secondarySSID;
-    doc["secondaryPassword"] = wifi.secondaryPassword;
-    doc["allowOpenNetworks"] = wifi.allowOpenNetworks;
-    doc["apModeEnabled"] = wifi.apModeEnabled;
-    doc["primaryStaticEnabled"] = wifi.primaryStaticEnabled;
-    doc["primaryIP"] = wifi.primaryIP;
-    doc["primaryGateway"] = wifi.primaryGateway;
-    doc["primarySubnet"] = wifi.primarySubnet;
-    doc["primaryDNS"] = wifi.primaryDNS;
-    doc["primaryMDNS"] = wifi.primaryMDNS;
-    doc["secondaryStaticEnabled"] = wifi.secondaryStaticEnabled;
-    doc["secondaryIP"] = wifi.secondaryIP;
-    doc["secondaryGateway"] = wifi.secondaryGateway;
-    doc["secondarySubnet"] = wifi.secondarySubnet;
-    doc["secondaryDNS"] = wifi.secondaryDNS;
-    doc["secondaryMDNS"] = wifi.secondaryMDNS;
+    doc["primarySSID"] = wifi->primarySSID;
+    doc["primaryPassword"] = wifi->primaryPassword;
+    doc["secondarySSID"] = wifi->secondarySSID;
+    doc["secondaryPassword"] = wifi->secondaryPassword;
+    doc["allowOpenNetworks"] = wifi->allowOpenNetworks;
+    doc["apModeEnabled"] = wifi->apModeEnabled;
+    doc["primaryStaticEnabled"] = wifi->primaryStaticEnabled;
+    doc["primaryIP"] = wifi->primaryIP;
+    doc["primaryGateway"] = wifi->primaryGateway;
+    doc["primarySubnet"] = wifi->primarySubnet;
+    doc["primaryDNS"] = wifi->primaryDNS;
+    doc["primaryMDNS"] = wifi->primaryMDNS;
+    doc["secondaryStaticEnabled"] = wifi->secondaryStaticEnabled;
+    doc["secondaryIP"] = wifi->secondaryIP;
+    doc["secondaryGateway"] = wifi->secondaryGateway;
+    doc["secondarySubnet"] = wifi->secondarySubnet;
+    doc["secondaryDNS"] = wifi->secondaryDNS;
+    doc["secondaryMDNS"] = wifi->secondaryMDNS;
     sendJson(doc);
 }
 
@@ -2417,7 +2652,7 @@ void WebInterface::handleWiFiUpdate() {
     JsonDocument doc; // WiFi update orta boyut
     if (deserializeJson(doc, server->arg("plain"))) { server->send(400, "application/json", "{\"error\":\"json\"}"); return; }
     
-    WiFiSettings wifi = network->getConfig();
+    WiFiSettings wifi = *network->getConfig(); // Yeni versiyon için kopya (copy-on-write)
     wifi.primarySSID = doc["primarySSID"].as<String>();
     wifi.primaryPassword = doc["primaryPassword"].as<String>();
     wifi.secondarySSID = doc["secondarySSID"].as<String>();
@@ -2481,8 +2716,8 @@ void WebInterface::handleWiFiUpdate() {
     
     delay(100);
     
-    // Yeni ayarlarla bağlantıyı dene
-    network->ensureConnected(false);
+    // Yeni ayarlarla bağlantı girişimi (beklenmez - durum makinesi yürütür)
+    network->requestConnect();
     
     // mDNS'i yenile (eğer STA modunda bağlıysak, hostname değişmiş olabilir)
     if (WiFi.status() == WL_CONNECTED) {
@@ -2494,11 +2729,27 @@ void WebInterface::handleWiFiUpdate() {
 }
 
 void WebInterface::handleWiFiScan() {
-    auto list = network->scanNetworks();
+    // Radyo taraması burada BEKLENMEZ: son yayınlanan sonuç hemen döner.
+    // ?refresh=1 → yeni tarama başlat (5 sn'den eskiyse); ?since=N → sürüm N'den
+    // yeniyse "changed". Arayüz "scanning" sürdükçe since ile kısa aralıklarla sorar.
+    auto scan = network->latestScan();
+    bool stale = scan->version == 0 || millis() - scan->completedAt >= 5000;
+    if (server->arg("refresh") == "1" && stale) {
+        network->requestScan();
+    }
+    
+    uint32_t since = server->arg("since").toInt();
     JsonDocument doc; // Network scan orta boyut
+    doc["version"] = scan->version;
+    doc["changed"] = scan->version > since;
+    doc["scanning"] = network->scanInProgress();
+    if (scan->version > 0) {
+        doc["ageMs"] = millis() - scan->completedAt;
+        doc["durationMs"] = scan->durationMs;
+    }
     JsonArray arr = doc["networks"].to<JsonArray>();
     String cur = WiFi.SSID();
-    for (auto &net : list) {
+    for (auto &net : scan->networks) {
         JsonObject item = arr.add<JsonObject>();
         item["ssid"] = net.ssid;
         item["rssi"] = net.rssi;
@@ -2509,17 +2760,31 @@ void WebInterface::handleWiFiScan() {
 }
 
 void WebInterface::handleAttachmentList() {
-    MailSettings mailSettings = mail->currentConfig();
+    MailConfigHandle mailSettings = mail->currentConfig(); // Kopyasız snapshot
     JsonDocument doc; // Attachment list orta boyut
     JsonArray arr = doc["attachments"].to<JsonArray>();
-    for (uint8_t i = 0; i < mailSettings.attachmentCount; ++i) {
+    for (uint8_t i = 0; i < mailSettings->attachmentCount; ++i) {
         JsonObject entry = arr.add<JsonObject>();
-        entry["displayName"] = mailSettings.attachments[i].displayName;
-        entry["storedPath"] = mailSettings.attachments[i].storedPath;
-        entry["size"] = mailSettings.attachments[i].size;
-        entry["forWarning"] = mailSettings.attachments[i].forWarning;
-        entry["forFinal"] = mailSettings.attachments[i].forFinal;
+        entry["displayName"] = mailSettings->attachments[i].displayName;
+        entry["storedPath"] = mailSettings->attachments[i].storedPath;
+        entry["size"] = mailSettings->attachments[i].size;
+        entry["forWarning"] = mailSettings->attachments[i].forWarning;
+        entry["forFinal"] = mailSettings->attachments[i].forFinal;
     }
+    
+    // Flash kullanımı: benzersiz içerikler + base64 kopyaları, 900KB kotasına karşı
+    AttachmentStore::Usage used = AttachmentStore::usage(*mailSettings);
+    size_t attachmentBytes = used.contentBytes;
+    size_t cacheBytes = used.cacheBytes;
+    JsonObject storage = doc["storage"].to<JsonObject>();
+    storage["attachmentBytes"] = attachmentBytes;
+    storage["cacheBytes"] = cacheBytes;
+    storage["references"] = used.references;
+    storage["uniqueFiles"] = used.blobs;
+    storage["dedupSavedBytes"] = used.referencedBytes - used.contentBytes;
+    storage["quotaBytes"] = ATTACHMENT_QUOTA_BYTES;
+    storage["quotaPercent"] = (attachmentBytes + cacheBytes) * 100 / ATTACHMENT_QUOTA_BYTES;
+    storage["fsFreeBytes"] = LittleFS.totalBytes() - LittleFS.usedBytes();
     sendJson(doc);
 }
 
@@ -2538,93 +2803,140 @@ void WebInterface::handleAttachmentUpload() {
         sanitized.replace("..", "");
         sanitized.replace("/", "_");
         uploadContext.originalName = sanitized;
-        String stored = store->dataFolder() + "/" + String(millis()) + "_" + sanitized;
         
-        uploadContext.file = LittleFS.open(stored, "w");
-        if (!uploadContext.file) {
-            return;
+        // ?compress=1 → metin belgeler gzip ile saklanır (PDF/JPEG/ZIP gibi biçimler atlanır)
+        bool compress = server->arg("compress") == "1" && GzipWriter::worthCompressing(sanitized);
+        
+        // Önce geçici dosyaya; içerik adı (özet) yükleme bitince belli olur
+        if (!uploadContext.upload.begin(store->dataFolder(), compress)) {
+            uploadContext.errorMessage = "Flash write failed";
         }
-        uploadContext.storedPath = stored;
-        uploadContext.written = 0;
         
     } else if (upload.status == UPLOAD_FILE_WRITE) {
-        if (!uploadContext.file) return;
+        if (!uploadContext.upload.active()) return;
         
-        // Dosya boyutu kontrolü (300 KB per group)
-        if (uploadContext.written + upload.currentSize > MAX_UPLOAD_SIZE) {
-            uploadContext.file.close();
-            LittleFS.remove(uploadContext.storedPath);
-            uploadContext.errorMessage = "File size exceeds 300 KB limit";
-            uploadContext.storedPath = "";
+        // Dosya boyutu kontrolü (300 KB per group) - sıkıştırmada saklanan boyut
+        // ancak yazdıkça belli olur, ham girdi ayrıca 1 MB ile sınırlanır
+        bool compressing = uploadContext.upload.compressed();
+        size_t inputLimit = compressing ? MAX_COMPRESS_INPUT : MAX_UPLOAD_SIZE;
+        if (uploadContext.upload.receivedBytes() + upload.currentSize > inputLimit) {
+            uploadContext.upload.abort();
+            uploadContext.errorMessage = compressing ? "File size exceeds 1 MB compression input limit"
+                                                     : "File size exceeds 300 KB limit";
+            return;
+        }
+        if (!uploadContext.upload.write(upload.buf, upload.currentSize)) {
+            uploadContext.upload.abort();
+            uploadContext.errorMessage = "Flash write failed";
             return;
         }
-        uploadContext.file.write(upload.buf, upload.currentSize);
-        uploadContext.written += upload.currentSize;
+        if (uploadContext.upload.size() > MAX_UPLOAD_SIZE) {
+            uploadContext.upload.abort();
+            uploadContext.errorMessage = "Compressed file still exceeds 300 KB limit";
+        }
         
     } else if (upload.status == UPLOAD_FILE_END) {
-        if (!uploadContext.file) return;
-        uploadContext.file.close();
+        if (!uploadContext.upload.active()) return;
         
         // Hangi gruba upload ediliyor?
         if (!server->hasArg("groupIndex")) {
-            LittleFS.remove(uploadContext.storedPath);
+            uploadContext.upload.abort();
             uploadContext.errorMessage = "Missing groupIndex parameter";
-            uploadContext.storedPath = "";
             return;
         }
         
         int groupIndex = server->arg("groupIndex").toInt();
-        MailSettings mailSettings = mail->currentConfig();
+        MailConfigHandle current = mail->currentConfig();
+        const MailSettings &mailSettings = *current; // Doğrulama kopyasız snapshot üzerinden
         
         // Geçerli grup index kontrolü
-        if (groupIndex < 0 || groupIndex >= MAX_MAIL_GROUPS || groupIndex >= mailSettings.mailGroupCount) {
-            LittleFS.remove(uploadContext.storedPath);
+        if (groupIndex < 0 || groupIndex >= (int)MAX_MAIL_GROUPS || groupIndex >= mailSettings.mailGroupCount) {
+            uploadContext.upload.abort();
             uploadContext.errorMessage = "Invalid groupIndex";
-            uploadContext.storedPath = "";
             return;
         }
         
-        MailGroup &group = mailSettings.mailGroups[groupIndex];
+        const MailGroup &group = mailSettings.mailGroups[groupIndex];
         
         // Grup dosya sayısı kontrolü (max 5 per group)
         if (group.attachmentCount >= MAX_ATTACHMENTS_PER_GROUP) {
-            LittleFS.remove(uploadContext.storedPath);
+            uploadContext.upload.abort();
             uploadContext.errorMessage = "Group has reached maximum file count (5)";
-            uploadContext.storedPath = "";
             return;
         }
         
-        // Toplam dosya boyutu kontrolü (900 KB total for all groups)
-        size_t totalSize = uploadContext.written;
-        for (uint8_t i = 0; i < mailSettings.mailGroupCount; i++) {
-            for (uint8_t j = 0; j < mailSettings.mailGroups[i].attachmentCount; j++) {
-                String path = mailSettings.mailGroups[i].attachments[j];
-                if (LittleFS.exists(path)) {
-                    File f = LittleFS.open(path, "r");
-                    if (f) {
-                        totalSize += f.size();
-                        f.close();
-                    }
-                }
+        // Özeti tamamla - aynı içerik zaten varsa ikinci kopya yazılmaz
+        String blobPath;
+        bool deduplicated = false;
+        bool compressed = uploadContext.upload.compressed();
+        size_t originalSize = uploadContext.upload.receivedBytes();
+        if (!uploadContext.upload.finish(blobPath, deduplicated, uploadContext.errorMessage)) {
+            return;
+        }
+        size_t uploadedSize = uploadContext.upload.size(); // gzip altbilgisi dahil
+        if (uploadedSize > MAX_UPLOAD_SIZE) {
+            if (!deduplicated) LittleFS.remove(blobPath);
+            uploadContext.errorMessage = "Compressed file still exceeds 300 KB limit";
+            return;
+        }
+        if (compressed) {
+            // Alıcı ".gz" ekini herhangi bir arşiv aracıyla açar
+            uploadContext.originalName += ".gz";
+        }
+        bool alreadyReferenced = AttachmentStore::referenced(mailSettings, blobPath);
+        
+        String ref = AttachmentStore::makeRef(blobPath, uploadContext.originalName);
+        for (uint8_t j = 0; j < group.attachmentCount; ++j) {
+            if (AttachmentStore::resolve(group.attachments[j]) == blobPath) {
+                // Blob başka referanslarca kullanılıyor - silinmez
+                uploadContext.errorMessage = "This file is already attached to this group";
+                return;
             }
         }
         
-        if (totalSize > 921600) { // 900 KB = 921600 bytes
-            LittleFS.remove(uploadContext.storedPath);
+        // Toplam dosya boyutu kontrolü (900 KB total for all groups)
+        // Aynı içerik bir kez sayılır - başka grupta zaten varsa kota artmaz
+        AttachmentStore::Usage used = AttachmentStore::usage(mailSettings);
+        size_t totalSize = used.contentBytes + (alreadyReferenced ? 0 : uploadedSize);
+        
+        if (totalSize > ATTACHMENT_QUOTA_BYTES) { // 900 KB = 921600 bytes
+            if (!alreadyReferenced) {
+                LittleFS.remove(blobPath);
+                AttachmentCache::remove(blobPath);
+            }
             uploadContext.errorMessage = "Total storage exceeded 900 KB limit";
-            uploadContext.storedPath = "";
             return;
         }
         
-        // Dosyayı gruba ekle
-        group.attachments[group.attachmentCount++] = uploadContext.storedPath;
-        mail->updateConfig(mailSettings);
+        // Dosyayı gruba ekle - sadece burada yeni versiyon kopyalanır
+        MailSettings updated = mailSettings;
+        MailGroup &target = updated.mailGroups[groupIndex];
+        target.attachments[target.attachmentCount++] = ref;
+        mail->updateConfig(updated);
+        uploadContext.storedPath = ref;
+        uploadContext.compressed = compressed;
+        uploadContext.originalSize = originalSize;
+        uploadContext.storedSize = uploadedSize;
         
-    } else if (upload.status == UPLOAD_FILE_ABORTED) {
-        if (uploadContext.file) {
-            uploadContext.file.close();
-            LittleFS.remove(uploadContext.storedPath);
+        Serial.printf("[Upload] Grup %d ← %s (%s)\n", groupIndex + 1, ref.c_str(),
+                      alreadyReferenced ? "başka grupla ortak içerik" : (deduplicated ? "mevcut içerik" : "yeni içerik"));
+        if (compressed) {
+            // base64 ile her alıcıya giden DATA baytı da aynı oranda küçülür
+            Serial.printf("[Upload] Sıkıştırma: %u → %u bayt, alıcı başına ~%u bayt daha az DATA\n",
+                          (unsigned)originalSize, (unsigned)uploadedSize,
+                          (unsigned)(originalSize > uploadedSize ? (originalSize - uploadedSize) * 4 / 3 : 0));
+        }
+        
+        // Gönderimde yeniden kodlamamak için base64 kopyasını şimdi üret - içerik
+        // başına bir kez (başarısız olursa gönderim anında kodlanır - yükleme yine geçerli)
+        if (AttachmentCache::footprint(blobPath) == 0) {
+            String cacheError;
+            if (!AttachmentCache::build(blobPath, cacheError)) {
+                Serial.printf("[Upload] Sidecar üretilmedi: %s\n", cacheError.c_str());
+            }
         }
+        
+    } else if (upload.status == UPLOAD_FILE_ABORTED) {
         uploadContext.reset();
     }
 }
@@ -2636,31 +2948,34 @@ void WebInterface::handleAttachmentDelete() {
     }
     
     String path = server->arg("path");
-    MailSettings mailSettings = mail->currentConfig();
-    bool removed = false;
+    MailConfigHandle current = mail->currentConfig();
+    int foundGroup = -1;
+    int foundIndex = -1;
     
-    // Mail grupları içinde dosyayı ara ve sil
-    for (uint8_t groupIdx = 0; groupIdx < mailSettings.mailGroupCount; groupIdx++) {
-        MailGroup &group = mailSettings.mailGroups[groupIdx];
+    // Mail grupları içinde dosyayı ara (kopyasız snapshot üzerinden)
+    for (uint8_t groupIdx = 0; groupIdx < current->mailGroupCount && foundGroup < 0; groupIdx++) {
+        const MailGroup &group = current->mailGroups[groupIdx];
         for (uint8_t i = 0; i < group.attachmentCount; i++) {
             if (path == group.attachments[i]) {
-                // Dosyayı LittleFS'den sil
-                LittleFS.remove(path);
-                
-                // Array'den kaldır (kaydır)
-                for (uint8_t j = i; j + 1 < group.attachmentCount; j++) {
-                    group.attachments[j] = group.attachments[j + 1];
-                }
-                group.attachmentCount--;
-                removed = true;
+                foundGroup = groupIdx;
+                foundIndex = i;
                 break;
             }
         }
-        if (removed) break;
     }
     
-    if (removed) {
+    if (foundGroup >= 0) {
+        // Yeni versiyonu oluştur ve array'den kaldır (kaydır)
+        MailSettings mailSettings = *current;
+        MailGroup &group = mailSettings.mailGroups[foundGroup];
+        for (uint8_t j = foundIndex; j + 1 < group.attachmentCount; j++) {
+            group.attachments[j] = group.attachments[j + 1];
+        }
+        group.attachmentCount--;
         mail->updateConfig(mailSettings);
+        
+        // İçerik ve base64 kopyası yalnızca son referansla birlikte silinir
+        AttachmentStore::release(mailSettings, path);
         server->send(200, "application/json", "{\"status\":\"deleted\"}");
     } else {
         server->send(404, "application/json", "{\"error\":\"dosya bulunamadı\"}");
@@ -2679,6 +2994,55 @@ void WebInterface::handleLogs() {
     sendJson(doc);
 }
 
+void WebInterface::handleMetrics() {
+    // ?reset=1 → ölçüm penceresini sıfırla (ayar değişikliği sonrası karşılaştırma için)
+    if (server->arg("reset") == "1") {
+        SmtpMetrics::reset();
+    }
+
+    JsonDocument doc;
+    doc["uptimeMs"] = millis();
+
+    JsonArray bounds = doc["bucketBoundsMs"].to<JsonArray>();
+    for (uint16_t bound : SMTP_HISTOGRAM_BOUNDS_MS) {
+        bounds.add(bound);
+    }
+
+    SmtpMetricsSnapshot metrics = SmtpMetrics::snapshot(); // Kilit yalnızca kopya süresince
+
+    JsonArray servers = doc["smtp"].to<JsonArray>();
+    for (uint8_t i = 0; i < metrics.serverCount; ++i) {
+        const SmtpServerMetrics &entry = metrics.servers[i];
+        JsonObject item = servers.add<JsonObject>();
+        item["server"] = entry.server;
+        item["attempts"] = entry.attempts;
+        item["lastOutcome"] = RetryPolicy::name(entry.lastOutcome);
+        item["lastSeenSec"] = (millis() - entry.lastSeen) / 1000;
+
+        JsonObject outcomes = item["outcomes"].to<JsonObject>();
+        for (uint8_t k = 0; k < SMTP_OUTCOME_COUNT; ++k) {
+            FailureClass outcome = static_cast<FailureClass>(k);
+            outcomes[outcome == FailureClass::NONE ? "ok" : RetryPolicy::name(outcome)] = entry.outcomes[k];
+        }
+
+        JsonObject phases = item["phases"].to<JsonObject>();
+        for (uint8_t p = 0; p < SMTP_PHASE_COUNT; ++p) {
+            const SmtpPhaseHistogram &histogram = entry.phases[p];
+            if (histogram.count == 0) continue;
+            JsonObject phase = phases[SmtpMetrics::phaseName(static_cast<SmtpPhase>(p))].to<JsonObject>();
+            phase["count"] = histogram.count;
+            phase["avgMs"] = histogram.averageMs();
+            phase["maxMs"] = histogram.maxMs;
+            phase["lastMs"] = histogram.lastMs;
+            JsonArray buckets = phase["histogram"].to<JsonArray>();
+            for (uint16_t bucket : histogram.buckets) {
+                buckets.add(bucket);
+            }
+        }
+    }
+    sendJson(doc);
+}
+
 void WebInterface::handleI18n() {
     String lang = server->arg("lang");
     if (lang.isEmpty()) {
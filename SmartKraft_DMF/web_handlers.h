@@ -66,6 +66,8 @@ private:
 
     void handleMailGet();
     void handleMailUpdate();
+    void handleMailRecipients(); // Flash alıcı listesini text/plain olarak akıt
+    void handleMailRecipientsUpload(); // text/plain yüklemeyi satır satır yeni flash listesine yaz
     void handleMailTest();
 
     void handleWiFiGet();
@@ -86,6 +88,7 @@ private:
     void handleI18n();
 
     void handleLogs();
+    void handleMetrics(); // SMTP aşama histogramları + sonuç sınıfları
     void sendJson(const JsonDocument &doc);
     
     // Helper functions
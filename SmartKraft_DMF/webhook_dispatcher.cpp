@@ -0,0 +1,245 @@
+#include "webhook_dispatcher.h"
+
+#include <WiFi.h>
+
+namespace {
+
+// "https://host:port/yol?x" → "https://host:port" (bağlantı yeniden kullanım anahtarı)
+String originOf(const char *url) {
+    const char *authority = strstr(url, "://");
+    if (!authority) return String(url);
+    const char *end = strchr(authority + 3, '/');
+    return end ? String(url).substring(0, end - url) : String(url);
+}
+
+}
+
+bool WebhookDispatcher::enqueue(const String &url, const char *label) {
+    if (url.length() == 0 || url.length() >= WEBHOOK_URL_LEN) {
+        Serial.printf("[Webhook] ✗ %s: URL boş veya çok uzun (%u)\n", label, url.length());
+        return false;
+    }
+
+    bool queued = false;
+    bool startWorker = false;
+    portENTER_CRITICAL(&lock);
+    for (auto &job : jobs) {
+        if (job.used) continue;
+        strlcpy(job.url, url.c_str(), WEBHOOK_URL_LEN);
+        strlcpy(job.label, label, WEBHOOK_LABEL_LEN);
+        job.used = true;
+        job.inFlight = false;
+        job.attempts = 0;
+        job.notBefore = millis();
+        job.backoffMs = 0;
+        job.sequence = nextSequence++;
+        queued = true;
+        break;
+    }
+    if (!queued) {
+        counters.dropped++;
+    } else if (!worker && !workerStarting) {
+        workerStarting = true;
+        startWorker = true;
+    }
+    TaskHandle_t notify = worker;
+    portEXIT_CRITICAL(&lock);
+
+    if (!queued) {
+        Serial.printf("[Webhook] ✗ %s: kuyruk dolu (%u), düşürüldü\n", label, WEBHOOK_QUEUE_SIZE);
+        return false;
+    }
+
+    if (startWorker) {
+        TaskHandle_t handle = nullptr;
+        bool created = xTaskCreate(workerTask, "Webhook", WORKER_STACK, this, 1, &handle) == pdPASS;
+        portENTER_CRITICAL(&lock);
+        worker = created ? handle : nullptr;
+        workerStarting = false;
+        portEXIT_CRITICAL(&lock);
+        if (!created) {
+            // İş tabloda kalır - sonraki enqueue görevi yeniden açmayı dener
+            Serial.println(F("[Webhook] ⚠️ Çalışan görev açılamadı (heap?)"));
+        }
+    } else if (notify) {
+        xTaskNotifyGive(notify);
+    }
+
+    Serial.printf("[Webhook] %s kuyruğa alındı\n", label);
+    return true;
+}
+
+WebhookStats WebhookDispatcher::stats() const {
+    portENTER_CRITICAL(&lock);
+    WebhookStats snapshot = counters;
+    snapshot.pending = 0;
+    for (const auto &job : jobs) {
+        if (job.used) snapshot.pending++;
+    }
+    portEXIT_CRITICAL(&lock);
+    return snapshot;
+}
+
+void WebhookDispatcher::workerTask(void *param) {
+    static_cast<WebhookDispatcher *>(param)->run();
+}
+
+void WebhookDispatcher::run() {
+    http.setReuse(true);
+    tlsClient.setInsecure(); // Eskisi gibi: sertifika doğrulaması yok
+
+    while (true) {
+        uint32_t waitMs;
+        int slot = takeDue(waitMs);
+        if (slot < 0) {
+            // Bekleyen iş yoksa süresiz, varsa en yakın denemeye kadar uyu
+            if (connectedHost.length() && waitMs == UINT32_MAX) {
+                dropConnection(); // Boşta keep-alive soketi tutma
+            }
+            ulTaskNotifyTake(pdTRUE, waitMs == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(waitMs));
+            continue;
+        }
+
+        Job &job = jobs[slot];
+        if (WiFi.status() != WL_CONNECTED) {
+            defer(slot, DEFER_MS);
+            continue;
+        }
+        if (ESP.getFreeHeap() < MIN_FREE_HEAP) {
+            Serial.printf("[Webhook] %s ertelendi - heap düşük (%u)\n", job.label, ESP.getFreeHeap());
+            defer(slot, DEFER_MS);
+            continue;
+        }
+
+        bool reused = false;
+        uint32_t start = millis();
+        int httpCode = request(job, reused);
+        uint32_t durationMs = millis() - start;
+        job.attempts++;
+
+        Serial.printf("[Webhook] %s → %d (%lu ms, deneme %u%s)\n", job.label, httpCode,
+                      (unsigned long)durationMs, job.attempts, reused ? ", bağlantı yeniden kullanıldı" : "");
+        if (reused) {
+            portENTER_CRITICAL(&lock);
+            counters.reusedConnections++;
+            portEXIT_CRITICAL(&lock);
+        }
+
+        bool success = httpCode >= 200 && httpCode < 400;
+        if (!success) {
+            dropConnection(); // Durumu belirsiz bağlantıyı yeniden kullanma
+            if (retryable(httpCode) && job.attempts < WEBHOOK_MAX_ATTEMPTS) {
+                retry(slot);
+                continue;
+            }
+        }
+        finish(slot, httpCode, success, durationMs);
+    }
+}
+
+int WebhookDispatcher::takeDue(uint32_t &waitMs) {
+    uint32_t now = millis();
+    int due = -1;
+    waitMs = UINT32_MAX;
+
+    portENTER_CRITICAL(&lock);
+    for (uint8_t i = 0; i < WEBHOOK_QUEUE_SIZE; ++i) {
+        const Job &job = jobs[i];
+        if (!job.used || job.inFlight) continue;
+        int32_t remaining = (int32_t)(job.notBefore - now);
+        if (remaining <= 0) {
+            if (due < 0 || (int32_t)(job.sequence - jobs[due].sequence) < 0) due = i;
+        } else if ((uint32_t)remaining < waitMs) {
+            waitMs = remaining;
+        }
+    }
+    if (due >= 0) jobs[due].inFlight = true;
+    portEXIT_CRITICAL(&lock);
+    return due;
+}
+
+int WebhookDispatcher::request(const Job &job, bool &reused) {
+    bool secure = strncmp(job.url, "https://", 8) == 0;
+    WiFiClient &client = secure ? static_cast<WiFiClient &>(tlsClient) : plainClient;
+
+    // Farklı host:port → eski bağlantıyı kapat; aynıysa keep-alive soketi kullanılır
+    String origin = originOf(job.url);
+    if (origin != connectedHost) {
+        dropConnection();
+    }
+    reused = connectedHost.length() > 0 && client.connected();
+
+    if (!http.begin(client, job.url)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    http.setTimeout(8000);
+    http.setConnectTimeout(3000);
+    int httpCode = http.GET();
+    http.end(); // reuse=true → sunucu izin verdiyse soket açık kalır
+    connectedHost = client.connected() ? origin : String();
+    return httpCode;
+}
+
+void WebhookDispatcher::defer(int slot, uint32_t delayMs) {
+    portENTER_CRITICAL(&lock);
+    jobs[slot].notBefore = millis() + delayMs;
+    jobs[slot].inFlight = false;
+    portEXIT_CRITICAL(&lock);
+}
+
+void WebhookDispatcher::retry(int slot) {
+    Job &job = jobs[slot];
+    // Üstel geri çekilme + jitter: 2 s, ~4 s, ~8 s ... (tavan 60 s)
+    uint32_t backoff = job.backoffMs ? min(job.backoffMs * 2, BACKOFF_CAP_MS) : BACKOFF_BASE_MS;
+    uint32_t delayMs = backoff / 2 + esp_random() % (backoff / 2 + 1);
+    Serial.printf("[Webhook] %s %lu ms sonra tekrar denenecek\n", job.label, (unsigned long)delayMs);
+
+    portENTER_CRITICAL(&lock);
+    job.backoffMs = backoff;
+    job.notBefore = millis() + delayMs;
+    job.inFlight = false;
+    counters.retries++;
+    portEXIT_CRITICAL(&lock);
+}
+
+void WebhookDispatcher::finish(int slot, int httpCode, bool success, uint32_t durationMs) {
+    Job &job = jobs[slot];
+    WebhookResult result;
+    strlcpy(result.label, job.label, WEBHOOK_LABEL_LEN);
+    result.httpCode = (int16_t)httpCode;
+    result.attempts = job.attempts;
+    result.success = success;
+    result.durationMs = durationMs;
+    result.finishedAt = millis();
+
+    if (!success) {
+        Serial.printf("[Webhook] ✗ %s başarısız (%d, %u deneme)\n", job.label, httpCode, job.attempts);
+    }
+
+    portENTER_CRITICAL(&lock);
+    if (success) {
+        counters.delivered++;
+    } else {
+        counters.failed++;
+    }
+    // En yeni başta
+    for (uint8_t i = WEBHOOK_HISTORY_SIZE - 1; i > 0; --i) {
+        counters.history[i] = counters.history[i - 1];
+    }
+    counters.history[0] = result;
+    if (counters.historyCount < WEBHOOK_HISTORY_SIZE) counters.historyCount++;
+    job.used = false;
+    job.inFlight = false;
+    portEXIT_CRITICAL(&lock);
+}
+
+void WebhookDispatcher::dropConnection() {
+    plainClient.stop();
+    tlsClient.stop();
+    connectedHost = "";
+}
+
+bool WebhookDispatcher::retryable(int httpCode) {
+    // Bağlantı/zaman aşımı hataları (<0), hız sınırı ve sunucu hataları
+    return httpCode <= 0 || httpCode == 408 || httpCode == 429 || httpCode >= 500;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <HTTPClient.h>
+#include "tls_session_cache.h"
+
+// ============================================================================
+// WEBHOOK (GET URL) GÖNDERİCİSİ - Tek kalıcı çalışan, sınırlı iş kuyruğu
+// ============================================================================
+// Eskiden her uyarı / başarılı grup için 8 KB yığınlı yeni bir görev, yeni bir
+// String ve yeni bir TLS istemcisi oluşturuluyordu; sonuç atılıyor, hata
+// tekrar denenmiyordu. Art arda birkaç alarm birkaç 8 KB görevi AYNI ANDA
+// açabiliyordu (cihaz ~20 KB boş heap'in altında yeniden başlıyor).
+//
+// Artık:
+//   - Tek çalışan görev (ilk işte açılır, kapanmaz) → en fazla 1 istek uçuşta
+//   - Sabit boyutlu iş tablosu (WEBHOOK_QUEUE_SIZE) - doluysa yeni iş düşer
+//   - Aynı host:port'a keep-alive bağlantı yeniden kullanılır (HTTPS'te TLS
+//     oturumu da CachedTlsClient önbelleğinden devam eder)
+//   - Bağlantı hatası / 5xx / 429 → üstel geri çekilme + jitter ile yeniden
+//     deneme; diğer 4xx kalıcı hatadır
+//   - WiFi yokken veya heap düşükken iş deneme hakkı harcamadan bekler
+//   - Son sonuçlar + sayaçlar /api/status "webhooks" altında
+
+static const uint8_t WEBHOOK_QUEUE_SIZE = 8;
+static const uint8_t WEBHOOK_HISTORY_SIZE = 4;
+static const uint8_t WEBHOOK_MAX_ATTEMPTS = 4;
+static const size_t WEBHOOK_URL_LEN = 256;
+static const size_t WEBHOOK_LABEL_LEN = 16;
+
+struct WebhookResult {
+    char label[WEBHOOK_LABEL_LEN] = {0}; // "warning-2", "final-g1" ...
+    int16_t httpCode = 0;                // <0 → HTTPClient hata kodu
+    uint8_t attempts = 0;
+    bool success = false;
+    uint32_t durationMs = 0;             // Son denemenin süresi
+    uint32_t finishedAt = 0;             // millis()
+};
+
+struct WebhookStats {
+    uint8_t pending = 0;
+    uint32_t delivered = 0;
+    uint32_t failed = 0;       // Deneme hakkı bitti / kalıcı hata
+    uint32_t retries = 0;
+    uint32_t dropped = 0;      // Kuyruk doluydu
+    uint32_t reusedConnections = 0;
+    uint8_t historyCount = 0;
+    WebhookResult history[WEBHOOK_HISTORY_SIZE]; // En yeni önce
+};
+
+class WebhookDispatcher {
+public:
+    // URL'yi kuyruğa al (çağıran hiç beklemez); false → kuyruk dolu / URL çok uzun
+    bool enqueue(const String &url, const char *label);
+
+    WebhookStats stats() const;
+
+private:
+    struct Job {
+        char url[WEBHOOK_URL_LEN];
+        char label[WEBHOOK_LABEL_LEN];
+        bool used = false;
+        bool inFlight = false;     // Çalışan görevde - enqueue bu slota dokunmaz
+        uint8_t attempts = 0;
+        uint32_t notBefore = 0;    // millis() - bu andan önce denenmez
+        uint32_t backoffMs = 0;
+        uint32_t sequence = 0;     // Aynı anda hazır işlerde FIFO
+    };
+
+    Job jobs[WEBHOOK_QUEUE_SIZE];
+    uint32_t nextSequence = 0;
+    WebhookStats counters;
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t worker = nullptr;
+    bool workerStarting = false;
+
+    // Yalnızca çalışan görev kullanır (bağlantı yeniden kullanımı)
+    HTTPClient http;
+    WiFiClient plainClient;
+    CachedTlsClient tlsClient;
+    String connectedHost;          // "https://host:port" - değişince bağlantı kapatılır
+
+    static constexpr uint32_t WORKER_STACK = 8192;
+    static constexpr uint32_t MIN_FREE_HEAP = 40 * 1024; // Altında TLS açılmaz, iş bekler
+    static constexpr uint32_t DEFER_MS = 5000;           // WiFi / heap bekleme aralığı
+    static constexpr uint32_t BACKOFF_BASE_MS = 2000;
+    static constexpr uint32_t BACKOFF_CAP_MS = 60000;
+
+    static void workerTask(void *param);
+    void run();
+    int takeDue(uint32_t &waitMs);             // Zamanı gelmiş en eski iş (slot) veya -1
+    int request(const Job &job, bool &reused);
+    void defer(int slot, uint32_t delayMs);    // Deneme sayılmadan ertele
+    void retry(int slot);                      // Geri çekilme ile yeniden sıraya
+    void finish(int slot, int httpCode, bool success, uint32_t durationMs);
+    void dropConnection();
+    static bool retryable(int httpCode);
+};
@@ -0,0 +1,209 @@
+#include "wifi_link_cache.h"
+#include "config_store.h"
+
+#include <Preferences.h>
+#include <esp_system.h>
+
+namespace {
+
+constexpr const char *NVS_LINK_KEY = "wifi_link";
+constexpr uint32_t RTC_MAGIC = 0x574C4E4B; // "WLNK"
+
+// Ham bayt: varsayılan değerli yapılar doğrudan üye olsaydı statik
+// ilklendirme her açılışta RTC içeriğini sıfırlardı
+struct RtcStore {
+    uint32_t magic;
+    uint32_t checksum;
+    uint8_t record[sizeof(WiFiLinkRecord)];
+    uint8_t stats[sizeof(WiFiLinkStats)];
+};
+
+RTC_NOINIT_ATTR RtcStore rtcStore;
+
+portMUX_TYPE linkLock = portMUX_INITIALIZER_UNLOCKED;
+WiFiLinkRecord cached;
+WiFiLinkStats counters;
+WiFiConnectKind bootKind = WiFiConnectKind::COLD_BOOT;
+bool connectedThisBoot = false;
+
+uint32_t rtcChecksum() {
+    // FNV-1a - magic/checksum alanları hariç
+    const uint8_t *bytes = rtcStore.record;
+    size_t len = sizeof(RtcStore) - offsetof(RtcStore, record);
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+// Kilit tutulurken çağrılır
+void persistToRtc() {
+    memcpy(rtcStore.record, &cached, sizeof(cached));
+    memcpy(rtcStore.stats, &counters, sizeof(counters));
+    rtcStore.magic = RTC_MAGIC;
+    rtcStore.checksum = rtcChecksum();
+}
+
+void saveToNvs(const WiFiLinkRecord &record) {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) return;
+    if (record.valid()) {
+        prefs.putBytes(NVS_LINK_KEY, &record, sizeof(record));
+    } else {
+        prefs.remove(NVS_LINK_KEY);
+    }
+    prefs.end();
+}
+
+bool sameLink(const WiFiLinkRecord &a, const WiFiLinkRecord &b) {
+    return strcmp(a.ssid, b.ssid) == 0 && memcmp(a.bssid, b.bssid, sizeof(a.bssid)) == 0 &&
+           a.channel == b.channel && a.ip == b.ip && a.gateway == b.gateway &&
+           a.subnet == b.subnet && a.dns == b.dns;
+}
+
+}
+
+String WiFiLinkRecord::bssidString() const {
+    char text[18];
+    snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X",
+             bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+    return String(text);
+}
+
+namespace WiFiLinkCache {
+
+void begin() {
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool warmBoot = reason == ESP_RST_SW || reason == ESP_RST_PANIC ||
+                    reason == ESP_RST_INT_WDT || reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT;
+    bool rtcValid = warmBoot && rtcStore.magic == RTC_MAGIC && rtcStore.checksum == rtcChecksum();
+
+    WiFiLinkRecord record;
+    WiFiLinkStats restored;
+    const char *source = "yok";
+    if (rtcValid) {
+        memcpy(&record, rtcStore.record, sizeof(record));
+        memcpy(&restored, rtcStore.stats, sizeof(restored));
+        source = "RTC";
+    } else {
+        Preferences prefs;
+        if (prefs.begin(NVS_NAMESPACE, true)) {
+            if (prefs.getBytesLength(NVS_LINK_KEY) == sizeof(record) &&
+                prefs.getBytes(NVS_LINK_KEY, &record, sizeof(record)) == sizeof(record)) {
+                source = "NVS";
+            }
+            prefs.end();
+        }
+    }
+    record.ssid[sizeof(record.ssid) - 1] = '\0';
+    if (!record.valid()) record = WiFiLinkRecord();
+
+    portENTER_CRITICAL(&linkLock);
+    cached = record;
+    counters = restored;
+    bootKind = warmBoot ? WiFiConnectKind::WARM_BOOT : WiFiConnectKind::COLD_BOOT;
+    connectedThisBoot = false;
+    persistToRtc();
+    portEXIT_CRITICAL(&linkLock);
+
+    if (record.valid()) {
+        Serial.printf("[WiFi] Hızlı bağlantı kaydı (%s): %s @ %s, kanal %u\n",
+                      source, record.ssid, record.bssidString().c_str(), record.channel);
+    } else {
+        Serial.println(F("[WiFi] Hızlı bağlantı kaydı yok - ilk bağlantı taramayla"));
+    }
+}
+
+bool load(WiFiLinkRecord &record) {
+    portENTER_CRITICAL(&linkLock);
+    record = cached;
+    portEXIT_CRITICAL(&linkLock);
+    return record.valid();
+}
+
+void store(const WiFiLinkRecord &record) {
+    if (!record.valid()) return;
+
+    portENTER_CRITICAL(&linkLock);
+    bool unchanged = sameLink(cached, record);
+    bool leaseChanged = strcmp(cached.ssid, record.ssid) == 0 && cached.ip != 0 && cached.ip != record.ip;
+    if (leaseChanged) counters.leaseChanges++;
+    cached = record;
+    persistToRtc();
+    portEXIT_CRITICAL(&linkLock);
+
+    if (leaseChanged) {
+        Serial.printf("[WiFi] DHCP farklı adres verdi: %s\n", IPAddress(record.ip).toString().c_str());
+    }
+    // Aynı AP'ye yeniden bağlanma flash'a yazmaz
+    if (!unchanged) saveToNvs(record);
+}
+
+void forget() {
+    portENTER_CRITICAL(&linkLock);
+    bool hadRecord = cached.valid();
+    cached = WiFiLinkRecord();
+    persistToRtc();
+    portEXIT_CRITICAL(&linkLock);
+
+    if (hadRecord) saveToNvs(WiFiLinkRecord());
+}
+
+WiFiConnectKind nextKind() {
+    portENTER_CRITICAL(&linkLock);
+    WiFiConnectKind kind = connectedThisBoot ? WiFiConnectKind::RECONNECT : bootKind;
+    portEXIT_CRITICAL(&linkLock);
+    return kind;
+}
+
+void recordConnect(WiFiConnectKind kind, uint32_t elapsedMs, bool fast) {
+    uint8_t index = static_cast<uint8_t>(kind);
+    if (index >= WIFI_CONNECT_KIND_COUNT) return;
+
+    portENTER_CRITICAL(&linkLock);
+    WiFiConnectTiming &timing = counters.kinds[index];
+    timing.count++;
+    timing.totalMs += elapsedMs;
+    timing.lastMs = elapsedMs;
+    if (fast) {
+        timing.fastCount++;
+        counters.fastAttempts++;
+    }
+    connectedThisBoot = true;
+    persistToRtc();
+    WiFiConnectTiming snapshot = timing;
+    portEXIT_CRITICAL(&linkLock);
+
+    Serial.printf("[WiFi] Bağlandı (%s, %s): %lu ms - ortalama %lu ms / %lu bağlantı\n",
+                  kindName(kind), fast ? "taramasız" : "taramalı", (unsigned long)elapsedMs,
+                  (unsigned long)snapshot.averageMs(), (unsigned long)snapshot.count);
+}
+
+void recordFallback() {
+    portENTER_CRITICAL(&linkLock);
+    counters.fastAttempts++;
+    counters.fastFallbacks++;
+    persistToRtc();
+    portEXIT_CRITICAL(&linkLock);
+}
+
+WiFiLinkStats stats() {
+    portENTER_CRITICAL(&linkLock);
+    WiFiLinkStats copy = counters;
+    portEXIT_CRITICAL(&linkLock);
+    return copy;
+}
+
+const char *kindName(WiFiConnectKind kind) {
+    switch (kind) {
+        case WiFiConnectKind::COLD_BOOT: return "soğuk açılış";
+        case WiFiConnectKind::WARM_BOOT: return "sıcak açılış";
+        case WiFiConnectKind::RECONNECT: return "yeniden bağlanma";
+        case WiFiConnectKind::COUNT:     break;
+    }
+    return "?";
+}
+
+}
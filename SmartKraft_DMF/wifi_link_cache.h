@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================================================
+// HIZLI WIFI BAĞLANTISI - Son başarılı BSSID / kanal / DHCP kaydı
+// ============================================================================
+// connectToKnown() her bağlanmada (açılış, 24 saatlik planlı restart, kopma
+// sonrası) önce tarama yapıyordu: SSID başına 3 tur, turlar arası 2 s. Tam
+// tarama tek başına ~2-3 s sürer.
+//
+// Son başarılı bağlantının erişim noktası (BSSID), kanalı ve DHCP kirası
+// saklanır. Sonraki bağlanmada tarama yapılmadan bu AP'ye, kanala sabitlenmiş
+// olarak doğrudan bağlanılır; olmazsa kayıt unutulur ve eski tarama yoluna
+// düşülür.
+//
+//   - RTC_NOINIT: yazılımsal resetlerde (planlı restart, OTA, WDT) korunur
+//   - NVS: güç kesintisinden sonra da; yalnızca kayıt değiştiğinde yazılır
+//     (flash aşınması - aynı AP'ye her bağlanmada yazma yok)
+//
+// DHCP kirası adres olarak yeniden UYGULANMAZ (yönlendirici adresi başkasına
+// vermiş olabilir, hazır lwIP INIT-REBOOT sunmuyor); değişim günlüklenir ve
+// durum sayfasında gösterilir.
+//
+// Bağlanma süresi soğuk açılış / sıcak açılış / yeniden bağlanma olarak
+// ayrı ölçülür (sayaçlar da RTC'de tutulur, sıcak açılışlarda birikir).
+
+static const uint32_t WIFI_FAST_CONNECT_TIMEOUT_MS = 6000; // Doğrudan bağlanma denemesi
+
+struct WiFiLinkRecord {
+    char ssid[33] = {0};
+    uint8_t bssid[6] = {0};
+    uint8_t channel = 0;
+    uint32_t ip = 0;        // Son DHCP kirası (bilgi amaçlı)
+    uint32_t gateway = 0;
+    uint32_t subnet = 0;
+    uint32_t dns = 0;
+
+    bool valid() const { return ssid[0] != '\0' && channel != 0; }
+    String bssidString() const;
+};
+
+enum class WiFiConnectKind : uint8_t {
+    COLD_BOOT = 0,  // Güç açılışı / harici reset sonrası ilk bağlantı
+    WARM_BOOT,      // Yazılımsal reset sonrası ilk bağlantı
+    RECONNECT,      // Çalışırken kopma sonrası
+    COUNT
+};
+
+static const uint8_t WIFI_CONNECT_KIND_COUNT = static_cast<uint8_t>(WiFiConnectKind::COUNT);
+
+struct WiFiConnectTiming {
+    uint32_t count = 0;
+    uint32_t fastCount = 0;     // Taramasız bağlananlar
+    uint32_t totalMs = 0;
+    uint32_t lastMs = 0;
+
+    uint32_t averageMs() const { return count ? totalMs / count : 0; }
+};
+
+struct WiFiLinkStats {
+    WiFiConnectTiming kinds[WIFI_CONNECT_KIND_COUNT];
+    uint32_t fastAttempts = 0;
+    uint32_t fastFallbacks = 0; // Doğrudan bağlanma olmadı → tarama
+    uint32_t leaseChanges = 0;  // DHCP farklı adres verdi
+};
+
+namespace WiFiLinkCache {
+    // setup() içinde, ağ bağlantısından önce - RTC geçerliyse oradan, yoksa NVS
+    void begin();
+
+    bool load(WiFiLinkRecord &record);
+    void store(const WiFiLinkRecord &record);
+    void forget();
+
+    // Bu açılışta henüz bağlanılmadıysa açılış türü, yoksa RECONNECT
+    WiFiConnectKind nextKind();
+    void recordConnect(WiFiConnectKind kind, uint32_t elapsedMs, bool fast);
+    void recordFallback();
+
+    WiFiLinkStats stats();
+    const char *kindName(WiFiConnectKind kind);
+}
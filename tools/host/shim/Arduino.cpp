@@ -0,0 +1,513 @@
+#include "Arduino.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <random>
+#include <thread>
+
+// ============================================================================
+// Saat
+// ============================================================================
+
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+const SteadyClock::time_point clockStart = SteadyClock::now();
+std::atomic<uint64_t> clockOffsetUs{0};
+
+std::mutex timeMutex;
+std::condition_variable timeChanged;
+
+uint64_t nowMicros() {
+    uint64_t real = std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - clockStart).count();
+    return real + clockOffsetUs.load();
+}
+
+}
+
+unsigned long millis() { return (unsigned long)(uint32_t)(nowMicros() / 1000); }
+unsigned long micros() { return (unsigned long)(uint32_t)nowMicros(); }
+
+void delay(uint32_t ms) {
+    uint32_t deadline = millis() + ms;
+    HostClock::waitUntil([] { return false; }, deadline, false);
+}
+
+void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+void yield() { std::this_thread::yield(); }
+
+namespace HostClock {
+
+void advance(uint32_t ms) {
+    clockOffsetUs += (uint64_t)ms * 1000;
+    notifyAll();
+}
+
+void notifyAll() {
+    std::lock_guard<std::mutex> guard(timeMutex);
+    timeChanged.notify_all();
+}
+
+bool waitUntil(const std::function<bool()> &ready, uint32_t deadlineMs, bool forever) {
+    // Gerçek bekleme kısa dilimlerle: advance() sanal süreyi ileri aldığında da uyanılır
+    std::unique_lock<std::mutex> guard(timeMutex);
+    while (true) {
+        if (ready()) return true;
+        int32_t remaining = (int32_t)(deadlineMs - (uint32_t)millis());
+        if (!forever && remaining <= 0) return false;
+        uint32_t slice = forever ? 5 : std::min<uint32_t>((uint32_t)remaining, 5);
+        timeChanged.wait_for(guard, std::chrono::milliseconds(slice ? slice : 1));
+    }
+}
+
+}
+
+// ============================================================================
+// Rastgelelik
+// ============================================================================
+
+namespace {
+std::mutex randomMutex;
+std::mt19937 generator(0x5EED1234u);
+std::function<uint32_t()> randomSource;
+}
+
+namespace HostRandom {
+
+void seed(uint32_t value) {
+    std::lock_guard<std::mutex> guard(randomMutex);
+    generator.seed(value);
+}
+
+void set(std::function<uint32_t()> source) {
+    std::lock_guard<std::mutex> guard(randomMutex);
+    randomSource = std::move(source);
+}
+
+}
+
+uint32_t esp_random() {
+    std::lock_guard<std::mutex> guard(randomMutex);
+    return randomSource ? randomSource() : generator();
+}
+
+long random(long howbig) { return howbig <= 0 ? 0 : (long)(esp_random() % (uint32_t)howbig); }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+void randomSeed(unsigned long seed) { HostRandom::seed((uint32_t)seed); }
+
+extern "C" size_t strlcpy(char *dst, const char *src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+extern "C" size_t strlcat(char *dst, const char *src, size_t size) {
+    size_t used = strnlen(dst, size);
+    if (used == size) return size + strlen(src);
+    return used + strlcpy(dst + used, src, size - used);
+}
+
+void pinMode(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return HIGH; }
+void digitalWrite(uint8_t, uint8_t) {}
+
+// ============================================================================
+// String
+// ============================================================================
+
+namespace {
+
+std::string formatUnsigned(unsigned long long n, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    if (n == 0) return "0";
+    std::string out;
+    while (n) {
+        unsigned digit = n % base;
+        out += (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        n /= base;
+    }
+    std::reverse(out.begin(), out.end());
+    return out;
+}
+
+std::string formatSigned(long long n, unsigned char base) {
+    if (n < 0 && base == 10) return "-" + formatUnsigned((unsigned long long)(-(n + 1)) + 1, base);
+    return formatUnsigned((unsigned long long)n, base);
+}
+
+std::string formatDouble(double n, unsigned char digits) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, n);
+    return buffer;
+}
+
+}
+
+String::String(long n, unsigned char base) : s_(formatSigned(n, base)) {}
+String::String(unsigned long n, unsigned char base) : s_(formatUnsigned(n, base)) {}
+String::String(long long n, unsigned char base) : s_(formatSigned(n, base)) {}
+String::String(unsigned long long n, unsigned char base) : s_(formatUnsigned(n, base)) {}
+String::String(double n, unsigned char digits) : s_(formatDouble(n, digits)) {}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s_.size()) return String();
+    to = std::min<unsigned int>(to, s_.size());
+    return String(s_.substr(from, to - from));
+}
+
+void String::replace(const String &from, const String &to) {
+    if (from.s_.empty()) return;
+    size_t at = 0;
+    while ((at = s_.find(from.s_, at)) != std::string::npos) {
+        s_.replace(at, from.s_.size(), to.s_);
+        at += to.s_.size();
+    }
+}
+
+void String::trim() {
+    size_t begin = 0;
+    while (begin < s_.size() && isspace((unsigned char)s_[begin])) begin++;
+    size_t end = s_.size();
+    while (end > begin && isspace((unsigned char)s_[end - 1])) end--;
+    s_ = s_.substr(begin, end - begin);
+}
+
+void String::toLowerCase() {
+    for (auto &c : s_) c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (auto &c : s_) c = (char)toupper((unsigned char)c);
+}
+
+void String::getBytes(unsigned char *buf, unsigned int size, unsigned int index) const {
+    if (!size || !buf) return;
+    if (index >= s_.size()) {
+        buf[0] = 0;
+        return;
+    }
+    unsigned int n = std::min<unsigned int>(size - 1, s_.size() - index);
+    memcpy(buf, s_.data() + index, n);
+    buf[n] = 0;
+}
+
+String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+String operator+(const String &a, const char *b) { String r(a); r += b; return r; }
+String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+String operator+(const String &a, char b) { String r(a); r += b; return r; }
+String operator+(char a, const String &b) { String r(a); r += b; return r; }
+
+// ============================================================================
+// Print / Stream
+// ============================================================================
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        if (!write(*buffer++)) break;
+        n++;
+    }
+    return n;
+}
+
+size_t Print::print(const String &s) { return write((const uint8_t *)s.c_str(), s.length()); }
+size_t Print::print(long n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(unsigned long n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(long long n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(unsigned long long n, int base) { return print(String(n, (unsigned char)base)); }
+size_t Print::print(double n, int digits) { return print(String(n, (unsigned char)digits)); }
+
+size_t Print::printf(const char *format, ...) {
+    char stackBuffer[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(stackBuffer, sizeof(stackBuffer), format, args);
+    va_end(args);
+    if (len < 0) return 0;
+    if ((size_t)len < sizeof(stackBuffer)) return write((const uint8_t *)stackBuffer, len);
+
+    std::vector<char> heapBuffer(len + 1);
+    va_start(args, format);
+    vsnprintf(heapBuffer.data(), heapBuffer.size(), format, args);
+    va_end(args);
+    return write((const uint8_t *)heapBuffer.data(), len);
+}
+
+int Stream::timedRead() {
+    uint32_t start = millis();
+    do {
+        int c = read();
+        if (c >= 0) return c;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    } while (millis() - start < _timeout);
+    return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = timedRead();
+        if (c < 0) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+    std::string out;
+    int c;
+    while ((c = timedRead()) >= 0 && c != terminator) out += (char)c;
+    return String(out);
+}
+
+String Stream::readString() {
+    std::string out;
+    int c;
+    while ((c = timedRead()) >= 0) out += (char)c;
+    return String(out);
+}
+
+// ============================================================================
+// Serial / ESP / IPAddress
+// ============================================================================
+
+HardwareSerial Serial;
+
+namespace {
+bool serialEnabled() {
+    static const bool enabled = getenv("DMF_HOST_LOG") != nullptr;
+    return enabled;
+}
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (serialEnabled()) fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+    if (serialEnabled()) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+EspClass ESP;
+
+namespace {
+std::atomic<uint32_t> freeHeap{180 * 1024};
+}
+
+uint32_t EspClass::getFreeHeap() { return freeHeap.load(); }
+
+void EspClass::restart() {
+    fprintf(stderr, "[host] ESP.restart() çağrıldı\n");
+    abort();
+}
+
+namespace HostEsp {
+void setFreeHeap(uint32_t bytes) { freeHeap = bytes; }
+}
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+bool IPAddress::fromString(const char *text) {
+    if (!text) return false;
+    unsigned parts[4];
+    char tail;
+    if (sscanf(text, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &tail) != 4) return false;
+    for (int i = 0; i < 4; ++i) {
+        if (parts[i] > 255) return false;
+        bytes_[i] = (uint8_t)parts[i];
+    }
+    return true;
+}
+
+bool IPAddress::fromString(const String &text) { return fromString(text.c_str()); }
+
+String IPAddress::toString() const {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", bytes_[0], bytes_[1], bytes_[2], bytes_[3]);
+    return String(buffer);
+}
+
+// ============================================================================
+// FreeRTOS
+// ============================================================================
+
+struct HostTask {
+    std::mutex m;
+    uint32_t notifications = 0;
+    UBaseType_t priority = 1;
+};
+
+struct HostSemaphore {
+    std::mutex m;
+    UBaseType_t count = 0;
+    UBaseType_t maxCount = 1;
+};
+
+struct HostQueue {
+    std::mutex m;
+    std::deque<std::vector<uint8_t>> items;
+    UBaseType_t length = 0;
+    UBaseType_t itemSize = 0;
+};
+
+namespace {
+
+struct TaskExit {};
+
+HostTask mainTask;
+thread_local HostTask *currentTask = &mainTask;
+std::atomic<uint32_t> tasksRunning{0};
+std::atomic<uint32_t> tasksCreated{0};
+std::atomic<uint32_t> tasksToFail{0};
+
+bool waitTicks(const std::function<bool()> &ready, TickType_t ticks) {
+    bool forever = ticks == portMAX_DELAY;
+    return HostClock::waitUntil(ready, (uint32_t)millis() + (forever ? 0 : ticks), forever);
+}
+
+}
+
+namespace HostTasks {
+uint32_t running() { return tasksRunning.load(); }
+uint32_t created() { return tasksCreated.load(); }
+void failCreates(uint32_t count) { tasksToFail = count; }
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *, uint32_t, void *param, UBaseType_t priority,
+                       TaskHandle_t *handle) {
+    uint32_t pending = tasksToFail.load();
+    while (pending > 0 && !tasksToFail.compare_exchange_weak(pending, pending - 1)) {
+    }
+    if (pending > 0) return pdFAIL;
+    HostTask *task = new HostTask();
+    task->priority = priority;
+    if (handle) *handle = task;
+    tasksRunning++;
+    tasksCreated++;
+    std::thread([fn, param, task] {
+        currentTask = task;
+        try {
+            fn(param);
+        } catch (const TaskExit &) {
+        }
+        tasksRunning--;
+        HostClock::notifyAll();
+        // Görev tanıtıcısı sızdırılır: FreeRTOS'ta da silinen görevin tanıtıcısı geçersizdir
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t) {
+    return xTaskCreate(fn, name, stackDepth, param, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == currentTask) throw TaskExit();
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return currentTask; }
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) { return (task ? task : currentTask)->priority; }
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 1024; }
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    HostTask *task = currentTask;
+    uint32_t value = 0;
+    waitTicks([&] {
+        std::lock_guard<std::mutex> guard(task->m);
+        if (task->notifications == 0) return false;
+        value = task->notifications;
+        task->notifications = clearOnExit ? 0 : task->notifications - 1;
+        return true;
+    }, ticks);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> guard(task->m);
+        task->notifications++;
+    }
+    HostClock::notifyAll();
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    HostSemaphore *sem = new HostSemaphore();
+    sem->maxCount = maxCount;
+    sem->count = initialCount;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return xSemaphoreCreateCounting(1, 1); }
+SemaphoreHandle_t xSemaphoreCreateBinary() { return xSemaphoreCreateCounting(1, 0); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    return waitTicks([sem] {
+        std::lock_guard<std::mutex> guard(sem->m);
+        if (sem->count == 0) return false;
+        sem->count--;
+        return true;
+    }, ticks) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    {
+        std::lock_guard<std::mutex> guard(sem->m);
+        if (sem->count >= sem->maxCount) return pdFALSE;
+        sem->count++;
+    }
+    HostClock::notifyAll();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    HostQueue *queue = new HostQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    bool ok = waitTicks([queue, item] {
+        std::lock_guard<std::mutex> guard(queue->m);
+        if (queue->items.size() >= queue->length) return false;
+        const uint8_t *bytes = static_cast<const uint8_t *>(item);
+        queue->items.emplace_back(bytes, bytes + queue->itemSize);
+        return true;
+    }, ticks);
+    if (ok) HostClock::notifyAll();
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+    bool ok = waitTicks([queue, item] {
+        std::lock_guard<std::mutex> guard(queue->m);
+        if (queue->items.empty()) return false;
+        memcpy(item, queue->items.front().data(), queue->itemSize);
+        queue->items.pop_front();
+        return true;
+    }, ticks);
+    if (ok) HostClock::notifyAll();
+    return ok ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> guard(queue->m);
+    return (UBaseType_t)queue->items.size();
+}
+
+void vQueueDelete(QueueHandle_t queue) { delete queue; }
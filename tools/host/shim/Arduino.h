@@ -0,0 +1,269 @@
+#pragma once
+
+// ============================================================================
+// HOST SHIM - Arduino-ESP32 çekirdeğinin posta yolunun kullandığı alt kümesi
+// ============================================================================
+// Yalnızca tools/host hedefleri içindir; Arduino IDE bu klasörü derlemez.
+// Firmware kaynakları değiştirilmeden Linux'ta derlenir:
+//   - String / Print / Stream: std::string üzerinde
+//   - millis()/micros(): gerçek süre + HostClock::advance() ile ileri sarma
+//   - esp_random(): HostRandom ile tekrarlanabilir (tohumlanabilir) üreteç
+//   - FreeRTOS görev/semafor/kuyruk: std::thread + koşul değişkenleri
+//   - Serial: DMF_HOST_LOG=1 ortam değişkeni varsa stdout'a, yoksa sessiz
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdarg>
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define F(x) (x)
+#define PSTR(x) (x)
+#define PROGMEM
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+template <class T, class A, class B>
+T constrain(T x, A a, B b) { return x < (T)a ? (T)a : (x > (T)b ? (T)b : x); }
+using std::min;
+using std::max;
+
+extern "C" size_t strlcpy(char *dst, const char *src, size_t size);
+extern "C" size_t strlcat(char *dst, const char *src, size_t size);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+// Sanal saat: testler beklemeden zaman atlatabilir (geri çekilme, TTL)
+namespace HostClock {
+    void advance(uint32_t ms);
+    // Görev beklemeleri: koşul ya da sanal son tarih (millis) gelene kadar
+    bool waitUntil(const std::function<bool()> &ready, uint32_t deadlineMs, bool forever);
+    void notifyAll();
+}
+
+// esp_random() kaynağı - varsayılan sabit tohumlu mt19937
+namespace HostRandom {
+    void seed(uint32_t value);
+    void set(std::function<uint32_t()> source); // nullptr → varsayılana dön
+}
+
+class String;
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const String &s);
+    size_t print(const char *s) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = 10) { return print((unsigned long)n, base); }
+    size_t print(int n, int base = 10) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = 10) { return print((unsigned long)n, base); }
+    size_t print(long n, int base = 10);
+    size_t print(unsigned long n, int base = 10);
+    size_t print(long long n, int base = 10);
+    size_t print(unsigned long long n, int base = 10);
+    size_t print(double n, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T &value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(const T &value, int format) { size_t n = print(value, format); return n + println(); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    int getWriteError() { return 0; }
+    void clearWriteError() {}
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual size_t readBytes(char *buffer, size_t length);
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    String readStringUntil(char terminator);
+    String readString();
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    unsigned long getTimeout() const { return _timeout; }
+
+protected:
+    unsigned long _timeout = 1000;
+    int timedRead();
+};
+
+class String {
+public:
+    String() {}
+    String(const char *s) : s_(s ? s : "") {}
+    String(const char *s, size_t len) : s_(s, len) {}
+    String(const std::string &s) : s_(s) {}
+    String(const String &) = default;
+    String(String &&) noexcept = default;
+    explicit String(char c) : s_(1, c) {}
+    explicit String(unsigned char n, unsigned char base = 10) : String((unsigned long)n, base) {}
+    explicit String(int n, unsigned char base = 10) : String((long)n, base) {}
+    explicit String(unsigned int n, unsigned char base = 10) : String((unsigned long)n, base) {}
+    explicit String(long n, unsigned char base = 10);
+    explicit String(unsigned long n, unsigned char base = 10);
+    explicit String(long long n, unsigned char base = 10);
+    explicit String(unsigned long long n, unsigned char base = 10);
+    explicit String(float n, unsigned char digits = 2) : String((double)n, digits) {}
+    explicit String(double n, unsigned char digits = 2);
+
+    String &operator=(const String &) = default;
+    String &operator=(String &&) noexcept = default;
+    String &operator=(const char *s) { s_ = s ? s : ""; return *this; }
+
+    String &operator+=(const String &o) { s_ += o.s_; return *this; }
+    String &operator+=(const char *s) { if (s) s_ += s; return *this; }
+    String &operator+=(char c) { s_ += c; return *this; }
+    String &operator+=(int n) { return *this += String(n); }
+    String &operator+=(unsigned int n) { return *this += String(n); }
+    String &operator+=(long n) { return *this += String(n); }
+    String &operator+=(unsigned long n) { return *this += String(n); }
+
+    bool concat(const String &o) { s_ += o.s_; return true; }
+    bool concat(const char *s) { if (s) s_ += s; return true; }
+    bool concat(const char *s, unsigned int len) { s_.append(s, len); return true; }
+    bool concat(char c) { s_ += c; return true; }
+
+    bool operator==(const String &o) const { return s_ == o.s_; }
+    bool operator==(const char *s) const { return s_ == (s ? s : ""); }
+    bool operator!=(const String &o) const { return s_ != o.s_; }
+    bool operator!=(const char *s) const { return !(*this == s); }
+    bool operator<(const String &o) const { return s_ < o.s_; }
+    explicit operator bool() const { return true; }
+
+    char operator[](unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+    char &operator[](unsigned int i) { return s_[i]; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+    void setCharAt(unsigned int i, char c) { if (i < s_.size()) s_[i] = c; }
+
+    unsigned int length() const { return (unsigned int)s_.size(); }
+    bool isEmpty() const { return s_.empty(); }
+    const char *c_str() const { return s_.c_str(); }
+    bool reserve(unsigned int size) { s_.reserve(size); return true; }
+    void clear() { s_.clear(); }
+
+    int indexOf(char c, unsigned int from = 0) const { return pos(s_.find(c, from)); }
+    int indexOf(const char *s, unsigned int from = 0) const { return pos(s_.find(s, from)); }
+    int indexOf(const String &s, unsigned int from = 0) const { return pos(s_.find(s.s_, from)); }
+    int lastIndexOf(char c) const { return pos(s_.rfind(c)); }
+    int lastIndexOf(const char *s) const { return pos(s_.rfind(s)); }
+    int lastIndexOf(const String &s) const { return pos(s_.rfind(s.s_)); }
+
+    String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    bool startsWith(const String &p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+    bool startsWith(const char *p) const { return startsWith(String(p)); }
+    bool endsWith(const String &p) const {
+        return p.s_.size() <= s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+    }
+    bool endsWith(const char *p) const { return endsWith(String(p)); }
+    bool equals(const String &o) const { return s_ == o.s_; }
+    bool equals(const char *s) const { return *this == s; }
+    bool equalsIgnoreCase(const String &o) const { return strcasecmp(c_str(), o.c_str()) == 0; }
+    int compareTo(const String &o) const { return s_.compare(o.s_); }
+
+    void replace(const String &from, const String &to);
+    void replace(const char *from, const char *to) { replace(String(from), String(to)); }
+    void replace(char from, char to) { std::replace(s_.begin(), s_.end(), from, to); }
+    void remove(unsigned int index) { if (index < s_.size()) s_.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < s_.size()) s_.erase(index, count); }
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(s_.c_str(), nullptr); }
+    double toDouble() const { return strtod(s_.c_str(), nullptr); }
+
+    void getBytes(unsigned char *buf, unsigned int size, unsigned int index = 0) const;
+    void toCharArray(char *buf, unsigned int size, unsigned int index = 0) const {
+        getBytes((unsigned char *)buf, size, index);
+    }
+
+    const std::string &std() const { return s_; }
+
+private:
+    std::string s_;
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+};
+
+String operator+(const String &a, const String &b);
+String operator+(const String &a, const char *b);
+String operator+(const char *a, const String &b);
+String operator+(const String &a, char b);
+String operator+(char a, const String &b);
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    void end() {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+#include "IPAddress.h"
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap() { return getFreeHeap(); }
+    uint32_t getMaxAllocHeap() { return getFreeHeap(); }
+    uint32_t getHeapSize() { return 320 * 1024; }
+    uint64_t getEfuseMac() { return 0x0000DEADBEEF1234ULL; }
+    uint32_t getCpuFreqMHz() { return 160; }
+    const char *getChipModel() { return "host"; }
+    const char *getSdkVersion() { return "host"; }
+    uint32_t getFlashChipSize() { return 4 * 1024 * 1024; }
+    [[noreturn]] void restart();
+};
+extern EspClass ESP;
+
+// ESP.getFreeHeap() değeri (RAM bütçesi kararlarını sınamak için ayarlanabilir)
+namespace HostEsp {
+    void setFreeHeap(uint32_t bytes);
+}
+
+#include "freertos_host.h"
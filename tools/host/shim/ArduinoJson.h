@@ -0,0 +1,673 @@
+#pragma once
+
+// ============================================================================
+// ArduinoJson 7 alt kümesi (host)
+// ============================================================================
+// config_store / mail_queue'nun kullandığı API: JsonDocument, operator[],
+// as<T>/is<T>/to<T>, add, operator| varsayılanı, dizi yinelemesi,
+// serializeJson / deserializeJson (String, Stream, char*).
+// Eksik anahtara okuma düğüm oluşturmaz; yazma (=, to<>, add) zinciri kurar.
+
+#include "Arduino.h"
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace host_json {
+
+struct Node;
+using NodePtr = std::shared_ptr<Node>;
+
+struct Node {
+    enum Type { Null, Bool, Int, UInt, Float, Str, Array, Object } type = Null;
+    bool b = false;
+    int64_t i = 0;
+    uint64_t u = 0;
+    double f = 0;
+    std::string s;
+    std::vector<NodePtr> items;
+    std::vector<std::pair<std::string, NodePtr>> members;
+
+    NodePtr find(const std::string &key) const {
+        for (auto &m : members) {
+            if (m.first == key) return m.second;
+        }
+        return nullptr;
+    }
+    void reset(Type t) {
+        type = t;
+        items.clear();
+        members.clear();
+        s.clear();
+    }
+};
+
+inline void writeEscaped(std::string &out, const std::string &text) {
+    out += '"';
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += (char)c;
+                }
+        }
+    }
+    out += '"';
+}
+
+inline void write(std::string &out, const Node *node) {
+    if (!node) {
+        out += "null";
+        return;
+    }
+    char buf[32];
+    switch (node->type) {
+        case Node::Null: out += "null"; break;
+        case Node::Bool: out += node->b ? "true" : "false"; break;
+        case Node::Int: snprintf(buf, sizeof(buf), "%lld", (long long)node->i); out += buf; break;
+        case Node::UInt: snprintf(buf, sizeof(buf), "%llu", (unsigned long long)node->u); out += buf; break;
+        case Node::Float: snprintf(buf, sizeof(buf), "%.9g", node->f); out += buf; break;
+        case Node::Str: writeEscaped(out, node->s); break;
+        case Node::Array:
+            out += '[';
+            for (size_t k = 0; k < node->items.size(); ++k) {
+                if (k) out += ',';
+                write(out, node->items[k].get());
+            }
+            out += ']';
+            break;
+        case Node::Object:
+            out += '{';
+            for (size_t k = 0; k < node->members.size(); ++k) {
+                if (k) out += ',';
+                writeEscaped(out, node->members[k].first);
+                out += ':';
+                write(out, node->members[k].second.get());
+            }
+            out += '}';
+            break;
+    }
+}
+
+class Parser {
+public:
+    explicit Parser(const std::string &text) : t(text) {}
+
+    bool parse(Node &root) {
+        skip();
+        if (p >= t.size()) {
+            empty = true;
+            return false;
+        }
+        if (!value(root, 0)) return false;
+        return true;
+    }
+    bool empty = false;
+
+private:
+    const std::string &t;
+    size_t p = 0;
+
+    void skip() {
+        while (p < t.size() && isspace((unsigned char)t[p])) p++;
+    }
+    bool literal(const char *word) {
+        size_t n = strlen(word);
+        if (t.compare(p, n, word) != 0) return false;
+        p += n;
+        return true;
+    }
+    bool string(std::string &out) {
+        if (t[p] != '"') return false;
+        p++;
+        while (p < t.size() && t[p] != '"') {
+            char c = t[p++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (p >= t.size()) return false;
+            char e = t[p++];
+            switch (e) {
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    if (p + 4 > t.size()) return false;
+                    unsigned cp = (unsigned)strtoul(t.substr(p, 4).c_str(), nullptr, 16);
+                    p += 4;
+                    if (cp < 0x80) {
+                        out += (char)cp;
+                    } else if (cp < 0x800) {
+                        out += (char)(0xC0 | (cp >> 6));
+                        out += (char)(0x80 | (cp & 0x3F));
+                    } else {
+                        out += (char)(0xE0 | (cp >> 12));
+                        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+                        out += (char)(0x80 | (cp & 0x3F));
+                    }
+                    break;
+                }
+                default: out += e;
+            }
+        }
+        if (p >= t.size()) return false;
+        p++;
+        return true;
+    }
+    bool value(Node &node, int depth) {
+        if (depth > 20) return false;
+        skip();
+        if (p >= t.size()) return false;
+        char c = t[p];
+        if (c == '{') {
+            node.reset(Node::Object);
+            p++;
+            skip();
+            if (p < t.size() && t[p] == '}') {
+                p++;
+                return true;
+            }
+            while (true) {
+                skip();
+                std::string key;
+                if (p >= t.size() || !string(key)) return false;
+                skip();
+                if (p >= t.size() || t[p++] != ':') return false;
+                auto child = std::make_shared<Node>();
+                if (!value(*child, depth + 1)) return false;
+                node.members.emplace_back(key, child);
+                skip();
+                if (p >= t.size()) return false;
+                if (t[p] == ',') { p++; continue; }
+                if (t[p] == '}') { p++; return true; }
+                return false;
+            }
+        }
+        if (c == '[') {
+            node.reset(Node::Array);
+            p++;
+            skip();
+            if (p < t.size() && t[p] == ']') {
+                p++;
+                return true;
+            }
+            while (true) {
+                auto child = std::make_shared<Node>();
+                if (!value(*child, depth + 1)) return false;
+                node.items.push_back(child);
+                skip();
+                if (p >= t.size()) return false;
+                if (t[p] == ',') { p++; continue; }
+                if (t[p] == ']') { p++; return true; }
+                return false;
+            }
+        }
+        if (c == '"') {
+            node.reset(Node::Str);
+            return string(node.s);
+        }
+        if (literal("true")) { node.reset(Node::Bool); node.b = true; return true; }
+        if (literal("false")) { node.reset(Node::Bool); node.b = false; return true; }
+        if (literal("null")) { node.reset(Node::Null); return true; }
+        size_t start = p;
+        while (p < t.size() && strchr("+-0123456789.eE", t[p])) p++;
+        if (p == start) return false;
+        std::string number = t.substr(start, p - start);
+        if (number.find_first_of(".eE") != std::string::npos) {
+            node.reset(Node::Float);
+            node.f = strtod(number.c_str(), nullptr);
+        } else if (number[0] == '-') {
+            node.reset(Node::Int);
+            node.i = strtoll(number.c_str(), nullptr, 10);
+        } else {
+            node.reset(Node::UInt);
+            node.u = strtoull(number.c_str(), nullptr, 10);
+        }
+        return true;
+    }
+};
+
+}
+
+class JsonArray;
+class JsonObject;
+
+class JsonVariant {
+public:
+    using Node = host_json::Node;
+    using NodePtr = host_json::NodePtr;
+    using Creator = std::function<NodePtr()>;
+
+    JsonVariant() {}
+    JsonVariant(NodePtr node, Creator create = nullptr) : node_(std::move(node)), create_(std::move(create)) {}
+
+    // --- Erişim ---
+    JsonVariant operator[](const char *key) const { return member(key ? key : ""); }
+    JsonVariant operator[](const String &key) const { return member(key.c_str()); }
+    JsonVariant operator[](char *key) const { return member(key ? key : ""); }
+    JsonVariant operator[](int index) const { return element((size_t)index); }
+    JsonVariant operator[](unsigned int index) const { return element(index); }
+    JsonVariant operator[](size_t index) const { return element(index); }
+    JsonVariant operator[](unsigned char index) const { return element(index); }
+
+    bool isNull() const { return !node_ || node_->type == Node::Null; }
+    size_t size() const {
+        if (!node_) return 0;
+        if (node_->type == Node::Array) return node_->items.size();
+        if (node_->type == Node::Object) return node_->members.size();
+        return 0;
+    }
+    bool containsKey(const char *key) const { return node_ && node_->type == Node::Object && node_->find(key); }
+
+    // --- Yazma ---
+    template <typename T> JsonVariant &operator=(const T &value) {
+        set(value);
+        return *this;
+    }
+    JsonVariant &operator=(const JsonVariant &other) {
+        NodePtr target = ensure();
+        if (target && other.node_) *target = *other.node_;
+        else if (target) target->reset(Node::Null);
+        return *this;
+    }
+    JsonVariant(const JsonVariant &) = default;
+
+    bool set(const char *value) {
+        if (!value) return setNull();
+        NodePtr n = ensure();
+        n->reset(Node::Str);
+        n->s = value;
+        return true;
+    }
+    bool set(char *value) { return set((const char *)value); }
+    bool set(const String &value) { return set(value.c_str()); }
+    bool set(const std::string &value) { return set(value.c_str()); }
+    bool set(bool value) {
+        NodePtr n = ensure();
+        n->reset(Node::Bool);
+        n->b = value;
+        return true;
+    }
+    bool set(float value) { return set((double)value); }
+    bool set(double value) {
+        NodePtr n = ensure();
+        n->reset(Node::Float);
+        n->f = value;
+        return true;
+    }
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type set(T value) {
+        NodePtr n = ensure();
+        if (std::is_signed<T>::value && value < 0) {
+            n->reset(Node::Int);
+            n->i = (int64_t)value;
+        } else {
+            n->reset(Node::UInt);
+            n->u = (uint64_t)value;
+        }
+        return true;
+    }
+    template <typename T>
+    typename std::enable_if<std::is_enum<T>::value, bool>::type set(T value) {
+        return set((typename std::underlying_type<T>::type)value);
+    }
+    template <size_t N> bool set(const char (&value)[N]) { return set((const char *)value); }
+    bool set(const JsonVariant &other) {
+        *this = other;
+        return true;
+    }
+    bool setNull() {
+        ensure()->reset(Node::Null);
+        return true;
+    }
+    void clear() {
+        if (node_) node_->reset(Node::Null);
+    }
+    void remove(const char *key) {
+        if (!node_ || node_->type != Node::Object) return;
+        auto &m = node_->members;
+        m.erase(std::remove_if(m.begin(), m.end(), [&](const std::pair<std::string, NodePtr> &e) { return e.first == key; }),
+                m.end());
+    }
+
+    template <typename T> T to();
+    template <typename T> bool add(const T &value);
+    template <typename T> T add();
+
+    // --- Dönüşüm ---
+    template <typename T> T as() const { return Converter<T>::get(node_.get()); }
+    template <typename T> bool is() const { return Converter<T>::matches(node_.get()); }
+    template <typename T> T operator|(const T &fallback) const {
+        return Converter<T>::matches(node_.get()) ? as<T>() : fallback;
+    }
+    const char *operator|(const char *fallback) const {
+        return node_ && node_->type == Node::Str ? node_->s.c_str() : fallback;
+    }
+    template <typename T, typename = typename std::enable_if<!std::is_same<T, JsonArray>::value &&
+                                                             !std::is_same<T, JsonObject>::value>::type>
+    operator T() const {
+        return as<T>();
+    }
+
+    NodePtr node() const { return node_; }
+    NodePtr ensure();
+
+    // --- Yineleme (dizi) ---
+    class iterator {
+    public:
+        iterator(NodePtr parent, size_t index) : parent_(std::move(parent)), index_(index) {}
+        JsonVariant operator*() const { return JsonVariant(parent_->items[index_]); }
+        iterator &operator++() {
+            index_++;
+            return *this;
+        }
+        bool operator!=(const iterator &o) const { return index_ != o.index_; }
+
+    private:
+        NodePtr parent_;
+        size_t index_;
+    };
+    iterator begin() const {
+        return iterator(node_, 0);
+    }
+    iterator end() const {
+        return iterator(node_, node_ && node_->type == Node::Array ? node_->items.size() : 0);
+    }
+
+    template <typename T, typename Enable = void> struct Converter;
+
+protected:
+    NodePtr node_;
+    Creator create_;
+
+    JsonVariant member(const std::string &key) const {
+        NodePtr self = node_;
+        Creator parent = create_;
+        NodePtr existing = self && self->type == Node::Object ? self->find(key) : nullptr;
+        Creator create = [self, parent, key]() -> NodePtr {
+            NodePtr owner = self ? self : (parent ? parent() : nullptr);
+            if (!owner) return nullptr;
+            if (owner->type != Node::Object) owner->reset(Node::Object);
+            NodePtr found = owner->find(key);
+            if (found) return found;
+            auto child = std::make_shared<Node>();
+            owner->members.emplace_back(key, child);
+            return child;
+        };
+        return JsonVariant(existing, create);
+    }
+    JsonVariant element(size_t index) const {
+        if (node_ && node_->type == Node::Array && index < node_->items.size()) {
+            return JsonVariant(node_->items[index]);
+        }
+        return JsonVariant();
+    }
+};
+
+inline JsonVariant::NodePtr JsonVariant::ensure() {
+    if (!node_ && create_) node_ = create_();
+    if (!node_) node_ = std::make_shared<Node>();
+    return node_;
+}
+
+class JsonArray : public JsonVariant {
+public:
+    JsonArray() {}
+    JsonArray(const JsonVariant &v) : JsonVariant(v.node() && v.node()->type == Node::Array ? v.node() : nullptr) {}
+    void remove(size_t index) {
+        if (node_ && index < node_->items.size()) node_->items.erase(node_->items.begin() + index);
+    }
+};
+
+class JsonObject : public JsonVariant {
+public:
+    JsonObject() {}
+    JsonObject(const JsonVariant &v) : JsonVariant(v.node() && v.node()->type == Node::Object ? v.node() : nullptr) {}
+    using JsonVariant::operator=;
+};
+
+using JsonVariantConst = JsonVariant;
+using JsonArrayConst = JsonArray;
+using JsonObjectConst = JsonObject;
+
+// --- Dönüştürücüler ---
+template <typename T>
+struct JsonVariant::Converter<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+    static T get(const Node *n) {
+        if (!n) return 0;
+        switch (n->type) {
+            case Node::Int: return (T)n->i;
+            case Node::UInt: return (T)n->u;
+            case Node::Float: return (T)n->f;
+            case Node::Bool: return (T)n->b;
+            default: return 0;
+        }
+    }
+    static bool matches(const Node *n) {
+        return n && (n->type == Node::Int || n->type == Node::UInt);
+    }
+};
+
+template <typename T>
+struct JsonVariant::Converter<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+    static T get(const Node *n) {
+        if (!n) return 0;
+        switch (n->type) {
+            case Node::Int: return (T)n->i;
+            case Node::UInt: return (T)n->u;
+            case Node::Float: return (T)n->f;
+            default: return 0;
+        }
+    }
+    static bool matches(const Node *n) {
+        return n && (n->type == Node::Int || n->type == Node::UInt || n->type == Node::Float);
+    }
+};
+
+template <> struct JsonVariant::Converter<bool> {
+    static bool get(const Node *n) {
+        if (!n) return false;
+        if (n->type == Node::Bool) return n->b;
+        if (n->type == Node::Int) return n->i != 0;
+        if (n->type == Node::UInt) return n->u != 0;
+        return false;
+    }
+    static bool matches(const Node *n) { return n && n->type == Node::Bool; }
+};
+
+template <> struct JsonVariant::Converter<const char *> {
+    static const char *get(const Node *n) { return n && n->type == Node::Str ? n->s.c_str() : nullptr; }
+    static bool matches(const Node *n) { return n && n->type == Node::Str; }
+};
+
+template <> struct JsonVariant::Converter<String> {
+    static String get(const Node *n) {
+        if (n && n->type == Node::Str) return String(n->s);
+        std::string out;
+        host_json::write(out, n);
+        return String(out);
+    }
+    static bool matches(const Node *n) { return n && n->type == Node::Str; }
+};
+
+template <> struct JsonVariant::Converter<JsonArray> {
+    static JsonArray get(const Node *) { return JsonArray(); }
+    static bool matches(const Node *n) { return n && n->type == Node::Array; }
+};
+
+template <> struct JsonVariant::Converter<JsonObject> {
+    static JsonObject get(const Node *) { return JsonObject(); }
+    static bool matches(const Node *n) { return n && n->type == Node::Object; }
+};
+
+template <> struct JsonVariant::Converter<JsonVariant> {
+    static JsonVariant get(const Node *) { return JsonVariant(); }
+    static bool matches(const Node *) { return true; }
+};
+
+// as<JsonArray>/as<JsonObject> düğümü paylaşmalı (Converter yalnızca ham işaretçi görür)
+template <> inline JsonArray JsonVariant::as<JsonArray>() const { return JsonArray(*this); }
+template <> inline JsonObject JsonVariant::as<JsonObject>() const { return JsonObject(*this); }
+template <> inline JsonVariant JsonVariant::as<JsonVariant>() const { return *this; }
+
+template <> inline JsonArray JsonVariant::to<JsonArray>() {
+    ensure()->reset(Node::Array);
+    return JsonArray(*this);
+}
+template <> inline JsonObject JsonVariant::to<JsonObject>() {
+    ensure()->reset(Node::Object);
+    return JsonObject(*this);
+}
+template <> inline JsonVariant JsonVariant::to<JsonVariant>() {
+    ensure()->reset(Node::Null);
+    return *this;
+}
+
+template <typename T> bool JsonVariant::add(const T &value) {
+    NodePtr self = ensure();
+    if (self->type != Node::Array) self->reset(Node::Array);
+    auto child = std::make_shared<Node>();
+    self->items.push_back(child);
+    JsonVariant(child).set(value);
+    return true;
+}
+
+template <> inline JsonObject JsonVariant::add<JsonObject>() {
+    NodePtr self = ensure();
+    if (self->type != Node::Array) self->reset(Node::Array);
+    auto child = std::make_shared<Node>();
+    child->type = Node::Object;
+    self->items.push_back(child);
+    return JsonObject(JsonVariant(child));
+}
+template <> inline JsonArray JsonVariant::add<JsonArray>() {
+    NodePtr self = ensure();
+    if (self->type != Node::Array) self->reset(Node::Array);
+    auto child = std::make_shared<Node>();
+    child->type = Node::Array;
+    self->items.push_back(child);
+    return JsonArray(JsonVariant(child));
+}
+template <> inline JsonVariant JsonVariant::add<JsonVariant>() {
+    NodePtr self = ensure();
+    if (self->type != Node::Array) self->reset(Node::Array);
+    auto child = std::make_shared<Node>();
+    self->items.push_back(child);
+    return JsonVariant(child);
+}
+
+class JsonDocument : public JsonVariant {
+public:
+    JsonDocument() : JsonVariant(std::make_shared<Node>()) {}
+    explicit JsonDocument(size_t) : JsonDocument() {}
+    JsonDocument(const JsonDocument &other) : JsonVariant(std::make_shared<Node>(*other.node_)) {}
+    JsonDocument &operator=(const JsonDocument &other) {
+        node_ = std::make_shared<Node>(*other.node_);
+        return *this;
+    }
+    using JsonVariant::operator=;
+    bool overflowed() const { return false; }
+    size_t memoryUsage() const { return 0; }
+    void shrinkToFit() {}
+    void clear() { node_ = std::make_shared<Node>(); }
+};
+
+class DeserializationError {
+public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+    DeserializationError(Code code = Ok) : code_(code) {}
+    explicit operator bool() const { return code_ != Ok; }
+    bool operator==(Code code) const { return code_ == code; }
+    bool operator!=(Code code) const { return code_ != code; }
+    Code code() const { return code_; }
+    const char *c_str() const {
+        static const char *names[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+        return names[code_];
+    }
+
+private:
+    Code code_;
+};
+
+namespace host_json {
+
+inline DeserializationError parseInto(JsonDocument &doc, const std::string &text) {
+    doc.clear();
+    Parser parser(text);
+    auto root = doc.ensure();
+    if (!parser.parse(*root)) {
+        root->reset(Node::Null);
+        return parser.empty ? DeserializationError::EmptyInput : DeserializationError::InvalidInput;
+    }
+    return DeserializationError::Ok;
+}
+
+inline std::string readAll(Stream &input) {
+    std::string text;
+    char buffer[256];
+    while (input.available() > 0) {
+        size_t n = input.readBytes(buffer, sizeof(buffer));
+        if (n == 0) break;
+        text.append(buffer, n);
+    }
+    return text;
+}
+
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const String &input) {
+    return host_json::parseInto(doc, input.std());
+}
+inline DeserializationError deserializeJson(JsonDocument &doc, const char *input) {
+    return host_json::parseInto(doc, input ? input : "");
+}
+inline DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t length) {
+    return host_json::parseInto(doc, std::string(input, length));
+}
+inline DeserializationError deserializeJson(JsonDocument &doc, const uint8_t *input, size_t length) {
+    return host_json::parseInto(doc, std::string((const char *)input, length));
+}
+inline DeserializationError deserializeJson(JsonDocument &doc, Stream &input) {
+    return host_json::parseInto(doc, host_json::readAll(input));
+}
+
+inline size_t measureJson(const JsonVariant &value) {
+    std::string out;
+    host_json::write(out, value.node().get());
+    return out.size();
+}
+inline size_t serializeJson(const JsonVariant &value, String &output) {
+    std::string out;
+    host_json::write(out, value.node().get());
+    output = String(out);
+    return out.size();
+}
+inline size_t serializeJson(const JsonVariant &value, Print &output) {
+    std::string out;
+    host_json::write(out, value.node().get());
+    return output.write((const uint8_t *)out.data(), out.size());
+}
+inline size_t serializeJson(const JsonVariant &value, char *buffer, size_t size) {
+    std::string out;
+    host_json::write(out, value.node().get());
+    if (size == 0) return 0;
+    size_t n = std::min(out.size(), size - 1);
+    memcpy(buffer, out.data(), n);
+    buffer[n] = '\0';
+    return n;
+}
+template <typename T> size_t serializeJsonPretty(const JsonVariant &value, T &output) {
+    return serializeJson(value, output);
+}
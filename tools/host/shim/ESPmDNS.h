@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Arduino.h"
+
+class MDNSResponder {
+public:
+    bool begin(const char *) { return true; }
+    void end() {}
+    bool addService(const char *, const char *, uint16_t) { return true; }
+    bool addServiceTxt(const char *, const char *, const char *, const char *) { return true; }
+    bool addServiceTxt(const char *, const char *, const char *, const String &) { return true; }
+};
+inline MDNSResponder MDNS;
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Arduino.h"
+#include <memory>
+
+// LittleFS yolları ("/data/x.bin") HostFS kök klasörünün altına eşlenir.
+// File, ESP32 çekirdeğindeki gibi paylaşımlı tanıtıcıdır (kopyalar aynı dosyayı gösterir).
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+namespace fs {
+
+struct FileImpl;
+
+class File : public Stream {
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : impl_(std::move(impl)) {}
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    size_t read(uint8_t *buffer, size_t size);
+    size_t readBytes(char *buffer, size_t length) override { return read((uint8_t *)buffer, length); }
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    operator bool() const;
+    const char *name() const;   // Son bileşen (ESP32 3.x ile aynı)
+    const char *path() const;
+    bool isDirectory() const;
+    File openNextFile(const char *mode = "r");
+    void rewindDirectory();
+    time_t getLastWrite() { return 0; }
+
+private:
+    std::shared_ptr<FileImpl> impl_;
+};
+
+class FS {
+public:
+    File open(const char *path, const char *mode = "r", bool create = false);
+    File open(const String &path, const char *mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char *path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path);
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool rename(const char *from, const char *to);
+    bool rename(const String &from, const String &to) { return rename(from.c_str(), to.c_str()); }
+    bool mkdir(const char *path);
+    bool mkdir(const String &path) { return mkdir(path.c_str()); }
+    bool rmdir(const char *path);
+    bool rmdir(const String &path) { return rmdir(path.c_str()); }
+};
+
+}
+
+using fs::File;
+using fs::FS;
+
+namespace HostFS {
+    // Kök klasör (yoksa oluşturulur); begin() öncesi ayarlanmazsa geçici klasör
+    void setRoot(const std::string &directory);
+    const std::string &root();
+    std::string hostPath(const char *path);
+    // Kökü boşalt (testler arası)
+    void wipe();
+    // Açık dosya tanıtıcıları (sızıntı kontrolü)
+    int openHandles();
+}
@@ -0,0 +1,164 @@
+#include "HTTPClient.h"
+
+bool HTTPClient::begin(WiFiClient &client, const String &url) {
+    client_ = &client;
+    extraHeaders_ = "";
+    contentLength_ = -1;
+    chunked_ = false;
+    serverKeepAlive_ = false;
+    bodyRead_ = false;
+
+    int schemeEnd = url.indexOf("://");
+    if (schemeEnd < 0) return false;
+    String scheme = url.substring(0, schemeEnd);
+    port_ = scheme == "https" ? 443 : 80;
+    String rest = url.substring(schemeEnd + 3);
+    int slash = rest.indexOf('/');
+    String authority = slash < 0 ? rest : rest.substring(0, slash);
+    uri_ = slash < 0 ? String("/") : rest.substring(slash);
+    int colon = authority.indexOf(':');
+    if (colon >= 0) {
+        port_ = (uint16_t)authority.substring(colon + 1).toInt();
+        authority = authority.substring(0, colon);
+    }
+    host_ = authority;
+    return host_.length() > 0;
+}
+
+void HTTPClient::addHeader(const String &name, const String &value) {
+    extraHeaders_ += name + ": " + value + "\r\n";
+}
+
+bool HTTPClient::readLine(String &line, uint32_t deadline) {
+    std::string text;
+    while (true) {
+        if (client_->available() > 0) {
+            int c = client_->read();
+            if (c < 0) continue;
+            if (c == '\n') break;
+            if (c != '\r') text += (char)c;
+            continue;
+        }
+        if (!client_->connected()) return false;
+        if ((int32_t)(millis() - deadline) >= 0) return false;
+        delay(1);
+    }
+    line = String(text);
+    return true;
+}
+
+bool HTTPClient::readExact(std::string &out, size_t length, uint32_t deadline) {
+    uint8_t buffer[512];
+    while (length > 0) {
+        int got = client_->available() > 0 ? client_->read(buffer, std::min(length, sizeof(buffer))) : -1;
+        if (got > 0) {
+            out.append((const char *)buffer, got);
+            length -= (size_t)got;
+            continue;
+        }
+        if (!client_->connected()) return false;
+        if ((int32_t)(millis() - deadline) >= 0) return false;
+        delay(1);
+    }
+    return true;
+}
+
+int HTTPClient::GET() {
+    if (!client_) return HTTPC_ERROR_NOT_CONNECTED;
+    if (!client_->connected()) {
+        if (!client_->connect(host_.c_str(), port_, connectTimeoutMs_)) return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    String request = "GET " + uri_ + " HTTP/1.1\r\nHost: " + host_;
+    if (port_ != 80 && port_ != 443) request += ":" + String(port_);
+    request += "\r\nUser-Agent: ESP32HTTPClient\r\nConnection: ";
+    request += reuse_ ? "keep-alive" : "close";
+    request += "\r\n" + extraHeaders_ + "\r\n";
+    if (client_->write((const uint8_t *)request.c_str(), request.length()) != request.length()) {
+        return HTTPC_ERROR_SEND_HEADER_FAILED;
+    }
+
+    uint32_t deadline = millis() + timeoutMs_;
+    String status;
+    if (!readLine(status, deadline)) {
+        return client_->connected() ? HTTPC_ERROR_READ_TIMEOUT : HTTPC_ERROR_CONNECTION_LOST;
+    }
+    if (!status.startsWith("HTTP/1.")) return HTTPC_ERROR_NO_HTTP_SERVER;
+    int code = status.substring(9, 12).toInt();
+    serverKeepAlive_ = status.startsWith("HTTP/1.1");
+
+    String header;
+    while (true) {
+        if (!readLine(header, deadline)) return HTTPC_ERROR_READ_TIMEOUT;
+        if (header.length() == 0) break;
+        int colon = header.indexOf(':');
+        if (colon < 0) continue;
+        String name = header.substring(0, colon);
+        String value = header.substring(colon + 1);
+        name.toLowerCase();
+        value.trim();
+        value.toLowerCase();
+        if (name == "content-length") contentLength_ = (int)value.toInt();
+        if (name == "transfer-encoding" && value == "chunked") chunked_ = true;
+        if (name == "connection") serverKeepAlive_ = value == "keep-alive";
+    }
+    if (code == 204 || code == 304) contentLength_ = 0;
+    return code;
+}
+
+String HTTPClient::getString() {
+    if (!client_ || bodyRead_) return String();
+    bodyRead_ = true;
+    uint32_t deadline = millis() + timeoutMs_;
+    std::string body;
+    if (chunked_) {
+        String sizeLine;
+        while (readLine(sizeLine, deadline)) {
+            size_t size = strtoul(sizeLine.c_str(), nullptr, 16);
+            if (size == 0) {
+                readLine(sizeLine, deadline);
+                break;
+            }
+            if (!readExact(body, size, deadline)) break;
+            readLine(sizeLine, deadline);
+        }
+    } else if (contentLength_ >= 0) {
+        readExact(body, (size_t)contentLength_, deadline);
+    } else {
+        // Uzunluksuz: bağlantı kapanana kadar
+        serverKeepAlive_ = false;
+        uint8_t buffer[512];
+        while (client_->connected() && (int32_t)(millis() - deadline) < 0) {
+            int got = client_->read(buffer, sizeof(buffer));
+            if (got > 0) body.append((const char *)buffer, got);
+            else delay(1);
+        }
+    }
+    return String(body);
+}
+
+void HTTPClient::end() {
+    if (!client_) return;
+    // Gövde tüketilmeden soket tekrar kullanılamaz
+    if (!bodyRead_ && (chunked_ || contentLength_ > 0)) getString();
+    bool keep = reuse_ && serverKeepAlive_ && (chunked_ || contentLength_ >= 0);
+    if (!keep) client_->stop();
+    client_ = nullptr;
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+        case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+        case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+        case HTTPC_ERROR_NO_STREAM: return "no stream";
+        case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+        case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+        case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+        case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+        case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+        default: return String();
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+// HTTP/1.1 GET: keep-alive (setReuse), Content-Length ve chunked gövde.
+// Hata kodları ESP32 HTTPClient ile aynı (negatif).
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NO_CONTENT 204
+
+typedef enum {
+    HTTPC_DISABLE_FOLLOW_REDIRECTS,
+    HTTPC_STRICT_FOLLOW_REDIRECTS,
+    HTTPC_FORCE_FOLLOW_REDIRECTS
+} followRedirects_t;
+
+class HTTPClient {
+public:
+    bool begin(WiFiClient &client, const String &url);
+    void end();
+    void setReuse(bool reuse) { reuse_ = reuse; }
+    void setTimeout(uint16_t ms) { timeoutMs_ = ms; }
+    void setConnectTimeout(int32_t ms) { connectTimeoutMs_ = ms; }
+    void setFollowRedirects(followRedirects_t) {}
+    void addHeader(const String &name, const String &value);
+
+    int GET();
+    String getString();
+    int getSize() { return contentLength_; }
+    WiFiClient *getStreamPtr() { return client_; }
+    WiFiClient &getStream() { return *client_; }
+    bool connected() { return client_ && client_->connected(); }
+    static String errorToString(int error);
+
+private:
+    WiFiClient *client_ = nullptr;
+    String host_;
+    uint16_t port_ = 80;
+    String uri_ = "/";
+    String extraHeaders_;
+    bool reuse_ = true;
+    uint16_t timeoutMs_ = 5000;
+    int32_t connectTimeoutMs_ = 5000;
+    int contentLength_ = -1;
+    bool chunked_ = false;
+    bool serverKeepAlive_ = false;
+    bool bodyRead_ = false;
+
+    bool readLine(String &line, uint32_t deadline);
+    bool readExact(std::string &out, size_t length, uint32_t deadline);
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Baytlar bellekte ağ sırasıyla (ESP32 ile aynı: uint32_t dönüşümü little-endian okur)
+class IPAddress {
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes_{a, b, c, d} {}
+    IPAddress(uint32_t raw) { memcpy(bytes_, &raw, 4); }
+
+    operator uint32_t() const { uint32_t raw; memcpy(&raw, bytes_, 4); return raw; }
+    uint8_t operator[](int i) const { return bytes_[i & 3]; }
+    uint8_t &operator[](int i) { return bytes_[i & 3]; }
+    bool operator==(const IPAddress &o) const { return memcmp(bytes_, o.bytes_, 4) == 0; }
+    bool operator!=(const IPAddress &o) const { return !(*this == o); }
+
+    bool fromString(const char *text);
+    bool fromString(const String &text);
+    String toString() const;
+
+private:
+    uint8_t bytes_[4] = {0, 0, 0, 0};
+};
+
+extern const IPAddress INADDR_NONE;
@@ -0,0 +1,232 @@
+#include "LittleFS.h"
+
+#include <atomic>
+#include <dirent.h>
+#include <filesystem>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace stdfs = std::filesystem;
+
+LittleFSFS LittleFS;
+
+namespace {
+
+std::string fsRoot;
+std::atomic<int> handles{0};
+
+const std::string &ensureRoot() {
+    if (fsRoot.empty()) {
+        char pattern[] = "/tmp/dmf-hostfs-XXXXXX";
+        const char *dir = mkdtemp(pattern);
+        fsRoot = dir ? dir : "/tmp/dmf-hostfs";
+    }
+    stdfs::create_directories(fsRoot);
+    return fsRoot;
+}
+
+}
+
+namespace HostFS {
+
+void setRoot(const std::string &directory) {
+    fsRoot = directory;
+    stdfs::create_directories(fsRoot);
+}
+
+const std::string &root() { return ensureRoot(); }
+
+std::string hostPath(const char *path) {
+    std::string p = path ? path : "";
+    if (p.empty() || p[0] != '/') p = "/" + p;
+    return ensureRoot() + p;
+}
+
+void wipe() {
+    std::error_code ec;
+    for (auto &entry : stdfs::directory_iterator(ensureRoot(), ec)) {
+        stdfs::remove_all(entry.path(), ec);
+    }
+}
+
+int openHandles() { return handles.load(); }
+
+}
+
+namespace fs {
+
+struct FileImpl {
+    FILE *fp = nullptr;
+    bool directory = false;
+    std::string path;       // LittleFS yolu
+    std::string name;       // Son bileşen
+    std::vector<std::string> entries;
+    size_t nextEntry = 0;
+
+    ~FileImpl() { closeHandle(); }
+    void closeHandle() {
+        if (fp) {
+            fclose(fp);
+            fp = nullptr;
+            handles--;
+        }
+    }
+};
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+    if (!impl_ || !impl_->fp) return 0;
+    return fwrite(buffer, 1, size, impl_->fp);
+}
+
+int File::available() {
+    if (!impl_ || !impl_->fp) return 0;
+    long remaining = (long)size() - (long)position();
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+    if (!impl_ || !impl_->fp) return -1;
+    int c = fgetc(impl_->fp);
+    if (c != EOF) ungetc(c, impl_->fp);
+    return c == EOF ? -1 : c;
+}
+
+void File::flush() {
+    if (impl_ && impl_->fp) fflush(impl_->fp);
+}
+
+size_t File::read(uint8_t *buffer, size_t size) {
+    if (!impl_ || !impl_->fp) return 0;
+    fflush(impl_->fp); // Okuma/yazma geçişi (r+ / a+)
+    return fread(buffer, 1, size, impl_->fp);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!impl_ || !impl_->fp) return false;
+    int whence = mode == SeekSet ? SEEK_SET : (mode == SeekCur ? SEEK_CUR : SEEK_END);
+    return fseek(impl_->fp, (long)pos, whence) == 0;
+}
+
+size_t File::position() const {
+    if (!impl_ || !impl_->fp) return 0;
+    long pos = ftell(impl_->fp);
+    return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+    if (!impl_ || !impl_->fp) return 0;
+    fflush(impl_->fp);
+    struct stat st;
+    return fstat(fileno(impl_->fp), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+    if (impl_) impl_->closeHandle();
+    impl_.reset();
+}
+
+File::operator bool() const { return impl_ && (impl_->fp || impl_->directory); }
+const char *File::name() const { return impl_ ? impl_->name.c_str() : ""; }
+const char *File::path() const { return impl_ ? impl_->path.c_str() : ""; }
+bool File::isDirectory() const { return impl_ && impl_->directory; }
+
+File File::openNextFile(const char *mode) {
+    if (!impl_ || !impl_->directory || impl_->nextEntry >= impl_->entries.size()) return File();
+    std::string child = impl_->path;
+    if (child.empty() || child.back() != '/') child += "/";
+    child += impl_->entries[impl_->nextEntry++];
+    return LittleFS.open(child.c_str(), mode);
+}
+
+void File::rewindDirectory() {
+    if (impl_) impl_->nextEntry = 0;
+}
+
+File FS::open(const char *path, const char *mode, bool) {
+    std::string host = HostFS::hostPath(path);
+    auto impl = std::make_shared<FileImpl>();
+    impl->path = path;
+    size_t slash = impl->path.find_last_of('/');
+    impl->name = slash == std::string::npos ? impl->path : impl->path.substr(slash + 1);
+
+    std::error_code ec;
+    if (stdfs::is_directory(host, ec)) {
+        impl->directory = true;
+        for (auto &entry : stdfs::directory_iterator(host, ec)) {
+            impl->entries.push_back(entry.path().filename().string());
+        }
+        std::sort(impl->entries.begin(), impl->entries.end());
+        return File(impl);
+    }
+
+    std::string m = mode ? mode : "r";
+    if (m[0] == 'r' && !stdfs::exists(host, ec)) return File();
+    if (m[0] != 'r') {
+        // LittleFS ara klasörleri kendiliğinden oluşturur
+        stdfs::create_directories(stdfs::path(host).parent_path(), ec);
+    }
+    std::string cmode = m;
+    if (cmode.find('b') == std::string::npos) cmode += "b";
+    impl->fp = fopen(host.c_str(), cmode.c_str());
+    if (!impl->fp) return File();
+    handles++;
+    return File(impl);
+}
+
+bool FS::exists(const char *path) {
+    std::error_code ec;
+    return stdfs::exists(HostFS::hostPath(path), ec);
+}
+
+bool FS::remove(const char *path) {
+    std::error_code ec;
+    std::string host = HostFS::hostPath(path);
+    return stdfs::is_regular_file(host, ec) && stdfs::remove(host, ec);
+}
+
+bool FS::rename(const char *from, const char *to) {
+    std::error_code ec;
+    std::string source = HostFS::hostPath(from);
+    if (!stdfs::exists(source, ec)) return false;
+    stdfs::rename(source, HostFS::hostPath(to), ec);
+    return !ec;
+}
+
+bool FS::mkdir(const char *path) {
+    std::error_code ec;
+    stdfs::create_directories(HostFS::hostPath(path), ec);
+    return !ec;
+}
+
+bool FS::rmdir(const char *path) {
+    std::error_code ec;
+    return stdfs::remove(HostFS::hostPath(path), ec);
+}
+
+}
+
+bool LittleFSFS::begin(bool, const char *, uint8_t, const char *) {
+    HostFS::root();
+    return true;
+}
+
+bool LittleFSFS::format() {
+    HostFS::wipe();
+    return true;
+}
+
+size_t LittleFSFS::totalBytes() { return 1536 * 1024; }
+
+size_t LittleFSFS::usedBytes() {
+    size_t used = 0;
+    std::error_code ec;
+    for (auto &entry : stdfs::recursive_directory_iterator(HostFS::root(), ec)) {
+        if (entry.is_regular_file(ec)) used += entry.file_size(ec);
+    }
+    return used;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Arduino.h"
+#include <map>
+#include <mutex>
+
+// NVS: süreç içi bellek (ad alanı → anahtar → bayt dizisi)
+class Preferences {
+public:
+    bool begin(const char *name, bool readOnly = false) {
+        ns_ = name ? name : "";
+        readOnly_ = readOnly;
+        open_ = true;
+        return true;
+    }
+    void end() { open_ = false; }
+
+    bool clear() {
+        std::lock_guard<std::mutex> guard(lock());
+        store()[ns_].clear();
+        return true;
+    }
+    bool remove(const char *key) {
+        std::lock_guard<std::mutex> guard(lock());
+        return store()[ns_].erase(key) > 0;
+    }
+    bool isKey(const char *key) {
+        std::lock_guard<std::mutex> guard(lock());
+        return store()[ns_].count(key) > 0;
+    }
+
+    size_t putBytes(const char *key, const void *value, size_t len) {
+        if (!open_ || readOnly_) return 0;
+        std::lock_guard<std::mutex> guard(lock());
+        const uint8_t *bytes = static_cast<const uint8_t *>(value);
+        store()[ns_][key].assign(bytes, bytes + len);
+        return len;
+    }
+    size_t getBytesLength(const char *key) {
+        std::lock_guard<std::mutex> guard(lock());
+        auto &space = store()[ns_];
+        auto it = space.find(key);
+        return it == space.end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char *key, void *buf, size_t maxLen) {
+        std::lock_guard<std::mutex> guard(lock());
+        auto &space = store()[ns_];
+        auto it = space.find(key);
+        if (it == space.end() || it->second.size() > maxLen) return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+
+    size_t putString(const char *key, const String &value) {
+        return putBytes(key, value.c_str(), value.length() + 1) ? value.length() : 0;
+    }
+    String getString(const char *key, const String &defaultValue = String()) {
+        std::lock_guard<std::mutex> guard(lock());
+        auto &space = store()[ns_];
+        auto it = space.find(key);
+        if (it == space.end() || it->second.empty()) return defaultValue;
+        return String((const char *)it->second.data());
+    }
+
+    template <typename T> size_t putScalar(const char *key, T value) { return putBytes(key, &value, sizeof(value)); }
+    template <typename T> T getScalar(const char *key, T defaultValue) {
+        T value;
+        return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+    }
+    size_t putUInt(const char *key, uint32_t v) { return putScalar(key, v); }
+    uint32_t getUInt(const char *key, uint32_t d = 0) { return getScalar(key, d); }
+    size_t putInt(const char *key, int32_t v) { return putScalar(key, v); }
+    int32_t getInt(const char *key, int32_t d = 0) { return getScalar(key, d); }
+    size_t putULong(const char *key, uint32_t v) { return putScalar(key, v); }
+    uint32_t getULong(const char *key, uint32_t d = 0) { return getScalar(key, d); }
+    size_t putUChar(const char *key, uint8_t v) { return putScalar(key, v); }
+    uint8_t getUChar(const char *key, uint8_t d = 0) { return getScalar(key, d); }
+    size_t putUShort(const char *key, uint16_t v) { return putScalar(key, v); }
+    uint16_t getUShort(const char *key, uint16_t d = 0) { return getScalar(key, d); }
+    size_t putBool(const char *key, bool v) { return putScalar(key, (uint8_t)v); }
+    bool getBool(const char *key, bool d = false) { return getScalar(key, (uint8_t)d) != 0; }
+    size_t putULong64(const char *key, uint64_t v) { return putScalar(key, v); }
+    uint64_t getULong64(const char *key, uint64_t d = 0) { return getScalar(key, d); }
+
+private:
+    using Space = std::map<std::string, std::vector<uint8_t>>;
+    static std::map<std::string, Space> &store() {
+        static std::map<std::string, Space> instance;
+        return instance;
+    }
+    static std::mutex &lock() {
+        static std::mutex instance;
+        return instance;
+    }
+    std::string ns_;
+    bool readOnly_ = false;
+    bool open_ = false;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Arduino.h"
+
+// OTA host'ta yazılmaz (network_manager yalnızca bağlanır)
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+class UpdateClass {
+public:
+    bool begin(size_t = UPDATE_SIZE_UNKNOWN) { return false; }
+    size_t writeStream(Stream &) { return 0; }
+    bool end(bool = false) { return false; }
+    bool isFinished() { return false; }
+    String errorString() { return "host"; }
+};
+inline UpdateClass Update;
@@ -0,0 +1,267 @@
+#include "WiFi.h"
+
+#include <mutex>
+
+WiFiClass WiFi;
+
+namespace {
+
+struct VirtualAp {
+    std::string ssid;
+    std::string password;
+    int32_t rssi;
+    bool open;
+    uint8_t bssid[6];
+    uint8_t channel;
+};
+
+struct Listener {
+    WiFiEventFuncCb callback;
+    arduino_event_id_t event;
+};
+
+std::recursive_mutex wifiLock;
+std::vector<VirtualAp> networks;
+std::vector<Listener> listeners;
+std::vector<VirtualAp> scanResults;
+bool scanReady = false;
+int connectedIndex = -1;
+VirtualAp linked;
+bool staticConfig = false;
+IPAddress staticIP, staticGateway, staticSubnet, staticDns;
+uint32_t beginCount = 0;
+uint32_t scanCount = 0;
+
+arduino_event_info_t disconnectInfo(uint8_t reason) {
+    arduino_event_info_t info{};
+    info.wifi_sta_disconnected.reason = reason;
+    return info;
+}
+
+}
+
+namespace HostWiFi {
+
+void addNetwork(const char *ssid, int32_t rssi, bool open, const char *password) {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    for (auto &net : networks) {
+        if (net.ssid == ssid) {
+            net.rssi = rssi;
+            net.open = open;
+            net.password = password ? password : "";
+            return;
+        }
+    }
+    VirtualAp ap{};
+    ap.ssid = ssid;
+    ap.password = password ? password : "";
+    ap.rssi = rssi;
+    ap.open = open;
+    uint8_t seed = (uint8_t)networks.size();
+    uint8_t bssid[6] = {0x02, 0x00, 0x5E, 0x10, 0x00, (uint8_t)(seed + 1)};
+    memcpy(ap.bssid, bssid, 6);
+    ap.channel = (uint8_t)(1 + (seed * 5) % 11);
+    networks.push_back(ap);
+}
+
+void removeNetwork(const char *ssid) {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    networks.erase(std::remove_if(networks.begin(), networks.end(),
+                                  [&](const VirtualAp &ap) { return ap.ssid == ssid; }),
+                   networks.end());
+}
+
+void reset() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    networks.clear();
+    scanResults.clear();
+    scanReady = false;
+    connectedIndex = -1;
+    staticConfig = false;
+}
+
+void dropLink(uint8_t reason) {
+    {
+        std::lock_guard<std::recursive_mutex> guard(wifiLock);
+        if (connectedIndex < 0) return;
+        connectedIndex = -1;
+    }
+    WiFi.raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, disconnectInfo(reason));
+}
+
+uint32_t beginCalls() { return beginCount; }
+uint32_t scanCalls() { return scanCount; }
+
+}
+
+void WiFiClass::raise(arduino_event_id_t event, arduino_event_info_t info) {
+    std::vector<Listener> copy;
+    {
+        std::lock_guard<std::recursive_mutex> guard(wifiLock);
+        copy = listeners;
+    }
+    for (auto &listener : copy) {
+        if (listener.callback && (listener.event == ARDUINO_EVENT_MAX || listener.event == event)) {
+            listener.callback(event, info);
+        }
+    }
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb callback, arduino_event_id_t event) {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    listeners.push_back({callback, event});
+    return listeners.size();
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t id) {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    if (id > 0 && id <= listeners.size()) listeners[id - 1].callback = nullptr;
+}
+
+wl_status_t WiFiClass::status() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    return connectedIndex >= 0 ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *password, int32_t, const uint8_t *, bool) {
+    int found = -1;
+    bool accepted = false;
+    {
+        std::lock_guard<std::recursive_mutex> guard(wifiLock);
+        beginCount++;
+        for (size_t i = 0; i < networks.size(); ++i) {
+            if (ssid && networks[i].ssid == ssid) found = (int)i;
+        }
+        if (found >= 0) {
+            const VirtualAp &ap = networks[found];
+            accepted = ap.open || ap.password.empty() || (password && ap.password == password);
+        }
+        if (accepted) {
+            connectedIndex = found;
+            linked = networks[found];
+        }
+    }
+    if (found < 0) {
+        raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, disconnectInfo(WIFI_REASON_NO_AP_FOUND));
+        return WL_NO_SSID_AVAIL;
+    }
+    if (!accepted) {
+        raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, disconnectInfo(WIFI_REASON_AUTH_FAIL));
+        return WL_CONNECT_FAILED;
+    }
+    raise(ARDUINO_EVENT_WIFI_STA_CONNECTED, arduino_event_info_t{});
+    raise(ARDUINO_EVENT_WIFI_STA_GOT_IP, arduino_event_info_t{});
+    return WL_CONNECTED;
+}
+
+bool WiFiClass::config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress) {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    staticConfig = local != INADDR_NONE && local != IPAddress();
+    staticIP = local;
+    staticGateway = gateway;
+    staticSubnet = subnet;
+    staticDns = dns1;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool, bool) {
+    bool wasConnected;
+    {
+        std::lock_guard<std::recursive_mutex> guard(wifiLock);
+        wasConnected = connectedIndex >= 0;
+        connectedIndex = -1;
+    }
+    if (wasConnected) raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, disconnectInfo(WIFI_REASON_ASSOC_LEAVE));
+    return true;
+}
+
+String WiFiClass::SSID() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    return connectedIndex >= 0 ? String(linked.ssid) : String();
+}
+
+int32_t WiFiClass::RSSI() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    return connectedIndex >= 0 ? linked.rssi : 0;
+}
+
+uint8_t *WiFiClass::BSSID() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    return connectedIndex >= 0 ? linked.bssid : nullptr;
+}
+
+int32_t WiFiClass::channel() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    return connectedIndex >= 0 ? linked.channel : 0;
+}
+
+IPAddress WiFiClass::localIP() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    if (connectedIndex < 0) return IPAddress();
+    return staticConfig ? staticIP : IPAddress(192, 168, 11, 50);
+}
+
+IPAddress WiFiClass::gatewayIP() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    if (connectedIndex < 0) return IPAddress();
+    return staticConfig ? staticGateway : IPAddress(192, 168, 11, 1);
+}
+
+IPAddress WiFiClass::subnetMask() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    if (connectedIndex < 0) return IPAddress();
+    return staticConfig ? staticSubnet : IPAddress(255, 255, 255, 0);
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t) {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    if (connectedIndex < 0) return IPAddress();
+    return staticConfig ? staticDns : IPAddress(192, 168, 11, 1);
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool, bool, uint32_t, uint8_t, const char *, const uint8_t *) {
+    int16_t count;
+    {
+        std::lock_guard<std::recursive_mutex> guard(wifiLock);
+        scanCount++;
+        scanResults = networks;
+        scanReady = true;
+        count = (int16_t)scanResults.size();
+    }
+    if (async) {
+        raise(ARDUINO_EVENT_WIFI_SCAN_DONE, arduino_event_info_t{});
+        return WIFI_SCAN_RUNNING;
+    }
+    return count;
+}
+
+int16_t WiFiClass::scanComplete() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    return scanReady ? (int16_t)scanResults.size() : WIFI_SCAN_FAILED;
+}
+
+void WiFiClass::scanDelete() {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    scanResults.clear();
+    scanReady = false;
+}
+
+String WiFiClass::SSID(uint8_t index) {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    return index < scanResults.size() ? String(scanResults[index].ssid) : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t index) {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    return index < scanResults.size() ? scanResults[index].rssi : 0;
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t index) {
+    std::lock_guard<std::recursive_mutex> guard(wifiLock);
+    if (index >= scanResults.size()) return WIFI_AUTH_OPEN;
+    return scanResults[index].open ? WIFI_AUTH_OPEN : WIFI_AUTH_WPA2_PSK;
+}
+
+int WiFiClass::hostByName(const char *host, IPAddress &result) {
+    return HostNet::resolve(host, result);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+#include "esp_wifi.h"
+
+// Radyo yok: HostWiFi ile tanımlanan sanal AP'ler taranır ve bağlanılır.
+// scanNetworks(true) SCAN_DONE'u, begin() ise STA_CONNECTED + GOT_IP ya da
+// DISCONNECTED/201 olaylarını eşzamanlı yayınlar (network_manager yalnızca bayrak kurar).
+
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_SCAN_COMPLETED = 2, WL_CONNECTED = 3,
+               WL_CONNECT_FAILED = 4, WL_CONNECTION_LOST = 5, WL_DISCONNECTED = 6 } wl_status_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+typedef enum {
+    ARDUINO_EVENT_WIFI_READY = 0,
+    ARDUINO_EVENT_WIFI_SCAN_DONE,
+    ARDUINO_EVENT_WIFI_STA_START,
+    ARDUINO_EVENT_WIFI_STA_STOP,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP,
+    ARDUINO_EVENT_WIFI_STA_LOST_IP,
+    ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+
+typedef struct {
+    uint8_t ssid[33];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+    int8_t rssi;
+} wifi_event_sta_disconnected_t;
+
+typedef union {
+    wifi_event_sta_disconnected_t wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef size_t wifi_event_id_t;
+typedef std::function<void(arduino_event_id_t, arduino_event_info_t)> WiFiEventFuncCb;
+
+class WiFiClass {
+public:
+    wl_status_t status();
+    bool isConnected() { return status() == WL_CONNECTED; }
+
+    wl_status_t begin(const char *ssid, const char *password = nullptr, int32_t channel = 0,
+                      const uint8_t *bssid = nullptr, bool connect = true);
+    bool config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(),
+                IPAddress dns2 = IPAddress());
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    bool setAutoReconnect(bool) { return true; }
+    bool mode(wifi_mode_t next) { mode_ = next; return true; }
+    wifi_mode_t getMode() { return mode_; }
+    bool setHostname(const char *name) { hostname_ = name ? name : ""; return true; }
+    const char *getHostname() { return hostname_.c_str(); }
+    bool setSleep(bool) { return true; }
+
+    String SSID();
+    int32_t RSSI();
+    uint8_t *BSSID();
+    int32_t channel();
+    IPAddress localIP();
+    IPAddress gatewayIP();
+    IPAddress subnetMask();
+    IPAddress dnsIP(uint8_t = 0);
+    String macAddress() { return "DE:AD:BE:EF:12:34"; }
+
+    int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false,
+                         uint32_t maxMsPerChannel = 300, uint8_t channel = 0, const char *ssid = nullptr,
+                         const uint8_t *bssid = nullptr);
+    int16_t scanComplete();
+    void scanDelete();
+    String SSID(uint8_t index);
+    int32_t RSSI(uint8_t index);
+    wifi_auth_mode_t encryptionType(uint8_t index);
+
+    int hostByName(const char *host, IPAddress &result);
+
+    bool softAP(const char *, const char * = nullptr) { return true; }
+    bool softAPConfig(IPAddress ip, IPAddress, IPAddress) { apIP_ = ip; return true; }
+    IPAddress softAPIP() { return apIP_; }
+    bool softAPdisconnect(bool = false) { return true; }
+
+    wifi_event_id_t onEvent(WiFiEventFuncCb callback, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+    void removeEvent(wifi_event_id_t id);
+
+    void raise(arduino_event_id_t event, arduino_event_info_t info);
+
+private:
+    wifi_mode_t mode_ = WIFI_STA;
+    std::string hostname_ = "esp32-host";
+    IPAddress apIP_;
+};
+
+extern WiFiClass WiFi;
+
+namespace HostWiFi {
+    // Sanal AP ekle (aynı SSID → güncellenir); görünür = taramada listelenir ve bağlanılabilir
+    void addNetwork(const char *ssid, int32_t rssi, bool open, const char *password = nullptr);
+    void removeNetwork(const char *ssid);
+    void reset();
+    // Bağlantıyı düşür: DISCONNECTED olayı verilen sebeple yayınlanır
+    void dropLink(uint8_t reason = WIFI_REASON_BEACON_TIMEOUT);
+    uint32_t beginCalls();
+    uint32_t scanCalls();
+}
@@ -0,0 +1,197 @@
+#include "WiFiClient.h"
+#include "WiFiClientSecure.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+struct HostSocket {
+    int fd = -1;
+    ~HostSocket() {
+        if (fd >= 0) close(fd);
+    }
+};
+
+namespace {
+
+std::mutex netLock;
+std::vector<uint32_t> aliases;
+std::map<std::string, uint32_t> hosts;
+std::atomic<uint32_t> lookupCount{0};
+std::atomic<uint32_t> connectCount{0};
+
+uint32_t route(const IPAddress &ip) {
+    std::lock_guard<std::mutex> guard(netLock);
+    for (uint32_t alias : aliases) {
+        if (alias == (uint32_t)ip) return (uint32_t)IPAddress(127, 0, 0, 1);
+    }
+    return (uint32_t)ip;
+}
+
+}
+
+namespace HostNet {
+
+void alias(const IPAddress &lanAddress) {
+    std::lock_guard<std::mutex> guard(netLock);
+    aliases.push_back((uint32_t)lanAddress);
+}
+
+void addHost(const char *name, const IPAddress &address) {
+    std::lock_guard<std::mutex> guard(netLock);
+    hosts[name] = (uint32_t)address;
+}
+
+uint32_t lookups() { return lookupCount.load(); }
+uint32_t connects() { return connectCount.load(); }
+
+// WiFi.hostByName() buradan çözer
+int resolve(const char *name, IPAddress &result) {
+    lookupCount++;
+    if (!name || !*name) return 0;
+    if (result.fromString(name)) return 1;
+    {
+        std::lock_guard<std::mutex> guard(netLock);
+        auto it = hosts.find(name);
+        if (it != hosts.end()) {
+            result = IPAddress(it->second);
+            return 1;
+        }
+    }
+    if (strcmp(name, "localhost") == 0) {
+        result = IPAddress(127, 0, 0, 1);
+        return 1;
+    }
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    addrinfo *found = nullptr;
+    if (getaddrinfo(name, nullptr, &hints, &found) != 0 || !found) return 0;
+    uint32_t raw = ((sockaddr_in *)found->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(found);
+    result = IPAddress(raw);
+    return 1;
+}
+
+}
+
+WiFiClient::WiFiClient() {}
+WiFiClient::~WiFiClient() {}
+
+int WiFiClient::fd() const { return sock ? sock->fd : -1; }
+
+bool WiFiClient::openSocket(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+    stop();
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    auto holder = std::make_shared<HostSocket>();
+    holder->fd = fd;
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = route(ip);
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    int rc = ::connect(fd, (sockaddr *)&addr, sizeof(addr));
+    if (rc < 0 && errno != EINPROGRESS) return false;
+    if (rc < 0) {
+        pollfd pfd{fd, POLLOUT, 0};
+        if (poll(&pfd, 1, timeoutMs > 0 ? timeoutMs : 3000) <= 0) return false;
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0) return false;
+    }
+    fcntl(fd, F_SETFL, flags);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sock = holder;
+    connectCount++;
+    return true;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+    return openSocket(ip, port, timeoutMs) ? 1 : 0;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port, int32_t timeoutMs) {
+    IPAddress ip;
+    if (!HostNet::resolve(host, ip)) return 0;
+    return connect(ip, port, timeoutMs);
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size) {
+    if (!sock) return 0;
+    size_t sent = 0;
+    while (sent < size) {
+        pollfd pfd{sock->fd, POLLOUT, 0};
+        if (poll(&pfd, 1, (int)_timeout) <= 0) break;
+        ssize_t n = send(sock->fd, buf + sent, size - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+            break;
+        }
+        sent += (size_t)n;
+    }
+    return sent;
+}
+
+int WiFiClient::available() {
+    if (!sock) return 0;
+    int pending = 0;
+    return ioctl(sock->fd, FIONREAD, &pending) == 0 ? pending : 0;
+}
+
+int WiFiClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size) {
+    if (!sock) return -1;
+    ssize_t n = recv(sock->fd, buf, size, MSG_DONTWAIT);
+    return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::peek() {
+    if (!sock) return -1;
+    uint8_t c;
+    return recv(sock->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+void WiFiClient::stop() { sock.reset(); }
+
+uint8_t WiFiClient::connected() {
+    if (!sock) return 0;
+    if (available() > 0) return 1;
+    uint8_t c;
+    ssize_t n = recv(sock->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        sock.reset();
+        return 0;
+    }
+    return 1;
+}
+
+int WiFiClientSecure::connect(const char *host, uint16_t port) { return connect(host, port, (int32_t)_timeout); }
+
+int WiFiClientSecure::connect(const char *host, uint16_t port, int32_t timeoutMs) {
+    IPAddress ip;
+    if (!HostNet::resolve(host, ip)) return 0;
+    return WiFiClient::connect(ip, port, timeoutMs);
+}
+
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port, const char *, const char *, const char *, const char *) {
+    return WiFiClient::connect(ip, port, (int32_t)_timeout);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Client.h"
+#include <memory>
+
+// POSIX TCP soketi. Kopyalar aynı soketi paylaşır (ESP32 çekirdeğindeki gibi).
+// HostNet::alias() ile yerel ağ adresleri (ör. 192.168.11.25) 127.0.0.1'e
+// yönlendirilir - firmware'in "yalnızca özel IPv4" kontrolü değişmeden sınanır.
+
+struct HostSocket;
+
+class WiFiClient : public Client {
+public:
+    WiFiClient();
+    ~WiFiClient() override;
+
+    int connect(IPAddress ip, uint16_t port) override { return connect(ip, port, (int32_t)_timeout); }
+    int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+    int connect(const char *host, uint16_t port) override { return connect(host, port, (int32_t)_timeout); }
+    virtual int connect(const char *host, uint16_t port, int32_t timeoutMs);
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buf, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buf, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override;
+    operator bool() override { return connected(); }
+
+    void setTimeout(uint32_t seconds) { _timeout = seconds * 1000; }
+    int setNoDelay(bool) { return 0; }
+    int fd() const;
+
+protected:
+    std::shared_ptr<HostSocket> sock;
+    bool openSocket(IPAddress ip, uint16_t port, int32_t timeoutMs);
+};
+
+namespace HostNet {
+    // Bu adrese yapılan bağlantılar 127.0.0.1'e gider
+    void alias(const IPAddress &lanAddress);
+    // resolve() için ad kaydı
+    void addHost(const char *name, const IPAddress &address);
+    // Ad çözümleme (WiFi.hostByName): IP biçimi, kayıtlı ad, "localhost", sistem
+    int resolve(const char *name, IPAddress &result);
+    uint32_t lookups();
+    uint32_t connects();
+}
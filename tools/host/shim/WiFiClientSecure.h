@@ -0,0 +1,37 @@
+#pragma once
+
+#include "WiFiClient.h"
+#include "ssl_client.h"
+
+// Host'ta TLS yok: bağlantı düz TCP açılır, startTLS() başarısız olur.
+// Firmware'in şifresiz yerel test yolu (setPlaintext) aynen çalışır.
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    WiFiClientSecure() { sslclient.reset(new sslclient_context()); }
+
+    using WiFiClient::connect;
+    int connect(IPAddress ip, uint16_t port) override { return connect(ip, port, nullptr, _CA_cert, _cert, _private_key); }
+    int connect(const char *host, uint16_t port) override;
+    int connect(const char *host, uint16_t port, int32_t timeoutMs) override;
+    int connect(IPAddress ip, uint16_t port, const char *host, const char *rootCA, const char *cliCert,
+                const char *cliKey);
+
+    void setInsecure() { _CA_cert = nullptr; }
+    void setCACert(const char *rootCA) { _CA_cert = rootCA; }
+    void setCertificate(const char *cert) { _cert = cert; }
+    void setPrivateKey(const char *key) { _private_key = key; }
+    void setPlainStart() { plainStart = true; }
+    bool stillInPlainStart() const { return plainStart; }
+    bool startTLS() { return false; }
+    void setHandshakeTimeout(unsigned long) {}
+
+protected:
+    std::unique_ptr<sslclient_context> sslclient;
+    const char *_CA_cert = nullptr;
+    const char *_cert = nullptr;
+    const char *_private_key = nullptr;
+    bool plainStart = false;
+};
+
+using NetworkClientSecure = WiFiClientSecure;
@@ -0,0 +1,78 @@
+#pragma once
+
+// FreeRTOS alt kümesi: görevler std::thread, 1 tick = 1 ms (sanal saat).
+// portENTER_CRITICAL özyinelemeli muteks - tek çekirdekli ESP32-C6'daki
+// kritik bölüm gibi aynı görevden iç içe girilebilir.
+
+#include <cstdint>
+#include <mutex>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portTICK_PERIOD_MS 1
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+struct portMUX_TYPE {
+    std::recursive_mutex m;
+    portMUX_TYPE() {}
+    portMUX_TYPE(const portMUX_TYPE &) {}
+    portMUX_TYPE &operator=(const portMUX_TYPE &) { return *this; }
+};
+#define portMUX_INITIALIZER_UNLOCKED portMUX_TYPE()
+#define portENTER_CRITICAL(mux) ((mux)->m.lock())
+#define portEXIT_CRITICAL(mux) ((mux)->m.unlock())
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux) portEXIT_CRITICAL(mux)
+#define taskENTER_CRITICAL(mux) portENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL(mux) portEXIT_CRITICAL(mux)
+
+struct HostTask;
+struct HostSemaphore;
+struct HostQueue;
+typedef HostTask *TaskHandle_t;
+typedef HostSemaphore *SemaphoreHandle_t;
+typedef HostQueue *QueueHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param,
+                       UBaseType_t priority, TaskHandle_t *handle);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+void vTaskDelete(TaskHandle_t task); // NULL → çağıran görev sonlanır
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+TickType_t xTaskGetTickCount();
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+void vQueueDelete(QueueHandle_t queue);
+#define xQueueSendToBack xQueueSend
+
+// Çalışan host görevlerinin sayısı (testler bitişi bekleyebilir)
+namespace HostTasks {
+    uint32_t running();
+    uint32_t created();
+    // Sonraki 'count' xTaskCreate çağrısı pdFAIL döner (bellek yetersiz yedek yolları)
+    void failCreates(uint32_t count);
+}
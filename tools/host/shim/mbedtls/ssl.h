@@ -0,0 +1,28 @@
+#pragma once
+
+// Oturum devamı host'ta yok: kayıt/yükleme her zaman hata döner
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define MBEDTLS_PRIVATE(member) member
+#define MBEDTLS_ERR_SSL_BAD_INPUT_DATA -0x7100
+
+struct mbedtls_ssl_session {
+    size_t id_len = 0;
+    unsigned char id[32] = {0};
+};
+
+struct mbedtls_ssl_context {
+    int unused = 0;
+};
+
+inline void mbedtls_ssl_session_init(mbedtls_ssl_session *session) { *session = mbedtls_ssl_session(); }
+inline void mbedtls_ssl_session_free(mbedtls_ssl_session *session) { *session = mbedtls_ssl_session(); }
+inline int mbedtls_ssl_set_session(mbedtls_ssl_context *, const mbedtls_ssl_session *) { return MBEDTLS_ERR_SSL_BAD_INPUT_DATA; }
+inline int mbedtls_ssl_get_session(const mbedtls_ssl_context *, mbedtls_ssl_session *) { return MBEDTLS_ERR_SSL_BAD_INPUT_DATA; }
+inline int mbedtls_ssl_session_save(const mbedtls_ssl_session *, unsigned char *, size_t, size_t *olen) {
+    if (olen) *olen = 0;
+    return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+}
+inline int mbedtls_ssl_session_load(mbedtls_ssl_session *, const unsigned char *, size_t) { return MBEDTLS_ERR_SSL_BAD_INPUT_DATA; }
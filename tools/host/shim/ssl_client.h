@@ -0,0 +1,7 @@
+#pragma once
+
+#include "mbedtls/ssl.h"
+
+struct sslclient_context {
+    mbedtls_ssl_context ssl_ctx;
+};
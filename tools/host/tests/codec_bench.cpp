@@ -0,0 +1,695 @@
+// ============================================================================
+// Kodlayıcı doğruluk testleri + host mikro ölçümleri
+// ============================================================================
+// Her bölüm önce çıktıyı bağımsız bir referansla karşılaştırır (CHECK), sonra
+// eski yol ile yeni yolu MB/s ve MB başına heap ayırma sayısıyla raporlar.
+// Ayırmalar global operator new sayacıyla ölçülür (yalnızca bu süreç).
+//
+//   base64  - Base64Stream::encodeLines ↔ RFC 2045 referansı;
+//             57 baytlık base64::encode() + print (eski ek yolu) ile kıyas
+//   journal - MailQueue günlüğü: yarım son kayıt / bozuk sağlama ile yeniden
+//             oynatma; MAX_QUEUE_SIZE ve üstünde eski JSON yeniden yazımı ile kıyas
+//   template - MessageTemplate render ↔ soldan sağa referans, render uzunluğu ==
+//             renderedLength(); büyük gövdede 6 String::replace geçişi ile kıyas
+//   gzip    - GzipWriter çıktısı zlib ile açılır (CRC32/ISIZE dahil) ve girdiyle
+//             aynı olmalı; CSV/talimat/anahtar listesi/rastgele veride oran
+//             (zlib -6 ile), MB/s ve base64 DATA boyutu. GzipWriter belleğini
+//             begin()'de malloc ile alır; sayaç yalnızca operator new görür
+
+#include "host_test.h"
+#include "base64_stream.h"
+#include "gzip_stream.h"
+#include "mail_queue.h"
+#include "message_template.h"
+
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <atomic>
+#include <base64.h>
+#include <chrono>
+#include <filesystem>
+#include <new>
+#include <random>
+#include <zlib.h>
+
+using namespace host_test;
+
+// --- Ayırma sayacı ------------------------------------------------------------
+
+namespace {
+std::atomic<uint64_t> allocations{0};
+}
+
+// noinline: satır içine açılınca GCC malloc/free eşleşmesini new/delete ile
+// karıştırıp -Wmismatched-new-delete verir
+__attribute__((noinline)) void *operator new(size_t size) {
+    allocations++;
+    if (void *p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void *p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace {
+
+// Yazılanı sayar, saklamaz (SMTP akışı yerine)
+class CountingPrint : public Print {
+public:
+    size_t bytes = 0;
+    size_t write(uint8_t) override {
+        bytes++;
+        return 1;
+    }
+    size_t write(const uint8_t *, size_t size) override {
+        bytes += size;
+        return size;
+    }
+};
+
+struct Measure {
+    double seconds = 0;
+    uint64_t allocations = 0;
+};
+
+template <class Fn>
+Measure measure(Fn &&fn) {
+    uint64_t before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    Measure m;
+    m.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    m.allocations = allocations.load() - before;
+    return m;
+}
+
+void report(const char *name, size_t bytes, const Measure &m) {
+    double mb = bytes / (1024.0 * 1024.0);
+    printf("  %-34s %8.1f MB/s %10.1f ayırma/MB\n", name, mb / m.seconds, m.allocations / mb);
+}
+
+std::vector<uint8_t> randomBytes(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(size);
+    for (auto &b : data) b = (uint8_t)rng();
+    return data;
+}
+
+// --- base64 ---------------------------------------------------------------------
+
+// Referans: RFC 4648 alfabesi, 76 karakterde CRLF, her satır CRLF ile biter
+std::string referenceBase64(const uint8_t *data, size_t length) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string flat;
+    for (size_t i = 0; i < length; i += 3) {
+        size_t n = std::min<size_t>(3, length - i);
+        uint32_t word = 0;
+        for (size_t k = 0; k < 3; ++k) word = (word << 8) | (k < n ? data[i + k] : 0);
+        for (size_t k = 0; k < 4; ++k) flat += k <= n ? table[(word >> (18 - 6 * k)) & 63] : '=';
+    }
+    std::string lines;
+    for (size_t i = 0; i < flat.size(); i += 76) lines += flat.substr(i, 76) + "\r\n";
+    return lines;
+}
+
+void base64Section() {
+    printf("base64\n");
+
+    // Doğruluk: tüm uzunluklar 0..2000 (kısmi son satır, 1/2 bayt dolgu)
+    std::vector<uint8_t> data = randomBytes(2000, 31);
+    std::vector<char> out(Base64Stream::encodedSize(data.size()));
+    for (size_t len = 0; len <= data.size(); ++len) {
+        size_t written = Base64Stream::encodeLines(data.data(), len, out.data(), out.size());
+        std::string expected = referenceBase64(data.data(), len);
+        if (written != Base64Stream::encodedSize(len) || std::string(out.data(), written) != expected) {
+            fprintf(stderr, "base64 uzunluk %zu: çıktı referansla aynı değil\n", len);
+            failures()++;
+            break;
+        }
+    }
+
+    // Parçalı çağrı: 57'nin katı bloklar + kısa son blok = tek seferlik çıktı
+    const size_t BLOCK_INPUT = Base64Stream::LINE_INPUT * 8; // Firmware ile aynı: 456 → 624 bayt
+    std::string chunked;
+    char block[Base64Stream::encodedSize(BLOCK_INPUT)];
+    for (size_t offset = 0; offset < data.size(); offset += BLOCK_INPUT) {
+        size_t len = std::min(BLOCK_INPUT, data.size() - offset);
+        chunked.append(block, Base64Stream::encodeLines(data.data() + offset, len, block, sizeof(block)));
+    }
+    CHECK(chunked == referenceBase64(data.data(), data.size()));
+
+    // Tampon küçükse hiçbir şey yazılmaz
+    CHECK(Base64Stream::encodeLines(data.data(), 58, out.data(), Base64Stream::encodedSize(58) - 1) == 0);
+
+    // Ölçüm: 4 MB, eski yol 57 bayt/satır String, yeni yol 456 bayt/blok yığın tamponu
+    const size_t TOTAL = 4 * 1024 * 1024;
+    std::vector<uint8_t> payload = randomBytes(TOTAL, 310);
+    CountingPrint legacySink, streamSink;
+    Measure legacy = measure([&] {
+        for (size_t offset = 0; offset < TOTAL; offset += Base64Stream::LINE_INPUT) {
+            size_t len = std::min(Base64Stream::LINE_INPUT, TOTAL - offset);
+            String encoded = base64::encode(payload.data() + offset, len);
+            legacySink.print(encoded);
+            legacySink.print("\r\n");
+        }
+    });
+    Measure stream = measure([&] {
+        for (size_t offset = 0; offset < TOTAL; offset += BLOCK_INPUT) {
+            size_t len = std::min(BLOCK_INPUT, TOTAL - offset);
+            size_t written = Base64Stream::encodeLines(payload.data() + offset, len, block, sizeof(block));
+            streamSink.write(reinterpret_cast<const uint8_t *>(block), written);
+        }
+    });
+    CHECK(legacySink.bytes == streamSink.bytes);
+    CHECK(stream.allocations == 0);
+    report("base64::encode + print (eski)", TOTAL, legacy);
+    report("Base64Stream::encodeLines", TOTAL, stream);
+}
+
+// --- journal ------------------------------------------------------------------
+
+const char *const JOURNAL_PATH = "/mail_queue.log";
+const size_t JOURNAL_RECORD_SIZE = 52;
+const size_t QUEUE_WARN_SIZE = 20; // MailAgent::MAX_QUEUE_SIZE (özel üye)
+
+size_t journalSize() {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(HostFS::hostPath(JOURNAL_PATH), ec);
+    return ec ? 0 : (size_t)size;
+}
+
+QueuedMail makeMail(int index) {
+    QueuedMail mail;
+    mail.type = index % 4 == 0 ? MailType::FINAL : MailType::WARNING;
+    mail.alarmIndex = (uint8_t)(index % 8);
+    mail.createdAt = millis();
+    mail.nextRetryTime = millis();
+    snprintf(mail.description, sizeof(mail.description), "mail-%d", index);
+    return mail;
+}
+
+std::vector<QueuedMail> drain(MailQueue &queue) {
+    std::vector<QueuedMail> mails;
+    QueuedMail mail;
+    while (queue.popDue(millis() + 1, mail)) mails.push_back(mail);
+    std::sort(mails.begin(), mails.end(), [](const QueuedMail &a, const QueuedMail &b) { return a.id < b.id; });
+    return mails;
+}
+
+void checkJournalReplay() {
+    freshFilesystem("journal");
+    uint32_t lastId = 0;
+    {
+        MailQueue queue;
+        queue.begin();
+        for (int i = 0; i < 5; ++i) lastId = queue.enqueue(makeMail(i));
+
+        QueuedMail mail;
+        CHECK(queue.popDue(millis() + 1, mail));
+        mail.phase = RetryPhase::PHASE2;
+        mail.attemptCount = 3;
+        queue.reschedule(mail); // ATTEMPT
+        CHECK(queue.popDue(millis() + 1, mail));
+        queue.complete(mail);   // COMPLETE
+        queue.enqueue(makeMail(5));
+    }
+
+    // Son kayıt (mail-5 ENQUEUE) yazılırken güç kesildi: 20 bayt eksik
+    size_t fullSize = journalSize();
+    CHECK(fullSize % JOURNAL_RECORD_SIZE == 0);
+    std::filesystem::resize_file(HostFS::hostPath(JOURNAL_PATH), fullSize - 20);
+
+    MailQueue replayed;
+    replayed.begin();
+    std::vector<QueuedMail> mails = drain(replayed);
+    CHECK(mails.size() == 4);
+    bool sawAttempt = false;
+    for (const QueuedMail &mail : mails) {
+        CHECK(strcmp(mail.description, "mail-5") != 0);
+        if (mail.attemptCount == 3 && mail.phase == RetryPhase::PHASE2) sawAttempt = true;
+    }
+    CHECK(sawAttempt);
+    // Bozuk kuyruk atıldı, günlük kayıt sınırında yeniden yazıldı; yeni ID'ler çakışmaz
+    CHECK(journalSize() % JOURNAL_RECORD_SIZE == 0);
+    for (const QueuedMail &mail : mails) replayed.reschedule(mail);
+    CHECK(replayed.enqueue(makeMail(6)) > lastId);
+
+    // Son TAM kaydın sağlaması bozuk: o kayıt (ve sonrası) yok sayılır
+    size_t size = journalSize();
+    {
+        FILE *f = fopen(HostFS::hostPath(JOURNAL_PATH).c_str(), "r+b");
+        fseek(f, (long)(size - JOURNAL_RECORD_SIZE + 10), SEEK_SET);
+        fputc('X', f);
+        fclose(f);
+    }
+    MailQueue corrupted;
+    corrupted.begin();
+    std::vector<QueuedMail> survivors = drain(corrupted);
+    CHECK(survivors.size() == 4);
+    for (const QueuedMail &mail : survivors) CHECK(strcmp(mail.description, "mail-6") != 0);
+
+    // Üçüncü açılış temiz günlükten aynı durumu okur
+    MailQueue again;
+    again.begin();
+    CHECK(again.size() == 4);
+}
+
+// Eski kuyruk: String alanlı kayıt, her işlemde sırala + tüm JSON'u yeniden yaz
+// (ayrı dosya adı: /mail_queue.json MailQueue::begin() tarafından dönüştürülürdü)
+struct LegacyMail {
+    uint32_t id;
+    uint8_t type;
+    uint8_t phase;
+    uint8_t attempts;
+    uint32_t nextRetryTime;
+    uint32_t createdAt;
+    String subject, body, startTime, endTime, description;
+};
+
+void saveLegacy(std::vector<LegacyMail> &queue) {
+    std::sort(queue.begin(), queue.end(), [](const LegacyMail &a, const LegacyMail &b) {
+        if (a.type != b.type) return a.type < b.type;
+        if (a.nextRetryTime != b.nextRetryTime) return a.nextRetryTime < b.nextRetryTime;
+        return a.createdAt < b.createdAt;
+    });
+    JsonDocument doc;
+    doc["nextId"] = (uint32_t)queue.size() + 1;
+    JsonArray arr = doc["queue"].to<JsonArray>();
+    for (const LegacyMail &mail : queue) {
+        JsonObject obj = arr.add<JsonObject>();
+        obj["id"] = mail.id;
+        obj["type"] = mail.type;
+        obj["phase"] = mail.phase;
+        obj["attempts"] = mail.attempts;
+        obj["created"] = mail.createdAt;
+        obj["subject"] = mail.subject;
+        obj["body"] = mail.body;
+        obj["startTime"] = mail.startTime;
+        obj["endTime"] = mail.endTime;
+        obj["desc"] = mail.description;
+    }
+    File file = LittleFS.open("/legacy_queue.json", "w");
+    serializeJson(doc, file);
+    file.close();
+}
+
+void benchJournal(size_t count) {
+    freshFilesystem("journal-bench");
+    // Eski: count ekleme + count deneme, her biri tam yeniden yazım
+    std::vector<LegacyMail> legacy;
+    size_t legacyBytes = 0;
+    Measure old = measure([&] {
+        for (size_t i = 0; i < count; ++i) {
+            LegacyMail mail{(uint32_t)i + 1, (uint8_t)(i % 4 == 0), 0, 0, (uint32_t)millis(), (uint32_t)millis(),
+                            "[DMF] Uyari " + String((int)i), "Cihaz bekleme suresi doldu, lutfen kontrol edin.",
+                            "", "", "mail-" + String((int)i)};
+            legacy.push_back(mail);
+            saveLegacy(legacy);
+            legacyBytes += LittleFS.open("/legacy_queue.json", "r").size();
+        }
+        for (size_t i = 0; i < count; ++i) {
+            legacy[i].attempts++;
+            legacy[i].nextRetryTime += 60000;
+            saveLegacy(legacy);
+            legacyBytes += LittleFS.open("/legacy_queue.json", "r").size();
+        }
+    });
+
+    // Yeni: aynı işlemler günlüğe kayıt ekler (O(log n) yığın + 52 bayt)
+    MailQueue queue;
+    queue.begin();
+    Measure journal = measure([&] {
+        for (size_t i = 0; i < count; ++i) queue.enqueue(makeMail((int)i));
+        QueuedMail mail;
+        for (size_t i = 0; i < count && queue.popDue(millis() + 1, mail); ++i) {
+            mail.attemptCount++;
+            mail.nextRetryTime = millis() + 60000;
+            queue.reschedule(mail);
+        }
+    });
+    CHECK(queue.size() == count);
+
+    double ops = 2.0 * count;
+    printf("  %4zu mail  eski %8.1f µs/işlem %8.0f B/işlem %6.1f ayırma/işlem | günlük %6.1f µs/işlem %3zu B/işlem %4.1f ayırma/işlem\n",
+           count, old.seconds * 1e6 / ops, legacyBytes / ops, old.allocations / ops, journal.seconds * 1e6 / ops,
+           JOURNAL_RECORD_SIZE, journal.allocations / ops);
+}
+
+void journalSection() {
+    printf("journal\n");
+    checkJournalReplay();
+    for (size_t count : {QUEUE_WARN_SIZE, QUEUE_WARN_SIZE * 5, QUEUE_WARN_SIZE * 25}) {
+        benchJournal(count);
+    }
+}
+
+// --- template -----------------------------------------------------------------
+
+struct PlaceholderText {
+    const char *text;
+    TemplateVar var;
+};
+
+const PlaceholderText PLACEHOLDER_TEXTS[] = {
+    {"{DEVICE_ID}", TemplateVar::DEVICE_ID},     {"{TIMESTAMP}", TemplateVar::TIMESTAMP},
+    {"{REMAINING}", TemplateVar::REMAINING},     {"%REMAINING%", TemplateVar::REMAINING},
+    {"%ALARM_INDEX%", TemplateVar::ALARM_INDEX}, {"%TOTAL_ALARMS%", TemplateVar::TOTAL_ALARMS},
+};
+
+// Referans: soldan sağa, her konumda tanınan yer tutucu; değeri yoksa olduğu gibi
+std::string referenceRender(const std::string &source, const TemplateValues &values) {
+    std::string out;
+    for (size_t i = 0; i < source.size();) {
+        bool matched = false;
+        for (const PlaceholderText &p : PLACEHOLDER_TEXTS) {
+            size_t len = strlen(p.text);
+            if (source.compare(i, len, p.text) != 0) continue;
+            const char *value = values.get(p.var);
+            out += value ? value : p.text;
+            i += len;
+            matched = true;
+            break;
+        }
+        if (!matched) out += source[i++];
+    }
+    return out;
+}
+
+class StringPrint : public Print {
+public:
+    std::string text;
+    size_t write(uint8_t c) override {
+        text += (char)c;
+        return 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        text.append((const char *)buffer, size);
+        return size;
+    }
+};
+
+void checkTemplates() {
+    // Tuzaklar: yarım yer tutucu, iç içe ayraçlar, çift %, UTF-8, değer içinde yer tutucu
+    const char *fragments[] = {
+        "Cihaz ", " - kalan ", "{", "}", "%", "%%", "{DEVICE", "DEVICE_ID}", "{{DEVICE_ID}}", "%ALARM_INDEX",
+        "Uyarı ğüşiöç ", "\r\n", "{device_id}", "%TOTAL_ALARMS%%", "{TIMESTAMP}{TIMESTAMP}", "x",
+    };
+    const char *valuePool[] = {nullptr, "", "HOSTDEV00001", "3", "12 saat 5 dakika", "{DEVICE_ID}", "%REMAINING%",
+                               "çok uzun değer çok uzun değer çok uzun değer çok uzun değer"};
+    std::mt19937 rng(40);
+    size_t mismatches = 0;
+    for (int round = 0; round < 3000; ++round) {
+        std::string source;
+        int parts = rng() % 24;
+        for (int i = 0; i < parts; ++i) {
+            if (rng() % 2) source += PLACEHOLDER_TEXTS[rng() % 6].text;
+            else source += fragments[rng() % (sizeof(fragments) / sizeof(fragments[0]))];
+        }
+        TemplateValues values;
+        for (uint8_t v = 0; v < static_cast<uint8_t>(TemplateVar::COUNT); ++v) {
+            values.set(static_cast<TemplateVar>(v), valuePool[rng() % (sizeof(valuePool) / sizeof(valuePool[0]))]);
+        }
+
+        MessageTemplate compiled(String(source.c_str()));
+        StringPrint out;
+        size_t written = compiled.render(out, values);
+        std::string expected = referenceRender(source, values);
+        if (out.text != expected || written != out.text.size() || compiled.renderedLength(values) != written) {
+            if (mismatches++ == 0) {
+                fprintf(stderr, "şablon \"%s\": render %zu bayt, renderedLength %zu, referans %zu\n", source.c_str(),
+                        written, compiled.renderedLength(values), expected.size());
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+
+    // Boş şablon
+    MessageTemplate empty{String()};
+    StringPrint out;
+    TemplateValues values;
+    CHECK(empty.render(out, values) == 0 && empty.renderedLength(values) == 0 && empty.tokenCount() == 0);
+}
+
+void benchTemplates() {
+    // ~11 KB gövde, 320 yer tutucu
+    String body;
+    for (int i = 0; i < 64; ++i) {
+        body += "Bu cihaz ({DEVICE_ID}) bekleme süresini doldurdu. Kalan: {REMAINING}. Uyarı %ALARM_INDEX%/%TOTAL_ALARMS% ";
+        body += "- zaman {TIMESTAMP}. Lütfen ekleri kontrol edip sorumlulara iletin.\r\n";
+    }
+    const String deviceId = "HOSTDEV00001", timestamp = "Mon, 19 Oct 2026 10:00:00 +0300", remaining = "2 saat";
+    const int MESSAGES = 2000;
+
+    size_t legacyBytes = 0;
+    Measure legacy = measure([&] {
+        for (int m = 0; m < MESSAGES; ++m) {
+            String text = body;
+            text.replace("{DEVICE_ID}", deviceId);
+            text.replace("{TIMESTAMP}", timestamp);
+            text.replace("{REMAINING}", remaining);
+            text.replace("%REMAINING%", remaining);
+            text.replace("%ALARM_INDEX%", String(2));
+            text.replace("%TOTAL_ALARMS%", String(3));
+            legacyBytes += text.length();
+        }
+    });
+
+    MessageTemplate compiled(body);
+    TemplateValues values;
+    values.set(TemplateVar::DEVICE_ID, deviceId.c_str());
+    values.set(TemplateVar::TIMESTAMP, timestamp.c_str());
+    values.set(TemplateVar::REMAINING, remaining.c_str());
+    values.set(TemplateVar::ALARM_INDEX, "2");
+    values.set(TemplateVar::TOTAL_ALARMS, "3");
+    CountingPrint sink;
+    Measure streamed = measure([&] {
+        for (int m = 0; m < MESSAGES; ++m) compiled.render(sink, values);
+    });
+    CHECK(sink.bytes == legacyBytes);
+    CHECK(streamed.allocations == 0);
+
+    printf("  %u bayt gövde, %u parça\n", (unsigned)body.length(), (unsigned)compiled.tokenCount());
+    printf("  %-34s %8.1f µs/mesaj %8.1f ayırma/mesaj\n", "6 x String::replace (eski)",
+           legacy.seconds * 1e6 / MESSAGES, legacy.allocations / (double)MESSAGES);
+    printf("  %-34s %8.1f µs/mesaj %8.1f ayırma/mesaj\n", "MessageTemplate::render",
+           streamed.seconds * 1e6 / MESSAGES, streamed.allocations / (double)MESSAGES);
+}
+
+void templateSection() {
+    printf("template\n");
+    checkTemplates();
+    benchTemplates();
+}
+
+// --- gzip ---------------------------------------------------------------------
+
+// Metin benzeri ekler (GzipWriter'ın hedeflediği belgeler) + sıkıştırılamaz veri
+std::string csvText(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::string text = "zaman;sensor;deger;durum\r\n";
+    char line[96];
+    for (uint32_t i = 0; text.size() < size; ++i) {
+        snprintf(line, sizeof(line), "2026-10-19 %02u:%02u:%02u;sensor-%02u;%u.%02u;%s\r\n", (i / 3600) % 24,
+                 (i / 60) % 60, i % 60, (unsigned)(rng() % 12), (unsigned)(rng() % 400), (unsigned)(rng() % 100),
+                 rng() % 10 ? "OK" : "ALARM");
+        text += line;
+    }
+    text.resize(size);
+    return text;
+}
+
+std::string instructionText(size_t size, uint32_t seed) {
+    static const char *const SENTENCES[] = {
+        "Bu mesaj, cihaz sahibinden belirli bir süre haber alınamadığı için otomatik olarak gönderildi. ",
+        "Ekteki belgeleri açmadan önce göndericinin kimliğini doğrulayın. ",
+        "Banka hesapları ve sigorta poliçeleri için ilgili kurumlarla iletişime geçin. ",
+        "Şifre yöneticisinin ana parolası ayrı bir zarfta, noterde saklanmaktadır. ",
+        "Sunucu erişim bilgileri yalnızca teknik sorumluya iletilmelidir.\r\n",
+        "Lütfen aşağıdaki adımları sırasıyla uygulayın ve her adımı kayıt altına alın.\r\n",
+    };
+    std::mt19937 rng(seed);
+    std::string text;
+    for (uint32_t step = 1; text.size() < size; ++step) {
+        text += std::to_string(step) + ". ";
+        text += SENTENCES[rng() % (sizeof(SENTENCES) / sizeof(SENTENCES[0]))];
+    }
+    text.resize(size);
+    return text;
+}
+
+// Anahtar listesi: sabit önek + rastgele base64 gövde → orta düzey kazanç
+std::string keyListText(size_t size, uint32_t seed) {
+    std::vector<uint8_t> key = randomBytes(size, seed);
+    std::string text;
+    for (size_t i = 0; text.size() < size; i += 32) {
+        std::string encoded = referenceBase64(key.data() + (i % (size - 32)), 32);
+        text += "ssh-ed25519 " + encoded.substr(0, encoded.size() - 2) + " yedek-" + std::to_string(i / 32) + "@dmf\n";
+    }
+    text.resize(size);
+    return text;
+}
+
+std::vector<uint8_t> bytesOf(const std::string &text) { return std::vector<uint8_t>(text.begin(), text.end()); }
+
+// Parçalar rastgele boyda (0 bayt dahil): yükleme parçaları gibi
+bool gzipCompress(const std::vector<uint8_t> &data, std::string &out, GzipStats &stats, uint32_t seed) {
+    StringPrint sink;
+    GzipWriter writer;
+    if (!writer.begin(sink)) return false;
+    std::mt19937 rng(seed);
+    for (size_t offset = 0; offset < data.size();) {
+        size_t len = std::min<size_t>(rng() % 3000, data.size() - offset);
+        if (!writer.write(data.data() + offset, len)) return false;
+        offset += len;
+    }
+    if (!writer.finish()) return false;
+    stats = writer.stats();
+    out.swap(sink.text);
+    return true;
+}
+
+// zlib ile aç: gzip sarmalayıcısı, CRC32 ve ISIZE zlib tarafından doğrulanır
+bool zlibInflate(const std::string &gz, std::vector<uint8_t> &out) {
+    z_stream zs{};
+    if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) return false;
+    zs.next_in = (Bytef *)gz.data();
+    zs.avail_in = (uInt)gz.size();
+    out.clear();
+    uint8_t buffer[16384];
+    int status;
+    do {
+        zs.next_out = buffer;
+        zs.avail_out = sizeof(buffer);
+        status = inflate(&zs, Z_NO_FLUSH);
+        out.insert(out.end(), buffer, buffer + (sizeof(buffer) - zs.avail_out));
+    } while (status == Z_OK);
+    bool complete = status == Z_STREAM_END && zs.avail_in == 0; // Sonda artık bayt yok
+    inflateEnd(&zs);
+    return complete;
+}
+
+// Kıyas için zlib (seviye 6, 32 KB pencere, dinamik Huffman) gzip boyutu
+size_t zlibGzipSize(const std::vector<uint8_t> &data) {
+    z_stream zs{};
+    if (deflateInit2(&zs, 6, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) return 0;
+    std::vector<uint8_t> out(deflateBound(&zs, data.size()));
+    zs.next_in = (Bytef *)data.data();
+    zs.avail_in = (uInt)data.size();
+    zs.next_out = out.data();
+    zs.avail_out = (uInt)out.size();
+    int status = deflate(&zs, Z_FINISH);
+    size_t size = status == Z_STREAM_END ? zs.total_out : 0;
+    deflateEnd(&zs);
+    return size;
+}
+
+bool roundTrips(const std::vector<uint8_t> &data, uint32_t seed) {
+    std::string gz;
+    GzipStats stats;
+    std::vector<uint8_t> restored;
+    return gzipCompress(data, gz, stats, seed) && zlibInflate(gz, restored) && restored == data &&
+           stats.inputBytes == data.size() && stats.outputBytes == gz.size();
+}
+
+void checkGzip() {
+    // Kenarlar: boş girdi, MIN_MATCH çevresi, MAX_MATCH (258) çevresi, pencere/tampon sınırları
+    const size_t SIZES[] = {0, 1, 2, 3, 4, 257, 258, 259, 517, 2047, 2048, 2049, 4095, 4096, 4097, 6145, 100000};
+    size_t failed = 0;
+    for (size_t size : SIZES) {
+        std::vector<std::vector<uint8_t>> inputs = {
+            randomBytes(size, (uint32_t)size),
+            bytesOf(csvText(size, (uint32_t)size)),
+            std::vector<uint8_t>(size, 'a'),                     // Uzun tek bayt koşusu
+        };
+        std::vector<uint8_t> period(size);                        // Tam pencere mesafesinde tekrar
+        for (size_t i = 0; i < size; ++i) period[i] = (uint8_t)((i % GzipWriter::WINDOW_SIZE) * 131 >> 3);
+        inputs.push_back(period);
+        for (size_t k = 0; k < inputs.size(); ++k) {
+            if (!roundTrips(inputs[k], (uint32_t)(size * 7 + k))) {
+                if (failed++ == 0) fprintf(stderr, "gzip %zu bayt (girdi %zu): zlib açılışı farklı\n", size, k);
+            }
+        }
+    }
+    CHECK(failed == 0);
+
+    // Tekilleştirme: aynı girdi, farklı parçalama → aynı bayt dizisi; mtime=0
+    std::vector<uint8_t> doc = bytesOf(instructionText(50000, 44));
+    std::string first, second;
+    GzipStats stats;
+    CHECK(gzipCompress(doc, first, stats, 1) && gzipCompress(doc, second, stats, 2));
+    CHECK(first == second);
+    CHECK(first.size() > 10 && first.compare(4, 4, std::string(4, '\0')) == 0);
+
+    // Yarıda bırakılan akış belleği bırakır, yeniden başlatılabilir
+    StringPrint sink;
+    GzipWriter writer;
+    CHECK(writer.begin(sink) && writer.write(doc.data(), 1000) && writer.active());
+    writer.release();
+    CHECK(!writer.active() && !writer.write(doc.data(), 1) && !writer.finish());
+    CHECK(roundTrips(doc, 3));
+
+    // Uzantı kararı
+    const char *packed[] = {"rapor.pdf", "FOTO.JPG", "arsiv.zip", "yedek.tar.gz", "tablo.xlsx"};
+    const char *plain[] = {"sensor.csv", "talimat.txt", "anahtarlar.pub", "notlar.md", "ayarlar.json"};
+    for (const char *name : packed) CHECK(!GzipWriter::worthCompressing(name));
+    for (const char *name : plain) CHECK(GzipWriter::worthCompressing(name));
+}
+
+void benchGzip() {
+    // 1 MB örnekler: oran (zlib -6 ile), MB/s, mail DATA'sında base64 bayt
+    const size_t SIZE = 1024 * 1024;
+    struct Corpus {
+        const char *name;
+        std::vector<uint8_t> data;
+    } corpora[] = {
+        {"CSV ölçüm kaydı", bytesOf(csvText(SIZE, 441))},
+        {"talimat metni", bytesOf(instructionText(SIZE, 442))},
+        {"anahtar listesi", bytesOf(keyListText(SIZE, 443))},
+        {"rastgele (sıkıştırılmış)", randomBytes(SIZE, 444)},
+    };
+
+    printf("  %6s %8s %9s %10s %10s %10s\n", "oran", "zlib -6", "MB/s", "ayırma/MB", "DATA ham", "DATA gzip");
+    for (Corpus &corpus : corpora) {
+        std::string gz;
+        GzipStats stats;
+        std::vector<uint8_t> restored;
+        CHECK(gzipCompress(corpus.data, gz, stats, 9) && zlibInflate(gz, restored) && restored == corpus.data);
+
+        // Ölçüm SMTP akışı gibi saklamayan hedefe: ayırma yalnızca sıkıştırıcıdan gelir
+        CountingPrint sink;
+        GzipWriter writer;
+        Measure m = measure([&] {
+            writer.begin(sink);
+            for (size_t offset = 0; offset < SIZE; offset += 1460) {
+                writer.write(corpus.data.data() + offset, std::min<size_t>(1460, SIZE - offset));
+            }
+            writer.finish();
+        });
+        CHECK(sink.bytes == gz.size() && m.allocations == 0);
+
+        double mb = SIZE / (1024.0 * 1024.0);
+        printf("  %5u%% %7u%% %9.1f %10.1f %10zu %10zu  %s\n", (unsigned)stats.ratioPercent(),
+               (unsigned)(zlibGzipSize(corpus.data) * 100 / SIZE), mb / m.seconds, m.allocations / mb,
+               Base64Stream::encodedSize(SIZE), Base64Stream::encodedSize(gz.size()), corpus.name);
+    }
+    // Rastgele veride kayıp sınırlı: sabit Huffman'da literal 8-9 bit
+    std::string gz;
+    GzipStats stats;
+    CHECK(gzipCompress(corpora[3].data, gz, stats, 9) && gz.size() < SIZE * 115 / 100);
+    CHECK(gzipCompress(corpora[0].data, gz, stats, 9) && stats.ratioPercent() <= 55);
+}
+
+void gzipSection() {
+    printf("gzip\n");
+    checkGzip();
+    benchGzip();
+}
+
+}
+
+int main() {
+    base64Section();
+    journalSection();
+    templateSection();
+    gzipSection();
+    return finish("codec_bench");
+}
@@ -0,0 +1,200 @@
+// ============================================================================
+// Final protokolü: eşzamanlı oturum ölçümü + bağlantısız başlangıç
+// ============================================================================
+// smtp_sink.py her bağlantıyı ayrı iş parçacığında karşılar; CONNECT ve DOT
+// gecikmeleri TLS el sıkışmasını ve sunucu yanıt süresini taklit eder.
+//   - runBenchmark(final): parallelSessions 1 / 2 / 3 için duvar süresi ve
+//     aşama dökümü; paralel dağıtım sıralıdan belirgin kısa olmalı
+//   - runFinalDispatch bağlantı yokken çalışan görev/oturum açmaz, beklemez: gruplar
+//     gönderilmedi kalır, final kuyruğa girer, bağlantı gelince kuyruk teslim eder
+//   - final yarıda kalır, grup web arayüzündeki gibi kaydedilir (aynı liste yeni
+//     ID ile yeniden yüklenir, konu değişir): kuyruk yalnızca kalanlara gönderir
+
+#include "host_test.h"
+#include "delivery_ledger.h"
+#include "mail_functions.h"
+#include "recipient_store.h"
+
+#include <chrono>
+
+using namespace host_test;
+
+namespace {
+
+const IPAddress SINK_LAN_ADDRESS(192, 168, 11, 26);
+const uint8_t GROUP_COUNT = 6;
+const uint16_t GROUP_SIZE = 5;
+
+uint16_t makeList(uint8_t group) {
+    RecipientWriter writer;
+    String error;
+    if (!writer.begin(error)) return 0;
+    for (uint16_t i = 0; i < GROUP_SIZE; ++i) {
+        String address = "f" + String(group) + "-" + String(i) + "@host.test";
+        if (!writer.add(address.c_str(), error)) return 0;
+    }
+    return writer.commit(error) ? writer.listId() : 0;
+}
+
+MailSettings finalSettings(uint16_t port) {
+    MailSettings settings;
+    settings.smtpServer = SINK_LAN_ADDRESS.toString();
+    settings.smtpPort = port;
+    settings.smtpTls = false;
+    settings.username = "dmf@host.test";
+    settings.password = "host-secret";
+    settings.ratePerMinute = 0;
+    settings.mailGroupCount = GROUP_COUNT;
+    for (uint8_t g = 0; g < GROUP_COUNT; ++g) {
+        MailGroup &group = settings.mailGroups[g];
+        group.name = "Grup" + String(g + 1);
+        group.enabled = true;
+        group.subject = "Final " + String(g + 1);
+        group.body = "Cihaz {DEVICE_ID}";
+        group.recipientListId = makeList(g);
+        group.recipientCount = GROUP_SIZE;
+    }
+    return settings;
+}
+
+// POST /api/mail/recipients gövdesi: her grup kaydında metin yeni listeye yazılır
+uint16_t uploadList(const std::string &text) {
+    RecipientUpload upload;
+    String error;
+    if (!upload.begin(error) || !upload.write(reinterpret_cast<const uint8_t *>(text.data()), text.size(), error) ||
+        !upload.finish(error)) {
+        return 0;
+    }
+    return upload.listId();
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main() {
+    freshFilesystem("final");
+    HostNet::alias(SINK_LAN_ADDRESS);
+    std::string saveDir = makeTempDir("final-eml");
+
+    Server sink("smtp_sink.py", {"--host", "127.0.0.1", "--port", "0", "--save-dir", saveDir,
+                                 "--rule", "CONNECT:delay=150", "--rule", "DOT:delay=30"});
+    CHECK(sink.ok());
+    if (!sink.ok()) return finish("final_dispatch_test");
+
+    DMFNetworkManager net;
+    CHECK(bringOnline(net));
+
+    MailAgent agent;
+    agent.begin(nullptr, &net, "HOSTDEV00035");
+    MailSettings settings = finalSettings(sink.port());
+    for (uint8_t g = 0; g < GROUP_COUNT; ++g) CHECK(settings.mailGroups[g].recipientListId != 0);
+    const size_t PER_ROUND = GROUP_COUNT * GROUP_SIZE;
+
+    // --- 1. eşzamanlı oturum ölçümü (CONNECT 150 ms, mesaj sonu 30 ms) ---
+    printf("final %u grup x %u alıcı\n", (unsigned)GROUP_COUNT, (unsigned)GROUP_SIZE);
+    double wall[MAX_PARALLEL_SMTP_SESSIONS + 1] = {};
+    for (uint8_t sessions = 1; sessions <= MAX_PARALLEL_SMTP_SESSIONS; ++sessions) {
+        settings.parallelSessions = sessions;
+        agent.updateConfig(settings);
+        size_t before = listFiles(saveDir).size();
+        String report;
+        auto start = std::chrono::steady_clock::now();
+        CHECK(agent.runBenchmark(true, 2, report));
+        wall[sessions] = elapsedMs(start) / 2;
+        CHECK(listFiles(saveDir).size() == before + 2 * PER_ROUND);
+        printf("  %u oturum: %7.1f ms/tur | %s\n", (unsigned)sessions, wall[sessions], report.c_str());
+    }
+    CHECK(wall[2] < wall[1] * 0.8);
+    CHECK(wall[3] < wall[2]);
+
+    // --- 2. bağlantı yok: beklemeden döner, gruplar kuyrukta ---
+    HostWiFi::removeNetwork("DMF-HostLAN");
+    HostWiFi::dropLink(WIFI_REASON_BEACON_TIMEOUT);
+    for (int i = 0; i < 20; ++i) net.loop();
+    CHECK(!net.isOnline());
+
+    settings.parallelSessions = 2;
+    agent.updateConfig(settings);
+    size_t before = listFiles(saveDir).size();
+    ScheduleSnapshot snapshot;
+    snapshot.timerActive = true;
+    snapshot.totalAlarms = 3;
+    TimerRuntime runtime;
+    String error;
+    uint32_t tasksBefore = HostTasks::created();
+    auto start = std::chrono::steady_clock::now();
+    CHECK(!agent.sendFinal(snapshot, runtime, error));
+    double offlineMs = elapsedMs(start);
+    CHECK(HostTasks::created() == tasksBefore); // FinalSMTP çalışanı başlatılmadı
+    printf("  bağlantısız final: %.1f ms, \"%s\"\n", offlineMs, error.c_str());
+    CHECK(offlineMs < 100); // Bağlantı denemesi / oturum zaman aşımı beklenmedi
+    CHECK(error.indexOf("İnternet bağlantısı yok") >= 0);
+    for (uint8_t g = 0; g < GROUP_COUNT; ++g) CHECK(!runtime.finalGroupsSent[g]);
+    CHECK(agent.getQueueSize() == 1);
+    CHECK(listFiles(saveDir).size() == before);
+
+    // --- 3. bağlantı gelir → kuyruk tüm grupları bir kez teslim eder ---
+    HostWiFi::addNetwork("DMF-HostLAN", -48, false, "host-pass");
+    net.requestConnect();
+    CHECK(waitFor([&] {
+        net.loop();
+        return net.isOnline();
+    }, 5000));
+    HostClock::advance(11 * 60 * 1000UL); // NETWORK geri çekilmesi en çok 10 dk
+    CHECK(waitFor([&] {
+        agent.processQueue();
+        return agent.getQueueSize() == 0;
+    }, 20000));
+    CHECK(listFiles(saveDir).size() == before + PER_ROUND);
+
+    // --- 4. yarıda kalan final + grup kaydı: teslim edilenlere ikinci mail yok ---
+    const uint16_t RESUME_SIZE = 6;
+    std::string resumeDir = makeTempDir("final-resume");
+    Server flaky("smtp_sink.py", {"--host", "127.0.0.1", "--port", "0", "--save-dir", resumeDir,
+                                  "--rule", "RCPT:reply=451@4"});
+    CHECK(flaky.ok());
+    std::string listText;
+    for (uint16_t i = 0; i < RESUME_SIZE; ++i) listText += "r" + std::to_string(i) + "@host.test\n";
+
+    DeliveryLedger::clearAll(); // Yeni final döngüsü
+    MailSettings resume = finalSettings(flaky.port());
+    resume.mailGroupCount = 1;
+    resume.mailGroups[0].recipientListId = uploadList(listText);
+    resume.mailGroups[0].recipientCount = RESUME_SIZE;
+    agent.updateConfig(resume);
+    TimerRuntime resumeRuntime;
+    CHECK(!agent.sendFinal(snapshot, resumeRuntime, error)); // 4. alıcı 451
+    CHECK(!resumeRuntime.finalGroupsSent[0]);
+    CHECK(listFiles(resumeDir).size() == 3);
+    CHECK(agent.getQueueSize() == 1);
+
+    // Web arayüzü: grup kaydı listeyi yeniden yükler (yeni ID), eski liste silinir
+    uint16_t oldListId = resume.mailGroups[0].recipientListId;
+    resume.mailGroups[0].recipientListId = uploadList(listText);
+    resume.mailGroups[0].subject = "Final (düzenlendi)";
+    CHECK(resume.mailGroups[0].recipientListId != oldListId);
+    RecipientStore::prune(&resume.mailGroups[0].recipientListId, 1);
+    agent.updateConfig(resume);
+
+    HostClock::advance(11 * 60 * 1000UL);
+    CHECK(waitFor([&] {
+        agent.processQueue();
+        return agent.getQueueSize() == 0;
+    }, 20000));
+    auto resumed = listFiles(resumeDir);
+    CHECK(resumed.size() == RESUME_SIZE);
+    for (uint16_t i = 0; i < RESUME_SIZE; ++i) {
+        std::string header = "To: r" + std::to_string(i) + "@host.test\r\n";
+        size_t copies = 0;
+        for (const std::string &file : resumed) {
+            if (readHostFile(resumeDir + "/" + file).find(header) != std::string::npos) copies++;
+        }
+        CHECK(copies == 1);
+    }
+    printf("  yarıda kalan final: 3 + %zu mail (grup kaydından sonra)\n", resumed.size() - 3);
+
+    return finish("final_dispatch_test");
+}
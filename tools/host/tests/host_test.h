@@ -0,0 +1,187 @@
+#pragma once
+
+// ============================================================================
+// Host testleri için ortak yardımcılar
+// ============================================================================
+// CHECK: başarısızlığı yazar ve sayar (test sonuna kadar devam eder)
+// Sunucu: tools/ altındaki Python test sunucusunu başlatır, ilk satırdan portu okur
+// bringOnline: sanal WiFi'de gerçek DMFNetworkManager'ı ONLINE'a sürer
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include "network_manager.h"
+
+#include <csignal>
+#include <dirent.h>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace host_test {
+
+inline int &failures() {
+    static int count = 0;
+    return count;
+}
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            fprintf(stderr, "%s:%d: CHECK başarısız: %s\n", __FILE__, __LINE__, #cond); \
+            host_test::failures()++;                                                 \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_RANGE(value, low, high)                                                                  \
+    do {                                                                                               \
+        double v_ = (double)(value);                                                                   \
+        if (v_ < (double)(low) || v_ > (double)(high)) {                                               \
+            fprintf(stderr, "%s:%d: CHECK_RANGE başarısız: %s = %.0f, beklenen [%.0f, %.0f]\n", __FILE__, \
+                    __LINE__, #value, v_, (double)(low), (double)(high));                              \
+            host_test::failures()++;                                                                   \
+        }                                                                                              \
+    } while (0)
+
+inline int finish(const char *name) {
+    if (failures() == 0) {
+        printf("%s: TAMAM\n", name);
+        return 0;
+    }
+    printf("%s: %d hata\n", name, failures());
+    return 1;
+}
+
+inline std::string makeTempDir(const char *tag) {
+    std::string pattern = std::string("/tmp/dmf-") + tag + "-XXXXXX";
+    std::vector<char> buffer(pattern.begin(), pattern.end());
+    buffer.push_back('\0');
+    const char *dir = mkdtemp(buffer.data());
+    return dir ? dir : "/tmp";
+}
+
+// Yerel LittleFS kökü + biçimlendirme
+inline void freshFilesystem(const char *tag) {
+    HostFS::setRoot(makeTempDir(tag));
+    LittleFS.begin(true);
+}
+
+// Python test sunucusu: "... <host>:<port> ..." satırını basana kadar beklenir
+class Server {
+public:
+    Server(const std::string &script, const std::vector<std::string> &args) { start(script, args); }
+    ~Server() { stop(); }
+
+    uint16_t port() const { return port_; }
+    bool ok() const { return port_ != 0; }
+
+    void stop() {
+        if (pid_ > 0) {
+            kill(pid_, SIGTERM);
+            waitpid(pid_, nullptr, 0);
+            pid_ = -1;
+        }
+        if (out_) {
+            fclose(out_);
+            out_ = nullptr;
+        }
+    }
+
+private:
+    pid_t pid_ = -1;
+    FILE *out_ = nullptr;
+    uint16_t port_ = 0;
+
+    void start(const std::string &script, const std::vector<std::string> &args) {
+        int pipes[2];
+        if (pipe(pipes) != 0) return;
+        pid_ = fork();
+        if (pid_ == 0) {
+            dup2(pipes[1], STDOUT_FILENO);
+            close(pipes[0]);
+            close(pipes[1]);
+            std::string path = std::string(DMF_TOOLS_DIR) + "/" + script;
+            std::vector<std::string> all = {DMF_PYTHON, "-u", path};
+            all.insert(all.end(), args.begin(), args.end());
+            std::vector<char *> argv;
+            for (auto &a : all) argv.push_back(const_cast<char *>(a.c_str()));
+            argv.push_back(nullptr);
+            execv(DMF_PYTHON, argv.data());
+            _exit(127);
+        }
+        close(pipes[1]);
+        out_ = fdopen(pipes[0], "r");
+        char line[256];
+        if (out_ && fgets(line, sizeof(line), out_)) {
+            // "dmf-sink 127.0.0.1:40123 dinliyor ..." → port
+            const char *colon = strchr(line, ':');
+            if (colon) port_ = (uint16_t)atoi(colon + 1);
+        }
+        if (port_ == 0) fprintf(stderr, "Sunucu başlatılamadı: %s\n", script.c_str());
+        // Sunucunun sonraki çıktısı boru tamponunu doldurmasın
+        if (out_) {
+            std::thread([file = out_] {
+                char sink[256];
+                while (fgets(sink, sizeof(sink), file)) {
+                    if (getenv("DMF_HOST_LOG")) fputs(sink, stdout);
+                }
+            }).detach();
+            out_ = nullptr;
+        }
+    }
+};
+
+// Klasördeki dosyalar (sıralı)
+inline std::vector<std::string> listFiles(const std::string &dir) {
+    std::vector<std::string> names;
+    DIR *d = opendir(dir.c_str());
+    if (!d) return names;
+    while (dirent *entry = readdir(d)) {
+        if (entry->d_name[0] != '.') names.push_back(entry->d_name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+inline std::string readHostFile(const std::string &path) {
+    std::string text;
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return text;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) text.append(buffer, n);
+    fclose(f);
+    return text;
+}
+
+// Sanal AP "DMF-HostLAN" görünür; ağ yöneticisi ONLINE olana kadar sürülür
+inline bool bringOnline(DMFNetworkManager &net) {
+    net.begin(nullptr);
+    HostWiFi::addNetwork("DMF-HostLAN", -48, false, "host-pass");
+    WiFiSettings wifi;
+    wifi.primarySSID = "DMF-HostLAN";
+    wifi.primaryPassword = "host-pass";
+    wifi.allowOpenNetworks = false;
+    net.setConfig(wifi);
+    net.requestConnect();
+    for (int i = 0; i < 200 && !net.isOnline(); ++i) {
+        net.loop();
+        delay(1);
+    }
+    return net.isOnline();
+}
+
+// Bekle: koşul ya da gerçek süre sınırı (ms)
+inline bool waitFor(const std::function<bool()> &ready, uint32_t limitMs) {
+    uint32_t start = millis();
+    while (!ready()) {
+        if (millis() - start > limitMs) return false;
+        delay(2);
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,277 @@
+// ============================================================================
+// Posta yolu uçtan uca: sendWarning / sendFinal / processQueue → smtp_sink.py
+// ============================================================================
+// Firmware kaynakları shim üzerinden gerçek soketlerle yerel sunucuya konuşur.
+// Sunucu 127.0.0.1'de dinler; cihaz ayarı yerel ağ adresi (192.168.11.25)
+// kalır ve HostNet ile loopback'e yönlenir - düz metin izni değişmeden sınanır.
+// Gelen .eml dosyalarında alıcı, konu ve base64 ekin baytları doğrulanır.
+//
+// 300 KB ek: uyarı maili uçtan uca, ardından aynı dosya SmtpSession üzerinden
+// üç akış yoluyla (sidecar / çift tamponlu okuyucu / sıralı yedek yol) sunucuya
+// gönderilir - süre, KB/s ve çözülen baytlar.
+
+#include "host_test.h"
+#include "attachment_cache.h"
+#include "attachment_pipeline.h"
+#include "attachment_store.h"
+#include "mail_functions.h"
+#include "recipient_store.h"
+
+#include <chrono>
+
+using namespace host_test;
+
+namespace {
+
+const IPAddress SINK_LAN_ADDRESS(192, 168, 11, 25);
+
+std::string decodeBase64(const std::string &text) {
+    std::string out;
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : text) {
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '+') value = 62;
+        else if (c == '/') value = 63;
+        else continue; // CRLF, '='
+        buffer = (buffer << 6) | (uint32_t)value;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out += (char)((buffer >> bits) & 0xFF);
+        }
+    }
+    return out;
+}
+
+// .eml içindeki ilk ekin çözülmüş baytları (yoksa boş)
+std::string attachmentBytes(const std::string &mail) {
+    size_t header = mail.find("Content-Disposition: attachment");
+    if (header == std::string::npos) return std::string();
+    size_t start = mail.find("\r\n\r\n", header);
+    size_t end = mail.find("\r\n--", start);
+    if (start == std::string::npos || end == std::string::npos) return std::string();
+    return decodeBase64(mail.substr(start + 4, end - start - 4));
+}
+
+uint16_t makeList(const char *prefix, uint16_t count) {
+    RecipientWriter writer;
+    String error;
+    if (!writer.begin(error)) return 0;
+    for (uint16_t i = 0; i < count; ++i) {
+        String address = String(prefix) + String(i) + "@host.test";
+        if (!writer.add(address.c_str(), error)) return 0;
+    }
+    return writer.commit(error) ? writer.listId() : 0;
+}
+
+String storeAttachment(const std::string &bytes) {
+    AttachmentUpload upload;
+    String blob, error;
+    bool deduplicated = false;
+    if (!upload.begin("/attachments") || !upload.write((const uint8_t *)bytes.data(), bytes.size()) ||
+        !upload.finish(blob, deduplicated, error)) {
+        return String();
+    }
+    return AttachmentStore::makeRef(blob, "rapor.bin");
+}
+
+MailSettings baseSettings(uint16_t port) {
+    MailSettings settings;
+    settings.smtpServer = SINK_LAN_ADDRESS.toString();
+    settings.smtpPort = port;
+    settings.smtpTls = false;
+    settings.username = "dmf@host.test";
+    settings.password = "host-secret";
+    settings.parallelSessions = 2;
+    settings.ratePerMinute = 0;
+    settings.recipients[0] = "owner@host.test";
+    settings.recipientCount = 1;
+    settings.warning.subject = "Uyari %ALARM_INDEX%/%TOTAL_ALARMS%";
+    settings.warning.body = "Cihaz {DEVICE_ID} - kalan {REMAINING}";
+    return settings;
+}
+
+size_t countMails(const std::string &dir) { return listFiles(dir).size(); }
+
+std::string newestMail(const std::string &dir) {
+    auto files = listFiles(dir);
+    return files.empty() ? std::string() : readHostFile(dir + "/" + files.back());
+}
+
+// Ek akışı tek mesajda: writeMimeMessage'ın ek bölümüyle aynı başlıklar
+AttachmentStreamStats streamToSink(const MailSettings &settings, const String &blobPath, size_t size, bool sidecar,
+                                   bool &sent) {
+    AttachmentStreamStats stats;
+    SmtpSession session(settings);
+    String error;
+    sent = session.beginEnvelope(error, Base64Stream::encodedSize(size) + 512) &&
+           session.addRecipient("akis@host.test", error) && session.beginData(error);
+    if (!sent) return stats;
+    Print &out = session.stream();
+    out.print("Subject: 300 KB ek\r\nMIME-Version: 1.0\r\n");
+    out.print("Content-Type: multipart/mixed; boundary=\"B\"\r\n\r\n--B\r\n");
+    out.print("Content-Type: application/octet-stream\r\nContent-Transfer-Encoding: base64\r\n");
+    out.print("Content-Disposition: attachment; filename=\"rapor.bin\"\r\n\r\n");
+    File file = sidecar ? AttachmentCache::open(blobPath, size) : LittleFS.open(blobPath, "r");
+    if (file) {
+        stats = AttachmentPipeline::stream(file, out, sidecar);
+        file.close();
+    }
+    out.print("--B--\r\n");
+    sent = session.endData(error);
+    return stats;
+}
+
+}
+
+int main() {
+    freshFilesystem("mail");
+    HostNet::alias(SINK_LAN_ADDRESS);
+    std::string saveDir = makeTempDir("mail-eml");
+
+    Server sink("smtp_sink.py", {"--host", "127.0.0.1", "--port", "0", "--save-dir", saveDir});
+    CHECK(sink.ok());
+    if (!sink.ok()) return finish("mail_flow_test");
+
+    DMFNetworkManager net;
+    CHECK(bringOnline(net));
+
+    MailAgent agent;
+    agent.begin(nullptr, &net, "HOSTDEV00001");
+
+    // Ek: 5000 bayt (satır sınırı ve dolgu kenarları), tüm gruplarda aynı blob
+    std::string payload;
+    for (int i = 0; i < 5000; ++i) payload += (char)((i * 37 + 11) & 0xFF);
+    String attachmentRef = storeAttachment(payload);
+    CHECK(attachmentRef.length() > 0);
+
+    MailSettings settings = baseSettings(sink.port());
+    const uint16_t GROUP_SIZE = 4;
+    settings.mailGroupCount = 3;
+    for (uint8_t g = 0; g < settings.mailGroupCount; ++g) {
+        MailGroup &group = settings.mailGroups[g];
+        group.name = "Grup" + String(g + 1);
+        group.enabled = true;
+        group.subject = "Final grup " + String(g + 1);
+        group.body = "Grup govdesi {DEVICE_ID}";
+        group.recipientListId = makeList(("g" + String(g + 1) + "-").c_str(), GROUP_SIZE);
+        group.recipientCount = GROUP_SIZE;
+        group.attachments[0] = attachmentRef;
+        group.attachmentCount = 1;
+        CHECK(group.recipientListId != 0);
+    }
+    agent.updateConfig(settings);
+
+    ScheduleSnapshot snapshot;
+    snapshot.timerActive = true;
+    snapshot.totalAlarms = 3;
+    snapshot.remainingSeconds = 3600;
+
+    // --- 1. sendWarning: tek mail, gönderen adresine ---
+    String error;
+    CHECK(agent.sendWarning(0, snapshot, error));
+    auto files = listFiles(saveDir);
+    CHECK(files.size() == 1);
+    if (files.size() == 1) {
+        std::string mail = readHostFile(saveDir + "/" + files[0]);
+        CHECK(mail.find("To: dmf@host.test") != std::string::npos);
+        CHECK(mail.find("Subject: Uyari 1/3") != std::string::npos);
+        CHECK(mail.find("Cihaz HOSTDEV00001") != std::string::npos);
+    }
+
+    // --- 2. sendFinal: 3 grup x 4 alıcı, 2 paralel oturum, ortak ek ---
+    TimerRuntime runtime;
+    uint32_t finalStart = millis();
+    CHECK(agent.sendFinal(snapshot, runtime, error));
+    uint32_t finalMs = millis() - finalStart;
+    for (uint8_t g = 0; g < settings.mailGroupCount; ++g) CHECK(runtime.finalGroupsSent[g]);
+    files = listFiles(saveDir);
+    CHECK(files.size() == 1 + (size_t)settings.mailGroupCount * GROUP_SIZE);
+    int withAttachment = 0;
+    int privateTo = 0;
+    for (size_t i = 1; i < files.size(); ++i) {
+        std::string mail = readHostFile(saveDir + "/" + files[i]);
+        if (attachmentBytes(mail) == payload) withAttachment++;
+        // Gizlilik: her mailde yalnızca kendi alıcısı
+        size_t to = mail.find("To: g");
+        if (to != std::string::npos && mail.find(",", to) > mail.find("\r\n", to)) privateTo++;
+    }
+    CHECK(withAttachment == settings.mailGroupCount * GROUP_SIZE);
+    CHECK(privateTo == settings.mailGroupCount * GROUP_SIZE);
+    printf("sendFinal: %u mail, %lu ms\n", (unsigned)(files.size() - 1), (unsigned long)finalMs);
+
+    // --- 3. processQueue: sunucuya ulaşılamıyor → kuyruk, düzelince teslim ---
+    size_t before = countMails(saveDir);
+    MailSettings broken = baseSettings(1); // Kapalı port: bağlantı reddi (NETWORK)
+    agent.updateConfig(broken);
+    CHECK(!agent.sendWarning(1, snapshot, error));
+    CHECK(agent.getQueueSize() == 1);
+
+    agent.processQueue(); // Hemen denenir, yine başarısız → NETWORK geri çekilmesi
+    CHECK(agent.getQueueSize() == 1);
+    CHECK(countMails(saveDir) == before);
+
+    agent.updateConfig(settings);
+    HostClock::advance(11 * 60 * 1000UL); // NETWORK geri çekilmesi en çok 10 dk
+    CHECK(waitFor([&] {
+        agent.processQueue();
+        return agent.getQueueSize() == 0;
+    }, 10000));
+    CHECK(countMails(saveDir) == before + 1);
+    QueueDrainStats stats = agent.queueStats();
+    CHECK(stats.lastDrainMails == 1);
+    CHECK(stats.avgDeliveryMs >= 11 * 60 * 1000UL);
+
+    // Kuyruk günlüğü boşalmış olmalı: yeniden yükleme mail getirmez
+    MailAgent reloaded;
+    reloaded.begin(nullptr, &net, "HOSTDEV00001");
+    CHECK(reloaded.getQueueSize() == 0);
+
+    // --- 4. 300 KB ek: uyarı maili uçtan uca ---
+    std::string large;
+    for (size_t i = 0; i < 300 * 1024; ++i) large += (char)((i * 131 + (i >> 9)) & 0xFF);
+    String largeRef = storeAttachment(large);
+    String blobPath = AttachmentStore::resolve(largeRef);
+    CHECK(largeRef.length() > 0);
+    AttachmentMeta &meta = settings.attachments[0];
+    strlcpy(meta.displayName, "rapor.bin", sizeof(meta.displayName));
+    strlcpy(meta.storedPath, blobPath.c_str(), sizeof(meta.storedPath));
+    meta.forWarning = true;
+    meta.forFinal = false;
+    settings.attachmentCount = 1;
+    agent.updateConfig(settings);
+
+    before = countMails(saveDir);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(agent.sendWarning(2, snapshot, error));
+    double warningMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CHECK(countMails(saveDir) == before + 1);
+    CHECK(attachmentBytes(newestMail(saveDir)) == large);
+    printf("300 KB ek: uyarı maili %.1f ms (sidecar üretimi dahil)\n", warningMs);
+
+    // Akış yolları: sidecar (kodlama yok) / çift tampon / görev kurulamadı → sıralı
+    CHECK(AttachmentCache::prepare(blobPath, error));
+    struct {
+        const char *name;
+        bool sidecar;
+        bool failTask;
+    } paths[] = {{"sidecar", true, false}, {"çift tampon", false, false}, {"sıralı", false, true}};
+    for (const auto &path : paths) {
+        HostTasks::failCreates(path.failTask ? 1 : 0);
+        bool sent = false;
+        AttachmentStreamStats stats = streamToSink(settings, blobPath, large.size(), path.sidecar, sent);
+        HostTasks::failCreates(0);
+        CHECK(sent && stats.ok);
+        CHECK(stats.preEncoded == path.sidecar);
+        CHECK(stats.pipelined == !path.failTask);
+        CHECK(attachmentBytes(newestMail(saveDir)) == large);
+        printf("  %-12s %7u bayt %4lu ms %6lu KB/s (flash bekleme %lu ms)\n", path.name, (unsigned)stats.bytes,
+               (unsigned long)stats.elapsedMs, (unsigned long)stats.kbPerSecond(), (unsigned long)stats.readWaitMs);
+    }
+
+    return finish("mail_flow_test");
+}
@@ -0,0 +1,166 @@
+// ============================================================================
+// Alıcı listesi yüklemesi: RecipientUpload (POST /api/mail/recipients gövdesi)
+// ============================================================================
+// Web sunucusu host'ta yok; uç noktanın yaptığı iş aynen sürülür: metin
+// HTTP_UPLOAD_BUFLEN (1436) baytlık parçalarla RecipientUpload'a verilir.
+// Sınanan:
+//   - parça sınırında bölünen satır / CRLF, boş satır, sonda satır sonu yok
+//   - 1000 sınırı, geçersiz ve aşırı uzun adres → hata, yarım dosya kalmaz
+//   - RecipientCursor ile geri okunan adresler girdiyle aynı sırada
+// Ölçüm: 10 / 100 / 1000 alıcıda yükleme sırasındaki en yüksek heap artışı
+// (glibc mallinfo2) sabit kalmalı; eski /api/mail yolu gövdenin tamamını
+// (JSON dizisi) RAM'de tutuyordu - karşılaştırma için o gövdenin boyutu.
+
+#include "host_test.h"
+#include "recipient_store.h"
+
+#include <chrono>
+#include <malloc.h>
+#include <random>
+
+using namespace host_test;
+
+namespace {
+
+const size_t HTTP_UPLOAD_BUFLEN = 1436; // Arduino-ESP32 WebServer parça boyu
+
+std::vector<std::string> makeAddresses(size_t count, const char *prefix) {
+    std::vector<std::string> list;
+    for (size_t i = 0; i < count; ++i) {
+        list.push_back(std::string(prefix) + ".kisi-" + std::to_string(i) + "@ornek-alan-" + std::to_string(i % 17) +
+                       ".com.tr");
+    }
+    return list;
+}
+
+// Tarayıcı metin kutusu: CRLF, arada boş satırlar ve boşluklar, son satır sonu yok
+std::string asUploadText(const std::vector<std::string> &list) {
+    std::string text;
+    for (size_t i = 0; i < list.size(); ++i) {
+        if (i % 50 == 7) text += "\r\n  \r\n";
+        text += (i % 3 == 0 ? "  " : "") + list[i];
+        if (i + 1 < list.size()) text += "\r\n";
+    }
+    return text;
+}
+
+std::vector<std::string> readBack(uint16_t listId) {
+    std::vector<std::string> list;
+    RecipientCursor cursor;
+    if (!cursor.open(listId)) return list;
+    char address[MAX_EMAIL_ADDRESS_LEN + 1];
+    while (cursor.next(address, sizeof(address))) list.push_back(address);
+    return list;
+}
+
+// Parça boyu 0 ise rastgele (1..HTTP_UPLOAD_BUFLEN)
+bool upload(const std::string &text, size_t chunk, uint16_t &listId, String &error, uint32_t seed = 1) {
+    RecipientUpload up;
+    if (!up.begin(error)) return false;
+    std::mt19937 rng(seed);
+    for (size_t offset = 0; offset < text.size();) {
+        size_t len = std::min(chunk ? chunk : 1 + rng() % HTTP_UPLOAD_BUFLEN, text.size() - offset);
+        if (!up.write(reinterpret_cast<const uint8_t *>(text.data()) + offset, len, error)) return false;
+        offset += len;
+    }
+    if (!up.finish(error)) return false;
+    listId = up.listId();
+    return true;
+}
+
+// Yarım kalan yüklemeler /recipients'ta dosya bırakmamalı
+size_t leftoverFiles() { return listFiles(HostFS::hostPath(RECIPIENT_DIR)).size(); }
+
+void checkUploads() {
+    std::vector<std::string> list = makeAddresses(MAX_RECIPIENT_LIST_SIZE, "a");
+    std::string text = asUploadText(list);
+
+    const size_t CHUNKS[] = {HTTP_UPLOAD_BUFLEN, 1, 2, 0};
+    for (size_t chunk : CHUNKS) {
+        uint16_t listId = 0;
+        String error;
+        CHECK(upload(text, chunk, listId, error, (uint32_t)chunk + 27));
+        CHECK(RecipientStore::count(listId) == MAX_RECIPIENT_LIST_SIZE);
+        CHECK(readBack(listId) == list);
+    }
+    RecipientStore::prune(nullptr, 0);
+    CHECK(leftoverFiles() == 0);
+
+    // Sonda LF: son satır boş sayılır
+    uint16_t listId = 0;
+    String error;
+    CHECK(upload("tek@alan.test\n", HTTP_UPLOAD_BUFLEN, listId, error));
+    CHECK(readBack(listId) == std::vector<std::string>{"tek@alan.test"});
+    RecipientStore::prune(nullptr, 0);
+
+    // Hatalar: yükleme iptal edilir, geçici dosya kalmaz
+    std::vector<std::string> over = makeAddresses(MAX_RECIPIENT_LIST_SIZE + 1, "b");
+    CHECK(!upload(asUploadText(over), HTTP_UPLOAD_BUFLEN, listId, error));
+    CHECK(error.indexOf("limit") >= 0);
+    CHECK(leftoverFiles() == 0);
+
+    std::vector<std::string> invalid = makeAddresses(600, "c");
+    invalid[500] = "bozuk-adres.ornek.com";
+    error = "";
+    CHECK(!upload(asUploadText(invalid), HTTP_UPLOAD_BUFLEN, listId, error));
+    CHECK(error.indexOf("bozuk-adres.ornek.com") >= 0);
+    CHECK(leftoverFiles() == 0);
+
+    std::vector<std::string> longLine = makeAddresses(10, "d");
+    longLine[4] = std::string(300, 'x') + "@uzun.test";
+    error = "";
+    CHECK(!upload(asUploadText(longLine), HTTP_UPLOAD_BUFLEN, listId, error));
+    CHECK(error.indexOf("uzun") >= 0);
+    CHECK(leftoverFiles() == 0);
+
+    // begin() olmadan yazma reddedilir
+    RecipientUpload idle;
+    CHECK(!idle.active() && !idle.write(reinterpret_cast<const uint8_t *>("x"), 1, error) && !idle.finish(error));
+}
+
+size_t heapInUse() { return mallinfo2().uordblks; }
+
+void benchUploads() {
+    printf("  %8s %14s %14s %10s\n", "alıcı", "heap tepe", "eski gövde", "süre");
+    size_t peaks[3] = {0, 0, 0};
+    const size_t COUNTS[3] = {10, 100, MAX_RECIPIENT_LIST_SIZE};
+    for (size_t k = 0; k < 3; ++k) {
+        std::vector<std::string> list = makeAddresses(COUNTS[k], "e");
+        std::string text = asUploadText(list);
+
+        // Eski yol: grup JSON'u ["...", "..."] tek gövde olarak server->arg("plain")
+        size_t legacyBody = 64;
+        for (const std::string &address : list) legacyBody += address.size() + 3;
+
+        String error;
+        size_t baseline = heapInUse();
+        size_t peak = 0;
+        auto start = std::chrono::steady_clock::now();
+        RecipientUpload up;
+        bool ok = up.begin(error);
+        for (size_t offset = 0; ok && offset < text.size(); offset += HTTP_UPLOAD_BUFLEN) {
+            size_t len = std::min(HTTP_UPLOAD_BUFLEN, text.size() - offset);
+            ok = up.write(reinterpret_cast<const uint8_t *>(text.data()) + offset, len, error);
+            peak = std::max(peak, heapInUse() - std::min(baseline, heapInUse()));
+        }
+        ok = ok && up.finish(error);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        CHECK(ok && up.count() == COUNTS[k]);
+        peaks[k] = peak;
+
+        printf("  %8zu %12zu B %12zu B %8.2f ms\n", COUNTS[k], peak, legacyBody, ms);
+        RecipientStore::prune(nullptr, 0);
+    }
+    // Tepe liste boyutuyla büyümez (dosya tamponları sabit)
+    CHECK(peaks[2] <= peaks[0] + 256);
+}
+
+}
+
+int main() {
+    freshFilesystem("recipients");
+    printf("recipient upload\n");
+    checkUploads();
+    benchUploads();
+    return finish("recipient_upload_test");
+}
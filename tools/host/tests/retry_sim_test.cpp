@@ -0,0 +1,381 @@
+// ============================================================================
+// Yeniden deneme politikası: birim sınırları + senaryolu kesinti simülasyonu
+// ============================================================================
+// 1. RetryPolicy::nextDelay - sınıf başına taban/tavan, decorrelated jitter
+//    (rastgelelik HostRandom ile sabitlenir / tohumlanır)
+// 2. RetryPolicy::classifyReply - SMTP kodu → hata sınıfı
+// 3. MailQueue yığın sırası - warning önce, sonra (nextRetryTime, createdAt)
+// 4. Kesinti simülasyonu: gerçek MailAgent + DMFNetworkManager + smtp_sink.py
+//    sanal saatte 1 sn adımlarla yürür. Her senaryo birkaç tohumla koşar;
+//    kesintinin bitişinden teslime kadar geçen süre (MTTD) raporlanır.
+// 5. Birikim boşaltma: WiFi kesintisinde 15 uyarı birikir, bağlantı gelince
+//    kuyruk 20 ms'lik loop turlarıyla boşalır. Eski davranış (10 sn'de bir
+//    mail) kova 1 jeton / dakikada 6 ile taklit edilir; varsayılan kova
+//    (5, 10/dk) ve sınırsız ile QueueDrainStats.lastDrainMs karşılaştırılır.
+
+#include "host_test.h"
+#include "mail_functions.h"
+#include "mail_queue.h"
+#include "retry_policy.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+using namespace host_test;
+
+namespace {
+
+const uint32_t SECOND = 1000;
+const uint32_t MINUTE = 60 * SECOND;
+const uint32_t HOUR = 60 * MINUTE;
+
+const IPAddress SINK_LAN_ADDRESS(192, 168, 11, 25);
+
+// --- 1. nextDelay --------------------------------------------------------------
+
+void checkBackoff(FailureClass failure, uint32_t base, uint32_t cap) {
+    // En küçük rastgele değer: hep taban
+    HostRandom::set([] { return 0u; });
+    CHECK(RetryPolicy::nextDelay(failure, 0) == base);
+    CHECK(RetryPolicy::nextDelay(failure, cap) == base);
+    HostRandom::set(nullptr);
+
+    // Zincir: her gecikme [taban, min(tavan, önceki × 3)]; tavana ulaşılır
+    HostRandom::seed(39);
+    uint32_t previous = 0;
+    uint32_t longest = 0;
+    for (int i = 0; i < 500; ++i) {
+        uint32_t delayMs = RetryPolicy::nextDelay(failure, previous);
+        uint64_t high = std::max<uint64_t>((uint64_t)previous * 3, base);
+        CHECK_RANGE(delayMs, base, std::min<uint64_t>(high, cap));
+        longest = std::max(longest, delayMs);
+        previous = delayMs;
+    }
+    CHECK(longest > cap - cap / 10);
+
+    // Decorrelated: aynı önceki gecikmeden çıkan değerler aralığa yayılır
+    uint32_t low = UINT32_MAX, high = 0;
+    for (int i = 0; i < 1000; ++i) {
+        uint32_t delayMs = RetryPolicy::nextDelay(failure, base * 2);
+        low = std::min(low, delayMs);
+        high = std::max(high, delayMs);
+    }
+    uint32_t span = std::min(base * 6, cap) - base;
+    CHECK(low < base + span / 20);
+    CHECK(high > base + span - span / 20);
+}
+
+// --- 2. classifyReply ------------------------------------------------------------
+
+void checkClassify() {
+    struct Case {
+        uint16_t code;
+        FailureClass expected;
+    };
+    const Case cases[] = {
+        {0, FailureClass::NETWORK},     {421, FailureClass::TRANSIENT}, {450, FailureClass::TRANSIENT},
+        {451, FailureClass::TRANSIENT}, {452, FailureClass::TRANSIENT}, {454, FailureClass::TRANSIENT},
+        {530, FailureClass::AUTH},      {534, FailureClass::AUTH},      {535, FailureClass::AUTH},
+        {550, FailureClass::PERMANENT}, {552, FailureClass::PERMANENT}, {554, FailureClass::PERMANENT},
+        {250, FailureClass::TRANSIENT}, // Hata yolunda beklenmeyen başarı kodu
+    };
+    for (const Case &c : cases) {
+        if (RetryPolicy::classifyReply(c.code) != c.expected) {
+            fprintf(stderr, "classifyReply(%u) = %s, beklenen %s\n", c.code,
+                    RetryPolicy::name(RetryPolicy::classifyReply(c.code)), RetryPolicy::name(c.expected));
+            failures()++;
+        }
+    }
+    CHECK(RetryPolicy::waitsForNetwork(FailureClass::NETWORK) && RetryPolicy::waitsForNetwork(FailureClass::DNS));
+    CHECK(!RetryPolicy::waitsForNetwork(FailureClass::TLS) && !RetryPolicy::waitsForNetwork(FailureClass::PERMANENT));
+    CHECK(RetryPolicy::waitsForConfig(FailureClass::AUTH) && RetryPolicy::waitsForConfig(FailureClass::CONFIG));
+    CHECK(!RetryPolicy::waitsForConfig(FailureClass::TRANSIENT));
+}
+
+// --- 3. MailQueue yığın sırası ------------------------------------------------------
+
+bool comesBefore(const QueuedMail &a, const QueuedMail &b) {
+    if (a.type != b.type) return a.type == MailType::WARNING;
+    if (a.nextRetryTime != b.nextRetryTime) return a.nextRetryTime < b.nextRetryTime;
+    return a.createdAt < b.createdAt;
+}
+
+void checkHeapOrder() {
+    MailQueue queue;
+    queue.begin();
+    queue.clear();
+
+    std::mt19937 rng(3039);
+    uint32_t now = millis();
+    std::vector<QueuedMail> expected;
+    for (int i = 0; i < 120; ++i) {
+        QueuedMail mail;
+        mail.type = rng() % 3 == 0 ? MailType::WARNING : MailType::FINAL;
+        mail.nextRetryTime = now + (rng() % 20) * SECOND; // Eşit zamanlar: createdAt ayırır
+        mail.createdAt = now - (uint32_t)(i * 7919) % 1000; // Benzersiz: eşitlik kalmaz
+        snprintf(mail.description, sizeof(mail.description), "m%d", i);
+        mail.id = queue.enqueue(mail);
+        expected.push_back(mail);
+    }
+
+    // Zamanı gelmemiş mail çıkmaz
+    QueuedMail out;
+    CHECK(!queue.popDue(now - 1, out));
+
+    // İlk yarı: 10 sn'ye kadar hazır olanlar; warning'ler tükenmeden final çıkmaz
+    std::vector<QueuedMail> popped;
+    while (queue.popDue(now + 9 * SECOND, out)) popped.push_back(out);
+    size_t dueCount = std::count_if(expected.begin(), expected.end(),
+                                    [&](const QueuedMail &m) { return m.nextRetryTime <= now + 9 * SECOND; });
+    CHECK(popped.size() == dueCount);
+
+    // Geri kalanlar + çıkanların yarısı yeniden planlanır (ATTEMPT yolu)
+    for (size_t i = 0; i < popped.size(); i += 2) {
+        QueuedMail mail = popped[i];
+        mail.nextRetryTime = now + 30 * SECOND + (rng() % 5) * SECOND;
+        queue.reschedule(mail);
+        for (QueuedMail &m : expected) {
+            if (m.id == mail.id) m.nextRetryTime = mail.nextRetryTime;
+        }
+    }
+    for (size_t i = 1; i < popped.size(); i += 2) {
+        queue.complete(popped[i]);
+        expected.erase(std::remove_if(expected.begin(), expected.end(),
+                                      [&](const QueuedMail &m) { return m.id == popped[i].id; }),
+                       expected.end());
+    }
+
+    // Yığın tek tek boşaltılınca tam sıra: (tip, nextRetryTime, createdAt)
+    std::vector<QueuedMail> rest;
+    while (queue.popDue(now + HOUR, out)) rest.push_back(out);
+    CHECK(rest.size() == expected.size());
+    std::sort(expected.begin(), expected.end(), comesBefore);
+    for (size_t i = 0; i < rest.size() && i < expected.size(); ++i) {
+        if (rest[i].id != expected[i].id) {
+            fprintf(stderr, "yığın sırası %zu: #%u, beklenen #%u\n", i, rest[i].id, expected[i].id);
+            failures()++;
+            break;
+        }
+    }
+    for (size_t i = 1; i < popped.size(); ++i) {
+        // İlk tur: warning'ler önce, her tipte zamana göre
+        CHECK(!comesBefore(popped[i], popped[i - 1]));
+    }
+    queue.clear();
+}
+
+// --- 4. Kesinti simülasyonu ------------------------------------------------------
+
+enum class OutageKind { WIFI, SERVER_DOWN, REJECT };
+
+struct Outage {
+    const char *name;
+    OutageKind kind;
+    uint32_t durationMs;
+    uint32_t boundMs; // Kesinti bitişinden teslime en uzun süre
+};
+
+class Simulation {
+public:
+    bool start() {
+        freshFilesystem("retry");
+        HostNet::alias(SINK_LAN_ADDRESS);
+        if (!startSink(0, false)) return false;
+        if (!bringOnline(net)) return false;
+        agent.begin(nullptr, &net, "HOSTDEV00039");
+        settings.smtpServer = SINK_LAN_ADDRESS.toString();
+        settings.smtpPort = port;
+        settings.smtpTls = false;
+        settings.username = "dmf@host.test";
+        settings.password = "host-secret";
+        settings.ratePerMinute = 0;
+        settings.recipients[0] = "owner@host.test";
+        settings.recipientCount = 1;
+        agent.updateConfig(settings);
+        return true;
+    }
+
+    // Kesinti bitişinden teslime ms; teslim olmazsa UINT32_MAX
+    uint32_t run(const Outage &outage, uint32_t seed) {
+        HostRandom::seed(seed);
+        begin(outage.kind);
+
+        String error;
+        ScheduleSnapshot snapshot;
+        snapshot.totalAlarms = 1;
+        if (agent.sendWarning(0, snapshot, error) || agent.getQueueSize() != 1) {
+            end(outage.kind);
+            return UINT32_MAX;
+        }
+
+        uint32_t start = millis();
+        while (millis() - start < outage.durationMs) {
+            step();
+            if (agent.getQueueSize() == 0) break; // Kesintide teslim olmamalı
+        }
+        bool heldDuringOutage = agent.getQueueSize() == 1;
+
+        end(outage.kind);
+        uint32_t recovered = millis();
+        while (agent.getQueueSize() > 0 && millis() - recovered < 4 * HOUR) step();
+        return heldDuringOutage && agent.getQueueSize() == 0 ? millis() - recovered : UINT32_MAX;
+    }
+
+    // WiFi kesintisinde 'count' uyarı biriktir, bağlantı gelince boşalt
+    QueueDrainStats drain(uint8_t count, uint8_t burst, uint16_t perMinute) {
+        settings.rateBurst = burst;
+        settings.ratePerMinute = perMinute;
+        agent.updateConfig(settings);
+
+        begin(OutageKind::WIFI);
+        String error;
+        ScheduleSnapshot snapshot;
+        snapshot.totalAlarms = count;
+        for (uint8_t i = 0; i < count; ++i) CHECK(!agent.sendWarning(i, snapshot, error));
+        CHECK(agent.getQueueSize() == count);
+        for (int i = 0; i < 30; ++i) step(SECOND);
+
+        end(OutageKind::WIFI);
+        uint32_t recovered = millis();
+        while (agent.getQueueSize() > 0 && millis() - recovered < 10 * MINUTE) step(20);
+        CHECK(agent.getQueueSize() == 0);
+        return agent.queueStats();
+    }
+
+private:
+    DMFNetworkManager net;
+    MailAgent agent;
+    MailSettings settings;
+    std::unique_ptr<Server> sink;
+    uint16_t port = 0;
+
+    bool startSink(uint16_t fixedPort, bool reject) {
+        sink.reset();
+        std::vector<std::string> args = {"--host", "127.0.0.1", "--port", std::to_string(fixedPort)};
+        if (reject) {
+            args.push_back("--rule");
+            args.push_back("DOT:reply=554");
+        }
+        sink.reset(new Server("smtp_sink.py", args));
+        if (sink->ok()) port = sink->port();
+        return sink->ok();
+    }
+
+    void step(uint32_t ms = SECOND) {
+        HostClock::advance(ms);
+        net.loop();
+        agent.processQueue();
+    }
+
+    void begin(OutageKind kind) {
+        switch (kind) {
+            case OutageKind::WIFI:
+                HostWiFi::removeNetwork("DMF-HostLAN");
+                HostWiFi::dropLink(WIFI_REASON_BEACON_TIMEOUT);
+                for (int i = 0; i < 20; ++i) net.loop();
+                break;
+            case OutageKind::SERVER_DOWN:
+                sink.reset(); // Bağlantı reddi (NETWORK, ağ olayı gelmez)
+                break;
+            case OutageKind::REJECT:
+                startSink(port, true); // 554 (PERMANENT)
+                break;
+        }
+    }
+
+    void end(OutageKind kind) {
+        switch (kind) {
+            case OutageKind::WIFI:
+                HostWiFi::addNetwork("DMF-HostLAN", -48, false, "host-pass");
+                break;
+            case OutageKind::SERVER_DOWN:
+            case OutageKind::REJECT:
+                startSink(port, false);
+                break;
+        }
+    }
+};
+
+void simulateOutages() {
+    // Sınır: sınıfın tavanı + kuyruk kontrol aralığı (10 sn) + bağlanma payı
+    const Outage outages[] = {
+        {"WiFi 2 dk", OutageKind::WIFI, 2 * MINUTE, 2 * MINUTE},
+        {"WiFi 30 dk", OutageKind::WIFI, 30 * MINUTE, 2 * MINUTE},
+        {"SMTP kapalı 20 dk", OutageKind::SERVER_DOWN, 20 * MINUTE, 10 * MINUTE + 20 * SECOND},
+        {"SMTP 554 45 dk", OutageKind::REJECT, 45 * MINUTE, 2 * HOUR + 20 * SECOND},
+    };
+    const uint32_t seeds[] = {1, 7, 39, 1234, 99991};
+
+    Simulation sim;
+    CHECK(sim.start());
+
+    printf("%-20s %10s %10s %10s\n", "kesinti", "MTTD (s)", "en az (s)", "en çok (s)");
+    for (const Outage &outage : outages) {
+        uint64_t total = 0;
+        uint32_t shortest = UINT32_MAX, longest = 0;
+        size_t runs = 0;
+        for (uint32_t seed : seeds) {
+            uint32_t latency = sim.run(outage, seed);
+            if (latency == UINT32_MAX) {
+                fprintf(stderr, "%s (tohum %u): teslim edilmedi veya kesintide gitti\n", outage.name, seed);
+                failures()++;
+                continue;
+            }
+            CHECK_RANGE(latency, 0, outage.boundMs);
+            total += latency;
+            shortest = std::min(shortest, latency);
+            longest = std::max(longest, latency);
+            runs++;
+        }
+        if (runs == 0) continue;
+        printf("%-20s %10.1f %10.1f %10.1f\n", outage.name, total / (double)runs / 1000.0, shortest / 1000.0,
+               longest / 1000.0);
+    }
+}
+
+void simulateDrain() {
+    const uint8_t BACKLOG = 15;
+    const uint32_t OLD_INTERVAL = 10 * SECOND; // Eski processQueue: 10 sn'de bir mail
+    struct {
+        const char *name;
+        uint8_t burst;
+        uint16_t perMinute;
+        uint32_t lowMs;
+        uint32_t highMs;
+    } modes[] = {
+        // İlk mail hemen, kalanlar dolum aralığıyla
+        {"eski (10 sn'de 1)", 1, 6, (BACKLOG - 1) * OLD_INTERVAL - 2 * SECOND, (BACKLOG - 1) * OLD_INTERVAL + 5 * SECOND},
+        {"kova 5, 10/dk", 5, 10, (BACKLOG - 5) * 6 * SECOND - 2 * SECOND, (BACKLOG - 5) * 6 * SECOND + 5 * SECOND},
+        {"sınırsız", 5, 0, 0, 5 * SECOND},
+    };
+
+    Simulation sim;
+    CHECK(sim.start());
+    printf("%-20s %10s %10s %14s\n", "boşaltma", "mail", "süre (s)", "teslim ort. (s)");
+    for (const auto &mode : modes) {
+        QueueDrainStats stats = sim.drain(BACKLOG, mode.burst, mode.perMinute);
+        CHECK(stats.lastDrainMails == BACKLOG);
+        CHECK_RANGE(stats.lastDrainMs, mode.lowMs, mode.highMs);
+        printf("%-20s %10u %10.1f %14.1f\n", mode.name, (unsigned)stats.lastDrainMails, stats.lastDrainMs / 1000.0,
+               stats.avgDeliveryMs / 1000.0);
+    }
+}
+
+}
+
+int main() {
+    checkBackoff(FailureClass::NETWORK, 30 * SECOND, 10 * MINUTE);
+    checkBackoff(FailureClass::DNS, 30 * SECOND, 10 * MINUTE);
+    checkBackoff(FailureClass::TRANSIENT, MINUTE, 15 * MINUTE);
+    checkBackoff(FailureClass::PERMANENT, 15 * MINUTE, 2 * HOUR);
+    checkBackoff(FailureClass::AUTH, 10 * MINUTE, HOUR);
+    checkClassify();
+
+    freshFilesystem("retry-queue");
+    checkHeapOrder();
+
+    simulateOutages();
+    simulateDrain();
+    return finish("retry_sim_test");
+}
@@ -0,0 +1,359 @@
+// ============================================================================
+// SmtpSession ↔ smtp_sink.py: ESMTP uzantısına göre gidiş-dönüş sayısı
+// ============================================================================
+// Aynı oturumda MESSAGES mesaj, her biri RECIPIENTS alıcılı zarf + '.' ile
+// başlayan satırlar içeren gövde. Sunucu dört kipte başlatılır:
+//   varsayılan        PIPELINING + CHUNKING → zarf 1 + mesaj sonu 1 (BDAT)
+//   --no-chunking     PIPELINING            → zarf+DATA 1 + mesaj sonu 1
+//   --no-pipelining   CHUNKING tek başına kullanılmaz → sıralı diyalog
+//   ikisi de kapalı   sıralı: MAIL + n×RCPT + DATA + mesaj sonu = 3 + n
+// Oturum açılışı her kipte selamlama + EHLO + AUTH PLAIN = 3 bekleme.
+// Gelen .eml dosyalarında gövde bayt bayt aynı olmalı (dot-stuffing / BDAT).
+//
+// Oturum yeniden kullanımı: CONNECT 120 ms (TLS el sıkışması yerine) ile
+// REUSE_MESSAGES tek alıcılı mesaj - eski yol her mesaja yeni oturum açıyordu.
+// Tek oturumda bağlantı / el sıkışma 1 olmalı; sunucu 5. mesajdan sonra
+// bağlantıyı keserse sonraki beginEnvelope bir kez yeniden bağlanır.
+//
+// DATA yazıcısı: MIME üreticisinin küçük print()'leri (başlıklar, 76 karakterlik
+// base64 satırları, 200 KB ek) eski yolda doğrudan sokete gidiyordu - burada
+// elle yürütülen sıralı diyalogla aynen yapılır. SmtpDataWriter ile soket
+// yazımı, hatta giden bayt ve DATA süresi (mesaj sonu 250 dahil) karşılaştırılır.
+
+#include "host_test.h"
+#include "base64_stream.h"
+#include "smtp_session.h"
+
+#include <base64.h>
+#include <chrono>
+
+using namespace host_test;
+
+namespace {
+
+const IPAddress SINK_LAN_ADDRESS(192, 168, 11, 27);
+const uint8_t MESSAGES = 4;
+const uint8_t RECIPIENTS = 3;
+const uint16_t OPEN_ROUND_TRIPS = 3;
+
+MailSettings sinkSettings(uint16_t port) {
+    MailSettings settings;
+    settings.smtpServer = SINK_LAN_ADDRESS.toString();
+    settings.smtpPort = port;
+    settings.smtpTls = false;
+    settings.username = "dmf@host.test";
+    settings.password = "host-secret";
+    return settings;
+}
+
+// ~12 KB: birden fazla yazıcı bloğu / BDAT parçası, nokta ile başlayan satırlar
+std::string makeBody(uint8_t message) {
+    std::string body = "Subject: Tur " + std::to_string(message) + "\r\n\r\n";
+    for (int line = 0; line < 160; ++line) {
+        if (line % 9 == 0) body += ".";
+        body += "satir " + std::to_string(line) + " mesaj " + std::to_string(message) +
+                " - SmartKraft DMF oturum testi icerigi\r\n";
+    }
+    body += ".\r\n..\r\nson\r\n";
+    return body;
+}
+
+// Tek mesaj: zarf + gövde + sonlandırıcı
+bool sendMessage(SmtpSession &session, const String *recipients, uint8_t count, const std::string &body,
+                 String &error) {
+    bool sent = session.beginEnvelope(error, body.size());
+    for (uint8_t r = 0; sent && r < count; ++r) sent = session.addRecipient(recipients[r], error);
+    sent = sent && session.beginData(error);
+    if (sent) session.stream().write(reinterpret_cast<const uint8_t *>(body.data()), body.size());
+    return sent && session.endData(error);
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Mode {
+    const char *name;
+    std::vector<std::string> flags;
+    bool pipelining;
+    bool chunking;
+};
+
+void runMode(const Mode &mode) {
+    std::string saveDir = makeTempDir("session-eml");
+    std::vector<std::string> args = {"--host", "127.0.0.1", "--port", "0", "--save-dir", saveDir};
+    args.insert(args.end(), mode.flags.begin(), mode.flags.end());
+    Server sink("smtp_sink.py", args);
+    CHECK(sink.ok());
+    if (!sink.ok()) return;
+
+    MailSettings settings = sinkSettings(sink.port());
+    SmtpSession session(settings);
+    String error;
+    auto start = std::chrono::steady_clock::now();
+    CHECK(session.open(error));
+    CHECK(session.phaseTimes().roundTrips == OPEN_ROUND_TRIPS);
+    CHECK(session.capabilities().pipelining == mode.pipelining);
+    CHECK(session.capabilities().chunking == mode.chunking);
+
+    const uint16_t perMessage = mode.pipelining ? 2 : 3 + RECIPIENTS;
+    bool chunked = mode.pipelining && mode.chunking;
+    for (uint8_t m = 0; m < MESSAGES; ++m) {
+        String recipients[RECIPIENTS];
+        for (uint8_t r = 0; r < RECIPIENTS; ++r) recipients[r] = "k" + String(m) + "-" + String(r) + "@host.test";
+        CHECK(sendMessage(session, recipients, RECIPIENTS, makeBody(m), error));
+        CHECK(session.lastRoundTrips() == perMessage);
+        CHECK(session.lastData().chunkedMode() == chunked);
+        if (chunked) CHECK(session.lastData().chunkCount() > 1);
+    }
+    uint16_t total = session.phaseTimes().roundTrips;
+    CHECK(total == OPEN_ROUND_TRIPS + MESSAGES * perMessage);
+    CHECK(session.handshakeCount() == 1);
+    session.close();
+    double ms = elapsedMs(start);
+
+    auto files = listFiles(saveDir);
+    CHECK(files.size() == MESSAGES);
+    size_t intact = 0;
+    for (const std::string &file : files) {
+        std::string mail = readHostFile(saveDir + "/" + file);
+        for (uint8_t m = 0; m < MESSAGES; ++m) {
+            if (mail.find(makeBody(m)) != std::string::npos) intact++;
+        }
+    }
+    CHECK(intact == MESSAGES);
+
+    printf("  %-16s %2u + %u x %u = %3u gidiş-dönüş, %7.1f ms\n", mode.name, (unsigned)OPEN_ROUND_TRIPS,
+           (unsigned)MESSAGES, (unsigned)perMessage, (unsigned)total, ms);
+}
+
+// Tek oturum ↔ mesaj başına oturum (eski yol), CONNECT gecikmesiyle
+void benchReuse() {
+    const uint8_t REUSE_MESSAGES = 10;
+    const uint32_t CONNECT_DELAY_MS = 120;
+    std::string saveDir = makeTempDir("session-reuse");
+    Server sink("smtp_sink.py", {"--host", "127.0.0.1", "--port", "0", "--save-dir", saveDir, "--rule",
+                                 "CONNECT:delay=" + std::to_string(CONNECT_DELAY_MS)});
+    CHECK(sink.ok());
+    if (!sink.ok()) return;
+    MailSettings settings = sinkSettings(sink.port());
+    String error;
+
+    // Eski yol: her alıcı için bağlan + EHLO + AUTH + mesaj + QUIT
+    uint32_t connectsBefore = HostNet::connects();
+    auto start = std::chrono::steady_clock::now();
+    for (uint8_t m = 0; m < REUSE_MESSAGES; ++m) {
+        SmtpSession fresh(settings);
+        String recipient = "eski" + String(m) + "@host.test";
+        CHECK(sendMessage(fresh, &recipient, 1, makeBody(m), error));
+    }
+    double freshMs = elapsedMs(start);
+    uint32_t freshConnects = HostNet::connects() - connectsBefore;
+
+    // Yeni yol: tek oturum, mesajlar arasında yalnızca zarf
+    connectsBefore = HostNet::connects();
+    start = std::chrono::steady_clock::now();
+    {
+        SmtpSession session(settings);
+        for (uint8_t m = 0; m < REUSE_MESSAGES; ++m) {
+            String recipient = "yeni" + String(m) + "@host.test";
+            CHECK(sendMessage(session, &recipient, 1, makeBody(m), error));
+        }
+        CHECK(session.handshakeCount() == 1);
+        CHECK(session.messageCount() == REUSE_MESSAGES);
+    }
+    double reuseMs = elapsedMs(start);
+    uint32_t reuseConnects = HostNet::connects() - connectsBefore;
+
+    CHECK(freshConnects == REUSE_MESSAGES);
+    CHECK(reuseConnects == 1);
+    CHECK(listFiles(saveDir).size() == 2u * REUSE_MESSAGES);
+    CHECK(reuseMs < freshMs / 3);
+    printf("  oturum başına mesaj  %2u bağlantı %7.1f ms\n", (unsigned)freshConnects, freshMs);
+    printf("  tek oturum           %2u bağlantı %7.1f ms (%.1fx)\n", (unsigned)reuseConnects, reuseMs,
+           freshMs / reuseMs);
+}
+
+// writeMimeMessage gibi: başlık / sınır başına bir print, ek satır başına bir print
+void produceMime(Print &out, const std::string &attachment) {
+    out.print("From: dmf@host.test\r\n");
+    out.print("To: yazici@host.test\r\n");
+    out.print("Subject: DATA yazici olcumu\r\n");
+    out.print("MIME-Version: 1.0\r\n");
+    out.print("Content-Type: multipart/mixed; boundary=\"----=_SKDMF_42\"\r\n\r\n");
+    out.print("------=_SKDMF_42\r\n");
+    out.print("Content-Type: text/plain; charset=UTF-8\r\n\r\n");
+    out.print("Cihaz HOSTDEV00030 - final\r\n\r\n");
+    out.print("------=_SKDMF_42\r\n");
+    out.print("Content-Type: application/octet-stream; name=\"rapor.bin\"\r\n");
+    out.print("Content-Transfer-Encoding: base64\r\n");
+    out.print("Content-Disposition: attachment; filename=\"rapor.bin\"\r\n\r\n");
+    char line[Base64Stream::LINE_OUTPUT + 1];
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(attachment.data());
+    for (size_t offset = 0; offset < attachment.size(); offset += Base64Stream::LINE_INPUT) {
+        size_t len = std::min(Base64Stream::LINE_INPUT, attachment.size() - offset);
+        size_t n = Base64Stream::encodeLines(data + offset, len, line, sizeof(line));
+        out.write(reinterpret_cast<const uint8_t *>(line), n);
+    }
+    out.print("\r\n------=_SKDMF_42--\r\n");
+}
+
+// Eski yol: her print() doğrudan soket yazımı
+class DirectPrint : public Print {
+public:
+    explicit DirectPrint(Client &client) : client(client) {}
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *data, size_t len) override {
+        writes++;
+        size_t sent = client.write(data, len);
+        bytes += sent;
+        return sent;
+    }
+    using Print::write;
+    uint32_t writes = 0;
+    uint32_t bytes = 0;
+
+private:
+    Client &client;
+};
+
+struct DataRun {
+    uint32_t writes = 0;
+    uint32_t bytes = 0;
+    double ms = 0;
+    bool ok = false;
+};
+
+bool expect(WiFiClient &client, SmtpReplyReader &reader, const String &line, const char *code) {
+    if (line.length()) client.print(line);
+    SmtpReply reply;
+    return reader.read(reply, SMTP_COMMAND_TIMEOUT_MS) && reply.matches(code);
+}
+
+// Eski yol: sıralı diyalog elle, DATA içeriği tamponsuz
+DataRun legacyData(const MailSettings &settings, const std::string &attachment) {
+    DataRun run;
+    WiFiClient client;
+    SmtpReplyReader reader;
+    if (!client.connect(settings.smtpServer.c_str(), settings.smtpPort)) return run;
+    reader.begin(client);
+    std::string plain = std::string("\0") + settings.username.c_str() + '\0' + settings.password.c_str();
+    String token = base64::encode(reinterpret_cast<const uint8_t *>(plain.data()), plain.size());
+    bool ok = expect(client, reader, "", "220") && expect(client, reader, "EHLO host\r\n", "250") &&
+              expect(client, reader, "AUTH PLAIN " + token + "\r\n", "235") &&
+              expect(client, reader, "MAIL FROM:<" + settings.username + ">\r\n", "250") &&
+              expect(client, reader, "RCPT TO:<yazici@host.test>\r\n", "250") &&
+              expect(client, reader, "DATA\r\n", "354");
+    if (!ok) return run;
+    auto start = std::chrono::steady_clock::now();
+    DirectPrint direct(client);
+    produceMime(direct, attachment);
+    direct.print("\r\n.\r\n");
+    run.ok = expect(client, reader, "", "250");
+    run.ms = elapsedMs(start);
+    run.writes = direct.writes;
+    run.bytes = direct.bytes;
+    expect(client, reader, "QUIT\r\n", "221");
+    client.stop();
+    return run;
+}
+
+DataRun writerData(const MailSettings &settings, const std::string &attachment) {
+    DataRun run;
+    SmtpSession session(settings);
+    String error;
+    if (!session.beginEnvelope(error) || !session.addRecipient("yazici@host.test", error)) return run;
+    // beginData ↔ endData arası: zarf yanıtları eski ölçümde de DATA'dan önce
+    if (!session.beginData(error)) return run;
+    auto start = std::chrono::steady_clock::now();
+    produceMime(session.stream(), attachment);
+    run.ok = session.endData(error);
+    run.ms = elapsedMs(start);
+    run.writes = session.lastData().flushCount();
+    run.bytes = session.lastData().wireBytes();
+    return run;
+}
+
+void benchWriter() {
+    std::string saveDir = makeTempDir("session-writer");
+    // Karşılaştırma DATA ile (BDAT'ta sonlandırıcı / dot-stuffing yok)
+    Server sink("smtp_sink.py", {"--host", "127.0.0.1", "--port", "0", "--save-dir", saveDir, "--no-chunking"});
+    CHECK(sink.ok());
+    if (!sink.ok()) return;
+    MailSettings settings = sinkSettings(sink.port());
+
+    std::string attachment(200 * 1024, '\0');
+    for (size_t i = 0; i < attachment.size(); ++i) attachment[i] = (char)((i * 131 + 7) & 0xFF);
+
+    const int ROUNDS = 3;
+    DataRun before, after;
+    for (int round = 0; round < ROUNDS; ++round) {
+        DataRun a = legacyData(settings, attachment);
+        DataRun b = writerData(settings, attachment);
+        CHECK(a.ok && b.ok);
+        if (round == 0 || a.ms < before.ms) before = a;
+        if (round == 0 || b.ms < after.ms) after = b;
+    }
+
+    // Aynı içerik: sunucuda saklanan mesajlar bayt bayt aynı
+    auto files = listFiles(saveDir);
+    CHECK(files.size() == 2 * ROUNDS);
+    if (files.size() >= 2) {
+        CHECK(readHostFile(saveDir + "/" + files[0]) == readHostFile(saveDir + "/" + files[1]));
+    }
+    CHECK(after.bytes == before.bytes); // Gövdede '.' ile başlayan satır yok → dot-stuffing eklemez
+    CHECK(after.writes * 10 < before.writes); // 78 baytlık satırlar → ~1400 baytlık bloklar
+    CHECK(after.writes <= before.bytes / (SMTP_WRITE_BUFFER_SIZE - 8) + 1);
+    printf("  %-16s %6u yazım %8u bayt %7.1f ms\n", "doğrudan soket", (unsigned)before.writes,
+           (unsigned)before.bytes, before.ms);
+    printf("  %-16s %6u yazım %8u bayt %7.1f ms\n", "SmtpDataWriter", (unsigned)after.writes,
+           (unsigned)after.bytes, after.ms);
+}
+
+// Sunucu oturumu keserse (5. mesaj sonrası) sonraki zarf bir kez yeniden bağlanır
+void checkReconnect() {
+    const uint8_t COUNT = 8;
+    std::string saveDir = makeTempDir("session-drop");
+    Server sink("smtp_sink.py", {"--host", "127.0.0.1", "--port", "0", "--save-dir", saveDir, "--rule",
+                                 "MAIL:reply=421@6"});
+    CHECK(sink.ok());
+    if (!sink.ok()) return;
+    MailSettings settings = sinkSettings(sink.port());
+    SmtpSession session(settings);
+    String error;
+    for (uint8_t m = 0; m < COUNT; ++m) {
+        String recipient = "d" + String(m) + "@host.test";
+        CHECK(sendMessage(session, &recipient, 1, makeBody(m), error));
+    }
+    CHECK(session.handshakeCount() == 2);
+    CHECK(session.reconnectCount() == 1);
+    session.close();
+    CHECK(listFiles(saveDir).size() == COUNT);
+}
+
+}
+
+int main() {
+    freshFilesystem("session");
+    HostNet::alias(SINK_LAN_ADDRESS);
+    DMFNetworkManager net;
+    CHECK(bringOnline(net));
+
+    printf("smtp oturumu: %u mesaj x %u alıcı\n", (unsigned)MESSAGES, (unsigned)RECIPIENTS);
+    const Mode MODES[] = {
+        {"varsayılan", {}, true, true},
+        {"--no-chunking", {"--no-chunking"}, true, false},
+        {"--no-pipelining", {"--no-pipelining"}, false, true},
+        {"ikisi de kapalı", {"--no-pipelining", "--no-chunking"}, false, false},
+    };
+    for (const Mode &mode : MODES) runMode(mode);
+
+    printf("oturum yeniden kullanımı\n");
+    benchReuse();
+    checkReconnect();
+
+    printf("DATA yazıcısı (200 KB ek, en iyi / 3 tur)\n");
+    benchWriter();
+
+    return finish("smtp_session_test");
+}
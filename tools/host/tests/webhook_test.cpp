@@ -0,0 +1,207 @@
+// ============================================================================
+// WebhookDispatcher → webhook_standin.py (gerçek HTTP/1.1)
+// ============================================================================
+// Yanıt senaryosu URL yolunda (200, 429, 5xx, bağlantı kesme). Sanal saat
+// geri çekilmeyi beklemeden atlatır; her denemenin sunucuya ulaşıp
+// ulaşmadığı /_hits kaydından okunur. Sınanan:
+//   - retryable: 429/5xx/kesme yeniden denenir, 404 kalıcı, 4 deneme sınırı
+//   - retry: gecikme [backoff/2, backoff], backoff 2 s → 4 s → 8 s
+//   - takeDue: ertelenen işler aynı anda hazır olunca FIFO
+//   - originOf: aynı host:port'ta keep-alive soketi, farklı portta yeni bağlantı
+//   - enqueue: kuyruk doluyken düşürme, geçmiş (en yeni önce, 4 kayıt)
+
+#include "host_test.h"
+#include "webhook_dispatcher.h"
+
+using namespace host_test;
+
+namespace {
+
+struct Hit {
+    int connection = 0;
+    std::string reply;
+    std::string path;
+};
+
+// Sunucunun kaydı (test kendi istemcisiyle sorar; dispatcher soketine dokunmaz)
+std::vector<Hit> hits(uint16_t port) {
+    std::vector<Hit> list;
+    WiFiClient client;
+    HTTPClient http;
+    http.setReuse(false);
+    if (!http.begin(client, "http://127.0.0.1:" + String(port) + "/_hits") || http.GET() != 200) return list;
+    std::string text = http.getString().c_str();
+    http.end();
+
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) break;
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+        size_t a = line.find(' ');
+        size_t b = line.find(' ', a + 1);
+        if (a == std::string::npos || b == std::string::npos) continue;
+        list.push_back({atoi(line.c_str()), line.substr(a + 1, b - a - 1), line.substr(b + 1)});
+    }
+    return list;
+}
+
+size_t hitCount(uint16_t port, const std::string &path) {
+    size_t count = 0;
+    for (const Hit &hit : hits(port)) count += hit.path == path;
+    return count;
+}
+
+String url(uint16_t port, const std::string &path) {
+    return "http://127.0.0.1:" + String(port) + String(path.c_str());
+}
+
+// İş bitti (teslim ya da kalıcı hata)
+bool waitSettled(WebhookDispatcher &dispatcher, uint32_t settled) {
+    return waitFor([&] {
+        WebhookStats stats = dispatcher.stats();
+        return stats.delivered + stats.failed >= settled;
+    }, 5000);
+}
+
+bool waitRetries(WebhookDispatcher &dispatcher, uint32_t retries) {
+    return waitFor([&] { return dispatcher.stats().retries >= retries; }, 5000);
+}
+
+// Son deneme yeniden sıraya alındıktan sonra: backoff/2'den önce istek gelmez,
+// backoff'a kadar gelir (gerçek süre payı 150 ms)
+void expectRetryWithin(uint16_t port, const std::string &path, size_t hitsBefore, uint32_t backoff) {
+    HostClock::advance(backoff / 2 - 150);
+    delay(40);
+    CHECK(hitCount(port, path) == hitsBefore);
+    HostClock::advance(backoff / 2 + 150);
+    CHECK(waitFor([&] { return hitCount(port, path) == hitsBefore + 1; }, 2000));
+}
+
+int run() {
+    Server serverA("webhook_standin.py", {"--host", "127.0.0.1", "--port", "0"});
+    Server serverB("webhook_standin.py", {"--host", "127.0.0.1", "--port", "0"});
+    CHECK(serverA.ok() && serverB.ok());
+    if (!serverA.ok() || !serverB.ok()) return finish("webhook_test");
+    uint16_t portA = serverA.port();
+    uint16_t portB = serverB.port();
+
+    DMFNetworkManager net;
+    CHECK(bringOnline(net));
+
+    WebhookDispatcher dispatcher;
+    uint32_t settled = 0;
+
+    // --- 1. keep-alive: art arda işler aynı soketi kullanır, origin değişince kapanır ---
+    // (kuyruk boşalınca çalışan soketi bırakır; bu yüzden dördü birlikte sıraya alınır)
+    CHECK(dispatcher.enqueue(url(portA, "/200/a"), "a"));
+    CHECK(dispatcher.enqueue(url(portA, "/200/b"), "b"));
+    CHECK(dispatcher.enqueue(url(portB, "/200/c"), "c"));
+    CHECK(dispatcher.enqueue(url(portA, "/200/d"), "d"));
+    settled += 4;
+    CHECK(waitSettled(dispatcher, settled));
+    CHECK(dispatcher.stats().reusedConnections == 1);
+
+    std::vector<Hit> log = hits(portA);
+    CHECK(log.size() == 3);
+    if (log.size() == 3) {
+        CHECK(log[0].connection == log[1].connection); // a, b: tek soket
+        CHECK(log[2].connection != log[0].connection); // d: B'ye geçişten sonra yeni soket
+    }
+
+    WebhookStats stats = dispatcher.stats();
+    CHECK(stats.delivered == 4 && stats.failed == 0 && stats.retries == 0);
+    CHECK(stats.historyCount == WEBHOOK_HISTORY_SIZE);
+    CHECK(strcmp(stats.history[0].label, "d") == 0 && strcmp(stats.history[3].label, "a") == 0);
+    CHECK(stats.history[0].httpCode == 200 && stats.history[0].attempts == 1 && stats.history[0].success);
+
+    // --- 2. 429: en kısa jitter ile tam backoff/2 sonra yeniden ---
+    HostRandom::set([] { return 0u; });
+    CHECK(dispatcher.enqueue(url(portA, "/429,200/r"), "r"));
+    CHECK(waitRetries(dispatcher, 1));
+    CHECK(dispatcher.stats().pending == 1);
+    expectRetryWithin(portA, "/429,200/r", 1, 2000);
+    CHECK(waitSettled(dispatcher, ++settled));
+    stats = dispatcher.stats();
+    CHECK(stats.history[0].success && stats.history[0].attempts == 2);
+    HostRandom::set(nullptr);
+
+    // --- 3. 503 dizisi: backoff 2 s → 4 s → 8 s, her gecikme [b/2, b] ---
+    const std::string flaky = "/503,502,500,200/s";
+    CHECK(dispatcher.enqueue(url(portA, flaky), "s"));
+    uint32_t backoff = 2000;
+    for (uint32_t i = 1; i <= 3; ++i) {
+        CHECK(waitRetries(dispatcher, 1 + i));
+        expectRetryWithin(portA, flaky, i, backoff);
+        backoff *= 2;
+    }
+    CHECK(waitSettled(dispatcher, ++settled));
+    stats = dispatcher.stats();
+    CHECK(stats.history[0].success && stats.history[0].attempts == WEBHOOK_MAX_ATTEMPTS);
+
+    // --- 4. bağlantı yanıtsız kesilir → yeniden denenir ---
+    CHECK(dispatcher.enqueue(url(portA, "/drop,200/k"), "k"));
+    CHECK(waitRetries(dispatcher, 5));
+    HostClock::advance(2000);
+    CHECK(waitSettled(dispatcher, ++settled));
+    stats = dispatcher.stats();
+    CHECK(stats.history[0].success && stats.history[0].attempts == 2);
+    CHECK(hitCount(portA, "/drop,200/k") == 2);
+
+    // --- 5. kalıcı hata: 404 tek deneme; 500 sürerse deneme hakkı biter ---
+    CHECK(dispatcher.enqueue(url(portA, "/404/p"), "p"));
+    CHECK(waitSettled(dispatcher, ++settled));
+    stats = dispatcher.stats();
+    CHECK(stats.failed == 1 && stats.retries == 5);
+    CHECK(stats.history[0].httpCode == 404 && stats.history[0].attempts == 1 && !stats.history[0].success);
+
+    CHECK(dispatcher.enqueue(url(portA, "/500/x"), "x"));
+    backoff = 2000;
+    for (uint32_t i = 1; i < WEBHOOK_MAX_ATTEMPTS; ++i) {
+        CHECK(waitRetries(dispatcher, 5 + i));
+        HostClock::advance(backoff);
+        backoff *= 2;
+    }
+    CHECK(waitFor([&] { return dispatcher.stats().failed == 2; }, 5000));
+    settled++;
+    stats = dispatcher.stats();
+    CHECK(stats.history[0].httpCode == 500 && stats.history[0].attempts == WEBHOOK_MAX_ATTEMPTS);
+    CHECK(hitCount(portA, "/500/x") == WEBHOOK_MAX_ATTEMPTS);
+
+    // --- 6. heap düşük: iş deneme harcamadan bekler; kuyruk dolunca düşer ---
+    HostEsp::setFreeHeap(30 * 1024);
+    for (int i = 0; i < WEBHOOK_QUEUE_SIZE; ++i) {
+        CHECK(dispatcher.enqueue(url(portA, "/200/q" + std::to_string(i)), ("q" + String(i)).c_str()));
+    }
+    CHECK(!dispatcher.enqueue(url(portA, "/200/fazla"), "fazla"));
+    CHECK(!dispatcher.enqueue(url(portA, "/" + std::string(WEBHOOK_URL_LEN, 'u')), "uzun"));
+    stats = dispatcher.stats();
+    CHECK(stats.dropped == 1 && stats.pending == WEBHOOK_QUEUE_SIZE);
+
+    delay(50);
+    size_t before = hits(portA).size();
+    HostEsp::setFreeHeap(180 * 1024);
+    HostClock::advance(5100); // DEFER_MS sonra hepsi aynı anda hazır
+    settled += WEBHOOK_QUEUE_SIZE;
+    CHECK(waitSettled(dispatcher, settled));
+    log = hits(portA);
+    CHECK(log.size() == before + WEBHOOK_QUEUE_SIZE);
+    for (size_t i = 0; i < WEBHOOK_QUEUE_SIZE && before + i < log.size(); ++i) {
+        CHECK(log[before + i].path == "/200/q" + std::to_string(i)); // FIFO
+    }
+    stats = dispatcher.stats();
+    CHECK(stats.pending == 0 && stats.retries == 8); // Ertelemeler deneme sayılmaz
+    CHECK(strcmp(stats.history[0].label, "q7") == 0 && stats.history[0].attempts == 1);
+
+    return finish("webhook_test");
+}
+
+}
+
+int main() {
+    int result = run();
+    // Çalışan görev kapanmaz (firmware'de de öyle): statik yıkıcılar beklemeden çık
+    fflush(stdout);
+    _exit(result);
+}
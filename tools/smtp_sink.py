@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+"""SmartKraft DMF - yerel SMTP test sunucusu (sink).
+
+Cihazın gerçek SMTP hesabı olmadan uyarı/final gönderim yollarını uçtan uca
+çalıştırmak için. Gelen mailleri kabul eder (isteğe bağlı .eml olarak saklar),
+komut başına gecikme, 4xx/5xx yanıt ve bağlantı kesme senaryoları uygular.
+
+Cihaz tarafı:
+  /api/mail → smtpServer = bu makinenin yerel IP'si, smtpPort = --port,
+              smtpTls = false (yalnızca özel IPv4 adresine izin verilir)
+  Seri konsol → "bench warning 5" veya "bench final 3"
+
+ESMTP uzantıları varsayılan olarak duyurulur (PIPELINING, CHUNKING/BDAT,
+SIZE). Cihazın eski sıralı diyalogla farkını ölçmek için --no-pipelining /
+--no-chunking ile kapatıp aynı bench komutunun "gidiş-dönüş" sayısını
+karşılaştırın.
+
+Kurallar (--rule, birden fazla verilebilir):
+  KOMUT:eylem[@n]
+    KOMUT : EHLO, AUTH, MAIL, RCPT, DATA, BDAT (LAST olmayan blok), DOT (mesaj
+            sonu - DATA "." veya BDAT LAST), RSET, QUIT, CONNECT
+    eylem : delay=<ms> | reply=<kod> | drop
+    @n    : yalnızca n. kez (1'den başlar); yoksa her seferinde
+
+Host testleri (tools/host, ctest) sunucuyu --port 0 ile başlatır; firmware
+kaynakları Linux'ta aynı diyaloğu bu sunucuya karşı çalıştırır.
+
+Örnekler:
+  smtp_sink.py --port 2525
+  smtp_sink.py --rule CONNECT:delay=300 --rule DOT:delay=150
+  smtp_sink.py --rule RCPT:reply=451@2 --rule DOT:drop@5
+  smtp_sink.py --rule AUTH:reply=535 --save-dir /tmp/dmf-mails
+  smtp_sink.py --no-pipelining --no-chunking        # "önce" ölçümü
+  smtp_sink.py --max-size 100000                    # SIZE ön kontrolü (552)
+"""
+
+import argparse
+import os
+import socketserver
+import threading
+import time
+
+REPLIES = {
+    421: "Service not available, closing channel",
+    450: "Mailbox unavailable (sink)",
+    451: "Local error in processing (sink)",
+    452: "Insufficient storage (sink)",
+    535: "Authentication credentials invalid (sink)",
+    550: "Mailbox unavailable (sink)",
+    552: "Message size exceeds limit (sink)",
+    554: "Transaction failed (sink)",
+}
+
+
+class Rule:
+    def __init__(self, spec):
+        verb, _, action = spec.partition(":")
+        if not action:
+            raise ValueError("kural biçimi KOMUT:eylem[@n] olmalı: " + spec)
+        self.verb = verb.upper()
+        action, _, nth = action.partition("@")
+        self.nth = int(nth) if nth else 0
+        self.delay_ms = 0
+        self.reply = 0
+        self.drop = False
+        if action == "drop":
+            self.drop = True
+        elif action.startswith("delay="):
+            self.delay_ms = int(action[6:])
+        elif action.startswith("reply="):
+            self.reply = int(action[6:])
+        else:
+            raise ValueError("bilinmeyen eylem: " + action)
+
+
+class Sink:
+    def __init__(self, rules, save_dir, max_size, pipelining, chunking):
+        self.rules = rules
+        self.save_dir = save_dir
+        self.max_size = max_size
+        self.pipelining = pipelining
+        self.chunking = chunking
+        self.lock = threading.Lock()
+        self.counts = {}
+        self.messages = 0
+
+    def match(self, verb):
+        """Komut sayacını artır, uygulanacak kuralları döndür."""
+        with self.lock:
+            count = self.counts.get(verb, 0) + 1
+            self.counts[verb] = count
+        return [r for r in self.rules if r.verb == verb and (r.nth == 0 or r.nth == count)]
+
+    def store(self, data):
+        with self.lock:
+            self.messages += 1
+            index = self.messages
+        if self.save_dir:
+            os.makedirs(self.save_dir, exist_ok=True)
+            with open(os.path.join(self.save_dir, "mail_%04d.eml" % index), "wb") as f:
+                f.write(data)
+        return index
+
+
+class Handler(socketserver.StreamRequestHandler):
+    sink = None
+    # Ardışık küçük yanıtlar (PIPELINING'de zarf yanıtları, BDAT alındıları)
+    # Nagle + gecikmeli ACK yüzünden ~40 ms beklemesin - ölçümü bozar
+    disable_nagle_algorithm = True
+
+    def send(self, code, text):
+        self.wfile.write(("%d %s\r\n" % (code, text)).encode())
+        self.wfile.flush()
+
+    def apply(self, verb, code, text):
+        """Kuralları uygula; False → bağlantı kesildi."""
+        for rule in self.sink.match(verb):
+            if rule.delay_ms:
+                time.sleep(rule.delay_ms / 1000.0)
+            if rule.drop:
+                self.log("%s: bağlantı kesildi (kural)" % verb)
+                return False
+            if rule.reply:
+                code, text = rule.reply, REPLIES.get(rule.reply, "Rule reply (sink)")
+        self.send(code, text)
+        if code == 421:
+            return False
+        return True
+
+    def log(self, text):
+        print("[%s:%d] %s" % (self.client_address[0], self.client_address[1], text), flush=True)
+
+    def read_data(self):
+        chunks = []
+        size = 0
+        while True:
+            line = self.rfile.readline()
+            if not line:
+                return None
+            if line == b".\r\n":
+                break
+            if line.startswith(b".."):
+                line = line[1:]
+            size += len(line)
+            if size <= self.sink.max_size:
+                chunks.append(line)
+        return b"".join(chunks), size
+
+    def finish_message(self, data, size):
+        """Mesaj sonu (DATA "." / BDAT LAST); False → bağlantı kesildi."""
+        if size > self.sink.max_size:
+            return self.apply("DOT", 552, REPLIES[552])
+        index = self.sink.store(data)
+        return self.apply("DOT", 250, "Queued as %d" % index)
+
+    @staticmethod
+    def declared_size(line):
+        for param in line.split()[2:]:
+            if param.upper().startswith("SIZE="):
+                try:
+                    return int(param[5:])
+                except ValueError:
+                    return 0
+        return 0
+
+    def handle(self):
+        start = time.time()
+        messages = 0
+        total_bytes = 0
+        commands = 0
+        bdat = []      # Açık BDAT mesajının blokları
+        bdat_size = 0
+        if not self.apply("CONNECT", 220, "dmf-sink ESMTP ready"):
+            return
+        while True:
+            raw = self.rfile.readline()
+            if not raw:
+                break
+            line = raw.decode(errors="replace").rstrip("\r\n")
+            verb = line.split(" ", 1)[0].upper()
+            commands += 1
+
+            if verb in ("EHLO", "HELO"):
+                self.wfile.write(b"250-dmf-sink\r\n")
+                self.wfile.write(("250-SIZE %d\r\n" % self.sink.max_size).encode())
+                self.wfile.write(b"250-8BITMIME\r\n")
+                if self.sink.pipelining:
+                    self.wfile.write(b"250-PIPELINING\r\n")
+                if self.sink.chunking:
+                    self.wfile.write(b"250-CHUNKING\r\n")
+                if not self.apply("EHLO", 250, "AUTH PLAIN LOGIN"):
+                    break
+            elif verb == "AUTH":
+                if line.upper().startswith("AUTH LOGIN"):
+                    self.send(334, "VXNlcm5hbWU6")
+                    if not self.rfile.readline():
+                        break
+                    self.send(334, "UGFzc3dvcmQ6")
+                    if not self.rfile.readline():
+                        break
+                if not self.apply("AUTH", 235, "Authentication succeeded"):
+                    break
+            elif verb == "MAIL" and self.declared_size(line) > self.sink.max_size:
+                self.log("MAIL: SIZE=%d > %d" % (self.declared_size(line), self.sink.max_size))
+                if not self.apply("MAIL", 552, REPLIES[552]):
+                    break
+            elif verb in ("MAIL", "RCPT", "RSET"):
+                if verb == "RSET":
+                    bdat, bdat_size = [], 0
+                if not self.apply(verb, 250, "OK"):
+                    break
+            elif verb == "BDAT" and self.sink.chunking:
+                parts = line.split()
+                try:
+                    length = int(parts[1])
+                except (IndexError, ValueError):
+                    self.send(501, "Syntax: BDAT <size> [LAST]")
+                    continue
+                data = self.rfile.read(length)
+                if len(data) < length:
+                    break
+                bdat_size += length
+                total_bytes += length
+                if bdat_size <= self.sink.max_size:
+                    bdat.append(data)
+                if len(parts) > 2 and parts[2].upper() == "LAST":
+                    message, size = b"".join(bdat), bdat_size
+                    bdat, bdat_size = [], 0
+                    messages += size <= self.sink.max_size
+                    if not self.finish_message(message, size):
+                        break
+                elif not self.apply("BDAT", 250, "%d octets received" % length):
+                    break
+            elif verb == "DATA":
+                if not self.apply("DATA", 354, "End data with <CR><LF>.<CR><LF>"):
+                    break
+                result = self.read_data()
+                if result is None:
+                    break
+                data, size = result
+                total_bytes += size
+                messages += size <= self.sink.max_size
+                if not self.finish_message(data, size):
+                    break
+            elif verb == "NOOP":
+                self.send(250, "OK")
+            elif verb == "QUIT":
+                self.apply("QUIT", 221, "Bye")
+                break
+            else:
+                self.send(502, "Command not implemented")
+        self.log("oturum: %d mesaj, %d komut, %d bayt, %.0f ms" %
+                 (messages, commands, total_bytes, (time.time() - start) * 1000))
+
+
+class Server(socketserver.ThreadingMixIn, socketserver.TCPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="DMF yerel SMTP test sunucusu")
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=2525)
+    parser.add_argument("--rule", action="append", default=[], help="KOMUT:eylem[@n]")
+    parser.add_argument("--save-dir", help="Gelen mailleri .eml olarak sakla")
+    parser.add_argument("--max-size", type=int, default=10 * 1024 * 1024, help="SIZE sınırı (bayt)")
+    parser.add_argument("--no-pipelining", action="store_true", help="PIPELINING duyurma")
+    parser.add_argument("--no-chunking", action="store_true", help="CHUNKING (BDAT) duyurma")
+    args = parser.parse_args()
+
+    Handler.sink = Sink([Rule(spec) for spec in args.rule], args.save_dir, args.max_size,
+                        not args.no_pipelining, not args.no_chunking)
+    with Server((args.host, args.port), Handler) as server:
+        # --port 0: işletim sistemi boş port seçer (host testleri ilk satırdan okur)
+        host, port = server.server_address[:2]
+        print("dmf-sink %s:%d dinliyor (%d kural)" % (host, port, len(args.rule)), flush=True)
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""SmartKraft DMF - yerel webhook (GET URL) test sunucusu.
+
+WebhookDispatcher'ın yeniden deneme, geri çekilme ve keep-alive davranışını
+gerçek HTTP/1.1 üzerinden sınamak için. Yanıt senaryosu URL yolunda yazılır:
+
+  GET /<yanıtlar>/<ad>
+    yanıtlar : virgülle ayrılmış sıra, aynı yola gelen n. istek n. öğeyi alır
+               (son öğe tekrarlanır). Öğe bir HTTP kodu (200, 429, 503 ...)
+               ya da "drop" (yanıt vermeden bağlantıyı kapat) olabilir.
+
+  GET /_hits
+    Şimdiye kadarki istekler, geliş sırasıyla, satır başına:
+      "<bağlantı no> <yanıt> <yol>"
+    (/_hits istekleri listelenmez)
+
+Yanıtlar Content-Length ile ve HTTP/1.1 keep-alive olarak döner; aynı
+bağlantı numarası soketin yeniden kullanıldığını gösterir.
+
+Host testleri (tools/host, ctest) sunucuyu --port 0 ile başlatır.
+
+Örnekler:
+  webhook_standin.py --port 8080
+  curl http://127.0.0.1:8080/429,200/uyari-1   # önce 429, sonra 200
+  curl http://127.0.0.1:8080/_hits
+"""
+
+import argparse
+import http.server
+import itertools
+import threading
+
+
+class Standin:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.counts = {}
+        self.hits = []
+        self.connections = itertools.count(1)
+
+    def next_reply(self, path):
+        parts = path.strip("/").split("/", 1)
+        steps = parts[0].split(",") if parts[0] else ["200"]
+        with self.lock:
+            n = self.counts.get(path, 0)
+            self.counts[path] = n + 1
+        return steps[min(n, len(steps) - 1)]
+
+    def record(self, connection, reply, path):
+        with self.lock:
+            self.hits.append("%d %s %s" % (connection, reply, path))
+
+    def report(self):
+        with self.lock:
+            return "".join(line + "\n" for line in self.hits)
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    standin = None
+
+    def setup(self):
+        super().setup()
+        self.connection_id = next(self.standin.connections)
+
+    def do_GET(self):
+        if self.path == "/_hits":
+            self.respond(200, self.standin.report())
+            return
+
+        reply = self.standin.next_reply(self.path)
+        self.standin.record(self.connection_id, reply, self.path)
+        if reply == "drop":
+            self.close_connection = True
+            return
+        code = int(reply)
+        self.respond(code, "dmf-standin %d\n" % code)
+
+    def respond(self, code, text):
+        body = text.encode()
+        self.send_response(code)
+        self.send_header("Content-Type", "text/plain")
+        self.send_header("Content-Length", str(len(body)))
+        self.send_header("Connection", "keep-alive")
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, fmt, *args):
+        print("[%s:%d] %s" % (self.client_address[0], self.client_address[1], fmt % args), flush=True)
+
+
+class Server(http.server.ThreadingHTTPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="DMF yerel webhook test sunucusu")
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8080)
+    args = parser.parse_args()
+
+    Handler.standin = Standin()
+    with Server((args.host, args.port), Handler) as server:
+        # --port 0: işletim sistemi boş port seçer (host testleri ilk satırdan okur)
+        host, port = server.server_address[:2]
+        print("dmf-webhook %s:%d dinliyor" % (host, port), flush=True)
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()